@@ -0,0 +1,920 @@
+/*
+ * Audio DSP golden tests (common/stft_ns, common/far_ring, common/vad_gate,
+ * common/audio_pkt, common/playout, common/time_sync).
+ *
+ * 1. Round trip: with a 0 dB floor the suppressor hands back its input
+ *    one hop late, to within FFT rounding.
+ * 2. Stationary noise: once the tracker has settled, the output is at
+ *    least 12 dB below the input.
+ * 3. Speech-like bursts in noise (250 ms on, 250 ms off): the bursts
+ *    keep their level within 1 dB and the gaps drop by at least 12 dB.
+ * 4. Golden output: a hash of every output sample from test 3. The
+ *    suppressor is integer only, so native_sim, QEMU and the FLPR all
+ *    produce the same bits; a new hash means the arithmetic changed.
+ * 5. Cost per hop next to the time-domain noise gate the FLPR audio
+ *    workloads use, as NSBENCH lines. Under QEMU (-icount shift=0) one
+ *    ns is one instruction. native_sim does not advance time while
+ *    code runs, so it skips this step.
+ * 6. Far-end ring: frames pushed with play times come back lined up by
+ *    time, to the sample, across frame edges; a lost frame leaves a
+ *    gap of zeros, frames that ended before they were wanted are
+ *    counted stale, and a full ring refuses the next frame.
+ * 7. VAD gate: closed on steady noise, open on the first frame of a
+ *    burst, held open for exactly the hangover after it, and closed
+ *    again once a 12 dB rise in the noise has been tracked.
+ * 8. Suppressor bypass: hops skipped while the gate is closed leave the
+ *    noise estimate alone, and the hop after them is still attenuated.
+ * 9. Audio packetiser: frames come back from the SDUs with their
+ *    sequence numbers, PCM and (compressed, to the sample) timestamps;
+ *    a sequence jump or a late frame closes an SDU early, the adaptive
+ *    batch follows the backlog, and batching raises the modelled
+ *    airtime efficiency.
+ * 10. Playout: over a simulated link of 4-frame SDUs at a 7.5 ms
+ *    interval, every frame plays at a delay sized from the batching;
+ *    a lost SDU goes through the conceal hook; +-100 ppm of clock
+ *    drift is estimated to 10 ppm and taken up by sample slips; a
+ *    burst of retransmissions raises the target, which falls back
+ *    after the window; a late start drops the backlog once.
+ * 11. Time sync: from connection anchors with 2 us of timestamp noise
+ *    and the odd predicted anchor, the peer clock is tracked to within
+ *    10 us at +-40 ppm, the drift to 1 ppm, and after 10 s with no
+ *    exchange the extrapolation is still inside 100 us.
+ *
+ * Signals are 8 kHz with the default N = 256 (16 ms hop), generated
+ * from an LCG and a parabolic sine so every target sees the same input.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <string.h>
+
+#include "stft_ns.h"
+#include "far_ring.h"
+#include "vad_gate.h"
+#include "audio_pkt.h"
+#include "playout.h"
+#include "time_sync.h"
+
+#define FS_HZ         8000
+#define HOP           STFT_NS_HOP
+#define TRACK_HOPS    96                  /* ~1.5 s noise window */
+#define FLOOR_DB      (-18)
+#define BURST_SAMPLES (FS_HZ / 4)         /* 250 ms on, 250 ms off */
+#define EDGE_SAMPLES  (FS_HZ / 40)        /* 25 ms skipped at each edge */
+#define SETTLE_HOPS   (3 * FS_HZ / HOP)
+#define RUN_HOPS      (7 * FS_HZ / HOP)
+#define BENCH_HOPS    64
+
+/* FNV-1a (per 16-bit sample) of test 3's output; N = 256 only */
+#define STFT_NS_GOLDEN 0x23e654a4u
+
+static int tests_passed;
+static int tests_failed;
+
+#define TEST_ASSERT(cond, name) do { \
+	if (cond) { \
+		printk("  PASS: %s\n", name); \
+		tests_passed++; \
+	} else { \
+		printk("  FAIL: %s\n", name); \
+		tests_failed++; \
+	} \
+} while (0)
+
+static struct stft_ns ns;
+static int16_t in[HOP];
+static int16_t out[HOP];
+static int16_t prev_in[HOP];
+static int16_t prev_clean[HOP];
+
+static uint32_t lcg_state;
+
+static int32_t noise(int32_t amp)
+{
+	int32_t sum = 0;
+
+	for (int i = 0; i < 2; i++) {
+		lcg_state = lcg_state * 1664525u + 1013904223u;
+		sum += (int32_t)(lcg_state >> 16) - 32768;
+	}
+	return (sum * amp) >> 16;
+}
+
+/* Parabolic sine, phase in 1/2^32 turns; 3rd harmonic at about -28 dB */
+static int32_t tone(uint32_t phase, int32_t amp)
+{
+	int32_t x = (int32_t)phase >> 16;             /* phase / pi, Q15 */
+	int32_t ax = (x < 0) ? -x : x;
+	int32_t y = (x * (32768 - ax)) >> 13;
+
+	if (y > 32767) {
+		y = 32767;
+	}
+	return (y * amp) >> 15;
+}
+
+#define PHASE_INC(hz) ((uint32_t)((4294967296ull * (hz)) / FS_HZ))
+
+static int64_t energy(const int16_t *buf, int n)
+{
+	int64_t e = 0;
+
+	for (int i = 0; i < n; i++) {
+		e += (int32_t)buf[i] * buf[i];
+	}
+	return e;
+}
+
+static void test_round_trip(void)
+{
+	int max_err = 0;
+
+	printk("\n--- Test: Round trip (0 dB floor) ---\n");
+
+	stft_ns_init(&ns, 0, TRACK_HOPS);
+	lcg_state = 1;
+	memset(prev_in, 0, sizeof(prev_in));
+
+	for (int h = 0; h < 100; h++) {
+		for (int i = 0; i < HOP; i++) {
+			uint32_t t = h * HOP + i;
+
+			in[i] = tone(t * PHASE_INC(700), 20000) + noise(8000);
+		}
+		stft_ns_process(&ns, in, out);
+		for (int i = 0; h > 0 && i < HOP; i++) {
+			int err = out[i] - prev_in[i];
+
+			err = (err < 0) ? -err : err;
+			max_err = (err > max_err) ? err : max_err;
+		}
+		memcpy(prev_in, in, sizeof(in));
+	}
+
+	printk("    max error: %d LSB\n", max_err);
+	TEST_ASSERT(max_err <= 8, "Output = input one hop late (within 8 LSB)");
+}
+
+static void test_stationary_noise(void)
+{
+	int64_t e_in = 0, e_out = 0;
+
+	printk("\n--- Test: Stationary noise ---\n");
+
+	stft_ns_init(&ns, FLOOR_DB, TRACK_HOPS);
+	lcg_state = 2;
+
+	for (int h = 0; h < RUN_HOPS; h++) {
+		for (int i = 0; i < HOP; i++) {
+			in[i] = noise(2000);
+		}
+		stft_ns_process(&ns, in, out);
+		if (h >= SETTLE_HOPS) {
+			e_in += energy(in, HOP);
+			e_out += energy(out, HOP);
+		}
+	}
+
+	printk("    out/in energy: %u/1000\n", (uint32_t)(e_out * 1000 / e_in));
+	TEST_ASSERT(e_out * 16 <= e_in, "Noise attenuated >= 12 dB");
+}
+
+static void test_bursts(void)
+{
+	int64_t e_clean = 0, e_on = 0, e_gap_in = 0, e_gap_out = 0;
+	uint32_t hash = 2166136261u;
+	int16_t clean[HOP];
+
+	printk("\n--- Test: Speech-like bursts in noise ---\n");
+
+	stft_ns_init(&ns, FLOOR_DB, TRACK_HOPS);
+	lcg_state = 3;
+	memset(prev_in, 0, sizeof(prev_in));
+	memset(prev_clean, 0, sizeof(prev_clean));
+
+	for (int h = 0; h < RUN_HOPS; h++) {
+		for (int i = 0; i < HOP; i++) {
+			uint32_t t = h * HOP + i;
+			bool on = (t / BURST_SAMPLES) % 2 == 0;
+
+			clean[i] = on ? tone(t * PHASE_INC(1000), 8000) +
+					tone(t * PHASE_INC(370), 4000) : 0;
+			in[i] = clean[i] + noise(1000);
+		}
+		stft_ns_process(&ns, in, out);
+
+		for (int i = 0; i < HOP; i++) {
+			hash = (hash ^ (uint16_t)out[i]) * 16777619u;
+		}
+
+		/* out is the previous hop's input */
+		for (int i = 0; h > SETTLE_HOPS && i < HOP; i++) {
+			uint32_t t = (h - 1) * HOP + i;
+			uint32_t pos = t % BURST_SAMPLES;
+
+			if (pos < EDGE_SAMPLES || pos >= BURST_SAMPLES - EDGE_SAMPLES) {
+				continue;
+			}
+			if ((t / BURST_SAMPLES) % 2 == 0) {
+				e_clean += (int32_t)prev_clean[i] * prev_clean[i];
+				e_on += (int32_t)out[i] * out[i];
+			} else {
+				e_gap_in += (int32_t)prev_in[i] * prev_in[i];
+				e_gap_out += (int32_t)out[i] * out[i];
+			}
+		}
+		memcpy(prev_in, in, sizeof(in));
+		memcpy(prev_clean, clean, sizeof(clean));
+	}
+
+	printk("    bursts out/clean: %u/1000, gaps out/in: %u/1000\n",
+	       (uint32_t)(e_on * 1000 / e_clean), (uint32_t)(e_gap_out * 1000 / e_gap_in));
+	/* 10^(+-1/10) = 1.26 and 0.79 */
+	TEST_ASSERT(e_on * 100 >= e_clean * 79 && e_on * 100 <= e_clean * 126,
+		    "Bursts kept within 1 dB");
+	TEST_ASSERT(e_gap_out * 16 <= e_gap_in, "Gaps attenuated >= 12 dB");
+
+	printk("    output hash: 0x%08x\n", hash);
+#if STFT_NS_N == 256
+	TEST_ASSERT(hash == STFT_NS_GOLDEN, "Output matches golden hash");
+#endif
+}
+
+#if defined(CONFIG_ARCH_POSIX)
+static void bench_cost(void)
+{
+	printk("\n--- Cost per hop ---\n");
+	printk("  SKIP: time does not advance while code runs on native_sim\n");
+}
+#else
+/* The time-domain stage in the FLPR audio workloads (6 and 7) */
+static void noise_gate(int16_t *buf, int n)
+{
+	int32_t noise_floor = 100;
+
+	for (int i = 0; i < n; i++) {
+		int32_t mag = (buf[i] < 0) ? -buf[i] : buf[i];
+
+		if (mag <= noise_floor) {
+			buf[i] = 0;
+		}
+	}
+}
+
+static void bench_cost(void)
+{
+	uint32_t t0, stft_cyc, gate_cyc;
+
+	printk("\n--- Cost per hop ---\n");
+
+	stft_ns_init(&ns, FLOOR_DB, TRACK_HOPS);
+	lcg_state = 4;
+	for (int i = 0; i < HOP; i++) {
+		in[i] = noise(2000);
+	}
+
+	t0 = k_cycle_get_32();
+	for (int h = 0; h < BENCH_HOPS; h++) {
+		stft_ns_process(&ns, in, out);
+	}
+	stft_cyc = k_cycle_get_32() - t0;
+
+	t0 = k_cycle_get_32();
+	for (int h = 0; h < BENCH_HOPS; h++) {
+		memcpy(out, in, sizeof(in));
+		noise_gate(out, HOP);
+	}
+	gate_cyc = k_cycle_get_32() - t0;
+
+	printk("NSBENCH impl=stft n=%d hop=%d: %u ns/hop\n", STFT_NS_N, HOP,
+	       (uint32_t)(k_cyc_to_ns_floor64(stft_cyc) / BENCH_HOPS));
+	printk("NSBENCH impl=gate hop=%d: %u ns/hop\n", HOP,
+	       (uint32_t)(k_cyc_to_ns_floor64(gate_cyc) / BENCH_HOPS));
+}
+#endif
+
+static struct far_ring ring;
+static struct far_ring_cursor cursor;
+static int16_t frame_pcm[FAR_RING_FRAME];
+static int16_t ref[FAR_RING_FRAME];
+
+#define RING_T0_US 1000000u
+#define SAMPLE_NS  (1000000000u / FAR_RING_RATE_HZ)
+
+static void push_frame(uint32_t seq)
+{
+	for (int i = 0; i < FAR_RING_FRAME; i++) {
+		frame_pcm[i] = seq * 1000 + i;
+	}
+	far_ring_push(&ring, seq, RING_T0_US + seq * FAR_RING_FRAME_US, frame_pcm);
+}
+
+/* Play time of sample i of frame seq */
+static uint32_t play_us(uint32_t seq, int i)
+{
+	return RING_T0_US + seq * FAR_RING_FRAME_US + i * SAMPLE_NS / 1000;
+}
+
+/* ref holds frame seq from sample i on, as far as n samples go */
+static bool ref_matches(uint32_t seq, int i, int n)
+{
+	for (int j = 0; j < n; j++) {
+		int k = i + j;
+		int16_t want = (seq + k / FAR_RING_FRAME) * 1000 + k % FAR_RING_FRAME;
+
+		if (ref[j] != want) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool ref_zero(int from)
+{
+	for (int j = from; j < FAR_RING_FRAME; j++) {
+		if (ref[j] != 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static void test_far_ring(void)
+{
+	struct far_ring_align align;
+	int ok;
+
+	printk("\n--- Test: Far-end ring ---\n");
+
+	memset(&ring, 0, sizeof(ring));
+	memset(&cursor, 0, sizeof(cursor));
+	far_ring_fetch(&ring, &cursor, RING_T0_US, ref, &align);
+	TEST_ASSERT(align.covered == 0 && ref_zero(0), "Uninitialised ring reads as silence");
+
+	far_ring_init(&ring);
+	memset(&cursor, 0, sizeof(cursor));
+	for (uint32_t seq = 0; seq < 4; seq++) {
+		push_frame(seq);
+	}
+
+	/* Window starts 5 samples into frame 1 and runs into frame 2 */
+	far_ring_fetch(&ring, &cursor, play_us(1, 5), ref, &align);
+	printk("    frame edge: covered %u, err %d ns\n", align.covered, align.err_ns);
+	TEST_ASSERT(align.covered == FAR_RING_FRAME && align.err_ns == 0 &&
+		    ref_matches(1, 5, FAR_RING_FRAME), "Reference spans a frame edge exactly");
+	TEST_ASSERT(cursor.stale == 1, "Frame that ended before the window counted stale");
+
+	/* 40 us past a sample rounds to it and reports the residual */
+	far_ring_fetch(&ring, &cursor, play_us(2, 5) + 40, ref, &align);
+	printk("    off-grid: err %d ns\n", align.err_ns);
+	TEST_ASSERT(ref_matches(2, 5, FAR_RING_FRAME) && align.err_ns == 40000,
+		    "Off-grid time rounds to the nearest sample");
+
+	/* Frame 4 is lost: the tail of the window is silence */
+	push_frame(5);
+	far_ring_fetch(&ring, &cursor, play_us(3, 5), ref, &align);
+	ok = ref_matches(3, 5, FAR_RING_FRAME - 5) && ref_zero(FAR_RING_FRAME - 5);
+	printk("    lost frame: covered %u, gap samples %u\n", align.covered,
+	       cursor.gap_samples);
+	TEST_ASSERT(ok && align.covered == FAR_RING_FRAME - 5 && cursor.gap_samples == 5,
+		    "Lost frame leaves a gap, not a shift");
+
+	/* Full ring refuses the next frame */
+	far_ring_init(&ring);
+	memset(&cursor, 0, sizeof(cursor));
+	ok = 0;
+	for (uint32_t seq = 0; seq < FAR_RING_SLOTS; seq++) {
+		ok += far_ring_push(&ring, seq, play_us(seq, 0), frame_pcm) == 0;
+	}
+	TEST_ASSERT(ok == FAR_RING_SLOTS &&
+		    far_ring_push(&ring, FAR_RING_SLOTS, play_us(FAR_RING_SLOTS, 0),
+				  frame_pcm) == -ENOSPC, "Full ring refuses a frame");
+}
+
+#define GATE_HANG 15  /* 240 ms of 16 ms frames */
+
+static void test_vad_gate(void)
+{
+	struct vad_gate g;
+	enum vad_gate_state st;
+	int open = 0, onset_ok = 0, hang = 0, after = 0, retrack = -1;
+
+	printk("\n--- Test: VAD gate ---\n");
+
+	vad_gate_init(&g, 9, GATE_HANG);
+	lcg_state = 5;
+
+	/* 2 s of noise, then a 500 ms burst, then noise again */
+	for (int f = 0; f < 250; f++) {
+		bool on = f >= 125 && f < 156;
+
+		for (int i = 0; i < HOP; i++) {
+			uint32_t t = f * HOP + i;
+
+			in[i] = noise(300) + (on ? tone(t * PHASE_INC(200), 6000) : 0);
+		}
+		st = vad_gate_update(&g, in, HOP);
+
+		if (f >= 10 && f < 125) {
+			open += vad_gate_open(st);
+		} else if (f == 125) {
+			onset_ok = (st == VAD_GATE_SPEECH);
+		} else if (f >= 156 && f < 156 + GATE_HANG) {
+			hang += (st == VAD_GATE_HANGOVER);
+		} else if (f >= 156 + GATE_HANG) {
+			after += vad_gate_open(st);
+		}
+	}
+	printk("    noise frames open: %d, hangover frames: %d/%d\n", open, hang, GATE_HANG);
+	TEST_ASSERT(open == 0, "Closed on steady noise");
+	TEST_ASSERT(onset_ok, "Open on the first burst frame");
+	TEST_ASSERT(hang == GATE_HANG && after == 0, "Held open for the hangover, then closed");
+
+	/* Noise steps up 12 dB: open at first, closed once tracked */
+	for (int f = 0; f < 250; f++) {
+		for (int i = 0; i < HOP; i++) {
+			in[i] = noise(1200);
+		}
+		st = vad_gate_update(&g, in, HOP);
+		if (!vad_gate_open(st) && retrack < 0) {
+			retrack = f;
+		}
+		if (vad_gate_open(st)) {
+			retrack = -1;
+		}
+	}
+	printk("    closed again after %d frames\n", retrack);
+	TEST_ASSERT(retrack >= 0 && retrack < 190, "Noise rise tracked within 3 s");
+}
+
+static void test_ns_bypass(void)
+{
+	int64_t e_in = 0, e_out = 0;
+	uint32_t before, after;
+
+	printk("\n--- Test: Suppressor bypass ---\n");
+
+	stft_ns_init(&ns, FLOOR_DB, TRACK_HOPS);
+	lcg_state = 6;
+
+	for (int h = 0; h < SETTLE_HOPS; h++) {
+		for (int i = 0; i < HOP; i++) {
+			in[i] = noise(2000);
+		}
+		stft_ns_process(&ns, in, out);
+	}
+	before = stft_ns_noise(&ns, 20);
+
+	/* One second gated, then two hops processed */
+	for (int h = 0; h < FS_HZ / HOP; h++) {
+		for (int i = 0; i < HOP; i++) {
+			in[i] = noise(2000);
+		}
+		stft_ns_skip(&ns, in);
+	}
+	after = stft_ns_noise(&ns, 20);
+
+	for (int h = 0; h < 2; h++) {
+		for (int i = 0; i < HOP; i++) {
+			in[i] = noise(2000);
+		}
+		stft_ns_process(&ns, in, out);
+		e_in += energy(in, HOP);
+		e_out += energy(out, HOP);
+	}
+
+	printk("    noise estimate %u -> %u, out/in energy: %u/1000\n", before, after,
+	       (uint32_t)(e_out * 1000 / e_in));
+	TEST_ASSERT(before == after, "Noise estimate kept through the bypass");
+	TEST_ASSERT(e_out * 16 <= e_in, "Attenuated >= 12 dB right after the bypass");
+}
+
+static uint8_t pkt_sdu[AUDIO_PKT_SDU_MAX];
+static int16_t pkt_pcm[AUDIO_PKT_FRAME];
+
+/* Push frame seq of a stream whose frames are 16 ms apart plus jitter_us */
+static size_t pkt_push(struct audio_pkt *p, uint16_t seq, int32_t jitter_us)
+{
+	for (int i = 0; i < AUDIO_PKT_FRAME; i++) {
+		pkt_pcm[i] = (int16_t)(seq * 131 + i);
+	}
+	return audio_pkt_push(p, seq, 1000000 + seq * AUDIO_PKT_FRAME_US + jitter_us,
+			      pkt_pcm, pkt_sdu);
+}
+
+/* Parse an SDU and check every frame against what pkt_push() sent */
+static int pkt_check(size_t len, int32_t (*jitter)(uint16_t), uint32_t tol_us)
+{
+	struct audio_pkt_frame f[AUDIO_PKT_MAX_FRAMES];
+	int n = audio_pkt_parse(pkt_sdu, len, f, AUDIO_PKT_MAX_FRAMES);
+
+	for (int k = 0; k < n; k++) {
+		int32_t err = (int32_t)(f[k].ts_us - (1000000 + f[k].seq * AUDIO_PKT_FRAME_US +
+						      jitter(f[k].seq)));
+
+		if ((err < 0 ? -err : err) > (int32_t)tol_us) {
+			return -1;
+		}
+		for (int i = 0; i < AUDIO_PKT_FRAME; i++) {
+			int16_t v = (int16_t)(f[k].pcm[2 * i] | (f[k].pcm[2 * i + 1] << 8));
+
+			if (v != (int16_t)(f[k].seq * 131 + i)) {
+				return -1;
+			}
+		}
+	}
+	return n;
+}
+
+static int32_t pkt_no_jitter(uint16_t seq)
+{
+	return 0;
+}
+
+static int32_t pkt_jitter(uint16_t seq)
+{
+	return (int32_t)((seq * 2654435761u) >> 22) - 512;  /* +-512 us */
+}
+
+static void test_audio_pkt(void)
+{
+	struct audio_pkt p;
+	struct audio_pkt_cfg cfg = {
+		.frames = 3, .compress = false, .hold_us = 100000, .sdu_max = 2000,
+	};
+	size_t len;
+	int sdus = 0, frames = 0, ok = 1;
+	uint32_t eff1, eff4;
+	static struct audio_pkt_q q;
+	uint8_t gatt, l2cap;
+
+	printk("\n--- Test: Audio packetiser ---\n");
+
+	/* Plain, 3 frames per SDU */
+	audio_pkt_init(&p, &cfg);
+	for (uint16_t seq = 0; seq < 9; seq++) {
+		len = pkt_push(&p, seq, 0);
+		if (len) {
+			int n = pkt_check(len, pkt_no_jitter, 0);
+
+			ok &= (n == 3 && len == AUDIO_PKT_HDR_PLAIN(3) + 3 * AUDIO_PKT_FRAME_BYTES);
+			sdus++;
+			frames += n;
+		}
+	}
+	TEST_ASSERT(ok && sdus == 3 && frames == 9, "Plain SDUs carry 3 frames each, exactly");
+
+	/* Compressed, jittered timestamps, and a sequence jump */
+	cfg.compress = true;
+	cfg.frames = 4;
+	audio_pkt_init(&p, &cfg);
+	ok = 1;
+	frames = 0;
+	for (int i = 0; i < 20; i++) {
+		uint16_t seq = (i < 14) ? i : i + 300;
+
+		len = pkt_push(&p, seq, pkt_jitter(seq));
+		if (len) {
+			int n = pkt_check(len, pkt_jitter, AUDIO_PKT_TS_UNIT_US / 2);
+
+			ok &= (n > 0);
+			frames += n;
+		}
+	}
+	len = audio_pkt_flush(&p, pkt_sdu);
+	frames += pkt_check(len, pkt_jitter, AUDIO_PKT_TS_UNIT_US / 2);
+	printk("    compressed: %u SDUs, %u header bytes, %u breaks\n",
+	       p.sdus, p.hdr_bytes, p.breaks);
+	TEST_ASSERT(ok && frames == 20, "Compressed SDUs rebuild times to the sample");
+	TEST_ASSERT(p.breaks == 1, "Sequence jump closes the SDU");
+
+	/* Hold time: 32 ms allows 3 frames; a frame 1 ms late closes at 2 */
+	cfg.frames = 4;
+	cfg.hold_us = 32000;
+	audio_pkt_init(&p, &cfg);
+	pkt_push(&p, 0, 0);
+	len = pkt_push(&p, 1, 1000);
+	TEST_ASSERT(p.limit == 3 && len == AUDIO_PKT_HDR_COMPRESSED(2) + 2 * AUDIO_PKT_FRAME_BYTES &&
+		    p.early == 1 && p.hold_max_us == 17000, "Hold time closes a late SDU");
+
+	/* Adaptive batch: grows while the queue holds more than one SDU */
+	cfg.adaptive = true;
+	cfg.hold_us = 100000;
+	audio_pkt_init(&p, &cfg);
+	for (int i = 0; i < 5; i++) {
+		audio_pkt_backlog(&p, 3);
+	}
+	ok = (p.batch == 4);
+	for (int i = 0; i < AUDIO_PKT_SHRINK_AFTER; i++) {
+		audio_pkt_backlog(&p, 1);
+	}
+	TEST_ASSERT(ok && p.batch == 3, "Adaptive batch follows the backlog");
+
+	/* Airtime model, L2CAP CoC with 247-byte K-frames over 251-byte PDUs */
+	eff1 = 1000 * (AUDIO_PKT_FRAME_BYTES * 4) /
+	       audio_pkt_air_us(AUDIO_PKT_HDR_COMPRESSED(1) + AUDIO_PKT_FRAME_BYTES, 247, 251, 2);
+	eff4 = 1000 * (4 * AUDIO_PKT_FRAME_BYTES * 4) /
+	       audio_pkt_air_us(AUDIO_PKT_HDR_COMPRESSED(4) + 4 * AUDIO_PKT_FRAME_BYTES, 247, 251, 2);
+	printk("    airtime efficiency, 2M PHY: 1 frame %u/1000, 4 frames %u/1000\n", eff1, eff4);
+	TEST_ASSERT(eff4 > eff1, "Batching raises airtime efficiency");
+
+	/* In-flight queue: switch bearers with three GATT SDUs still out */
+	audio_pkt_q_init(&q, 4);
+	gatt = audio_pkt_q_path(&q);
+	for (int i = 0; i < 4; i++) {
+		audio_pkt_q_push(&q)->n = i;
+	}
+	ok = (audio_pkt_q_push(&q) == NULL && audio_pkt_q_sent(&q, gatt)->n == 0);
+	l2cap = audio_pkt_q_path(&q);
+	ok &= (audio_pkt_q_len(&q) == 0 && audio_pkt_q_push(&q) != NULL);
+	/* Late GATT completions, then the new bearer's own */
+	for (int i = 0; i < 3; i++) {
+		ok &= (audio_pkt_q_sent(&q, gatt) == NULL);
+	}
+	ok &= (audio_pkt_q_len(&q) == 1 && audio_pkt_q_sent(&q, l2cap) != NULL &&
+	       audio_pkt_q_len(&q) == 0 && audio_pkt_q_sent(&q, l2cap) == NULL);
+	for (int i = 0; i < 4; i++) {
+		ok &= (audio_pkt_q_push(&q) != NULL);
+	}
+	TEST_ASSERT(ok && q.stale == 4 && audio_pkt_q_len(&q) == 4,
+		    "Bearer switch drops the old path's completions");
+}
+
+/* A simulated link into the playout engine. The sender closes an SDU
+ * every batch frames; it arrives at the next connection event, on a
+ * receiver clock that runs ppm apart, plus up to burst_events extra
+ * events (retransmissions) inside the burst. L2CAP delivers in order.
+ */
+#define PO_CI_US 7500
+
+struct po_link {
+	int batch;
+	int32_t ppm;
+	uint32_t burst_from_ms;
+	uint32_t burst_to_ms;
+	uint32_t burst_events;
+	int lose_sdu;           /* SDU to drop, or -1 */
+	uint32_t pull_from_us;  /* first playout tick */
+	uint32_t warmup_ms;
+};
+
+struct po_result {
+	uint32_t concealed_warm;  /* concealed at the end of the warm-up */
+	int32_t target_max;
+	struct playout_status end;
+};
+
+static struct playout po;
+static int16_t po_in[PLAYOUT_FRAME];
+static int16_t po_out[PLAYOUT_FRAME];
+static uint32_t po_hook_calls;
+static uint32_t po_hook_missing;
+
+static void po_conceal(void *user, int16_t *out, const int16_t *last, uint32_t missing)
+{
+	po_hook_calls++;
+	po_hook_missing = MAX(po_hook_missing, missing);
+	playout_conceal_fade(user, out, last, missing);
+}
+
+static void po_run(const struct po_link *l, uint32_t ms, struct po_result *res)
+{
+	struct playout_cfg cfg = {
+		.min_frames = 2, .max_frames = 12, .window_frames = 128, .conceal = po_conceal,
+	};
+	struct playout_status s;
+	uint32_t pull_us = l->pull_from_us;
+	uint32_t last = 0;
+	int sdu = 0;
+
+	playout_init(&po, &cfg);
+	memset(res, 0, sizeof(*res));
+	po_hook_calls = 0;
+	po_hook_missing = 0;
+	lcg_state = 11;
+
+	for (uint32_t k = 0; k * PLAYOUT_FRAME_US < ms * 1000; k += l->batch, sdu++) {
+		int64_t close = (int64_t)(k + l->batch) * PLAYOUT_FRAME_US;
+		uint32_t arrival;
+
+		close += close * l->ppm / 1000000;
+		arrival = (uint32_t)((close + PO_CI_US - 1) / PO_CI_US * PO_CI_US) + 400;
+		if (close >= l->burst_from_ms * 1000ll && close < l->burst_to_ms * 1000ll) {
+			lcg_state = lcg_state * 1664525u + 1013904223u;
+			arrival += (lcg_state >> 16) % (l->burst_events + 1) * PO_CI_US;
+		}
+		arrival = MAX(arrival, last);
+		last = arrival;
+
+		while (pull_us < arrival) {
+			playout_pull(&po, pull_us, po_out);
+			playout_status(&po, pull_us, &s);
+			res->target_max = MAX(res->target_max, s.target_us);
+			if (pull_us / 1000 < l->warmup_ms) {
+				res->concealed_warm = po.concealed;
+			}
+			pull_us += PLAYOUT_FRAME_US;
+		}
+
+		if (sdu == l->lose_sdu) {
+			continue;
+		}
+		for (int i = 0; i < l->batch; i++) {
+			for (int j = 0; j < PLAYOUT_FRAME; j++) {
+				po_in[j] = (int16_t)((k + i) * 131 + j);
+			}
+			playout_put(&po, k + i, 5000000 + (k + i) * PLAYOUT_FRAME_US, arrival, po_in);
+		}
+	}
+	playout_status(&po, pull_us, &res->end);
+}
+
+static void test_playout(void)
+{
+	struct po_link l = {
+		.batch = 4, .lose_sdu = -1, .warmup_ms = 2000,
+	};
+	struct po_result res, steady;
+	int32_t err;
+
+	printk("\n--- Test: Playout ---\n");
+
+	/* Steady link, 4-frame SDUs every 64 ms */
+	po_run(&l, 20000, &steady);
+	err = steady.end.offset_us - steady.end.target_us;
+	printk("    steady: target %d us, spread %d us, jitter %u us, offset err %d us\n",
+	       steady.end.target_us, steady.end.spread_us, steady.end.jitter_us, err);
+	TEST_ASSERT(po.concealed == 0 && po.late == 0 && po.skipped == 0 && po.overruns == 0,
+		    "Steady link plays every frame");
+	TEST_ASSERT(steady.end.target_us <= 5 * PLAYOUT_FRAME_US + PO_CI_US &&
+		    err >= -PLAYOUT_FRAME_US / 4 && err <= PLAYOUT_FRAME_US / 4,
+		    "Delay settles on a target sized from the batching");
+
+	/* One lost SDU: four frames through the conceal hook */
+	l.lose_sdu = 100;
+	po_run(&l, 20000, &res);
+	TEST_ASSERT(po.concealed == 4 && po_hook_calls == 4 && po_hook_missing == 4 &&
+		    po.late == 0, "Lost SDU concealed through the hook");
+	l.lose_sdu = -1;
+
+	/* Clock drift both ways, 60 s */
+	for (int32_t ppm = -100; ppm <= 100; ppm += 200) {
+		l.ppm = ppm;
+		po_run(&l, 60000, &res);
+		printk("    %+d ppm: estimate %d ppb, slips %u dropped %u repeated, concealed %u\n",
+		       ppm, res.end.drift_ppb, po.slips_drop, po.slips_repeat, po.concealed);
+		err = res.end.drift_ppb - ppm * 1000;
+		TEST_ASSERT(err > -10000 && err < 10000 &&
+			    po.concealed == res.concealed_warm &&
+			    (ppm > 0 ? po.slips_repeat > po.slips_drop : po.slips_drop > po.slips_repeat),
+			    ppm > 0 ? "Slow sender: drift found, samples repeated"
+				    : "Fast sender: drift found, samples dropped");
+	}
+	l.ppm = 0;
+
+	/* 5 s of retransmissions, up to 8 connection events late */
+	l.burst_from_ms = 20000;
+	l.burst_to_ms = 25000;
+	l.burst_events = 8;
+	po_run(&l, 40000, &res);
+	printk("    burst: target %d -> %d -> %d us, concealed %u, held %u, skipped %u\n",
+	       steady.end.target_us, res.target_max, res.end.target_us, po.concealed, po.held,
+	       po.skipped);
+	TEST_ASSERT(res.target_max >= steady.end.target_us + 6 * PO_CI_US &&
+		    res.end.target_us == steady.end.target_us,
+		    "Target rises in a burst and falls back after the window");
+	TEST_ASSERT(po.concealed <= 8, "Burst costs at most 8 concealed frames");
+	l.burst_events = 0;
+
+	/* Playout starts 1 s after the stream: the ring overflows once */
+	l.pull_from_us = 1000000;
+	po_run(&l, 20000, &res);
+	printk("    late start: %u overruns, %u skipped\n", po.overruns, po.skipped);
+	TEST_ASSERT(po.overruns > 0 && po.state == PLAYOUT_PLAYING &&
+		    po.concealed == res.concealed_warm && res.concealed_warm == 0,
+		    "Late start drops the backlog and plays on");
+}
+
+/* Two clocks over a simulated link: the central's anchors are its own
+ * clock at every TS_CI_US, the peripheral's are the same instants on a
+ * clock ppm apart and TS_PEER_OFFSET_US ahead, stamped with up to 2 us
+ * of noise. Every 37th peer anchor is a predicted one, 60 us off. The
+ * peer's anchors reach the central TS_DELAY_EVENTS later.
+ */
+#define TS_CI_US          7500
+#define TS_STRIDE         8
+#define TS_DELAY_EVENTS   3
+#define TS_LOCAL0_US      2000000ull
+#define TS_PEER_OFFSET_US 123456789ll
+
+static struct time_sync tsync;
+
+static uint64_t ts_peer_true(uint64_t local_us, int32_t ppm)
+{
+	int64_t t = (int64_t)(local_us - TS_LOCAL0_US);
+
+	return TS_LOCAL0_US + TS_PEER_OFFSET_US + t + t * ppm / 1000000;
+}
+
+/* Runs `events` connection events and returns the largest error of
+ * to_peer() at every event once 16 pairs are in
+ */
+static int64_t ts_run(int32_t ppm, uint32_t events)
+{
+	int64_t worst = 0;
+	int n = 0;
+
+	time_sync_init(&tsync);
+	lcg_state = 5;
+
+	for (uint32_t k = 0; k < events; k++) {
+		uint64_t local = TS_LOCAL0_US + (uint64_t)k * TS_CI_US;
+		uint64_t peer;
+
+		if (k % TS_STRIDE == 0) {
+			time_sync_local(&tsync, (uint16_t)k, local);
+		}
+		if (k >= TS_DELAY_EVENTS && (k - TS_DELAY_EVENTS) % TS_STRIDE == 0) {
+			uint32_t e = k - TS_DELAY_EVENTS;
+			uint64_t at = TS_LOCAL0_US + (uint64_t)e * TS_CI_US;
+
+			peer = ts_peer_true(at, ppm) + noise(2);
+			if (++n % 37 == 0) {
+				peer += 60;
+			}
+			time_sync_peer(&tsync, (uint16_t)e, peer);
+		}
+		if (n >= 16 && time_sync_to_peer(&tsync, local, &peer)) {
+			int64_t err = (int64_t)(peer - ts_peer_true(local, ppm));
+
+			worst = MAX(worst, err < 0 ? -err : err);
+		}
+	}
+	return worst;
+}
+
+static void test_time_sync(void)
+{
+	uint64_t peer, local, x;
+	int64_t err, hold;
+
+	printk("\n--- Test: Time sync ---\n");
+
+	time_sync_init(&tsync);
+	TEST_ASSERT(!time_sync_to_peer(&tsync, TS_LOCAL0_US, &peer) &&
+		    !time_sync_peer(&tsync, 0, TS_LOCAL0_US),
+		    "No estimate before the first matched pair");
+
+	for (int32_t ppm = -40; ppm <= 40; ppm += 80) {
+		/* 30 s of a 7.5 ms interval */
+		err = ts_run(ppm, 4000);
+		printk("    %+d ppm: worst %lld us, drift %d ppb, resid %u us, %u pairs, "
+		       "%u outliers\n", ppm, (long long)err, tsync.drift_ppb, tsync.resid_us,
+		       tsync.pairs, tsync.outliers);
+		TEST_ASSERT(err < 10 && tsync.outliers > 0 &&
+			    tsync.drift_ppb > ppm * 1000 - 1000 && tsync.drift_ppb < ppm * 1000 + 1000,
+			    ppm > 0 ? "Fast peer tracked to 10 us, drift to 1 ppm"
+				    : "Slow peer tracked to 10 us, drift to 1 ppm");
+
+		/* Exchange stops: extrapolate 10 s past the newest pair */
+		x = tsync.ref_local + 10000000;
+		time_sync_to_peer(&tsync, x, &peer);
+		hold = (int64_t)(peer - ts_peer_true(x, ppm));
+		time_sync_to_local(&tsync, peer, &local);
+		printk("    %+d ppm: 10 s holdover %lld us, round trip %lld us\n", ppm,
+		       (long long)hold, (long long)(local - x));
+		TEST_ASSERT(hold > -100 && hold < 100 && local - x + 1 <= 2,
+			    "Holdover stays inside 100 us and converts back");
+	}
+}
+
+int main(void)
+{
+	printk("========================================\n");
+	printk("Audio DSP Golden Tests\n");
+	printk("Board: %s\n", CONFIG_BOARD);
+	printk("========================================\n");
+
+	test_round_trip();
+	test_stationary_noise();
+	test_bursts();
+	bench_cost();
+	test_far_ring();
+	test_vad_gate();
+	test_ns_bypass();
+	test_audio_pkt();
+	test_playout();
+	test_time_sync();
+
+	printk("\n========================================\n");
+	printk("Results: %d passed, %d failed\n", tests_passed, tests_failed);
+	printk("========================================\n");
+
+	if (tests_failed > 0) {
+		printk("VALIDATION FAILED\n");
+	} else {
+		printk("ALL TESTS PASSED\n");
+	}
+
+	return 0;
+}
@@ -22,9 +22,14 @@ Examples:
 
     # Combined
     python3 ble_throughput_test.py --name nRF54L15_Dual --device-tx 48 --workload 6  # Audio + 48 kbps BLE
+
+    # Far-end downlink (needs far_end.conf on both images)
+    python3 ble_throughput_test.py --name nRF54L15_Dual --workload 7 --far-end 440   # 440 Hz AEC reference
 """
 
 import asyncio
+import math
+import struct
 import time
 import argparse
 from bleak import BleakClient, BleakScanner
@@ -34,12 +39,18 @@ TX_CHAR_UUID = "6e400003-b5a3-f393-e0a9-e50e24dcca9e"  # Device TX (we receive)
 RX_CHAR_UUID = "6e400002-b5a3-f393-e0a9-e50e24dcca9e"  # Device RX (we send)
 CTRL_CHAR_UUID = "6e400004-b5a3-f393-e0a9-e50e24dcca9e"  # Control (configure device TX rate)
 RISCV_WORKLOAD_UUID = "6e400005-b5a3-f393-e0a9-e50e24dcca9e"  # RISC-V workload control
+FAR_END_UUID = "6e400007-b5a3-f393-e0a9-e50e24dcca9e"  # Far-end audio (AEC reference downlink)
 DEVICE_NAME = None  # Will be set by command line or default to "nRF54L15_Test"
 
 # Target TX rate (kbps) - can be overridden by command line arg
 TARGET_TX_KBPS = None  # None = max speed, 0 = RX only (no TX)
 DEVICE_TX_KBPS = None  # None = max speed, 0 = disabled
 RISCV_WORKLOAD = None  # None = don't change, 0-6 = set workload
+FAR_END_HZ = None  # None = no downlink, else tone frequency (Hz)
+
+# Far-end frames: 128 samples at 8 kHz = 16 ms
+FAR_END_RATE = 8000
+FAR_END_FRAME = 128
 
 # Stats tracking
 rx_bytes = 0
@@ -123,6 +134,31 @@ async def send_data(client):
             await asyncio.sleep(0.1)
 
 
+async def send_far_end(client):
+    """Stream a tone to the far-end audio characteristic in real time"""
+    period = FAR_END_FRAME / FAR_END_RATE
+    step = 2 * math.pi * FAR_END_HZ / FAR_END_RATE
+    seq = 0
+    next_time = time.monotonic()
+
+    print(f"Streaming far-end audio: {FAR_END_HZ} Hz tone, {period*1000:.0f} ms frames")
+
+    while True:
+        first = seq * FAR_END_FRAME
+        samples = [int(8000 * math.sin(step * (first + i))) for i in range(FAR_END_FRAME)]
+        # seq (u16), reserved (u16), 128 x s16, all little-endian
+        frame = struct.pack(f'<HH{FAR_END_FRAME}h', seq & 0xFFFF, 0, *samples)
+        try:
+            await client.write_gatt_char(FAR_END_UUID, frame, response=False)
+        except Exception as e:
+            print(f"Error sending far-end frame {seq}: {e}")
+
+        # Keep to the audio clock rather than accumulating sleep error
+        seq += 1
+        next_time += period
+        await asyncio.sleep(max(0, next_time - time.monotonic()))
+
+
 async def main():
     """Main function to connect and run throughput test"""
     global rx_bytes, tx_bytes, start_time
@@ -183,7 +219,10 @@ async def main():
                 10: "Clothing Rustle Suppression (impulse noise)",
                 11: "Spatial Noise Cancellation (GSC + adaptive filter)",
                 12: "Wind Noise Reduction (correlation-based)",
-                13: "Full Necklace Pipeline (6-stage processing)"
+                13: "Full Necklace Pipeline (6-stage processing)",
+                14: "Corebench (CoreMark-class compute, needs corebench.conf)",
+                15: "PDM Decimation (CIC + FIR to 8 kHz PCM, needs pdm_dec.conf)",
+                16: "STFT Noise Suppression (vs time-domain gate, needs stft_ns.conf)"
             }
             workload_name = workload_names.get(RISCV_WORKLOAD, "Unknown")
             print(f"Configuring RISC-V workload to {RISCV_WORKLOAD} ({workload_name})...")
@@ -196,6 +235,11 @@ async def main():
         # Start stats display task
         stats_task = asyncio.create_task(print_stats())
 
+        # Start the far-end downlink if requested
+        far_end_task = None
+        if FAR_END_HZ is not None:
+            far_end_task = asyncio.create_task(send_far_end(client))
+
         # Start sending data
         try:
             await send_data(client)
@@ -203,6 +247,8 @@ async def main():
             print("\n\nTest stopped by user")
         finally:
             stats_task.cancel()
+            if far_end_task:
+                far_end_task.cancel()
 
             # Print final stats
             if start_time:
@@ -227,6 +273,8 @@ Examples:
   %(prog)s --mac-tx 0                         Mac doesn't send, Device: max speed
   %(prog)s --mac-tx 0 --device-tx 50          Mac RX only, Device: 50 kbps
   %(prog)s --name nRF54L15_Dual               Connect to dual-core app
+  %(prog)s --name nRF54L15_Dual --workload 7 --far-end 440
+                                              AEC with a 440 Hz far-end reference
         '''
     )
 
@@ -255,9 +303,16 @@ Examples:
     parser.add_argument(
         '--workload',
         type=int,
-        metavar='0-13',
-        choices=range(0, 14),
-        help='RISC-V workload (0=Idle, 1=Matrix, 2=Sort, 3=FFT, 4=Crypto, 5=Mixed, 6=Audio, 7=Audio+AEC, 8-13=Necklace algos)'
+        metavar='0-16',
+        choices=range(0, 17),
+        help='RISC-V workload (0=Idle, 1=Matrix, 2=Sort, 3=FFT, 4=Crypto, 5=Mixed, 6=Audio, 7=Audio+AEC, 8-13=Necklace algos, 14=Corebench, 15=PDM decimation, 16=STFT noise suppression)'
+    )
+
+    parser.add_argument(
+        '--far-end',
+        type=int,
+        metavar='HZ',
+        help='Stream a tone of HZ as far-end audio for the AEC reference (dual-core app with far_end.conf)'
     )
 
     args = parser.parse_args()
@@ -305,12 +360,23 @@ Examples:
             10: "Clothing Rustle Suppression (impulse noise)",
             11: "Spatial Noise Cancellation (GSC + adaptive filter)",
             12: "Wind Noise Reduction (correlation-based)",
-            13: "Full Necklace Pipeline (6-stage processing)"
+            13: "Full Necklace Pipeline (6-stage processing)",
+            14: "Corebench (CoreMark-class compute, needs corebench.conf)",
+            15: "PDM Decimation (CIC + FIR to 8 kHz PCM, needs pdm_dec.conf)",
+            16: "STFT Noise Suppression (vs time-domain gate, needs stft_ns.conf)"
         }
         print(f"RISC-V workload: {RISCV_WORKLOAD} ({workload_names[RISCV_WORKLOAD]})")
     else:
         print("RISC-V workload: Not configured (will use device default)")
 
+    # Set far-end downlink
+    if args.far_end is not None:
+        if not 0 < args.far_end < FAR_END_RATE // 2:
+            print(f"Error: far-end tone must be between 1 and {FAR_END_RATE // 2 - 1} Hz")
+            exit(1)
+        FAR_END_HZ = args.far_end
+        print(f"Far-end downlink: {FAR_END_HZ} Hz tone")
+
     try:
         asyncio.run(main())
     except KeyboardInterrupt:
@@ -0,0 +1,127 @@
+#!/bin/bash
+# Packetised audio into the central's jitter buffer, on nrf54l15bsim.
+#
+#   wearable  nrf54l15_l2cap_test_fast     (device 0, audio.conf: 16 ms frames, 4 per SDU)
+#   gateway   nrf54l15_l2cap_central_fast  (device 1, playout.conf: common/playout)
+#
+# Both also build with time_sync.conf (common/time_sync), so the
+# gateway can put each frame's capture time on its own clock and
+# report the end-to-end latency, capture to playout.
+#
+# --attenuation raises the path loss of the simulated channel until
+# packets start to fail CRC, which stands in for interference: the LL
+# retransmits, SDUs arrive late and in bursts, and the playout target
+# has to grow. --xo-drift runs the wearable's crystal off by the given
+# ppm, for the drift estimate to find.
+#
+# The summary averages the gateway's PLAYOUT lines after warm-up and
+# totals their per-second counts, and gives the mean and worst
+# end-to-end latency once the clocks are synced.
+#
+# Usage: ./audio_playout.sh [--seconds N] [--attenuation DB] [--xo-drift PPM] [--no-build]
+
+set -e
+
+source "$(dirname "$0")/bsim_common.sh"
+
+SECONDS_SIM=60
+ATTENUATION=
+XO_DRIFT_PPM=
+BUILD=1
+# Skip the link bring-up and the first jitter window
+WARMUP_S=8
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        --seconds) SECONDS_SIM="$2"; shift 2 ;;
+        --attenuation) ATTENUATION="$2"; shift 2 ;;
+        --xo-drift) XO_DRIFT_PPM="$2"; shift 2 ;;
+        --no-build) BUILD=0; shift ;;
+        *) echo "Usage: $0 [--seconds N] [--attenuation DB] [--xo-drift PPM] [--no-build]"
+           exit 1 ;;
+    esac
+done
+
+bsim_check_env
+
+WEARABLE=nrf54l15_l2cap_test_fast
+GATEWAY=nrf54l15_l2cap_central_fast
+BUILD_NAME=build_bsim_audio
+
+NAME="att${ATTENUATION:-0}_drift${XO_DRIFT_PPM:-0}"
+OUT_DIR="$BSIM_DIR/out/audio_playout_$NAME"
+mkdir -p "$OUT_DIR"
+SIM_ID="audio_${NAME}_$$"
+
+echo "========================================"
+echo "BabbleSim audio playout: $NAME (${SECONDS_SIM}s simulated)"
+echo "========================================"
+
+if [ $BUILD -eq 1 ]; then
+    printf "${YELLOW}Building for $BSIM_BOARD...${NC}\n"
+    BSIM_BUILD_NAME=$BUILD_NAME bsim_build "$WEARABLE" -- \
+        -DEXTRA_CONF_FILE="audio.conf;time_sync.conf" > /dev/null
+    BSIM_BUILD_NAME=$BUILD_NAME bsim_build "$GATEWAY" -- \
+        -DEXTRA_CONF_FILE="playout.conf;time_sync.conf" > /dev/null
+fi
+WEARABLE_EXE="$WORKSPACE/$WEARABLE/$BUILD_NAME/zephyr/zephyr.exe"
+GATEWAY_EXE="$WORKSPACE/$GATEWAY/$BUILD_NAME/zephyr/zephyr.exe"
+
+PHY_ARGS=()
+if [ -n "$ATTENUATION" ]; then
+    PHY_ARGS=(-argschannel -at="$ATTENUATION")
+fi
+WEARABLE_ARGS=()
+if [ -n "$XO_DRIFT_PPM" ]; then
+    WEARABLE_ARGS=(-xo_drift="${XO_DRIFT_PPM}e-6")
+fi
+
+printf "${YELLOW}Running simulation...${NC}\n"
+bsim_run_phy "$SIM_ID" 2 "$SECONDS_SIM" "${PHY_ARGS[@]}"
+"$WEARABLE_EXE" -s="$SIM_ID" -d=0 "${WEARABLE_ARGS[@]}" > "$OUT_DIR/wearable.log" 2>&1 &
+WEARABLE_PID=$!
+"$GATEWAY_EXE" -s="$SIM_ID" -d=1 > "$OUT_DIR/gateway.log" 2>&1 &
+GATEWAY_PID=$!
+
+if ! bsim_wait $PHY_PID $WEARABLE_PID $GATEWAY_PID; then
+    printf "${RED}Simulation exited with an error (logs in $OUT_DIR)${NC}\n"
+fi
+
+# PLAYOUT: delay <ms> target <ms> depth <ms> | jitter <ms> spread <ms> | drift <ppm> ppm |
+#          played <n> concealed <n> underruns <n> late <n> overruns <n> skipped <n> held <n> |
+#          wait avg <ms> max <ms> | bad SDUs <n> | e2e <ms>
+# e2e is "-" until the first TSYNC fit; those lines are skipped.
+playout() {
+    grep '^PLAYOUT:' "$OUT_DIR/gateway.log" | tail -n +$((WARMUP_S + 1))
+}
+mean_field() {
+    playout | awk -v f="$1" '$f != "-" { s += $f; n++ } END { if (n) printf "%.1f", s / n; else printf "-" }'
+}
+max_field() {
+    playout | awk -v f="$1" '$f == "-" { next } { if (n++ == 0 || $f > m) m = $f } END { if (n) printf "%.1f", m; else printf "-" }'
+}
+sum_field() {
+    playout | awk -v f="$1" '{ s += $f } END { print s + 0 }'
+}
+
+echo ""
+echo "Results (after ${WARMUP_S}s warm-up):"
+printf "  %-28s %s kbps\n" "wearable TX" \
+    "$(grep '^TX:' "$OUT_DIR/wearable.log" | tail -n +$((WARMUP_S + 1)) |
+       awk '{ s += $5; n++ } END { if (n) printf "%.0f", s / n; else printf "-" }')"
+printf "  %-28s %s\n" "wearable dropped SDUs" \
+    "$(grep '^AUDIO:' "$OUT_DIR/wearable.log" | tail -n 1 | awk '{ print $6 }')"
+printf "  %-28s %s / %s ms\n" "delay mean / max" "$(mean_field 3)" "$(max_field 3)"
+printf "  %-28s %s / %s ms\n" "target mean / max" "$(mean_field 5)" "$(max_field 5)"
+printf "  %-28s %s ms\n" "jitter (RFC 3550) mean" "$(mean_field 10)"
+printf "  %-28s %s ppm\n" "drift (last estimate)" \
+    "$(playout | tail -n 1 | awk '{ print $15 }')"
+printf "  %-28s %s ms\n" "buffer wait max" "$(max_field 37)"
+printf "  %-28s %s / %s ms\n" "end-to-end mean / max" "$(mean_field 44)" "$(max_field 44)"
+for f in "played 19" "concealed 21" "underruns 23" "late 25" "overruns 27" "skipped 29" "held 31"; do
+    set -- $f
+    printf "  %-28s %s\n" "$1 (total)" "$(sum_field "$2")"
+done
+grep -h '^LINKUP payload' "$OUT_DIR"/*.log | sed 's/^/  /' || true
+echo ""
+echo "Logs in $OUT_DIR"
@@ -0,0 +1,69 @@
+#!/bin/bash
+# Shared helpers for the BabbleSim (nrf54l15bsim) scripts in this directory.
+# Source it, don't run it.
+#
+# Requires BSIM_OUT_PATH and BSIM_COMPONENTS_PATH (see Zephyr's
+# "BabbleSim" docs) and a west workspace at zephyr_workspace/zephyrproject.
+
+BSIM_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+WORKSPACE="$BSIM_DIR/.."
+NRF_ZEPHYR="$WORKSPACE/zephyrproject"
+BSIM_BOARD="nrf54l15bsim/nrf54l15/cpuapp"
+BSIM_PHY="${BSIM_OUT_PATH:-}/bin/bs_2G4_phy_v1"
+
+GREEN='\033[0;32m'
+RED='\033[0;31m'
+YELLOW='\033[1;33m'
+NC='\033[0m'
+
+bsim_check_env() {
+    if [ -z "$BSIM_OUT_PATH" ] || [ -z "$BSIM_COMPONENTS_PATH" ]; then
+        printf "${RED}BSIM_OUT_PATH and BSIM_COMPONENTS_PATH must be set${NC}\n"
+        exit 1
+    fi
+    if [ ! -x "$BSIM_PHY" ]; then
+        printf "${RED}Missing $BSIM_PHY (build BabbleSim first)${NC}\n"
+        exit 1
+    fi
+}
+
+# bsim_build <app> [extra west args...]
+# Builds <app> for nrf54l15bsim into <app>/build_bsim (or <app>/$BSIM_BUILD_NAME,
+# for a second configuration of the same app) and prints the exe path.
+bsim_build() {
+    local app="$1"
+    shift
+    local build_dir="$WORKSPACE/$app/${BSIM_BUILD_NAME:-build_bsim}"
+
+    printf "  %-35s" "$app" >&2
+    if (cd "$NRF_ZEPHYR" && west build -b "$BSIM_BOARD" "../$app" -d "$build_dir" -p "$@" \
+            > "$build_dir.log" 2>&1); then
+        printf "${GREEN}BUILD OK${NC}\n" >&2
+    else
+        printf "${RED}BUILD FAILED${NC} (see $build_dir.log)\n" >&2
+        return 1
+    fi
+    echo "$build_dir/zephyr/zephyr.exe"
+}
+
+# bsim_run_phy <sim_id> <num_devices> <seconds> [extra phy args...]
+# Starts the 2.4 GHz phy in the background; PHY_PID holds its pid.
+bsim_run_phy() {
+    local sim_id="$1"
+    local devices="$2"
+    local seconds="$3"
+    shift 3
+
+    "$BSIM_PHY" -s="$sim_id" -D="$devices" -sim_length=$((seconds * 1000000)) "$@" \
+        > "$OUT_DIR/phy.log" 2>&1 &
+    PHY_PID=$!
+}
+
+# bsim_wait <pid...>: wait for all given processes, return non-zero if any failed
+bsim_wait() {
+    local rc=0
+    for pid in "$@"; do
+        wait "$pid" || rc=1
+    done
+    return $rc
+}
@@ -0,0 +1,117 @@
+#!/bin/bash
+# SoftDevice Controller vs Zephyr LL on identical app code (nrf54l15bsim).
+#
+# Builds nrf54l15_l2cap_test_fast once per controller (-DCTLR=sdc|zephyr)
+# and per scenario, runs each against the same nrf54l15_l2cap_central_fast
+# build, and wraps the peripheral in perf or callgrind. ctlr_ab_report.py
+# then puts throughput, send->sent latency and instructions per SDU
+# (host path and controller) side by side.
+#
+# A scenario is SDU_LEN:CI_MIN-CI_MAX (1.25 ms units); 0-0 leaves the
+# interval to the central (50 ms).
+#
+# Usage: ./ctlr_ab.sh [--seconds N] [--tool perf|callgrind|none]
+#                     [--scenarios "2000:0-0 492:6-12 ..."] [--no-build]
+
+set -e
+
+source "$(dirname "$0")/bsim_common.sh"
+
+SECONDS_SIM=20
+TOOL=perf
+SCENARIOS="2000:0-0 2000:6-12 492:0-0 492:6-12"
+BUILD=1
+CTLRS="sdc zephyr"
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        --seconds) SECONDS_SIM="$2"; shift 2 ;;
+        --tool) TOOL="$2"; shift 2 ;;
+        --scenarios) SCENARIOS="$2"; shift 2 ;;
+        --no-build) BUILD=0; shift ;;
+        *) echo "Usage: $0 [--seconds N] [--tool perf|callgrind|none] [--scenarios \"...\"] [--no-build]"
+           exit 1 ;;
+    esac
+done
+
+case "$TOOL" in
+    callgrind) WRAP_BASE=(valgrind --tool=callgrind --dump-instr=no --collect-jumps=no) ;;
+    perf) WRAP_BASE=(perf record -e instructions:u -g) ;;
+    none) WRAP_BASE=() ;;
+    *) echo "Unknown tool: $TOOL"; exit 1 ;;
+esac
+
+bsim_check_env
+
+PYTHON="${PYTHON:-python3}"
+PERIPHERAL=nrf54l15_l2cap_test_fast
+CENTRAL=nrf54l15_l2cap_central_fast
+AB_DIR="$BSIM_DIR/out/ctlr_ab"
+mkdir -p "$AB_DIR"
+
+echo "========================================"
+echo "BabbleSim controller A/B: $CTLRS ($TOOL, ${SECONDS_SIM}s per run)"
+echo "Scenarios: $SCENARIOS"
+echo "========================================"
+
+if [ $BUILD -eq 1 ]; then
+    printf "${YELLOW}Building for $BSIM_BOARD...${NC}\n"
+    bsim_build "$CENTRAL" > /dev/null
+fi
+CENTRAL_EXE="$WORKSPACE/$CENTRAL/build_bsim/zephyr/zephyr.exe"
+
+for scenario in $SCENARIOS; do
+    SDU="${scenario%%:*}"
+    CI="${scenario#*:}"
+    CI_MIN="${CI%-*}"
+    CI_MAX="${CI#*-}"
+
+    for ctlr in $CTLRS; do
+        NAME="${ctlr}_sdu${SDU}_ci${CI_MIN}-${CI_MAX}"
+        BUILD_NAME="build_bsim_$NAME"
+        OUT_DIR="$AB_DIR/$NAME"
+        mkdir -p "$OUT_DIR"
+
+        if [ $BUILD -eq 1 ]; then
+            # Plain image: sysbuild would not forward CTLR to the app
+            BSIM_BUILD_NAME=$BUILD_NAME bsim_build "$PERIPHERAL" --no-sysbuild -- \
+                -DCTLR="$ctlr" \
+                -DCONFIG_L2CAP_TEST_SDU_LEN="$SDU" \
+                -DCONFIG_L2CAP_TEST_CI_MIN="$CI_MIN" \
+                -DCONFIG_L2CAP_TEST_CI_MAX="$CI_MAX" > /dev/null
+        fi
+        PERIPHERAL_EXE="$WORKSPACE/$PERIPHERAL/$BUILD_NAME/zephyr/zephyr.exe"
+
+        case "$TOOL" in
+            callgrind) WRAP=("${WRAP_BASE[@]}" --callgrind-out-file="$OUT_DIR/callgrind.out") ;;
+            perf) WRAP=("${WRAP_BASE[@]}" -o "$OUT_DIR/perf.data" --) ;;
+            none) WRAP=() ;;
+        esac
+
+        printf "  %-35s" "$NAME"
+        SIM_ID="ctlr_ab_${NAME//-/_}_$$"
+        bsim_run_phy "$SIM_ID" 2 "$SECONDS_SIM"
+        "$CENTRAL_EXE" -s="$SIM_ID" -d=1 > "$OUT_DIR/central.log" 2>&1 &
+        CENTRAL_PID=$!
+        "${WRAP[@]}" "$PERIPHERAL_EXE" -s="$SIM_ID" -d=0 > "$OUT_DIR/peripheral.log" 2>&1 &
+        PERIPHERAL_PID=$!
+
+        if bsim_wait $PHY_PID $CENTRAL_PID $PERIPHERAL_PID; then
+            printf "${GREEN}DONE${NC}\n"
+        else
+            printf "${RED}EXITED WITH ERROR${NC} (logs in $OUT_DIR)\n"
+        fi
+
+        printf "CTLR=%s\nSDU=%s\nCI_MIN=%s\nCI_MAX=%s\nTOOL=%s\n" \
+            "$ctlr" "$SDU" "$CI_MIN" "$CI_MAX" "$TOOL" > "$OUT_DIR/run.env"
+
+        if [ "$TOOL" != none ]; then
+            "$PYTHON" "$BSIM_DIR/host_profile_report.py" --tool "$TOOL" --out-dir "$OUT_DIR" \
+                --elf "$PERIPHERAL_EXE" --json "$OUT_DIR/profile.json" \
+                > "$OUT_DIR/profile.txt" 2>&1 || true
+        fi
+    done
+done
+
+echo ""
+"$PYTHON" "$BSIM_DIR/ctlr_ab_report.py" --out-dir "$AB_DIR"
@@ -0,0 +1,146 @@
+#!/usr/bin/env python3
+"""
+Side-by-side SDC vs Zephyr LL report for runs written by ctlr_ab.sh.
+
+Each run directory (out/ctlr_ab/<ctlr>_sdu<N>_ci<min>-<max>/) holds
+run.env, peripheral.log, central.log and, when profiled, profile.json
+from host_profile_report.py --json. For every scenario this prints, per
+controller:
+
+  - peripheral TX and central RX throughput (mean after warm-up)
+  - send -> sent latency per SDU (mean of the per-second averages, and max)
+  - instructions per SDU: host path (BT host + net_buf + app),
+    controller, and the whole process
+
+Usage:
+    python3 ctlr_ab_report.py --out-dir out/ctlr_ab [--warmup 5]
+"""
+
+import argparse
+import json
+import os
+import re
+import sys
+
+TX_RE = re.compile(r"^TX: \d+ bytes total, (\d+) kbps"
+                   r"(?: \| sdu lat avg (\d+)\.(\d) ms max (\d+)\.(\d) ms)?")
+RX_RE = re.compile(r"^RX: (\d+) kbps")
+
+CTLR_NAMES = {"sdc": "SDC", "zephyr": "Zephyr LL"}
+
+
+def read_env(path):
+    env = {}
+    with open(path) as f:
+        for line in f:
+            key, _, value = line.strip().partition("=")
+            if key:
+                env[key] = value
+    return env
+
+
+def mean(values):
+    return sum(values) / len(values) if values else None
+
+
+def parse_run(run_dir, warmup):
+    """Return the metrics of one run directory."""
+    tx, lat_avg, lat_max, rx = [], [], [], []
+
+    with open(os.path.join(run_dir, "peripheral.log"), errors="replace") as f:
+        lines = [m for m in (TX_RE.match(line) for line in f) if m]
+    for m in lines[warmup:]:
+        tx.append(int(m.group(1)))
+        if m.group(2) is not None:
+            lat_avg.append(int(m.group(2)) + int(m.group(3)) / 10)
+            lat_max.append(int(m.group(4)) + int(m.group(5)) / 10)
+
+    central_log = os.path.join(run_dir, "central.log")
+    if os.path.exists(central_log):
+        with open(central_log, errors="replace") as f:
+            lines = [m for m in (RX_RE.match(line) for line in f) if m]
+        rx = [int(m.group(1)) for m in lines[warmup:]]
+
+    run = {
+        "tx_kbps": mean(tx),
+        "rx_kbps": mean(rx),
+        "lat_avg_ms": mean(lat_avg),
+        "lat_max_ms": max(lat_max) if lat_max else None,
+    }
+
+    profile = os.path.join(run_dir, "profile.json")
+    if os.path.exists(profile):
+        with open(profile) as f:
+            p = json.load(f)
+        run["unit"] = p["unit"]
+        run["host_per_sdu"] = p["host_path_per_sdu"]
+        run["ctlr_per_sdu"] = p["per_sdu"]["bt_controller"]
+        run["total_per_sdu"] = p["total_per_sdu"]
+    return run
+
+
+def fmt(value, spec):
+    return "-" if value is None else format(value, spec)
+
+
+def delta(a, b):
+    if a is None or b is None or a == 0:
+        return "-"
+    return f"{(b - a) * 100.0 / a:+.1f}%"
+
+
+def main():
+    parser = argparse.ArgumentParser(description="SDC vs Zephyr LL A/B report")
+    parser.add_argument("--out-dir", required=True, help="Directory written by ctlr_ab.sh")
+    parser.add_argument("--warmup", type=int, default=5,
+                        help="Per-second lines to skip (link bring-up)")
+    args = parser.parse_args()
+
+    scenarios = {}
+    for name in sorted(os.listdir(args.out_dir)):
+        run_dir = os.path.join(args.out_dir, name)
+        env_path = os.path.join(run_dir, "run.env")
+        if not os.path.exists(env_path):
+            continue
+        env = read_env(env_path)
+        ci = ("central" if env["CI_MAX"] == "0"
+              else f"{int(env['CI_MIN']) * 1.25:g}-{int(env['CI_MAX']) * 1.25:g} ms")
+        key = (int(env["SDU"]), ci)
+        scenarios.setdefault(key, {})[env["CTLR"]] = parse_run(run_dir, args.warmup)
+
+    if not scenarios:
+        print(f"No runs found in {args.out_dir}")
+        return 1
+
+    rows = [
+        ("TX kbps", "tx_kbps", ".0f"),
+        ("RX kbps (central)", "rx_kbps", ".0f"),
+        ("send->sent avg ms", "lat_avg_ms", ".1f"),
+        ("send->sent max ms", "lat_max_ms", ".1f"),
+        ("host path /SDU", "host_per_sdu", ".0f"),
+        ("controller /SDU", "ctlr_per_sdu", ".0f"),
+        ("whole process /SDU", "total_per_sdu", ".0f"),
+    ]
+
+    print("========================================")
+    print("Controller A/B (nrf54l15bsim, identical app code)")
+    print("========================================")
+    for (sdu, ci), runs in sorted(scenarios.items(), key=lambda kv: (-kv[0][0], kv[0][1])):
+        a = runs.get("sdc", {})
+        b = runs.get("zephyr", {})
+        unit = a.get("unit") or b.get("unit") or "instr"
+        print(f"\nSDU {sdu} B, CI {ci}")
+        print(f"  {'':<24} {CTLR_NAMES['sdc']:>10} {CTLR_NAMES['zephyr']:>10} {'delta':>8}")
+        for label, field, spec in rows:
+            if "/SDU" in label:
+                label = label.replace("/SDU", f"{unit}/SDU")
+            print(f"  {label:<24} {fmt(a.get(field), spec):>10} {fmt(b.get(field), spec):>10}"
+                  f" {delta(a.get(field), b.get(field)):>8}")
+
+    print("\nInstructions come from the simulated process: BabbleSim does not advance time")
+    print("while code runs, so CPU load is counted, not timed.")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
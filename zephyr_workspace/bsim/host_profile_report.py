@@ -0,0 +1,197 @@
+#!/usr/bin/env python3
+"""
+Turn a BabbleSim host-path profile into instructions per SDU.
+
+Reads the peripheral log written by profile_host.sh to get the number
+of SDUs (L2CAP) or notifications (GATT) sent, then symbolises the
+callgrind or perf profile of the peripheral and prints:
+
+  - instructions per SDU split by component (BT host, net_buf, app,
+    kernel, controller, simulator/other)
+  - the hottest functions by self cost, per SDU
+  - inclusive cost per SDU of the main TX entry points
+
+--json also writes the component totals for ctlr_ab_report.py.
+
+Usage:
+    python3 host_profile_report.py --tool callgrind --out-dir out/profile_l2cap \\
+        --elf ../nrf54l15_l2cap_test_fast/build_bsim/zephyr/zephyr.exe
+"""
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+
+TX_RE = re.compile(r"TX: (\d+) bytes total")
+L2CAP_SDU_RE = re.compile(r"Using TX SDU size: (\d+)")
+GATT_PAYLOAD_RE = re.compile(r"max notify payload: (\d+)")
+
+# callgrind_annotate: "1,234,567 (12.34%)  /path/file.c:func [/path/obj]"
+CG_LINE_RE = re.compile(r"^\s*([\d,]+)\s+(?:\(\s*[\d.]+%\)\s+)?(.+?)\s+\[(.+)\]\s*$")
+# perf report --fields period,sym: "  123456789  [.] func"
+PERF_LINE_RE = re.compile(r"^\s*(\d+)\s+\[[.k]\]\s+(\S+)")
+
+# Functions whose inclusive cost is the per-SDU host TX path
+ENTRY_POINTS = ["stream_thread", "bt_l2cap_chan_send", "bt_gatt_notify_cb",
+                "net_buf_alloc_len", "bt_conn_send_cb", "bt_l2cap_send_pdu",
+                "hci_driver_send", "bt_send"]
+
+COMPONENTS = ["bt_host", "net_buf", "app", "kernel", "bt_controller", "libc", "other"]
+
+PATH_RULES = [
+    ("subsys/bluetooth/host", "bt_host"),
+    ("subsys/bluetooth/common", "bt_host"),
+    ("net_buf", "net_buf"),
+    ("subsys/net/buf", "net_buf"),
+    ("/src/main.c", "app"),
+    ("/kernel/", "kernel"),
+    ("softdevice_controller", "bt_controller"),
+    ("mpsl", "bt_controller"),
+    ("subsys/bluetooth/controller", "bt_controller"),
+    ("libc", "libc"),
+]
+
+PREFIX_RULES = [
+    (("bt_l2cap", "l2cap_", "bt_att", "att_", "bt_gatt", "gatt_", "bt_conn", "conn_",
+      "bt_hci", "hci_", "bt_smp", "bt_buf", "bt_send", "bt_recv", "tx_notify", "process_"), "bt_host"),
+    (("net_buf",), "net_buf"),
+    (("stream_thread", "main", "connected", "disconnected", "l2cap_chan_", "notify_sent"), "app"),
+    (("z_", "k_", "arch_", "sys_", "pend", "unpend", "ready_thread"), "kernel"),
+    (("sdc_", "mpsl_", "sym_", "ll_", "lll_", "ull_", "radio_"), "bt_controller"),
+    (("memcpy", "memset", "memmove", "strlen"), "libc"),
+]
+
+
+def component(func, path=None):
+    if path:
+        for needle, comp in PATH_RULES:
+            if needle in path:
+                return comp
+    for prefixes, comp in PREFIX_RULES:
+        if func.startswith(prefixes):
+            return comp
+    return "other"
+
+
+def parse_peripheral_log(path):
+    """Return (bytes_sent, sdu_size) from the peripheral console log."""
+    bytes_sent = 0
+    sdu_size = 0
+    with open(path, errors="replace") as f:
+        for line in f:
+            m = TX_RE.search(line)
+            if m:
+                bytes_sent = int(m.group(1))
+            m = L2CAP_SDU_RE.search(line) or GATT_PAYLOAD_RE.search(line)
+            if m:
+                sdu_size = int(m.group(1))
+    return bytes_sent, sdu_size
+
+
+def callgrind_costs(out_file, inclusive):
+    """Return [(cost, func, path)] from callgrind_annotate."""
+    cmd = ["callgrind_annotate", f"--inclusive={'yes' if inclusive else 'no'}",
+           "--threshold=100", out_file]
+    text = subprocess.run(cmd, capture_output=True, text=True, check=True).stdout
+    rows = []
+    for line in text.splitlines():
+        m = CG_LINE_RE.match(line)
+        if not m:
+            continue
+        location = m.group(2)
+        path, _, func = location.rpartition(":")
+        rows.append((int(m.group(1).replace(",", "")), func, path))
+    return rows
+
+
+def perf_costs(perf_data, inclusive):
+    """Return [(instructions, func, None)] from an instructions:u perf recording."""
+    mode = "--children" if inclusive else "--no-children"
+    cmd = ["perf", "report", "-i", perf_data, "--stdio", mode, "--fields", "period,sym"]
+    text = subprocess.run(cmd, capture_output=True, text=True, check=True).stdout
+    rows = []
+    for line in text.splitlines():
+        m = PERF_LINE_RE.match(line)
+        if m:
+            rows.append((int(m.group(1)), m.group(2), None))
+    return rows
+
+
+def main():
+    parser = argparse.ArgumentParser(description="BabbleSim host-path profile report")
+    parser.add_argument("--tool", choices=["callgrind", "perf", "none"], required=True)
+    parser.add_argument("--out-dir", required=True, help="Directory written by profile_host.sh")
+    parser.add_argument("--elf", help="Peripheral executable (for reference in the report)")
+    parser.add_argument("--top", type=int, default=20, help="Hot functions to list")
+    parser.add_argument("--json", help="Also write the per-SDU component totals here")
+    args = parser.parse_args()
+
+    bytes_sent, sdu_size = parse_peripheral_log(os.path.join(args.out_dir, "peripheral.log"))
+    sdus = bytes_sent // sdu_size if sdu_size else 0
+
+    print("========================================", flush=True)
+    print("Host-path profile", flush=True)
+    print("========================================", flush=True)
+    if args.elf:
+        print(f"  Binary:    {args.elf}")
+    print(f"  TX bytes:  {bytes_sent}")
+    print(f"  SDU size:  {sdu_size}")
+    print(f"  SDUs sent: {sdus}")
+
+    if args.tool == "none":
+        return 0
+    if sdus == 0:
+        print("ERROR: no SDUs sent; check central.log / peripheral.log", flush=True)
+        return 1
+
+    if args.tool == "callgrind":
+        out_file = os.path.join(args.out_dir, "callgrind.out")
+        self_rows = callgrind_costs(out_file, inclusive=False)
+        incl_rows = callgrind_costs(out_file, inclusive=True)
+        unit = "Ir"
+    else:
+        perf_data = os.path.join(args.out_dir, "perf.data")
+        self_rows = perf_costs(perf_data, inclusive=False)
+        incl_rows = perf_costs(perf_data, inclusive=True)
+        unit = "instr"
+
+    by_comp = {c: 0 for c in COMPONENTS}
+    for cost, func, path in self_rows:
+        by_comp[component(func, path)] += cost
+    total = sum(by_comp.values())
+
+    print(f"\n  {'Component':<16} {unit + '/SDU':>12} {'Share':>7}")
+    print(f"  {'-' * 16} {'-' * 12} {'-' * 7}")
+    for comp in COMPONENTS:
+        if by_comp[comp]:
+            print(f"  {comp:<16} {by_comp[comp] / sdus:>12.0f} {by_comp[comp] * 100.0 / total:>6.1f}%")
+    host = by_comp["bt_host"] + by_comp["net_buf"] + by_comp["app"]
+    print(f"  {'host path':<16} {host / sdus:>12.0f} {host * 100.0 / total:>6.1f}%")
+
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump({"unit": unit, "sdus": sdus, "sdu_size": sdu_size,
+                       "per_sdu": {c: by_comp[c] / sdus for c in COMPONENTS},
+                       "host_path_per_sdu": host / sdus,
+                       "total_per_sdu": total / sdus}, f, indent=2)
+
+    print(f"\n  Hottest functions (self {unit}/SDU):")
+    for cost, func, path in sorted(self_rows, key=lambda r: r[0], reverse=True)[:args.top]:
+        print(f"    {cost / sdus:>10.0f}  {component(func, path):<14} {func}")
+
+    incl = {}
+    for cost, func, _ in incl_rows:
+        incl[func] = max(incl.get(func, 0), cost)
+    print(f"\n  TX entry points (inclusive {unit}/SDU):")
+    for func in ENTRY_POINTS:
+        if func in incl:
+            print(f"    {incl[func] / sdus:>10.0f}  {func}")
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
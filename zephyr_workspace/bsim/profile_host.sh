@@ -0,0 +1,97 @@
+#!/bin/bash
+# Profile the BLE host path of a throughput peripheral on nrf54l15bsim.
+#
+# Builds the peripheral and its matching central for nrf54l15bsim, runs
+# both on a simulated 2.4 GHz link and wraps the peripheral in perf or
+# valgrind-callgrind. host_profile_report.py then turns the profile and
+# the peripheral's "TX:" log into host-path instructions per SDU.
+#
+# Usage: ./profile_host.sh <l2cap|gatt> [--tool callgrind|perf|none] [--seconds N] [--no-build]
+
+set -e
+
+source "$(dirname "$0")/bsim_common.sh"
+
+MODE="${1:-}"
+shift || true
+TOOL="callgrind"
+SECONDS_SIM=20
+BUILD=1
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        --tool) TOOL="$2"; shift 2 ;;
+        --seconds) SECONDS_SIM="$2"; shift 2 ;;
+        --no-build) BUILD=0; shift ;;
+        *) echo "Unknown option: $1"; exit 1 ;;
+    esac
+done
+
+case "$MODE" in
+    l2cap)
+        PERIPHERAL=nrf54l15_l2cap_test_fast
+        CENTRAL=nrf54l15_l2cap_central_fast
+        ;;
+    gatt)
+        PERIPHERAL=nrf54l15_gatt_peripheral_fast
+        CENTRAL=nrf54l15_gatt_central_fast
+        ;;
+    *)
+        echo "Usage: $0 <l2cap|gatt> [--tool callgrind|perf|none] [--seconds N] [--no-build]"
+        exit 1
+        ;;
+esac
+
+bsim_check_env
+
+OUT_DIR="$BSIM_DIR/out/profile_$MODE"
+mkdir -p "$OUT_DIR"
+SIM_ID="profile_${MODE}_$$"
+
+echo "========================================"
+echo "BabbleSim host-path profile: $MODE ($TOOL, ${SECONDS_SIM}s simulated)"
+echo "========================================"
+
+if [ $BUILD -eq 1 ]; then
+    printf "${YELLOW}Building for $BSIM_BOARD...${NC}\n"
+    bsim_build "$PERIPHERAL" > /dev/null
+    bsim_build "$CENTRAL" > /dev/null
+fi
+PERIPHERAL_EXE="$WORKSPACE/$PERIPHERAL/build_bsim/zephyr/zephyr.exe"
+CENTRAL_EXE="$WORKSPACE/$CENTRAL/build_bsim/zephyr/zephyr.exe"
+
+case "$TOOL" in
+    callgrind)
+        WRAP=(valgrind --tool=callgrind --callgrind-out-file="$OUT_DIR/callgrind.out"
+              --dump-instr=no --collect-jumps=no)
+        ;;
+    perf)
+        WRAP=(perf record -e instructions:u -g -o "$OUT_DIR/perf.data" --)
+        ;;
+    none)
+        WRAP=()
+        ;;
+    *)
+        echo "Unknown tool: $TOOL"
+        exit 1
+        ;;
+esac
+
+printf "${YELLOW}Running simulation...${NC}\n"
+bsim_run_phy "$SIM_ID" 2 "$SECONDS_SIM"
+
+"$CENTRAL_EXE" -s="$SIM_ID" -d=1 > "$OUT_DIR/central.log" 2>&1 &
+CENTRAL_PID=$!
+
+# The phy advances in lock-step with the slowest device, so the
+# instrumented peripheral just makes the run take longer in wall time.
+"${WRAP[@]}" "$PERIPHERAL_EXE" -s="$SIM_ID" -d=0 > "$OUT_DIR/peripheral.log" 2>&1 &
+PERIPHERAL_PID=$!
+
+if ! bsim_wait $PHY_PID $CENTRAL_PID $PERIPHERAL_PID; then
+    printf "${RED}Simulation exited with an error (logs in $OUT_DIR)${NC}\n"
+fi
+
+PYTHON="${PYTHON:-python3}"
+"$PYTHON" "$BSIM_DIR/host_profile_report.py" --tool "$TOOL" --out-dir "$OUT_DIR" \
+    --elf "$PERIPHERAL_EXE"
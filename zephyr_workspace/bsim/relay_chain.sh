@@ -0,0 +1,121 @@
+#!/bin/bash
+# Three-node L2CAP relay run on nrf54l15bsim.
+#
+#   wearable  nrf54l15_l2cap_test_fast       (device 0, streams 2000 B SDUs)
+#   relay     nrf54l15_l2cap_relay           (device 1, zero-copy forward)
+#   gateway   nrf54l15_l2cap_central_fast    (device 2, built with relay.conf)
+#
+# Runs all three on one simulated 2.4 GHz channel, then summarises the
+# wearable's TX rate, the relay's in/out rates, hold time and credit
+# holds, and the gateway's RX rate. --direct runs the same wearable and
+# gateway without the relay, as the baseline for end-to-end throughput.
+#
+# Usage: ./relay_chain.sh [--seconds N] [--direct] [--no-build]
+
+set -e
+
+source "$(dirname "$0")/bsim_common.sh"
+
+SECONDS_SIM=30
+DIRECT=0
+BUILD=1
+# Skip the link bring-up when averaging the per-second lines
+WARMUP_S=5
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        --seconds) SECONDS_SIM="$2"; shift 2 ;;
+        --direct) DIRECT=1; shift ;;
+        --no-build) BUILD=0; shift ;;
+        *) echo "Usage: $0 [--seconds N] [--direct] [--no-build]"; exit 1 ;;
+    esac
+done
+
+bsim_check_env
+
+WEARABLE=nrf54l15_l2cap_test_fast
+RELAY=nrf54l15_l2cap_relay
+GATEWAY=nrf54l15_l2cap_central_fast
+
+if [ $DIRECT -eq 1 ]; then
+    MODE=direct
+    GATEWAY_BUILD=build_bsim
+else
+    MODE=relay
+    GATEWAY_BUILD=build_bsim_relay
+fi
+
+OUT_DIR="$BSIM_DIR/out/relay_chain_$MODE"
+mkdir -p "$OUT_DIR"
+SIM_ID="relay_${MODE}_$$"
+
+echo "========================================"
+echo "BabbleSim L2CAP relay chain: $MODE (${SECONDS_SIM}s simulated)"
+echo "========================================"
+
+if [ $BUILD -eq 1 ]; then
+    printf "${YELLOW}Building for $BSIM_BOARD...${NC}\n"
+    bsim_build "$WEARABLE" > /dev/null
+    if [ $DIRECT -eq 1 ]; then
+        bsim_build "$GATEWAY" > /dev/null
+    else
+        bsim_build "$RELAY" > /dev/null
+        BSIM_BUILD_NAME=$GATEWAY_BUILD bsim_build "$GATEWAY" -- \
+            -DEXTRA_CONF_FILE=relay.conf > /dev/null
+    fi
+fi
+WEARABLE_EXE="$WORKSPACE/$WEARABLE/build_bsim/zephyr/zephyr.exe"
+RELAY_EXE="$WORKSPACE/$RELAY/build_bsim/zephyr/zephyr.exe"
+GATEWAY_EXE="$WORKSPACE/$GATEWAY/$GATEWAY_BUILD/zephyr/zephyr.exe"
+
+printf "${YELLOW}Running simulation...${NC}\n"
+if [ $DIRECT -eq 1 ]; then
+    bsim_run_phy "$SIM_ID" 2 "$SECONDS_SIM"
+    "$WEARABLE_EXE" -s="$SIM_ID" -d=0 > "$OUT_DIR/wearable.log" 2>&1 &
+    WEARABLE_PID=$!
+    "$GATEWAY_EXE" -s="$SIM_ID" -d=1 > "$OUT_DIR/gateway.log" 2>&1 &
+    GATEWAY_PID=$!
+    PIDS="$PHY_PID $WEARABLE_PID $GATEWAY_PID"
+else
+    bsim_run_phy "$SIM_ID" 3 "$SECONDS_SIM"
+    "$WEARABLE_EXE" -s="$SIM_ID" -d=0 > "$OUT_DIR/wearable.log" 2>&1 &
+    WEARABLE_PID=$!
+    "$RELAY_EXE" -s="$SIM_ID" -d=1 > "$OUT_DIR/relay.log" 2>&1 &
+    RELAY_PID=$!
+    "$GATEWAY_EXE" -s="$SIM_ID" -d=2 > "$OUT_DIR/gateway.log" 2>&1 &
+    GATEWAY_PID=$!
+    PIDS="$PHY_PID $WEARABLE_PID $RELAY_PID $GATEWAY_PID"
+fi
+
+if ! bsim_wait $PIDS; then
+    printf "${RED}Simulation exited with an error (logs in $OUT_DIR)${NC}\n"
+fi
+
+# Mean of field <n> over the per-second lines matching <pattern>, after warm-up
+mean_field() {
+    grep "$1" "$2" | tail -n +$((WARMUP_S + 1)) |
+        awk -v f="$3" '{ s += $f; n++ } END { if (n) printf "%.0f", s / n; else printf "-" }'
+}
+
+echo ""
+echo "Results (mean after ${WARMUP_S}s warm-up):"
+printf "  %-28s %s kbps\n" "wearable TX" "$(mean_field '^TX:' "$OUT_DIR/wearable.log" 5)"
+if [ $DIRECT -eq 0 ]; then
+    # RELAY: in <k> kbps out <k> kbps | hold avg <ms> ms max <ms> ms | bufs ... | credit holds <n> | dropped <n>
+    printf "  %-28s %s kbps\n" "relay in" "$(mean_field '^RELAY:' "$OUT_DIR/relay.log" 3)"
+    printf "  %-28s %s kbps\n" "relay out" "$(mean_field '^RELAY:' "$OUT_DIR/relay.log" 6)"
+    printf "  %-28s %s ms\n" "relay hold (avg of avgs)" \
+        "$(grep '^RELAY:' "$OUT_DIR/relay.log" | tail -n +$((WARMUP_S + 1)) |
+           awk '{ s += $11; n++ } END { if (n) printf "%.1f", s / n; else printf "-" }')"
+    printf "  %-28s %s ms\n" "relay hold (max)" \
+        "$(grep '^RELAY:' "$OUT_DIR/relay.log" | tail -n +$((WARMUP_S + 1)) |
+           awk '{ if ($14 > m) m = $14 } END { printf "%.1f", m }')"
+    printf "  %-28s %s\n" "credit holds (total)" \
+        "$(grep '^RELAY:' "$OUT_DIR/relay.log" | awk '{ s += $(NF-3) } END { print s + 0 }')"
+    printf "  %-28s %s\n" "dropped SDUs (total)" \
+        "$(grep '^RELAY:' "$OUT_DIR/relay.log" | awk '{ s += $NF } END { print s + 0 }')"
+fi
+printf "  %-28s %s kbps\n" "gateway RX (end to end)" "$(mean_field '^RX:' "$OUT_DIR/gateway.log" 2)"
+grep -h '^LINKUP payload' "$OUT_DIR"/*.log | sed 's/^/  /' || true
+echo ""
+echo "Logs in $OUT_DIR"
@@ -0,0 +1,96 @@
+#!/bin/bash
+# Connection-anchor time sync (common/time_sync) checked against the
+# simulator's clock, on nrf54l15bsim.
+#
+#   wearable  nrf54l15_l2cap_test_fast     (device 0, time_sync.conf)
+#   gateway   nrf54l15_l2cap_central_fast  (device 1, time_sync.conf)
+#
+# Both boards print a TSYNC line a second, ending with their own clock,
+# their estimate of the peer's, and the phy time of the same instant.
+# time_sync_report.py turns those into the error of each estimate.
+# --xo-drift runs the wearable's crystal off by the given ppm, which
+# the drift fit has to follow; --attenuation makes the link lossy, so
+# that anchor exchanges go missing and the peripheral reports
+# predicted anchors.
+#
+# Usage: ./time_sync.sh [--seconds N] [--xo-drift PPM] [--attenuation DB] [--no-build]
+
+set -e
+
+source "$(dirname "$0")/bsim_common.sh"
+
+SECONDS_SIM=120
+XO_DRIFT_PPM=
+ATTENUATION=
+BUILD=1
+# TSYNC lines skipped on each board: bring-up and the first fit
+WARMUP=10
+PYTHON="${PYTHON:-python3}"
+
+while [ $# -gt 0 ]; do
+    case "$1" in
+        --seconds) SECONDS_SIM="$2"; shift 2 ;;
+        --xo-drift) XO_DRIFT_PPM="$2"; shift 2 ;;
+        --attenuation) ATTENUATION="$2"; shift 2 ;;
+        --no-build) BUILD=0; shift ;;
+        *) echo "Usage: $0 [--seconds N] [--xo-drift PPM] [--attenuation DB] [--no-build]"
+           exit 1 ;;
+    esac
+done
+
+bsim_check_env
+
+WEARABLE=nrf54l15_l2cap_test_fast
+GATEWAY=nrf54l15_l2cap_central_fast
+BUILD_NAME=build_bsim_tsync
+
+NAME="drift${XO_DRIFT_PPM:-0}_att${ATTENUATION:-0}"
+OUT_DIR="$BSIM_DIR/out/time_sync_$NAME"
+mkdir -p "$OUT_DIR"
+SIM_ID="tsync_${NAME}_$$"
+
+echo "========================================"
+echo "BabbleSim time sync: $NAME (${SECONDS_SIM}s simulated)"
+echo "========================================"
+
+if [ $BUILD -eq 1 ]; then
+    printf "${YELLOW}Building for $BSIM_BOARD...${NC}\n"
+    BSIM_BUILD_NAME=$BUILD_NAME bsim_build "$WEARABLE" -- \
+        -DEXTRA_CONF_FILE=time_sync.conf > /dev/null
+    BSIM_BUILD_NAME=$BUILD_NAME bsim_build "$GATEWAY" -- \
+        -DEXTRA_CONF_FILE=time_sync.conf > /dev/null
+fi
+WEARABLE_EXE="$WORKSPACE/$WEARABLE/$BUILD_NAME/zephyr/zephyr.exe"
+GATEWAY_EXE="$WORKSPACE/$GATEWAY/$BUILD_NAME/zephyr/zephyr.exe"
+
+PHY_ARGS=()
+if [ -n "$ATTENUATION" ]; then
+    PHY_ARGS=(-argschannel -at="$ATTENUATION")
+fi
+WEARABLE_ARGS=()
+if [ -n "$XO_DRIFT_PPM" ]; then
+    WEARABLE_ARGS=(-xo_drift="${XO_DRIFT_PPM}e-6")
+fi
+
+printf "${YELLOW}Running simulation...${NC}\n"
+bsim_run_phy "$SIM_ID" 2 "$SECONDS_SIM" "${PHY_ARGS[@]}"
+"$WEARABLE_EXE" -s="$SIM_ID" -d=0 "${WEARABLE_ARGS[@]}" > "$OUT_DIR/wearable.log" 2>&1 &
+WEARABLE_PID=$!
+"$GATEWAY_EXE" -s="$SIM_ID" -d=1 > "$OUT_DIR/gateway.log" 2>&1 &
+GATEWAY_PID=$!
+
+if ! bsim_wait $PHY_PID $WEARABLE_PID $GATEWAY_PID; then
+    printf "${RED}Simulation exited with an error (logs in $OUT_DIR)${NC}\n"
+fi
+
+echo ""
+for dev in wearable gateway; do
+    printf "  %-10s %s\n" "$dev" "$(grep '^TSYNC:' "$OUT_DIR/$dev.log" | tail -n 1 |
+        sed 's/ | local.*//')"
+done
+echo ""
+STATUS=0
+"$PYTHON" "$BSIM_DIR/time_sync_report.py" --out-dir "$OUT_DIR" --warmup $WARMUP || STATUS=$?
+echo ""
+echo "Logs in $OUT_DIR"
+exit $STATUS
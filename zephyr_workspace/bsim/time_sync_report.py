@@ -0,0 +1,121 @@
+#!/usr/bin/env python3
+"""
+Accuracy of common/time_sync against the simulator's clock, for runs
+written by time_sync.sh.
+
+Every TSYNC line on nrf54l15bsim ends with "local <s> peer <s> phy <s>":
+the board's own clock, its estimate of the peer's clock, and the phy's
+time for the same instant, which every device shares. Each board's own
+(phy, local) points give its true clock as a line in phy time, so the
+other board's "peer" estimate at any phy time can be checked against
+that line.
+
+For each direction this prints the mean, RMS and largest error after
+warm-up, and the last drift and residual from the line itself. The
+run fails if any error exceeds --limit (default 100 us).
+
+Usage:
+    python3 time_sync_report.py --out-dir out/time_sync_<name> [--warmup 10] [--limit 100]
+"""
+
+import argparse
+import math
+import os
+import re
+import sys
+
+TSYNC_RE = re.compile(r"^TSYNC: offset (-?\d+\.\d+) ms drift (-?\d+\.\d+) ppm "
+                      r"resid (\d+) us .*\| local (\d+\.\d+) peer (\d+\.\d+) "
+                      r"phy (\d+\.\d+)")
+
+LOGS = {"wearable": "wearable.log", "gateway": "gateway.log"}
+
+
+def us(seconds):
+    """Seconds with six decimals, as printed, to integer us."""
+    whole, _, frac = seconds.partition(".")
+    return int(whole) * 1000000 + int(frac)
+
+
+def read_lines(path):
+    lines = []
+    with open(path, errors="replace") as f:
+        for line in f:
+            m = TSYNC_RE.match(line)
+            if m:
+                lines.append({
+                    "drift_ppm": float(m.group(2)),
+                    "resid_us": int(m.group(3)),
+                    "local": us(m.group(4)),
+                    "peer": us(m.group(5)),
+                    "phy": us(m.group(6)),
+                })
+    return lines
+
+
+def clock_line(lines):
+    """Least-squares local = a + b * phy over one board's own lines."""
+    x0 = lines[0]["phy"]
+    y0 = lines[0]["local"]
+    xs = [t["phy"] - x0 for t in lines]
+    ys = [t["local"] - y0 for t in lines]
+    n = len(xs)
+    mx, my = sum(xs) / n, sum(ys) / n
+    sxx = sum((x - mx) ** 2 for x in xs)
+    b = sum((x - mx) * (y - my) for x, y in zip(xs, ys)) / sxx if sxx else 1.0
+    a = my - b * mx
+    return lambda phy: y0 + a + b * (phy - x0), (b - 1) * 1e6
+
+
+def check(name, peer_name, lines, truth, warmup):
+    errors = [t["peer"] - truth(t["phy"]) for t in lines[warmup:]]
+    if not errors:
+        print(f"  {name}: no TSYNC lines after warm-up")
+        return None
+    rms = math.sqrt(sum(e * e for e in errors) / len(errors))
+    worst = max(errors, key=abs)
+    last = lines[-1]
+    print(f"  {name} -> {peer_name}: {len(errors)} lines, error mean {sum(errors) / len(errors):+.1f} "
+          f"rms {rms:.1f} max {worst:+.0f} us | drift {last['drift_ppm']:+.3f} ppm "
+          f"resid {last['resid_us']} us")
+    return abs(worst)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[1])
+    ap.add_argument("--out-dir", required=True)
+    ap.add_argument("--warmup", type=int, default=10,
+                    help="TSYNC lines to skip on each board (default 10)")
+    ap.add_argument("--limit", type=float, default=100,
+                    help="largest error allowed, us (default 100)")
+    args = ap.parse_args()
+
+    lines = {}
+    for name, log in LOGS.items():
+        path = os.path.join(args.out_dir, log)
+        lines[name] = read_lines(path) if os.path.exists(path) else []
+        if len(lines[name]) < 2:
+            print(f"{name}: fewer than 2 TSYNC lines with phy time in {path}")
+            return 1
+
+    truth = {}
+    print("Clocks against phy time:")
+    for name in LOGS:
+        truth[name], ppm = clock_line(lines[name])
+        print(f"  {name}: {ppm:+.3f} ppm")
+
+    print(f"Peer estimates (after {args.warmup} lines):")
+    worst = [check("gateway", "wearable", lines["gateway"], truth["wearable"], args.warmup),
+             check("wearable", "gateway", lines["wearable"], truth["gateway"], args.warmup)]
+    if None in worst:
+        return 1
+
+    if max(worst) > args.limit:
+        print(f"FAIL: error {max(worst):.0f} us over {args.limit:.0f} us")
+        return 1
+    print(f"PASS: error within {args.limit:.0f} us")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
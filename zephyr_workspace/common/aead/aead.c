@@ -0,0 +1,432 @@
+/*
+ * AES-128-CCM (RFC 3610 / SP 800-38C) and AES-128-GCM (SP 800-38D)
+ *
+ * Both modes are written once over a block function and a GHASH
+ * multiply picked by the back end: the reference pairs FIPS-197 AES
+ * with the bit-serial GHASH of SP 800-38D algorithm 1, the T-table
+ * back end pairs T-table AES with Shoup's 4-bit table GHASH. PSA is
+ * handed off whole to aead_psa.c.
+ */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "aead.h"
+
+#if defined(CONFIG_AEAD_PSA)
+int aead_psa_init(struct aead_ctx *ctx, const uint8_t key[AEAD_KEY_LEN]);
+void aead_psa_free(struct aead_ctx *ctx);
+int aead_psa_crypt(struct aead_ctx *ctx, enum aead_mode mode, bool decrypt,
+		   const uint8_t *nonce, const uint8_t *aad, size_t aad_len,
+		   const uint8_t *in, size_t len, uint8_t *out,
+		   uint8_t *tag, size_t tag_len);
+#endif
+
+#if defined(CONFIG_AEAD_PSA)
+#define IS_ENABLED_PSA true
+#else
+#define IS_ENABLED_PSA false
+#endif
+
+typedef void (*block_fn_t)(const uint32_t rk[44], const uint8_t in[16], uint8_t out[16]);
+
+static const char *const impl_names[AEAD_IMPLS] = {
+	[AEAD_IMPL_REF] = "ref",
+	[AEAD_IMPL_TTABLE] = "ttable",
+	[AEAD_IMPL_PSA] = "psa",
+};
+
+static inline size_t min_sz(size_t a, size_t b)
+{
+	return (a < b) ? a : b;
+}
+
+static inline void xor_block(uint8_t *dst, const uint8_t *src, size_t n)
+{
+	for (size_t i = 0; i < n; i++) {
+		dst[i] ^= src[i];
+	}
+}
+
+static inline block_fn_t block_fn(const struct aead_ctx *ctx)
+{
+	return (ctx->impl == AEAD_IMPL_TTABLE) ? aes128_encrypt_ttable : aes128_encrypt_ref;
+}
+
+/* GHASH multiply: x = x * H in GF(2^128) */
+
+static void ghash_mult_ref(const struct aead_ctx *ctx, uint8_t x[16])
+{
+	uint8_t z[16] = { 0 };
+	uint8_t v[16];
+
+	memcpy(v, ctx->h, 16);
+
+	for (int i = 0; i < 128; i++) {
+		if (x[i / 8] & (0x80 >> (i % 8))) {
+			xor_block(z, v, 16);
+		}
+
+		bool lsb = v[15] & 1;
+
+		for (int j = 15; j > 0; j--) {
+			v[j] = (uint8_t)((v[j] >> 1) | (v[j - 1] << 7));
+		}
+		v[0] >>= 1;
+		if (lsb) {
+			v[0] ^= 0xe1;
+		}
+	}
+
+	memcpy(x, z, 16);
+}
+
+/* Shoup's 4-bit tables: hh/hl[i] = i * H for every nibble i */
+static void ghash_table_init(struct aead_ctx *ctx)
+{
+	uint64_t vh = 0, vl = 0;
+
+	for (int i = 0; i < 8; i++) {
+		vh = (vh << 8) | ctx->h[i];
+		vl = (vl << 8) | ctx->h[i + 8];
+	}
+
+	ctx->hl[8] = vl;
+	ctx->hh[8] = vh;
+	ctx->hl[0] = 0;
+	ctx->hh[0] = 0;
+
+	for (int i = 4; i > 0; i >>= 1) {
+		uint32_t t = (uint32_t)(vl & 1) * 0xe1000000U;
+
+		vl = (vh << 63) | (vl >> 1);
+		vh = (vh >> 1) ^ ((uint64_t)t << 32);
+		ctx->hl[i] = vl;
+		ctx->hh[i] = vh;
+	}
+
+	for (int i = 2; i <= 8; i *= 2) {
+		vh = ctx->hh[i];
+		vl = ctx->hl[i];
+		for (int j = 1; j < i; j++) {
+			ctx->hh[i + j] = vh ^ ctx->hh[j];
+			ctx->hl[i + j] = vl ^ ctx->hl[j];
+		}
+	}
+}
+
+static const uint16_t ghash_last4[16] = {
+	0x0000, 0x1c20, 0x3840, 0x2460, 0x7080, 0x6ca0, 0x48c0, 0x54e0,
+	0xe100, 0xfd20, 0xd940, 0xc560, 0x9180, 0x8da0, 0xa9c0, 0xb5e0,
+};
+
+static void ghash_mult_table(const struct aead_ctx *ctx, uint8_t x[16])
+{
+	uint8_t lo = x[15] & 0x0f;
+	uint64_t zh = ctx->hh[lo];
+	uint64_t zl = ctx->hl[lo];
+	uint8_t rem;
+
+	for (int i = 15; i >= 0; i--) {
+		uint8_t hi = x[i] >> 4;
+
+		lo = x[i] & 0x0f;
+		if (i != 15) {
+			rem = (uint8_t)zl & 0x0f;
+			zl = (zh << 60) | (zl >> 4);
+			zh = (zh >> 4) ^ ((uint64_t)ghash_last4[rem] << 48);
+			zh ^= ctx->hh[lo];
+			zl ^= ctx->hl[lo];
+		}
+
+		rem = (uint8_t)zl & 0x0f;
+		zl = (zh << 60) | (zl >> 4);
+		zh = (zh >> 4) ^ ((uint64_t)ghash_last4[rem] << 48);
+		zh ^= ctx->hh[hi];
+		zl ^= ctx->hl[hi];
+	}
+
+	for (int i = 7; i >= 0; i--) {
+		x[i] = (uint8_t)zh;
+		x[i + 8] = (uint8_t)zl;
+		zh >>= 8;
+		zl >>= 8;
+	}
+}
+
+static inline void ghash_mult(const struct aead_ctx *ctx, uint8_t x[16])
+{
+	if (ctx->impl == AEAD_IMPL_TTABLE) {
+		ghash_mult_table(ctx, x);
+	} else {
+		ghash_mult_ref(ctx, x);
+	}
+}
+
+static void ghash_update(const struct aead_ctx *ctx, uint8_t y[16],
+			 const uint8_t *data, size_t len)
+{
+	for (size_t off = 0; off < len; off += 16) {
+		xor_block(y, data + off, min_sz(len - off, 16));
+		ghash_mult(ctx, y);
+	}
+}
+
+static int ccm_crypt(const struct aead_ctx *ctx, bool decrypt,
+		     const uint8_t *nonce, const uint8_t *aad, size_t aad_len,
+		     const uint8_t *in, size_t len, uint8_t *out,
+		     uint8_t tag[AEAD_TAG_MAX], size_t tag_len)
+{
+	block_fn_t enc = block_fn(ctx);
+	uint8_t x[16], a[16], s[16], b[16];
+	uint16_t ctr = 0;
+
+	if (tag_len < 4 || tag_len > 16 || (tag_len & 1) ||
+	    len > 0xffff || aad_len >= 0xff00) {
+		return -EINVAL;
+	}
+
+	/* B0: flags | nonce | payload length (L = 2) */
+	x[0] = (uint8_t)((aad_len ? 0x40 : 0) | (((tag_len - 2) / 2) << 3) | (2 - 1));
+	memcpy(&x[1], nonce, AEAD_CCM_NONCE_LEN);
+	x[14] = (uint8_t)(len >> 8);
+	x[15] = (uint8_t)len;
+	enc(ctx->rk, x, x);
+
+	/* AAD, prefixed with its 2-byte length */
+	if (aad_len > 0) {
+		size_t n = min_sz(aad_len, 14);
+
+		memset(b, 0, 16);
+		b[0] = (uint8_t)(aad_len >> 8);
+		b[1] = (uint8_t)aad_len;
+		memcpy(&b[2], aad, n);
+		xor_block(x, b, 16);
+		enc(ctx->rk, x, x);
+
+		for (size_t off = n; off < aad_len; off += 16) {
+			xor_block(x, aad + off, min_sz(aad_len - off, 16));
+			enc(ctx->rk, x, x);
+		}
+	}
+
+	/* A_i: flags | nonce | counter */
+	a[0] = 2 - 1;
+	memcpy(&a[1], nonce, AEAD_CCM_NONCE_LEN);
+
+	for (size_t off = 0; off < len; off += 16) {
+		size_t n = min_sz(len - off, 16);
+
+		ctr++;
+		a[14] = (uint8_t)(ctr >> 8);
+		a[15] = (uint8_t)ctr;
+		enc(ctx->rk, a, s);
+
+		/* b = plaintext block, taken before out (may alias in) is written */
+		memcpy(b, in + off, n);
+		if (decrypt) {
+			xor_block(b, s, n);
+			memcpy(out + off, b, n);
+		} else {
+			for (size_t j = 0; j < n; j++) {
+				out[off + j] = b[j] ^ s[j];
+			}
+		}
+
+		xor_block(x, b, n);
+		enc(ctx->rk, x, x);
+	}
+
+	a[14] = 0;
+	a[15] = 0;
+	enc(ctx->rk, a, s);
+	for (size_t j = 0; j < tag_len; j++) {
+		tag[j] = x[j] ^ s[j];
+	}
+	return 0;
+}
+
+static int gcm_crypt(const struct aead_ctx *ctx, bool decrypt,
+		     const uint8_t *iv, const uint8_t *aad, size_t aad_len,
+		     const uint8_t *in, size_t len, uint8_t *out,
+		     uint8_t tag[AEAD_TAG_MAX], size_t tag_len)
+{
+	block_fn_t enc = block_fn(ctx);
+	uint8_t j0[16], cb[16], s[16], y[16] = { 0 };
+	uint32_t ctr = 1;
+
+	if (tag_len < 4 || tag_len > 16) {
+		return -EINVAL;
+	}
+
+	/* 96-bit IV: J0 = IV || 0^31 || 1 */
+	memcpy(j0, iv, AEAD_GCM_IV_LEN);
+	j0[12] = 0;
+	j0[13] = 0;
+	j0[14] = 0;
+	j0[15] = 1;
+	memcpy(cb, j0, 16);
+
+	ghash_update(ctx, y, aad, aad_len);
+
+	for (size_t off = 0; off < len; off += 16) {
+		size_t n = min_sz(len - off, 16);
+
+		ctr++;
+		cb[12] = (uint8_t)(ctr >> 24);
+		cb[13] = (uint8_t)(ctr >> 16);
+		cb[14] = (uint8_t)(ctr >> 8);
+		cb[15] = (uint8_t)ctr;
+		enc(ctx->rk, cb, s);
+
+		/* GHASH runs over the ciphertext: absorb in before decrypting */
+		if (decrypt) {
+			xor_block(y, in + off, n);
+			ghash_mult(ctx, y);
+		}
+		for (size_t j = 0; j < n; j++) {
+			out[off + j] = in[off + j] ^ s[j];
+		}
+		if (!decrypt) {
+			xor_block(y, out + off, n);
+			ghash_mult(ctx, y);
+		}
+	}
+
+	/* len(A) || len(C) in bits */
+	uint64_t abits = (uint64_t)aad_len * 8;
+	uint64_t cbits = (uint64_t)len * 8;
+
+	for (int i = 0; i < 8; i++) {
+		y[i] ^= (uint8_t)(abits >> (56 - 8 * i));
+		y[i + 8] ^= (uint8_t)(cbits >> (56 - 8 * i));
+	}
+	ghash_mult(ctx, y);
+
+	enc(ctx->rk, j0, s);
+	for (size_t j = 0; j < tag_len; j++) {
+		tag[j] = y[j] ^ s[j];
+	}
+	return 0;
+}
+
+int aead_init(struct aead_ctx *ctx, enum aead_impl impl, const uint8_t key[AEAD_KEY_LEN])
+{
+	static const uint8_t zero[16];
+
+	if (!aead_impl_available(impl)) {
+		return -ENOTSUP;
+	}
+
+	memset(ctx, 0, sizeof(*ctx));
+	ctx->impl = impl;
+
+#if defined(CONFIG_AEAD_PSA)
+	if (impl == AEAD_IMPL_PSA) {
+		return aead_psa_init(ctx, key);
+	}
+#endif
+
+	if (impl == AEAD_IMPL_TTABLE) {
+		aes128_ttable_init();
+	}
+
+	aes128_expand_key(key, ctx->rk);
+	block_fn(ctx)(ctx->rk, zero, ctx->h);
+	if (impl == AEAD_IMPL_TTABLE) {
+		ghash_table_init(ctx);
+	}
+	return 0;
+}
+
+void aead_free(struct aead_ctx *ctx)
+{
+#if defined(CONFIG_AEAD_PSA)
+	if (ctx->impl == AEAD_IMPL_PSA) {
+		aead_psa_free(ctx);
+	}
+#endif
+	memset(ctx, 0, sizeof(*ctx));
+}
+
+static int crypt(struct aead_ctx *ctx, enum aead_mode mode, bool decrypt,
+		 const uint8_t *nonce, const uint8_t *aad, size_t aad_len,
+		 const uint8_t *in, size_t len, uint8_t *out,
+		 uint8_t *tag, size_t tag_len)
+{
+#if defined(CONFIG_AEAD_PSA)
+	if (ctx->impl == AEAD_IMPL_PSA) {
+		return aead_psa_crypt(ctx, mode, decrypt, nonce, aad, aad_len,
+				      in, len, out, tag, tag_len);
+	}
+#endif
+
+	if (mode == AEAD_CCM) {
+		return ccm_crypt(ctx, decrypt, nonce, aad, aad_len, in, len, out, tag, tag_len);
+	}
+	return gcm_crypt(ctx, decrypt, nonce, aad, aad_len, in, len, out, tag, tag_len);
+}
+
+int aead_encrypt(struct aead_ctx *ctx, enum aead_mode mode,
+		 const uint8_t *nonce, const uint8_t *aad, size_t aad_len,
+		 const uint8_t *in, size_t len, uint8_t *out,
+		 uint8_t *tag, size_t tag_len)
+{
+	return crypt(ctx, mode, false, nonce, aad, aad_len, in, len, out, tag, tag_len);
+}
+
+int aead_decrypt(struct aead_ctx *ctx, enum aead_mode mode,
+		 const uint8_t *nonce, const uint8_t *aad, size_t aad_len,
+		 const uint8_t *in, size_t len, uint8_t *out,
+		 const uint8_t *tag, size_t tag_len)
+{
+	uint8_t calc[AEAD_TAG_MAX];
+	uint8_t diff = 0;
+	int err;
+
+	/* Before anything touches calc; the modes narrow it further */
+	if (tag_len > AEAD_TAG_MAX) {
+		return -EINVAL;
+	}
+
+#if defined(CONFIG_AEAD_PSA)
+	if (ctx->impl == AEAD_IMPL_PSA) {
+		/* PSA checks the tag itself */
+		memcpy(calc, tag, tag_len);
+		return crypt(ctx, mode, true, nonce, aad, aad_len, in, len, out, calc, tag_len);
+	}
+#endif
+
+	err = crypt(ctx, mode, true, nonce, aad, aad_len, in, len, out, calc, tag_len);
+	if (err) {
+		return err;
+	}
+
+	for (size_t i = 0; i < tag_len; i++) {
+		diff |= calc[i] ^ tag[i];
+	}
+	if (diff != 0) {
+		memset(out, 0, len);
+		return -EBADMSG;
+	}
+	return 0;
+}
+
+const char *aead_impl_name(enum aead_impl impl)
+{
+	return (impl < AEAD_IMPLS) ? impl_names[impl] : "?";
+}
+
+bool aead_impl_available(enum aead_impl impl)
+{
+	switch (impl) {
+	case AEAD_IMPL_REF:
+	case AEAD_IMPL_TTABLE:
+		return true;
+	case AEAD_IMPL_PSA:
+		return IS_ENABLED_PSA;
+	default:
+		return false;
+	}
+}
@@ -0,0 +1,90 @@
+/*
+ * AES-128-CCM / AES-128-GCM for application-layer audio encryption,
+ * with interchangeable block and GHASH back ends:
+ *
+ *   AEAD_IMPL_REF     byte-oriented FIPS-197 AES, bit-serial GHASH.
+ *                     Small and obviously correct; the reference the
+ *                     others are checked against.
+ *   AEAD_IMPL_TTABLE  32-bit T-table AES (4 KiB of tables built at
+ *                     first use) and 4-bit table GHASH. Runs on either
+ *                     core; meant for the FLPR.
+ *   AEAD_IMPL_PSA     PSA Crypto, i.e. the CRACEN engine on the nRF54L15
+ *                     M33 (CONFIG_AEAD_PSA, nRF Connect SDK only).
+ *
+ * CCM uses a 13-byte nonce (L = 2, payload up to 65535 bytes) and an
+ * even tag of 4..16 bytes; GCM a 12-byte IV and a 4..16 byte tag. AAD
+ * is limited to 0xFEFF bytes for CCM.
+ *
+ * aead_selftest() runs the FIPS-197, GCM spec and RFC 3610 vectors
+ * through every enabled back end; aead_bench_run() times one audio
+ * frame at a time (CONFIG_AEAD_BENCH_FRAME) and prints AEADBENCH lines.
+ */
+
+#ifndef COMMON_AEAD_H_
+#define COMMON_AEAD_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define AEAD_KEY_LEN       16
+#define AEAD_CCM_NONCE_LEN 13
+#define AEAD_GCM_IV_LEN    12
+#define AEAD_TAG_MAX       16
+
+enum aead_impl {
+	AEAD_IMPL_REF,
+	AEAD_IMPL_TTABLE,
+	AEAD_IMPL_PSA,
+	AEAD_IMPLS,
+};
+
+enum aead_mode {
+	AEAD_CCM,
+	AEAD_GCM,
+};
+
+struct aead_ctx {
+	enum aead_impl impl;
+	uint32_t rk[44];          /* expanded key, big-endian words */
+	uint8_t h[16];            /* GHASH key E(K, 0^128) */
+	uint64_t hl[16];          /* 4-bit GHASH table (TTABLE) */
+	uint64_t hh[16];
+	uint32_t psa_key[2];      /* CCM, GCM key ids (PSA) */
+};
+
+/* Returns -ENOTSUP for a back end that is not built in. */
+int aead_init(struct aead_ctx *ctx, enum aead_impl impl, const uint8_t key[AEAD_KEY_LEN]);
+void aead_free(struct aead_ctx *ctx);
+
+/* in and out may alias. tag receives tag_len bytes. */
+int aead_encrypt(struct aead_ctx *ctx, enum aead_mode mode,
+		 const uint8_t *nonce, const uint8_t *aad, size_t aad_len,
+		 const uint8_t *in, size_t len, uint8_t *out,
+		 uint8_t *tag, size_t tag_len);
+
+/* Returns -EBADMSG on tag mismatch; out is then zeroed. */
+int aead_decrypt(struct aead_ctx *ctx, enum aead_mode mode,
+		 const uint8_t *nonce, const uint8_t *aad, size_t aad_len,
+		 const uint8_t *in, size_t len, uint8_t *out,
+		 const uint8_t *tag, size_t tag_len);
+
+const char *aead_impl_name(enum aead_impl impl);
+bool aead_impl_available(enum aead_impl impl);
+
+/* Known-answer tests on every available back end; 0 if all pass. */
+int aead_selftest(void);
+
+/* Encrypt CONFIG_AEAD_BENCH_FRAME-byte frames back to back for
+ * CONFIG_AEAD_BENCH_MS per back end and mode. core labels the output,
+ * mhz converts time to cycles.
+ */
+void aead_bench_run(const char *core, uint32_t mhz);
+
+/* Block primitives, shared by aead.c and the self-test */
+void aes128_expand_key(const uint8_t key[16], uint32_t rk[44]);
+void aes128_encrypt_ref(const uint32_t rk[44], const uint8_t in[16], uint8_t out[16]);
+void aes128_ttable_init(void);
+void aes128_encrypt_ttable(const uint32_t rk[44], const uint8_t in[16], uint8_t out[16]);
+
+#endif /* COMMON_AEAD_H_ */
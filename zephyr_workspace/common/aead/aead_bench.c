@@ -0,0 +1,316 @@
+/*
+ * Known-answer self-test and per-frame throughput bench for the AEAD
+ * back ends.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/printk.h>
+#include <string.h>
+
+#include "aead.h"
+
+/* FIPS-197 appendix C.1 */
+static const uint8_t fips_key[16] = {
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+	0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+};
+static const uint8_t fips_pt[16] = {
+	0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+	0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff,
+};
+static const uint8_t fips_ct[16] = {
+	0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30,
+	0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a,
+};
+
+/* RFC 3610 packet vector #1 */
+static const uint8_t ccm_key[16] = {
+	0xc0, 0xc1, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7,
+	0xc8, 0xc9, 0xca, 0xcb, 0xcc, 0xcd, 0xce, 0xcf,
+};
+static const uint8_t ccm_nonce[13] = {
+	0x00, 0x00, 0x00, 0x03, 0x02, 0x01, 0x00, 0xa0,
+	0xa1, 0xa2, 0xa3, 0xa4, 0xa5,
+};
+static const uint8_t ccm_aad[8] = {
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+};
+static const uint8_t ccm_pt[23] = {
+	0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+	0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+	0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e,
+};
+static const uint8_t ccm_ct[23] = {
+	0x58, 0x8c, 0x97, 0x9a, 0x61, 0xc6, 0x63, 0xd2,
+	0xf0, 0x66, 0xd0, 0xc2, 0xc0, 0xf9, 0x89, 0x80,
+	0x6d, 0x5f, 0x6b, 0x61, 0xda, 0xc3, 0x84,
+};
+static const uint8_t ccm_tag[8] = {
+	0x17, 0xe8, 0xd1, 0x2c, 0xfd, 0xf9, 0x26, 0xe0,
+};
+
+/* GCM specification (McGrew/Viega) test case 4 */
+static const uint8_t gcm_key[16] = {
+	0xfe, 0xff, 0xe9, 0x92, 0x86, 0x65, 0x73, 0x1c,
+	0x6d, 0x6a, 0x8f, 0x94, 0x67, 0x30, 0x83, 0x08,
+};
+static const uint8_t gcm_iv[12] = {
+	0xca, 0xfe, 0xba, 0xbe, 0xfa, 0xce, 0xdb, 0xad,
+	0xde, 0xca, 0xf8, 0x88,
+};
+static const uint8_t gcm_aad[20] = {
+	0xfe, 0xed, 0xfa, 0xce, 0xde, 0xad, 0xbe, 0xef,
+	0xfe, 0xed, 0xfa, 0xce, 0xde, 0xad, 0xbe, 0xef,
+	0xab, 0xad, 0xda, 0xd2,
+};
+static const uint8_t gcm_pt[60] = {
+	0xd9, 0x31, 0x32, 0x25, 0xf8, 0x84, 0x06, 0xe5,
+	0xa5, 0x59, 0x09, 0xc5, 0xaf, 0xf5, 0x26, 0x9a,
+	0x86, 0xa7, 0xa9, 0x53, 0x15, 0x34, 0xf7, 0xda,
+	0x2e, 0x4c, 0x30, 0x3d, 0x8a, 0x31, 0x8a, 0x72,
+	0x1c, 0x3c, 0x0c, 0x95, 0x95, 0x68, 0x09, 0x53,
+	0x2f, 0xcf, 0x0e, 0x24, 0x49, 0xa6, 0xb5, 0x25,
+	0xb1, 0x6a, 0xed, 0xf5, 0xaa, 0x0d, 0xe6, 0x57,
+	0xba, 0x63, 0x7b, 0x39,
+};
+static const uint8_t gcm_ct[60] = {
+	0x42, 0x83, 0x1e, 0xc2, 0x21, 0x77, 0x74, 0x24,
+	0x4b, 0x72, 0x21, 0xb7, 0x84, 0xd0, 0xd4, 0x9c,
+	0xe3, 0xaa, 0x21, 0x2f, 0x2c, 0x02, 0xa4, 0xe0,
+	0x35, 0xc1, 0x7e, 0x23, 0x29, 0xac, 0xa1, 0x2e,
+	0x21, 0xd5, 0x14, 0xb2, 0x54, 0x66, 0x93, 0x1c,
+	0x7d, 0x8f, 0x6a, 0x5a, 0xac, 0x84, 0xaa, 0x05,
+	0x1b, 0xa3, 0x0b, 0x39, 0x6a, 0x0a, 0xac, 0x97,
+	0x3d, 0x58, 0xe0, 0x91,
+};
+static const uint8_t gcm_tag[16] = {
+	0x5b, 0xc9, 0x4f, 0xbc, 0x32, 0x21, 0xa5, 0xdb,
+	0x94, 0xfa, 0xe9, 0x5a, 0xe7, 0x12, 0x1a, 0x47,
+};
+
+struct aead_kat {
+	const char *name;
+	enum aead_mode mode;
+	const uint8_t *key, *nonce, *aad, *pt, *ct, *tag;
+	size_t aad_len, len, tag_len;
+};
+
+static const struct aead_kat kats[] = {
+	{ "rfc3610#1", AEAD_CCM, ccm_key, ccm_nonce, ccm_aad, ccm_pt, ccm_ct, ccm_tag,
+	  sizeof(ccm_aad), sizeof(ccm_pt), sizeof(ccm_tag) },
+	{ "gcm-tc4", AEAD_GCM, gcm_key, gcm_iv, gcm_aad, gcm_pt, gcm_ct, gcm_tag,
+	  sizeof(gcm_aad), sizeof(gcm_pt), sizeof(gcm_tag) },
+};
+
+static uint8_t frame_in[CONFIG_AEAD_BENCH_FRAME];
+static uint8_t frame_out[CONFIG_AEAD_BENCH_FRAME];
+static uint8_t frame_ref[CONFIG_AEAD_BENCH_FRAME];
+
+static const uint8_t bench_key[16] = {
+	0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+	0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c,
+};
+
+/* Frame header as AAD: sequence number plus stream id */
+#define BENCH_AAD_LEN 8
+#define BENCH_TAG_LEN 8
+
+static void bench_nonce(uint8_t nonce[AEAD_CCM_NONCE_LEN], uint32_t seq)
+{
+	memset(nonce, 0, AEAD_CCM_NONCE_LEN);
+	nonce[0] = 0xa5;
+	sys_put_be32(seq, &nonce[AEAD_CCM_NONCE_LEN - 4]);
+}
+
+static int kat_run(enum aead_impl impl, const struct aead_kat *k)
+{
+	struct aead_ctx ctx;
+	uint8_t buf[64], tag[AEAD_TAG_MAX], big_tag[2 * AEAD_TAG_MAX] = { 0 };
+	int err;
+
+	err = aead_init(&ctx, impl, k->key);
+	if (err) {
+		return err;
+	}
+
+	err = aead_encrypt(&ctx, k->mode, k->nonce, k->aad, k->aad_len,
+			   k->pt, k->len, buf, tag, k->tag_len);
+	if (!err && (memcmp(buf, k->ct, k->len) || memcmp(tag, k->tag, k->tag_len))) {
+		err = -EIO;
+	}
+
+	if (!err) {
+		err = aead_decrypt(&ctx, k->mode, k->nonce, k->aad, k->aad_len,
+				   k->ct, k->len, buf, k->tag, k->tag_len);
+		if (!err && memcmp(buf, k->pt, k->len)) {
+			err = -EIO;
+		}
+	}
+
+	/* A flipped tag bit must be rejected */
+	if (!err) {
+		memcpy(tag, k->tag, k->tag_len);
+		tag[0] ^= 0x01;
+		if (aead_decrypt(&ctx, k->mode, k->nonce, k->aad, k->aad_len,
+				 k->ct, k->len, buf, tag, k->tag_len) != -EBADMSG) {
+			err = -EIO;
+		}
+	}
+
+	/* An oversized tag length must be refused before it is copied */
+	if (!err && aead_decrypt(&ctx, k->mode, k->nonce, k->aad, k->aad_len, k->ct,
+				 k->len, buf, big_tag, sizeof(big_tag)) != -EINVAL) {
+		err = -EIO;
+	}
+
+	aead_free(&ctx);
+	return err;
+}
+
+/* Encrypt the bench frame and compare against the reference back end */
+static int cross_check(enum aead_impl impl, enum aead_mode mode)
+{
+	struct aead_ctx ctx;
+	uint8_t nonce[AEAD_CCM_NONCE_LEN], tag[BENCH_TAG_LEN], ref_tag[BENCH_TAG_LEN];
+	int err;
+
+	bench_nonce(nonce, 0);
+
+	err = aead_init(&ctx, AEAD_IMPL_REF, bench_key);
+	if (err) {
+		return err;
+	}
+	aead_encrypt(&ctx, mode, nonce, frame_in, BENCH_AAD_LEN, frame_in,
+		     sizeof(frame_in), frame_ref, ref_tag, sizeof(ref_tag));
+	aead_free(&ctx);
+
+	err = aead_init(&ctx, impl, bench_key);
+	if (err) {
+		return err;
+	}
+	err = aead_encrypt(&ctx, mode, nonce, frame_in, BENCH_AAD_LEN, frame_in,
+			   sizeof(frame_in), frame_out, tag, sizeof(tag));
+	aead_free(&ctx);
+
+	if (!err && (memcmp(frame_out, frame_ref, sizeof(frame_out)) ||
+		     memcmp(tag, ref_tag, sizeof(tag)))) {
+		err = -EIO;
+	}
+	return err;
+}
+
+int aead_selftest(void)
+{
+	int failures = 0;
+
+	for (size_t i = 0; i < sizeof(frame_in); i++) {
+		frame_in[i] = (uint8_t)(i * 7 + 3);
+	}
+
+	/* Block primitives first: a wrong S-box shows up here, not as a
+	 * puzzling tag mismatch further down.
+	 */
+	uint32_t rk[44];
+	uint8_t blk[16];
+
+	aes128_expand_key(fips_key, rk);
+	aes128_encrypt_ref(rk, fips_pt, blk);
+	if (memcmp(blk, fips_ct, 16)) {
+		printk("AEADTEST fips197 ref: FAIL\n");
+		failures++;
+	}
+	aes128_ttable_init();
+	aes128_encrypt_ttable(rk, fips_pt, blk);
+	if (memcmp(blk, fips_ct, 16)) {
+		printk("AEADTEST fips197 ttable: FAIL\n");
+		failures++;
+	}
+
+	for (int impl = 0; impl < AEAD_IMPLS; impl++) {
+		if (!aead_impl_available(impl)) {
+			continue;
+		}
+
+		for (size_t i = 0; i < ARRAY_SIZE(kats); i++) {
+			int err = kat_run(impl, &kats[i]);
+
+			printk("AEADTEST %s %s: %s (%d)\n", kats[i].name,
+			       aead_impl_name(impl), err ? "FAIL" : "ok", err);
+			failures += (err != 0);
+		}
+
+		if (impl != AEAD_IMPL_REF) {
+			for (int mode = AEAD_CCM; mode <= AEAD_GCM; mode++) {
+				int err = cross_check(impl, mode);
+
+				printk("AEADTEST frame%u-%s %s: %s (%d)\n",
+				       (unsigned int)sizeof(frame_in),
+				       mode == AEAD_CCM ? "ccm" : "gcm",
+				       aead_impl_name(impl), err ? "FAIL" : "ok", err);
+				failures += (err != 0);
+			}
+		}
+	}
+
+	printk("AEADTEST %s\n", failures ? "FAILED" : "passed");
+	return failures ? -EIO : 0;
+}
+
+void aead_bench_run(const char *core, uint32_t mhz)
+{
+	uint8_t nonce[AEAD_CCM_NONCE_LEN], tag[BENCH_TAG_LEN];
+
+	for (int impl = 0; impl < AEAD_IMPLS; impl++) {
+		if (!aead_impl_available(impl)) {
+			continue;
+		}
+
+		for (int mode = AEAD_CCM; mode <= AEAD_GCM; mode++) {
+			struct aead_ctx ctx;
+			uint32_t frames = 0;
+			int err;
+
+			err = aead_init(&ctx, impl, bench_key);
+			if (err) {
+				printk("AEADBENCH core=%s impl=%s: init failed (%d)\n",
+				       core, aead_impl_name(impl), err);
+				break;
+			}
+
+			int64_t start = k_uptime_ticks();
+			int64_t end = start + k_ms_to_ticks_ceil64(CONFIG_AEAD_BENCH_MS);
+			int64_t now;
+
+			do {
+				bench_nonce(nonce, frames);
+				sys_put_be32(frames, frame_in);
+				err = aead_encrypt(&ctx, mode, nonce, frame_in, BENCH_AAD_LEN,
+						   frame_in, sizeof(frame_in), frame_out,
+						   tag, sizeof(tag));
+				frames++;
+				now = k_uptime_ticks();
+			} while (!err && now < end);
+
+			aead_free(&ctx);
+
+			if (err) {
+				printk("AEADBENCH core=%s impl=%s: encrypt failed (%d)\n",
+				       core, aead_impl_name(impl), err);
+				break;
+			}
+
+			uint64_t us = k_ticks_to_us_floor64(now - start);
+			uint64_t bytes = (uint64_t)frames * sizeof(frame_in);
+			uint32_t cyc_per_b_x100 = (uint32_t)(us * mhz * 100 / bytes);
+			uint32_t kbps = (uint32_t)(bytes * 1000000 / 1024 / us);
+
+			printk("AEADBENCH core=%s impl=%s mode=%s frame=%u: "
+			       "%u.%02u cyc/B, %u KB/s, %u us/frame\n",
+			       core, aead_impl_name(impl), mode == AEAD_CCM ? "ccm" : "gcm",
+			       (unsigned int)sizeof(frame_in),
+			       cyc_per_b_x100 / 100, cyc_per_b_x100 % 100, kbps,
+			       (uint32_t)(us / frames));
+		}
+	}
+}
@@ -0,0 +1,118 @@
+/*
+ * PSA Crypto back end. On the nRF54L15 the nRF Connect SDK routes
+ * psa_aead_* to the CRACEN driver, so this is the hardware path.
+ *
+ * One volatile key per mode, since a PSA key policy names a single
+ * algorithm. The one-shot API wants ciphertext and tag in one buffer,
+ * so they go through a scratch buffer guarded by a mutex.
+ */
+
+#include <zephyr/kernel.h>
+#include <psa/crypto.h>
+#include <errno.h>
+#include <string.h>
+
+#include "aead.h"
+
+static uint8_t scratch[CONFIG_AEAD_PSA_MAX_LEN + AEAD_TAG_MAX];
+static K_MUTEX_DEFINE(scratch_lock);
+
+static psa_algorithm_t base_alg(enum aead_mode mode)
+{
+	return (mode == AEAD_CCM) ? PSA_ALG_CCM : PSA_ALG_GCM;
+}
+
+static int import_key(const uint8_t key[AEAD_KEY_LEN], enum aead_mode mode, uint32_t *id)
+{
+	psa_key_attributes_t attr = PSA_KEY_ATTRIBUTES_INIT;
+	psa_key_id_t key_id;
+	psa_status_t status;
+
+	psa_set_key_usage_flags(&attr, PSA_KEY_USAGE_ENCRYPT | PSA_KEY_USAGE_DECRYPT);
+	psa_set_key_lifetime(&attr, PSA_KEY_LIFETIME_VOLATILE);
+	psa_set_key_algorithm(&attr, PSA_ALG_AEAD_WITH_AT_LEAST_THIS_LENGTH_TAG(base_alg(mode), 4));
+	psa_set_key_type(&attr, PSA_KEY_TYPE_AES);
+	psa_set_key_bits(&attr, 128);
+
+	status = psa_import_key(&attr, key, AEAD_KEY_LEN, &key_id);
+	psa_reset_key_attributes(&attr);
+	if (status != PSA_SUCCESS) {
+		return -EIO;
+	}
+
+	*id = key_id;
+	return 0;
+}
+
+int aead_psa_init(struct aead_ctx *ctx, const uint8_t key[AEAD_KEY_LEN])
+{
+	int err;
+
+	if (psa_crypto_init() != PSA_SUCCESS) {
+		return -EIO;
+	}
+
+	err = import_key(key, AEAD_CCM, &ctx->psa_key[AEAD_CCM]);
+	if (err) {
+		return err;
+	}
+
+	err = import_key(key, AEAD_GCM, &ctx->psa_key[AEAD_GCM]);
+	if (err) {
+		psa_destroy_key(ctx->psa_key[AEAD_CCM]);
+		ctx->psa_key[AEAD_CCM] = 0;
+	}
+	return err;
+}
+
+void aead_psa_free(struct aead_ctx *ctx)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(ctx->psa_key); i++) {
+		if (ctx->psa_key[i]) {
+			psa_destroy_key(ctx->psa_key[i]);
+			ctx->psa_key[i] = 0;
+		}
+	}
+}
+
+/* For decrypt, tag carries the expected tag in */
+int aead_psa_crypt(struct aead_ctx *ctx, enum aead_mode mode, bool decrypt,
+		   const uint8_t *nonce, const uint8_t *aad, size_t aad_len,
+		   const uint8_t *in, size_t len, uint8_t *out,
+		   uint8_t *tag, size_t tag_len)
+{
+	psa_algorithm_t alg = PSA_ALG_AEAD_WITH_SHORTENED_TAG(base_alg(mode), tag_len);
+	size_t nonce_len = (mode == AEAD_CCM) ? AEAD_CCM_NONCE_LEN : AEAD_GCM_IV_LEN;
+	psa_status_t status;
+	size_t olen;
+
+	if (len > CONFIG_AEAD_PSA_MAX_LEN || tag_len > AEAD_TAG_MAX) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&scratch_lock, K_FOREVER);
+
+	if (decrypt) {
+		memcpy(scratch, in, len);
+		memcpy(scratch + len, tag, tag_len);
+		status = psa_aead_decrypt(ctx->psa_key[mode], alg, nonce, nonce_len,
+					  aad, aad_len, scratch, len + tag_len,
+					  out, len, &olen);
+	} else {
+		status = psa_aead_encrypt(ctx->psa_key[mode], alg, nonce, nonce_len,
+					  aad, aad_len, in, len,
+					  scratch, len + tag_len, &olen);
+		if (status == PSA_SUCCESS) {
+			memcpy(out, scratch, len);
+			memcpy(tag, scratch + len, tag_len);
+		}
+	}
+
+	k_mutex_unlock(&scratch_lock);
+
+	if (status == PSA_ERROR_INVALID_SIGNATURE) {
+		memset(out, 0, len);
+		return -EBADMSG;
+	}
+	return (status == PSA_SUCCESS) ? 0 : -EIO;
+}
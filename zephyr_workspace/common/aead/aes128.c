@@ -0,0 +1,213 @@
+/*
+ * AES-128 block encryption: key expansion, a byte-oriented reference
+ * and a T-table version.
+ *
+ * The reference follows FIPS-197 section 5.1 step by step on a
+ * column-major byte state. The T-table version folds SubBytes,
+ * ShiftRows and MixColumns into four 256-entry word lookups per column
+ * (Daemen/Rijmen, "AES Proposal: Rijndael", section 5.2.1). The tables
+ * are derived from the S-box at init rather than stored, which keeps
+ * 4 KiB out of the FLPR image's load region; they still take 4 KiB of
+ * RAM.
+ *
+ * Only encryption is needed: CCM and GCM both run the cipher forward.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "aead.h"
+
+static const uint8_t sbox[256] = {
+	0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+	0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+	0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+	0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+	0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+	0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+	0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+	0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+	0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+	0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+	0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+	0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+	0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+	0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+	0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+	0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16,
+};
+
+static uint32_t te0[256], te1[256], te2[256], te3[256];
+static bool te_ready;
+
+static inline uint8_t xtime(uint8_t x)
+{
+	return (uint8_t)((x << 1) ^ ((x & 0x80) ? 0x1b : 0x00));
+}
+
+static inline uint32_t load_be32(const uint8_t *p)
+{
+	return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+	       ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static inline void store_be32(uint8_t *p, uint32_t v)
+{
+	p[0] = (uint8_t)(v >> 24);
+	p[1] = (uint8_t)(v >> 16);
+	p[2] = (uint8_t)(v >> 8);
+	p[3] = (uint8_t)v;
+}
+
+void aes128_expand_key(const uint8_t key[16], uint32_t rk[44])
+{
+	uint8_t rcon = 0x01;
+
+	for (int i = 0; i < 4; i++) {
+		rk[i] = load_be32(key + 4 * i);
+	}
+
+	for (int i = 4; i < 44; i++) {
+		uint32_t t = rk[i - 1];
+
+		if ((i % 4) == 0) {
+			/* RotWord, SubWord, Rcon */
+			t = ((uint32_t)sbox[(t >> 16) & 0xff] << 24) |
+			    ((uint32_t)sbox[(t >> 8) & 0xff] << 16) |
+			    ((uint32_t)sbox[t & 0xff] << 8) |
+			    (uint32_t)sbox[t >> 24];
+			t ^= (uint32_t)rcon << 24;
+			rcon = xtime(rcon);
+		}
+		rk[i] = rk[i - 4] ^ t;
+	}
+}
+
+/* Reference: FIPS-197 Cipher(), state[r + 4c] */
+
+static void add_round_key(uint8_t s[16], const uint32_t *w)
+{
+	for (int c = 0; c < 4; c++) {
+		s[4 * c + 0] ^= (uint8_t)(w[c] >> 24);
+		s[4 * c + 1] ^= (uint8_t)(w[c] >> 16);
+		s[4 * c + 2] ^= (uint8_t)(w[c] >> 8);
+		s[4 * c + 3] ^= (uint8_t)w[c];
+	}
+}
+
+static void sub_bytes(uint8_t s[16])
+{
+	for (int i = 0; i < 16; i++) {
+		s[i] = sbox[s[i]];
+	}
+}
+
+static void shift_rows(uint8_t s[16])
+{
+	uint8_t t[16];
+
+	for (int r = 0; r < 4; r++) {
+		for (int c = 0; c < 4; c++) {
+			t[4 * c + r] = s[4 * ((c + r) % 4) + r];
+		}
+	}
+	memcpy(s, t, 16);
+}
+
+static void mix_columns(uint8_t s[16])
+{
+	for (int c = 0; c < 4; c++) {
+		uint8_t *col = &s[4 * c];
+		uint8_t a0 = col[0], a1 = col[1], a2 = col[2], a3 = col[3];
+		uint8_t all = a0 ^ a1 ^ a2 ^ a3;
+
+		col[0] ^= all ^ xtime(a0 ^ a1);
+		col[1] ^= all ^ xtime(a1 ^ a2);
+		col[2] ^= all ^ xtime(a2 ^ a3);
+		col[3] ^= all ^ xtime(a3 ^ a0);
+	}
+}
+
+void aes128_encrypt_ref(const uint32_t rk[44], const uint8_t in[16], uint8_t out[16])
+{
+	uint8_t s[16];
+
+	memcpy(s, in, 16);
+	add_round_key(s, &rk[0]);
+
+	for (int round = 1; round < 10; round++) {
+		sub_bytes(s);
+		shift_rows(s);
+		mix_columns(s);
+		add_round_key(s, &rk[4 * round]);
+	}
+
+	sub_bytes(s);
+	shift_rows(s);
+	add_round_key(s, &rk[40]);
+	memcpy(out, s, 16);
+}
+
+/* T-table */
+
+void aes128_ttable_init(void)
+{
+	if (te_ready) {
+		return;
+	}
+
+	for (int i = 0; i < 256; i++) {
+		uint8_t s = sbox[i];
+		uint8_t s2 = xtime(s);
+		uint8_t s3 = s2 ^ s;
+		uint32_t w = ((uint32_t)s2 << 24) | ((uint32_t)s << 16) |
+			     ((uint32_t)s << 8) | (uint32_t)s3;
+
+		te0[i] = w;
+		te1[i] = (w >> 8) | (w << 24);
+		te2[i] = (w >> 16) | (w << 16);
+		te3[i] = (w >> 24) | (w << 8);
+	}
+	te_ready = true;
+}
+
+void aes128_encrypt_ttable(const uint32_t rk[44], const uint8_t in[16], uint8_t out[16])
+{
+	uint32_t s0 = load_be32(in) ^ rk[0];
+	uint32_t s1 = load_be32(in + 4) ^ rk[1];
+	uint32_t s2 = load_be32(in + 8) ^ rk[2];
+	uint32_t s3 = load_be32(in + 12) ^ rk[3];
+	uint32_t t0, t1, t2, t3;
+	const uint32_t *k = rk + 4;
+
+	for (int round = 1; round < 10; round++, k += 4) {
+		t0 = te0[s0 >> 24] ^ te1[(s1 >> 16) & 0xff] ^
+		     te2[(s2 >> 8) & 0xff] ^ te3[s3 & 0xff] ^ k[0];
+		t1 = te0[s1 >> 24] ^ te1[(s2 >> 16) & 0xff] ^
+		     te2[(s3 >> 8) & 0xff] ^ te3[s0 & 0xff] ^ k[1];
+		t2 = te0[s2 >> 24] ^ te1[(s3 >> 16) & 0xff] ^
+		     te2[(s0 >> 8) & 0xff] ^ te3[s1 & 0xff] ^ k[2];
+		t3 = te0[s3 >> 24] ^ te1[(s0 >> 16) & 0xff] ^
+		     te2[(s1 >> 8) & 0xff] ^ te3[s2 & 0xff] ^ k[3];
+		s0 = t0;
+		s1 = t1;
+		s2 = t2;
+		s3 = t3;
+	}
+
+	/* Last round: no MixColumns, S-box only */
+	t0 = ((uint32_t)sbox[s0 >> 24] << 24) | ((uint32_t)sbox[(s1 >> 16) & 0xff] << 16) |
+	     ((uint32_t)sbox[(s2 >> 8) & 0xff] << 8) | (uint32_t)sbox[s3 & 0xff];
+	t1 = ((uint32_t)sbox[s1 >> 24] << 24) | ((uint32_t)sbox[(s2 >> 16) & 0xff] << 16) |
+	     ((uint32_t)sbox[(s3 >> 8) & 0xff] << 8) | (uint32_t)sbox[s0 & 0xff];
+	t2 = ((uint32_t)sbox[s2 >> 24] << 24) | ((uint32_t)sbox[(s3 >> 16) & 0xff] << 16) |
+	     ((uint32_t)sbox[(s0 >> 8) & 0xff] << 8) | (uint32_t)sbox[s1 & 0xff];
+	t3 = ((uint32_t)sbox[s3 >> 24] << 24) | ((uint32_t)sbox[(s0 >> 16) & 0xff] << 16) |
+	     ((uint32_t)sbox[(s1 >> 8) & 0xff] << 8) | (uint32_t)sbox[s2 & 0xff];
+
+	store_be32(out, t0 ^ k[0]);
+	store_be32(out + 4, t1 ^ k[1]);
+	store_be32(out + 8, t2 ^ k[2]);
+	store_be32(out + 12, t3 ^ k[3]);
+}
@@ -0,0 +1,207 @@
+#!/usr/bin/env python3
+"""
+Build-time packer for the PSE84 octal NOR asset store (common/assetfs).
+
+Lays out a set of files as one flash image with an index table at the
+front, ready to be programmed at --flash-offset into the 128 MB
+S28HS01GT on SMIF0. Only the first --xip-size bytes of the chip are
+memory mapped (XIP at 0x60000000); the packer never lets an asset
+straddle that boundary, so each asset is either readable in place
+through XIP or read whole through SMIF MMIO.
+
+Image layout (little endian):
+    header   32 bytes   magic "AFS1", version, entry size, count,
+                        index CRC32, image size, alignment
+    index    48 bytes/entry, sorted by (FNV-1a hash, name)
+             name[32] hash offset size crc32
+    data     each asset at an --align boundary; offsets are relative
+             to the image start
+
+Usage:
+    # Pack a directory of frames and sprites at 16 MB into the chip
+    python3 asset_pack.py -o assets.bin --flash-offset 0x1000000 frames/ ui/
+
+    # List the contents of an existing image
+    python3 asset_pack.py --list assets.bin --flash-offset 0x1000000
+"""
+
+import argparse
+import os
+import struct
+import sys
+import zlib
+
+MAGIC = b"AFS1"
+VERSION = 1
+HEADER_FMT = "<4sHHIIII8x"
+ENTRY_FMT = "<32sIIII"
+HEADER_SIZE = struct.calcsize(HEADER_FMT)
+ENTRY_SIZE = struct.calcsize(ENTRY_FMT)
+NAME_MAX = 31
+
+CHIP_SIZE = 128 * 1024 * 1024
+XIP_BASE = 0x60000000
+
+
+def fnv1a(name):
+    h = 0x811C9DC5
+    for b in name.encode():
+        h = ((h ^ b) * 0x01000193) & 0xFFFFFFFF
+    return h
+
+
+def parse_int(s):
+    return int(s, 0)
+
+
+def align_up(v, a):
+    return (v + a - 1) // a * a
+
+
+def collect(paths):
+    """Expand directories (recursively, sorted) into (name, path) pairs.
+    Names are paths relative to the directory given on the command line."""
+    files = []
+    for p in paths:
+        if os.path.isdir(p):
+            for root, _, names in sorted(os.walk(p)):
+                for n in sorted(names):
+                    full = os.path.join(root, n)
+                    files.append((os.path.relpath(full, p).replace(os.sep, "/"), full))
+        else:
+            files.append((os.path.basename(p), p))
+    return files
+
+
+def layout(files, flash_offset, xip_size, align):
+    """Assign image offsets. Returns list of dicts in pack order."""
+    index_end = HEADER_SIZE + ENTRY_SIZE * len(files)
+    pos = align_up(index_end, align)
+    if flash_offset + index_end > xip_size:
+        raise ValueError("index must sit inside the XIP window")
+
+    assets = []
+    for name, path in files:
+        size = os.path.getsize(path)
+        start = flash_offset + pos
+        boundary = xip_size
+        if start < boundary < start + size:
+            # Would straddle the end of the XIP window: move it past.
+            pos = align_up(boundary - flash_offset, align)
+            start = flash_offset + pos
+        with open(path, "rb") as f:
+            data = f.read()
+        assets.append({"name": name, "offset": pos, "size": size,
+                       "crc": zlib.crc32(data) & 0xFFFFFFFF, "data": data,
+                       "xip": start + size <= xip_size})
+        pos = align_up(pos + size, align)
+
+    if flash_offset + pos > CHIP_SIZE:
+        raise ValueError("image (%d bytes at 0x%x) does not fit the %d MB chip"
+                         % (pos, flash_offset, CHIP_SIZE >> 20))
+    return assets, pos
+
+
+def pack(args):
+    files = collect(args.inputs)
+    if not files:
+        print("no input files", file=sys.stderr)
+        return 1
+
+    seen = set()
+    for name, _ in files:
+        if len(name.encode()) > NAME_MAX:
+            print("name too long (max %d): %s" % (NAME_MAX, name), file=sys.stderr)
+            return 1
+        if name in seen:
+            print("duplicate name: %s" % name, file=sys.stderr)
+            return 1
+        seen.add(name)
+
+    try:
+        assets, image_size = layout(files, args.flash_offset, args.xip_size, args.align)
+    except ValueError as e:
+        print(str(e), file=sys.stderr)
+        return 1
+
+    index = b"".join(struct.pack(ENTRY_FMT, a["name"].encode(), fnv1a(a["name"]),
+                                 a["offset"], a["size"], a["crc"])
+                     for a in sorted(assets, key=lambda a: (fnv1a(a["name"]), a["name"])))
+    header = struct.pack(HEADER_FMT, MAGIC, VERSION, ENTRY_SIZE, len(assets),
+                         zlib.crc32(index) & 0xFFFFFFFF, image_size, args.align)
+
+    image = bytearray(b"\xff" * image_size)  # erased NOR reads 0xFF
+    image[0:HEADER_SIZE] = header
+    image[HEADER_SIZE:HEADER_SIZE + len(index)] = index
+    for a in assets:
+        image[a["offset"]:a["offset"] + a["size"]] = a["data"]
+
+    with open(args.output, "wb") as f:
+        f.write(image)
+
+    print_table(assets, args.flash_offset)
+    print("%s: %d assets, %d bytes, flash 0x%08x..0x%08x"
+          % (args.output, len(assets), image_size, args.flash_offset,
+             args.flash_offset + image_size), flush=True)
+    return 0
+
+
+def print_table(assets, flash_offset):
+    print("%-32s %10s %10s  %-5s %s" % ("name", "size", "flash", "path", "crc32"))
+    for a in assets:
+        print("%-32s %10d 0x%08x  %-5s %08x"
+              % (a["name"], a["size"], flash_offset + a["offset"],
+                 "xip" if a["xip"] else "mmio", a["crc"]))
+
+
+def list_image(args):
+    with open(args.list, "rb") as f:
+        img = f.read()
+    magic, ver, esize, count, icrc, size, align = struct.unpack_from(HEADER_FMT, img, 0)
+    if magic != MAGIC or ver != VERSION or esize != ENTRY_SIZE:
+        print("not an AFS%d image" % VERSION, file=sys.stderr)
+        return 1
+    index = img[HEADER_SIZE:HEADER_SIZE + count * ENTRY_SIZE]
+    if zlib.crc32(index) & 0xFFFFFFFF != icrc:
+        print("index CRC mismatch", file=sys.stderr)
+        return 1
+
+    assets = []
+    for i in range(count):
+        raw, h, off, sz, crc = struct.unpack_from(ENTRY_FMT, index, i * ENTRY_SIZE)
+        name = raw.rstrip(b"\0").decode()
+        ok = zlib.crc32(img[off:off + sz]) & 0xFFFFFFFF == crc
+        assets.append({"name": name + ("" if ok else " (CRC BAD)"), "offset": off,
+                       "size": sz, "crc": crc,
+                       "xip": args.flash_offset + off + sz <= args.xip_size})
+    print_table(sorted(assets, key=lambda a: a["offset"]), args.flash_offset)
+    print("%d assets, %d bytes, align %d" % (count, size, align))
+    return 0
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("inputs", nargs="*", help="files or directories to pack")
+    ap.add_argument("-o", "--output", default="assets.bin")
+    ap.add_argument("--flash-offset", type=parse_int, default=0x1000000,
+                    help="chip offset the image is programmed at (default 16 MB, "
+                         "after the boot images)")
+    ap.add_argument("--xip-size", type=parse_int, default=64 * 1024 * 1024,
+                    help="bytes of the chip mapped by XIP (default 64 MB)")
+    ap.add_argument("--align", type=parse_int, default=4096,
+                    help="asset alignment (power of two, default 4096)")
+    ap.add_argument("--list", metavar="IMAGE", help="list an existing image")
+    args = ap.parse_args()
+
+    if args.align & (args.align - 1) or args.align < 64:
+        ap.error("--align must be a power of two >= 64")
+    if args.list:
+        return list_image(args)
+    if not args.inputs:
+        ap.error("no inputs")
+    return pack(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
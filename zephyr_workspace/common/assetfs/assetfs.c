@@ -0,0 +1,176 @@
+/*
+ * Asset store runtime (see assetfs.h).
+ *
+ * Everything here reads the image through the XIP window; only
+ * assetfs_read() of an asset above the window leaves it.
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/crc.h>
+
+#include "assetfs.h"
+
+#define XIP_END     CONFIG_ASSETFS_XIP_SIZE
+#define VERIFY_CHUNK 4096U
+
+static const struct assetfs_header *hdr;
+static const struct assetfs_entry *index_tbl;
+static struct assetfs_stats stats;
+
+static inline const void *xip_ptr(uint32_t flash_addr)
+{
+	return (const void *)(uintptr_t)(CONFIG_ASSETFS_XIP_BASE + flash_addr);
+}
+
+static uint32_t fnv1a(const char *s)
+{
+	uint32_t h = 0x811C9DC5U;
+
+	while (*s != '\0') {
+		h = (h ^ (uint8_t)*s++) * 0x01000193U;
+	}
+	return h;
+}
+
+static void fill_asset(const struct assetfs_entry *e, struct asset *out)
+{
+	uint32_t addr = CONFIG_ASSETFS_FLASH_OFFSET + e->offset;
+
+	out->name = e->name;
+	out->flash_addr = addr;
+	out->size = e->size;
+	out->crc32 = e->crc32;
+	out->xip = (addr + e->size <= XIP_END) ? xip_ptr(addr) : NULL;
+}
+
+int assetfs_mount(void)
+{
+	const struct assetfs_header *h = xip_ptr(CONFIG_ASSETFS_FLASH_OFFSET);
+	const struct assetfs_entry *idx = (const struct assetfs_entry *)(h + 1);
+
+	BUILD_ASSERT(sizeof(struct assetfs_header) == 32, "header layout");
+	BUILD_ASSERT(sizeof(struct assetfs_entry) == 48, "entry layout");
+	BUILD_ASSERT(CONFIG_ASSETFS_FLASH_OFFSET < CONFIG_ASSETFS_XIP_SIZE,
+		     "asset index must be in the XIP window");
+
+	if (h->magic != ASSETFS_MAGIC || h->version != ASSETFS_VERSION ||
+	    h->entry_size != sizeof(struct assetfs_entry)) {
+		return -ENOENT;
+	}
+	if (crc32_ieee((const uint8_t *)idx, h->count * sizeof(*idx)) != h->index_crc) {
+		return -EBADMSG;
+	}
+
+	hdr = h;
+	index_tbl = idx;
+	return (int)h->count;
+}
+
+uint32_t assetfs_count(void)
+{
+	return hdr != NULL ? hdr->count : 0;
+}
+
+int assetfs_find(const char *name, struct asset *out)
+{
+	uint32_t h, lo = 0, hi;
+	uint32_t t0 = k_cycle_get_32();
+	uint32_t ns;
+	int ret = -ENOENT;
+
+	if (hdr == NULL) {
+		return -ENOENT;
+	}
+
+	h = fnv1a(name);
+	hi = hdr->count;
+
+	/* Lower bound on hash, then walk the (rare) collisions. */
+	while (lo < hi) {
+		uint32_t mid = lo + (hi - lo) / 2U;
+
+		if (index_tbl[mid].hash < h) {
+			lo = mid + 1U;
+		} else {
+			hi = mid;
+		}
+	}
+	for (; lo < hdr->count && index_tbl[lo].hash == h; lo++) {
+		if (strncmp(index_tbl[lo].name, name, ASSETFS_NAME_LEN) == 0) {
+			fill_asset(&index_tbl[lo], out);
+			ret = 0;
+			break;
+		}
+	}
+
+	ns = k_cyc_to_ns_floor32(k_cycle_get_32() - t0);
+	stats.lookups++;
+	stats.lookup_sum_ns += ns;
+	stats.lookup_max_ns = MAX(stats.lookup_max_ns, ns);
+	if (ret < 0) {
+		stats.misses++;
+	}
+	return ret;
+}
+
+int assetfs_get(uint32_t idx, struct asset *out)
+{
+	if (hdr == NULL || idx >= hdr->count) {
+		return -ENOENT;
+	}
+	fill_asset(&index_tbl[idx], out);
+	return 0;
+}
+
+int assetfs_read(const struct asset *a, uint32_t off, void *buf, size_t len)
+{
+	int ret;
+
+	if (off >= a->size) {
+		return 0;
+	}
+	len = MIN(len, a->size - off);
+
+	if (a->xip != NULL) {
+		memcpy(buf, (const uint8_t *)a->xip + off, len);
+		return (int)len;
+	}
+
+	if (!IS_ENABLED(CONFIG_ASSETFS_MMIO)) {
+		return -ENOTSUP;
+	}
+	ret = assetfs_mmio_read(a->flash_addr + off, buf, len);
+	if (ret < 0) {
+		return ret;
+	}
+	stats.mmio_reads++;
+	stats.mmio_bytes += len;
+	return (int)len;
+}
+
+int assetfs_verify(const struct asset *a)
+{
+	static uint8_t chunk[VERIFY_CHUNK];
+	uint32_t crc = 0;
+
+	if (a->xip != NULL) {
+		crc = crc32_ieee(a->xip, a->size);
+	} else {
+		for (uint32_t off = 0; off < a->size; off += VERIFY_CHUNK) {
+			int n = assetfs_read(a, off, chunk, VERIFY_CHUNK);
+
+			if (n < 0) {
+				return n;
+			}
+			crc = crc32_ieee_update(crc, chunk, n);
+		}
+	}
+	return crc == a->crc32 ? 0 : -EIO;
+}
+
+void assetfs_get_stats(struct assetfs_stats *out)
+{
+	*out = stats;
+}
@@ -0,0 +1,91 @@
+/*
+ * Read-only asset store on the PSE84 octal NOR (S28HS01GT, SMIF0 CS0).
+ *
+ * The image is produced by asset_pack.py and programmed at
+ * CONFIG_ASSETFS_FLASH_OFFSET. The header and index are read in place
+ * through XIP; lookups are a binary search on the FNV-1a hash of the
+ * name followed by a string compare.
+ *
+ * Assets that lie inside the XIP window have a direct pointer
+ * (asset.xip) and can be used without copying. Assets above it must be
+ * copied out with assetfs_read(), which goes through SMIF MMIO when
+ * CONFIG_ASSETFS_MMIO is set and returns -ENOTSUP otherwise.
+ */
+
+#ifndef COMMON_ASSETFS_H_
+#define COMMON_ASSETFS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define ASSETFS_MAGIC    0x31534641U /* "AFS1" */
+#define ASSETFS_VERSION  1U
+#define ASSETFS_NAME_LEN 32U
+
+/* On-flash layout; must match asset_pack.py. */
+struct assetfs_header {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t entry_size;
+	uint32_t count;
+	uint32_t index_crc;
+	uint32_t image_size;
+	uint32_t align;
+	uint32_t reserved[2];
+};
+
+struct assetfs_entry {
+	char name[ASSETFS_NAME_LEN];
+	uint32_t hash;
+	uint32_t offset; /* from image start */
+	uint32_t size;
+	uint32_t crc32;
+};
+
+struct asset {
+	const char *name;
+	uint32_t flash_addr; /* chip offset */
+	uint32_t size;
+	uint32_t crc32;
+	const void *xip;     /* NULL if above the XIP window */
+};
+
+struct assetfs_stats {
+	uint32_t lookups;
+	uint32_t misses;
+	uint32_t lookup_max_ns;
+	uint64_t lookup_sum_ns;
+	uint32_t mmio_reads;
+	uint64_t mmio_bytes;
+};
+
+/* Validate the header and index CRC. Returns the number of assets, or
+ * -ENOENT (no image), -EBADMSG (bad index CRC).
+ */
+int assetfs_mount(void);
+
+uint32_t assetfs_count(void);
+
+/* Look up by name. Returns 0 or -ENOENT. */
+int assetfs_find(const char *name, struct asset *out);
+
+/* Asset by index position (hash order), for listing. */
+int assetfs_get(uint32_t idx, struct asset *out);
+
+/* Copy len bytes from offset off of the asset into buf. Returns bytes
+ * copied or a negative errno.
+ */
+int assetfs_read(const struct asset *a, uint32_t off, void *buf, size_t len);
+
+/* Recompute the asset's CRC32 (reads it fully). Returns 0 or -EIO. */
+int assetfs_verify(const struct asset *a);
+
+void assetfs_get_stats(struct assetfs_stats *out);
+
+/* MMIO path (assetfs_mmio.c): copy from a chip offset above the XIP
+ * window into dst. Destinations outside CONFIG_ASSETFS_MMIO_DST_BASE/
+ * SIZE go through the bounce buffer, or fail with -EINVAL without one.
+ */
+int assetfs_mmio_read(uint32_t flash_addr, void *dst, size_t len);
+
+#endif /* COMMON_ASSETFS_H_ */
@@ -0,0 +1,29 @@
+/*
+ * M55 <-> M33 mailbox for asset reads above the SMIF0 XIP window.
+ * Shared by assetfs_mmio.c (M55 client) and assetfs_mmio_server.c
+ * (M33 companion); both place it at CONFIG_ASSETFS_MBOX_ADDR.
+ *
+ * The client fills the request, then bumps `req`. The server sees
+ * req != done, performs the read into `dst` (an address the M33 can
+ * write: SRAM, SOCMEM or PSRAM), stores `status` and sets done = req.
+ */
+
+#ifndef COMMON_ASSETFS_MBOX_H_
+#define COMMON_ASSETFS_MBOX_H_
+
+#include <stdint.h>
+
+#define ASSETFS_MBOX_MAGIC 0x4D534641U /* "AFSM" */
+
+struct assetfs_mbox {
+	uint32_t magic;
+	volatile uint32_t req;
+	volatile uint32_t done;
+	uint32_t flash_addr;   /* chip offset */
+	uint32_t len;
+	uint32_t dst;
+	volatile int32_t status;
+	uint32_t reserved;
+} __attribute__((aligned(32)));
+
+#endif /* COMMON_ASSETFS_MBOX_H_ */
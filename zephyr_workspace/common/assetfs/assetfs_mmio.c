@@ -0,0 +1,156 @@
+/*
+ * M55 client for asset reads above the SMIF0 XIP window.
+ *
+ * The M55 has no access to the SMIF0 registers, so the read is posted
+ * to the M33 (assetfs_mmio_server.c) through the mailbox at
+ * CONFIG_ASSETFS_MBOX_ADDR, and the M33 is woken with the doorbell
+ * (common/ipc_bell). While the M33 has SMIF0 in MMIO mode any
+ * instruction fetch or data read from the XIP window would stall or
+ * fault, so posting and waiting happen in one __ramfunc with
+ * interrupts locked, touching only SRAM. Requests are split into
+ * CONFIG_ASSETFS_MMIO_CHUNK pieces to bound the interrupt-off window.
+ *
+ * The M33 writes to the destination address exactly as the M55 gives
+ * it, so that address must be one both cores map the same way
+ * (CONFIG_ASSETFS_MMIO_DST_BASE/SIZE, SOCMEM by default). Anything
+ * else, e.g. a DTCM buffer, is read through the SOCMEM bounce buffer,
+ * or refused with -EINVAL when there is none.
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/cache.h>
+#include <zephyr/kernel.h>
+#include <zephyr/linker/section_tags.h>
+#include <cmsis_core.h>
+
+#include "assetfs.h"
+#include "assetfs_mbox.h"
+#include "ipc_bell.h"
+
+#define MBOX ((struct assetfs_mbox *)CONFIG_ASSETFS_MBOX_ADDR)
+
+#if CONFIG_ASSETFS_MMIO_BOUNCE_ADDR != 0
+BUILD_ASSERT(CONFIG_ASSETFS_MMIO_BOUNCE_ADDR >= CONFIG_ASSETFS_MMIO_DST_BASE &&
+	     CONFIG_ASSETFS_MMIO_BOUNCE_ADDR + CONFIG_ASSETFS_MMIO_CHUNK <=
+	     CONFIG_ASSETFS_MMIO_DST_BASE + CONFIG_ASSETFS_MMIO_DST_SIZE,
+	     "MMIO bounce buffer must lie in the shared destination window");
+
+#define BOUNCE ((uint8_t *)CONFIG_ASSETFS_MMIO_BOUNCE_ADDR)
+static K_MUTEX_DEFINE(bounce_lock);
+#endif
+
+/* Post one request and spin until the M33 completes it. Only
+ * force-inlined CMSIS cache operations and the inline doorbell store
+ * are used: nothing here may leave RAM.
+ */
+static __ramfunc int mbox_transfer(struct assetfs_mbox *mb, uint32_t flash_addr,
+				   uint32_t dst, uint32_t len)
+{
+	uint32_t seq = mb->req + 1U;
+
+	mb->flash_addr = flash_addr;
+	mb->len = len;
+	mb->dst = dst;
+	mb->status = -EINPROGRESS;
+	mb->req = seq;
+	SCB_CleanDCache_by_Addr((void *)mb, sizeof(*mb));
+	__DSB();
+	ipc_bell_ring();
+
+	for (uint32_t i = 0; i < CONFIG_ASSETFS_MMIO_TIMEOUT_SPINS; i++) {
+		SCB_InvalidateDCache_by_Addr((void *)mb, sizeof(*mb));
+		if (mb->done == seq) {
+			return mb->status;
+		}
+	}
+	return -ETIMEDOUT;
+}
+
+static bool dst_shared(const void *dst, size_t len)
+{
+	uintptr_t off = (uintptr_t)dst - CONFIG_ASSETFS_MMIO_DST_BASE;
+
+	/* Below the base wraps to a huge offset and fails too */
+	return off < CONFIG_ASSETFS_MMIO_DST_SIZE &&
+	       len <= CONFIG_ASSETFS_MMIO_DST_SIZE - off;
+}
+
+/* One chunk at a time into `to`, a shared address. */
+static int mmio_chunk(uint32_t flash_addr, uint8_t *to, uint32_t n)
+{
+	unsigned int key = irq_lock();
+	int ret = mbox_transfer(MBOX, flash_addr, (uint32_t)(uintptr_t)to, n);
+
+	irq_unlock(key);
+	return ret;
+}
+
+#if CONFIG_ASSETFS_MMIO_BOUNCE_ADDR != 0
+static int mmio_read_bounced(uint32_t flash_addr, uint8_t *out, size_t len)
+{
+	int ret = 0;
+
+	k_mutex_lock(&bounce_lock, K_FOREVER);
+	while (len > 0) {
+		uint32_t n = MIN(len, (size_t)CONFIG_ASSETFS_MMIO_CHUNK);
+
+		/* The CPU only ever reads the bounce buffer, so its lines
+		 * are clean and can simply be dropped around the transfer.
+		 */
+		sys_cache_data_invd_range(BOUNCE, n);
+		ret = mmio_chunk(flash_addr, BOUNCE, n);
+		if (ret < 0) {
+			break;
+		}
+		sys_cache_data_invd_range(BOUNCE, n);
+		memcpy(out, BOUNCE, n);
+
+		flash_addr += n;
+		out += n;
+		len -= n;
+	}
+	k_mutex_unlock(&bounce_lock);
+	return ret;
+}
+#endif
+
+int assetfs_mmio_read(uint32_t flash_addr, void *dst, size_t len)
+{
+	uint8_t *out = dst;
+
+	if (MBOX->magic != ASSETFS_MBOX_MAGIC) {
+		/* Server not running in the M33 image. */
+		return -ENODEV;
+	}
+
+	if (!dst_shared(dst, len)) {
+		/* The M33 would write this address in its own map */
+#if CONFIG_ASSETFS_MMIO_BOUNCE_ADDR != 0
+		return mmio_read_bounced(flash_addr, out, len);
+#else
+		return -EINVAL;
+#endif
+	}
+
+	/* Write back and drop any cached copy of the destination so the
+	 * M33's writes are not overwritten by a later eviction.
+	 */
+	sys_cache_data_flush_and_invd_range(dst, len);
+
+	while (len > 0) {
+		uint32_t n = MIN(len, (size_t)CONFIG_ASSETFS_MMIO_CHUNK);
+		int ret = mmio_chunk(flash_addr, out, n);
+
+		if (ret < 0) {
+			return ret;
+		}
+
+		flash_addr += n;
+		out += n;
+		len -= n;
+	}
+
+	sys_cache_data_invd_range(dst, out - (uint8_t *)dst);
+	return 0;
+}
@@ -0,0 +1,89 @@
+/*
+ * M33 secure-side server for asset reads above the SMIF0 XIP window.
+ *
+ * Built into the enable_cm55 companion through the app's m33/ Zephyr
+ * module (CONFIG_ASSETFS_MMIO_SERVER). The companion runs from RRAM,
+ * so it keeps running while SMIF0 is out of XIP mode. Uses the octal
+ * memslot generated in pse84_octal_enablement/cycfg_octal_generated.
+ * SMIF0 itself is left as the boot chain configured it.
+ *
+ * A thread publishes the mailbox magic, then serves requests as they
+ * come. It sleeps on the doorbell (common/ipc_bell), which the M55
+ * rings after each post, and looks anyway every
+ * CONFIG_ASSETFS_MMIO_SERVER_POLL_MS in case a ring is lost.
+ *
+ * Cy_SMIF_MemRead drains the RX FIFO with the CPU. Moving that to a
+ * DW channel on the SMIF RX trigger is the next step if the M33 copy
+ * turns out to limit throughput.
+ */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <zephyr/kernel.h>
+
+#include "cy_smif.h"
+#include "cy_smif_memslot.h"
+#include "cycfg_qspi_memslot.h"
+
+#include "assetfs_mbox.h"
+#include "ipc_bell.h"
+
+#define MBOX ((struct assetfs_mbox *)CONFIG_ASSETFS_MBOX_ADDR)
+#define POLL K_MSEC(CONFIG_ASSETFS_MMIO_SERVER_POLL_MS)
+
+/* Only the PDL's blocking-call timeout (us) is needed: SMIF0 is not
+ * re-initialised here.
+ */
+static cy_stc_smif_context_t smif_ctx = {
+	.timeout = 100000U,
+};
+
+static void assetfs_mmio_server_init(void)
+{
+	MBOX->req = 0;
+	MBOX->done = 0;
+	MBOX->status = 0;
+	MBOX->magic = ASSETFS_MBOX_MAGIC;
+}
+
+/* Serve at most one pending request. Returns true if one was served. */
+static bool assetfs_mmio_serve(void)
+{
+	uint32_t req = MBOX->req;
+	cy_en_smif_status_t st;
+
+	if (req == MBOX->done) {
+		return false;
+	}
+
+	Cy_SMIF_SetMode(SMIF0_CORE, CY_SMIF_NORMAL);
+	st = Cy_SMIF_MemRead(SMIF0_CORE, &S28HS01GT_SMIF0_SlaveSlot_0, MBOX->flash_addr,
+			     (uint8_t *)(uintptr_t)MBOX->dst, MBOX->len, &smif_ctx);
+	Cy_SMIF_SetMode(SMIF0_CORE, CY_SMIF_MEMORY);
+
+	MBOX->status = (st == CY_SMIF_SUCCESS) ? 0 : -EIO;
+	__DSB();
+	MBOX->done = req;
+	return true;
+}
+
+static void server_main(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	assetfs_mmio_server_init();
+
+	for (;;) {
+		if (!assetfs_mmio_serve()) {
+			(void)ipc_bell_wait(POLL);
+		}
+	}
+}
+
+/* Highest application priority: the M55 spins with interrupts locked
+ * until each request is done.
+ */
+K_THREAD_DEFINE(assetfs_mmio_server, CONFIG_ASSETFS_MMIO_SERVER_STACK_SIZE, server_main, NULL,
+		NULL, NULL, K_HIGHEST_APPLICATION_THREAD_PRIO, 0, 0);
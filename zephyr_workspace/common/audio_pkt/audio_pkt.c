@@ -0,0 +1,316 @@
+/*
+ * Audio packetiser (see audio_pkt.h)
+ */
+
+#include "audio_pkt.h"
+
+#include <string.h>
+
+#define SEQ_STEP_MAX  255
+#define TS_STEP_MAX   127
+#define T_IFS_US      150
+
+static void put_le16(uint8_t *p, uint16_t v)
+{
+	p[0] = v & 0xFF;
+	p[1] = v >> 8;
+}
+
+static void put_le32(uint8_t *p, uint32_t v)
+{
+	put_le16(p, v & 0xFFFF);
+	put_le16(p + 2, v >> 16);
+}
+
+static uint16_t get_le16(const uint8_t *p)
+{
+	return p[0] | (p[1] << 8);
+}
+
+static uint32_t get_le32(const uint8_t *p)
+{
+	return get_le16(p) | ((uint32_t)get_le16(p + 2) << 16);
+}
+
+static size_t sdu_len(bool compress, uint32_t n)
+{
+	return (compress ? AUDIO_PKT_HDR_COMPRESSED(n) : AUDIO_PKT_HDR_PLAIN(n)) +
+	       n * AUDIO_PKT_FRAME_BYTES;
+}
+
+void audio_pkt_init(struct audio_pkt *p, const struct audio_pkt_cfg *cfg)
+{
+	uint32_t limit = AUDIO_PKT_MAX_FRAMES;
+
+	memset(p, 0, sizeof(*p));
+	p->cfg = *cfg;
+
+	/* Largest batch the bearer takes and the hold time allows */
+	while (limit > 1 && cfg->sdu_max && sdu_len(cfg->compress, limit) > cfg->sdu_max) {
+		limit--;
+	}
+	if (limit > 1 + cfg->hold_us / AUDIO_PKT_FRAME_US) {
+		limit = 1 + cfg->hold_us / AUDIO_PKT_FRAME_US;
+	}
+	if (cfg->frames >= 1 && limit > cfg->frames) {
+		limit = cfg->frames;
+	}
+	p->limit = limit;
+	p->batch = cfg->adaptive ? 1 : limit;
+}
+
+/* Write the open SDU to out. now_us is the capture time of the frame
+ * that closed it, which is when the SDU is ready to send.
+ */
+static size_t close_sdu(struct audio_pkt *p, uint8_t *out, uint32_t now_us)
+{
+	uint8_t *o = out;
+	size_t hdr;
+
+	if (p->cfg.compress) {
+		*o++ = AUDIO_PKT_COMPRESSED | p->n;
+		put_le16(o, p->seq[0]);
+		put_le32(o + 2, p->ts_us[0]);
+		o += 6;
+		for (int i = 1; i < p->n; i++) {
+			int32_t step = (int32_t)(p->ts_us[i] - p->ts_us[i - 1]) - AUDIO_PKT_FRAME_US;
+
+			*o++ = (uint8_t)(p->seq[i] - p->seq[i - 1]);
+			*o++ = (uint8_t)(int8_t)(step / AUDIO_PKT_TS_UNIT_US);
+		}
+	} else {
+		*o++ = p->n;
+		for (int i = 0; i < p->n; i++) {
+			put_le16(o, p->seq[i]);
+			put_le32(o + 2, p->ts_us[i]);
+			o += 6;
+		}
+	}
+	hdr = o - out;
+
+	/* PCM is little-endian on every target this runs on */
+	memcpy(o, p->pcm, p->n * AUDIO_PKT_FRAME_BYTES);
+
+	for (int i = 0; i < p->n; i++) {
+		uint32_t hold = now_us - p->ts_us[i];
+
+		p->hold_sum_us += hold;
+		if (hold > p->hold_max_us) {
+			p->hold_max_us = hold;
+		}
+	}
+	p->sdus++;
+	p->frames += p->n;
+	p->hdr_bytes += hdr;
+
+	size_t len = hdr + p->n * AUDIO_PKT_FRAME_BYTES;
+
+	p->n = 0;
+	return len;
+}
+
+/* Compressed time step from the previous frame, in samples past one
+ * frame period, rounded to the nearest
+ */
+static int32_t ts_step(const struct audio_pkt *p, uint32_t ts_us)
+{
+	int32_t d = (int32_t)(ts_us - p->ts_us[p->n - 1]) - AUDIO_PKT_FRAME_US;
+
+	return (d + (d < 0 ? -AUDIO_PKT_TS_UNIT_US : AUDIO_PKT_TS_UNIT_US) / 2) /
+	       AUDIO_PKT_TS_UNIT_US;
+}
+
+size_t audio_pkt_push(struct audio_pkt *p, uint16_t seq, uint32_t ts_us,
+		      const int16_t *pcm, uint8_t *out)
+{
+	size_t len = 0;
+
+	if (p->n > 0 && p->cfg.compress) {
+		uint16_t dseq = seq - p->seq[p->n - 1];
+		int32_t step = ts_step(p, ts_us);
+
+		if (dseq == 0 || dseq > SEQ_STEP_MAX || step < -TS_STEP_MAX || step > TS_STEP_MAX) {
+			len = close_sdu(p, out, ts_us);
+			p->breaks++;
+		} else {
+			/* Keep the time the receiver will rebuild, so
+			 * rounding does not add up along the SDU
+			 */
+			ts_us = p->ts_us[p->n - 1] + AUDIO_PKT_FRAME_US + step * AUDIO_PKT_TS_UNIT_US;
+		}
+	}
+
+	p->seq[p->n] = seq;
+	p->ts_us[p->n] = ts_us;
+	memcpy(p->pcm[p->n], pcm, AUDIO_PKT_FRAME_BYTES);
+	p->n++;
+
+	/* A break leaves one frame, which the batch and hold caps in
+	 * audio_pkt_init() never close on its own
+	 */
+	if (len == 0) {
+		if (p->n >= p->batch) {
+			len = close_sdu(p, out, ts_us);
+		} else if (ts_us + AUDIO_PKT_FRAME_US - p->ts_us[0] > p->cfg.hold_us) {
+			len = close_sdu(p, out, ts_us);
+			p->early++;
+		}
+	}
+	return len;
+}
+
+size_t audio_pkt_flush(struct audio_pkt *p, uint8_t *out)
+{
+	if (p->n == 0) {
+		return 0;
+	}
+	return close_sdu(p, out, p->ts_us[p->n - 1]);
+}
+
+void audio_pkt_backlog(struct audio_pkt *p, uint32_t queued)
+{
+	if (!p->cfg.adaptive) {
+		return;
+	}
+
+	if (queued > 1) {
+		p->calm = 0;
+		if (p->batch < p->limit) {
+			p->batch++;
+		}
+	} else if (++p->calm >= AUDIO_PKT_SHRINK_AFTER) {
+		p->calm = 0;
+		if (p->batch > 1) {
+			p->batch--;
+		}
+	}
+}
+
+int audio_pkt_parse(const uint8_t *sdu, size_t len, struct audio_pkt_frame *f, int max)
+{
+	bool compress;
+	int n;
+	const uint8_t *h;
+	const uint8_t *pcm;
+	uint16_t seq;
+	uint32_t ts;
+
+	if (len < 1) {
+		return -1;
+	}
+	compress = sdu[0] & AUDIO_PKT_COMPRESSED;
+	n = sdu[0] & ~AUDIO_PKT_COMPRESSED;
+	if (n == 0 || len != sdu_len(compress, n)) {
+		return -1;
+	}
+
+	h = sdu + 1;
+	pcm = sdu + len - n * AUDIO_PKT_FRAME_BYTES;
+	seq = get_le16(h);
+	ts = get_le32(h + 2);
+
+	for (int i = 0; i < n && i < max; i++) {
+		if (i > 0) {
+			if (compress) {
+				const uint8_t *d = h + 6 + 2 * (i - 1);
+
+				seq += d[0];
+				ts += AUDIO_PKT_FRAME_US + (int8_t)d[1] * AUDIO_PKT_TS_UNIT_US;
+			} else {
+				seq = get_le16(h + 6 * i);
+				ts = get_le32(h + 6 * i + 2);
+			}
+		}
+		f[i].seq = seq;
+		f[i].ts_us = ts;
+		f[i].pcm = pcm + i * AUDIO_PKT_FRAME_BYTES;
+	}
+	return n < max ? n : max;
+}
+
+/* One LL PDU of len payload bytes from the peripheral, the central's
+ * empty PDU and the two inter-frame spaces around them
+ */
+static uint32_t pdu_air_us(uint32_t len, uint8_t phy_mbps)
+{
+	uint32_t preamble = (phy_mbps == 2) ? 2 : 1;
+	uint32_t overhead = preamble + 4 + 2 + 3;  /* + access address, header, CRC */
+
+	return ((overhead + len) + overhead) * 8 / phy_mbps + 2 * T_IFS_US;
+}
+
+/* An L2CAP frame of len bytes, header included, cut into LL PDUs */
+static uint32_t frame_air_us(uint32_t len, uint16_t ll_len, uint8_t phy_mbps)
+{
+	uint32_t us = 0;
+
+	while (len > ll_len) {
+		us += pdu_air_us(ll_len, phy_mbps);
+		len -= ll_len;
+	}
+	return us + pdu_air_us(len, phy_mbps);
+}
+
+uint32_t audio_pkt_air_us(size_t sdu_len, uint16_t mps, uint16_t ll_len, uint8_t phy_mbps)
+{
+	uint32_t left;
+	uint32_t us = 0;
+
+	if (mps == 0) {
+		return frame_air_us(4 + 3 + sdu_len, ll_len, phy_mbps);
+	}
+
+	/* The first K-frame carries the 2-byte SDU length */
+	left = sdu_len + 2;
+	while (left > 0) {
+		uint32_t k = (left > mps) ? mps : left;
+
+		us += frame_air_us(4 + k, ll_len, phy_mbps);
+		left -= k;
+	}
+	return us;
+}
+
+void audio_pkt_q_init(struct audio_pkt_q *q, uint32_t size)
+{
+	memset(q, 0, sizeof(*q));
+	q->size = (size > AUDIO_PKT_Q_MAX) ? AUDIO_PKT_Q_MAX : size;
+}
+
+uint8_t audio_pkt_q_path(struct audio_pkt_q *q)
+{
+	q->tail = q->head;
+	return ++q->gen;
+}
+
+struct audio_pkt_sdu_rec *audio_pkt_q_push(struct audio_pkt_q *q)
+{
+	struct audio_pkt_sdu_rec *r;
+
+	if (audio_pkt_q_len(q) >= q->size) {
+		return NULL;
+	}
+	r = &q->rec[q->head++ % AUDIO_PKT_Q_MAX];
+	memset(r, 0, sizeof(*r));
+	r->gen = q->gen;
+	return r;
+}
+
+void audio_pkt_q_unpush(struct audio_pkt_q *q)
+{
+	if (q->head != q->tail) {
+		q->head--;
+	}
+}
+
+const struct audio_pkt_sdu_rec *audio_pkt_q_sent(struct audio_pkt_q *q, uint8_t gen)
+{
+	const struct audio_pkt_sdu_rec *r = &q->rec[q->tail % AUDIO_PKT_Q_MAX];
+
+	if (q->head == q->tail || r->gen != gen) {
+		q->stale++;
+		return NULL;
+	}
+	q->tail++;
+	return r;
+}
@@ -0,0 +1,177 @@
+/*
+ * Audio packetiser: batches 16 ms PCM frames into BLE SDUs.
+ *
+ * Every SDU costs a fixed amount of radio time (L2CAP header, LL PDU
+ * headers, inter-frame spaces, the central's empty PDUs), so one frame
+ * per SDU wastes airtime; every frame held for a batch adds a frame
+ * period of latency. The packetiser takes a frames-per-SDU target, an
+ * optional header compression and a maximum hold time, and can move
+ * the target with the sender's backlog.
+ *
+ * SDU layout, little-endian:
+ *
+ *   plain:       u8 n | n x (u16 seq, u32 ts_us) | n x 128 s16
+ *   compressed:  u8 0x80|n | u16 seq, u32 ts_us
+ *                | (n-1) x (u8 seq step, s8 ts step - 16 ms in 125 us)
+ *                | n x 128 s16
+ *
+ * ts_us is the sender's capture time of the frame's first sample. A
+ * frame whose steps do not fit a byte closes the SDU early, so either
+ * layout carries any sequence.
+ *
+ * Pure C with no kernel calls: the caller passes in the time and owns
+ * the SDU buffers, which is what lets audio_dsp_test run it on a host.
+ */
+
+#ifndef COMMON_AUDIO_PKT_H_
+#define COMMON_AUDIO_PKT_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define AUDIO_PKT_FRAME       128   /* samples per frame, 16 ms at 8 kHz */
+#define AUDIO_PKT_FRAME_BYTES (AUDIO_PKT_FRAME * 2)
+#define AUDIO_PKT_FRAME_US    16000
+#define AUDIO_PKT_TS_UNIT_US  125   /* one sample at 8 kHz */
+
+#if defined(CONFIG_AUDIO_PKT_MAX_FRAMES)
+#define AUDIO_PKT_MAX_FRAMES CONFIG_AUDIO_PKT_MAX_FRAMES
+#else
+#define AUDIO_PKT_MAX_FRAMES 4
+#endif
+
+#define AUDIO_PKT_COMPRESSED  0x80
+#define AUDIO_PKT_HDR_PLAIN(n)      (1 + 6 * (n))
+#define AUDIO_PKT_HDR_COMPRESSED(n) (7 + 2 * ((n) - 1))
+#define AUDIO_PKT_SDU_MAX \
+	(AUDIO_PKT_HDR_PLAIN(AUDIO_PKT_MAX_FRAMES) + AUDIO_PKT_MAX_FRAMES * AUDIO_PKT_FRAME_BYTES)
+
+/* Consecutive SDUs with an empty queue before the batch shrinks */
+#define AUDIO_PKT_SHRINK_AFTER 16
+
+struct audio_pkt_cfg {
+	uint8_t frames;      /* frames per SDU, or the adaptive upper bound */
+	bool adaptive;       /* move between 1 and frames with the backlog */
+	bool compress;
+	uint32_t hold_us;    /* longest a frame waits for its SDU to close */
+	uint16_t sdu_max;    /* largest SDU the bearer takes */
+};
+
+struct audio_pkt {
+	struct audio_pkt_cfg cfg;
+	uint8_t batch;       /* current frames-per-SDU target */
+	uint8_t limit;       /* frames that fit in cfg.sdu_max */
+	uint8_t n;           /* frames in the open SDU */
+	uint8_t calm;        /* SDUs since the queue last held one */
+	uint16_t seq[AUDIO_PKT_MAX_FRAMES];
+	uint32_t ts_us[AUDIO_PKT_MAX_FRAMES];
+	int16_t pcm[AUDIO_PKT_MAX_FRAMES][AUDIO_PKT_FRAME];
+
+	/* Counters since init */
+	uint32_t sdus;
+	uint32_t frames;
+	uint32_t hdr_bytes;
+	uint32_t early;      /* SDUs closed by the hold time */
+	uint32_t breaks;     /* SDUs closed because a step did not compress */
+	uint64_t hold_sum_us;
+	uint32_t hold_max_us;
+};
+
+/* One frame found by audio_pkt_parse() */
+struct audio_pkt_frame {
+	uint16_t seq;
+	uint32_t ts_us;
+	const uint8_t *pcm;  /* AUDIO_PKT_FRAME LE s16, not aligned */
+};
+
+void audio_pkt_init(struct audio_pkt *p, const struct audio_pkt_cfg *cfg);
+
+/* Queue one frame captured at ts_us. When this closes an SDU, it is
+ * written to out (at least AUDIO_PKT_SDU_MAX bytes) and its length
+ * returned; otherwise 0. An SDU closes when it reaches the batch, when
+ * waiting one more frame would hold its first frame longer than
+ * hold_us, or, compressed, when this frame's steps do not fit; in the
+ * last case this frame opens the next SDU.
+ */
+size_t audio_pkt_push(struct audio_pkt *p, uint16_t seq, uint32_t ts_us,
+		      const int16_t *pcm, uint8_t *out);
+
+/* Close the open SDU, if any, into out; 0 when nothing was queued */
+size_t audio_pkt_flush(struct audio_pkt *p, uint8_t *out);
+
+/* Adaptive mode: call after handing an SDU to the bearer with the
+ * number of SDUs it still holds, that one included. A queue that holds
+ * more than one means the link is not keeping up with the SDU rate, so
+ * the batch grows; AUDIO_PKT_SHRINK_AFTER SDUs in a row that found it
+ * empty shrink it again.
+ */
+void audio_pkt_backlog(struct audio_pkt *p, uint32_t queued);
+
+/* Split an SDU into frames; returns how many (at most max), or -1 if
+ * the SDU is malformed
+ */
+int audio_pkt_parse(const uint8_t *sdu, size_t len, struct audio_pkt_frame *f, int max);
+
+/* SDUs the bearer still holds, oldest first, for the sender's latency
+ * and backlog accounting. Sent callbacks arrive in send order on one
+ * bearer, but a switch between bearers (GATT <-> L2CAP) leaves the old
+ * one's SDUs in flight. audio_pkt_q_path() starts a new generation:
+ * it forgets the outstanding records, and a completion tagged with an
+ * older generation is dropped instead of popping a new one. head and
+ * tail only ever count up, so head - tail is always the queue length.
+ *
+ * No locking here: the sender serialises calls from its thread and
+ * the bearer's callbacks.
+ */
+#define AUDIO_PKT_Q_MAX 16
+
+struct audio_pkt_sdu_rec {
+	uint32_t submit_us;
+	uint32_t hold_sum_us;  /* sum over its frames of submit - capture end */
+	uint32_t hold_max_us;
+	uint8_t n;
+	uint8_t gen;
+};
+
+struct audio_pkt_q {
+	struct audio_pkt_sdu_rec rec[AUDIO_PKT_Q_MAX];
+	uint32_t head;
+	uint32_t tail;
+	uint32_t size;
+	uint32_t stale;        /* completions dropped as an older generation's */
+	uint8_t gen;
+};
+
+void audio_pkt_q_init(struct audio_pkt_q *q, uint32_t size);
+
+/* New bearer: drop what the old one holds; returns the new generation */
+uint8_t audio_pkt_q_path(struct audio_pkt_q *q);
+
+/* Record for the next SDU, tagged with the current generation, or NULL
+ * if size SDUs are already out
+ */
+struct audio_pkt_sdu_rec *audio_pkt_q_push(struct audio_pkt_q *q);
+
+/* Take back the last push, when the bearer refused the SDU */
+void audio_pkt_q_unpush(struct audio_pkt_q *q);
+
+/* One SDU of generation gen was sent: its record, or NULL if the
+ * completion is stale
+ */
+const struct audio_pkt_sdu_rec *audio_pkt_q_sent(struct audio_pkt_q *q, uint8_t gen);
+
+static inline uint32_t audio_pkt_q_len(const struct audio_pkt_q *q)
+{
+	return q->head - q->tail;
+}
+
+/* Radio time to carry one SDU from the peripheral, on a link with
+ * ll_len-byte LL payloads at phy_mbps (1 or 2). mps 0 means an ATT
+ * notification (3-byte ATT header in one L2CAP frame); otherwise an
+ * L2CAP CoC SDU cut into K-frames of at most mps bytes. Each LL PDU is
+ * counted with the central's empty PDU and two inter-frame spaces.
+ */
+uint32_t audio_pkt_air_us(size_t sdu_len, uint16_t mps, uint16_t ll_len, uint8_t phy_mbps);
+
+#endif /* COMMON_AUDIO_PKT_H_ */
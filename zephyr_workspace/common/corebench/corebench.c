@@ -0,0 +1,480 @@
+/*
+ * CoreMark-class compute benchmark
+ *
+ * The kernels follow the shape of EEMBC CoreMark (linked list, matrix,
+ * state machine, CRC) but are written from scratch and sized for the
+ * FLPR's RAM. Scores are therefore not CoreMark scores. They compare
+ * cores with each other, not with published CoreMark tables.
+ *
+ * Only fixed-width unsigned arithmetic feeds the signature, so it is
+ * the same on every core and compiler.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <errno.h>
+#include <stddef.h>
+
+#include "corebench.h"
+
+#define LIST_NODES 64
+#define LIST_FINDS 16
+#define MAT_N      16
+#define STATE_LEN  256
+
+/* volatile: read at run time, so nothing below folds to a constant */
+static volatile uint16_t seed_list = 0x3415;
+static volatile uint16_t seed_matrix = 0x3415;
+static volatile uint16_t seed_state = 0x0066;
+
+static uint16_t crc8(uint8_t data, uint16_t crc)
+{
+	for (int i = 0; i < 8; i++) {
+		uint16_t x = (data ^ crc) & 1;
+
+		data >>= 1;
+		crc >>= 1;
+		if (x) {
+			crc ^= 0xa001;
+		}
+	}
+	return crc;
+}
+
+static uint16_t crc16(uint16_t v, uint16_t crc)
+{
+	crc = crc8((uint8_t)v, crc);
+	return crc8((uint8_t)(v >> 8), crc);
+}
+
+static uint16_t crc32(uint32_t v, uint16_t crc)
+{
+	crc = crc16((uint16_t)v, crc);
+	return crc16((uint16_t)(v >> 16), crc);
+}
+
+static inline uint32_t lcg(uint32_t *x)
+{
+	*x = *x * 1103515245u + 12345u;
+	return *x >> 16;
+}
+
+/* List */
+
+struct list_node {
+	struct list_node *next;
+	uint16_t data;
+	uint16_t idx;
+};
+
+static struct list_node list_pool[LIST_NODES];
+
+typedef int (*list_cmp_t)(const struct list_node *a, const struct list_node *b);
+
+static int cmp_data(const struct list_node *a, const struct list_node *b)
+{
+	return (a->data > b->data) - (a->data < b->data);
+}
+
+static int cmp_idx(const struct list_node *a, const struct list_node *b)
+{
+	return (a->idx > b->idx) - (a->idx < b->idx);
+}
+
+static struct list_node *list_init(uint16_t seed)
+{
+	uint32_t x = seed;
+
+	for (int i = 0; i < LIST_NODES; i++) {
+		list_pool[i].idx = (uint16_t)i;
+		list_pool[i].data = (uint16_t)(lcg(&x) & 0x7fff);
+		list_pool[i].next = (i + 1 < LIST_NODES) ? &list_pool[i + 1] : NULL;
+	}
+	return &list_pool[0];
+}
+
+static struct list_node *list_reverse(struct list_node *head)
+{
+	struct list_node *prev = NULL;
+
+	while (head) {
+		struct list_node *next = head->next;
+
+		head->next = prev;
+		prev = head;
+		head = next;
+	}
+	return prev;
+}
+
+static struct list_node *list_find(struct list_node *head, uint16_t data)
+{
+	while (head && head->data != data) {
+		head = head->next;
+	}
+	return head;
+}
+
+/* Bottom-up merge sort, O(n log n) without recursion */
+static struct list_node *list_sort(struct list_node *list, list_cmp_t cmp)
+{
+	for (int insize = 1;; insize *= 2) {
+		struct list_node *p = list, *tail = NULL;
+		int merges = 0;
+
+		list = NULL;
+		while (p) {
+			struct list_node *q = p;
+			int psize = 0, qsize = insize;
+
+			merges++;
+			for (int i = 0; i < insize && q; i++) {
+				psize++;
+				q = q->next;
+			}
+
+			while (psize > 0 || (qsize > 0 && q)) {
+				struct list_node *e;
+
+				if (psize == 0) {
+					e = q;
+					q = q->next;
+					qsize--;
+				} else if (qsize == 0 || !q || cmp(p, q) <= 0) {
+					e = p;
+					p = p->next;
+					psize--;
+				} else {
+					e = q;
+					q = q->next;
+					qsize--;
+				}
+
+				if (tail) {
+					tail->next = e;
+				} else {
+					list = e;
+				}
+				tail = e;
+			}
+			p = q;
+		}
+		tail->next = NULL;
+
+		if (merges <= 1) {
+			return list;
+		}
+	}
+}
+
+static uint16_t bench_list(uint16_t seed, uint16_t crc)
+{
+	struct list_node *head = list_init(seed);
+	uint16_t found = 0, missed = 0;
+
+	for (int i = 0; i < LIST_FINDS; i++) {
+		/* Odd rounds look for a value that is (almost always) absent */
+		uint16_t want = list_pool[(i * 7) % LIST_NODES].data ^ (uint16_t)(i & 1);
+		struct list_node *n = list_find(head, want);
+
+		if (n) {
+			found++;
+			crc = crc16(n->idx, crc);
+		} else {
+			missed++;
+		}
+		head = list_reverse(head);
+	}
+
+	head = list_sort(head, cmp_data);
+	for (struct list_node *n = head; n; n = n->next) {
+		crc = crc16(n->data, crc);
+	}
+
+	head = list_sort(head, cmp_idx);
+	for (uint16_t i = 0; head; head = head->next, i++) {
+		/* Sorted back by index: any misordering changes the signature */
+		crc = crc16(head->idx ^ i, crc);
+	}
+
+	crc = crc16(found, crc);
+	return crc16(missed, crc);
+}
+
+/* Matrix */
+
+static int16_t mat_a[MAT_N * MAT_N];
+static int16_t mat_b[MAT_N * MAT_N];
+static int32_t mat_c[MAT_N * MAT_N];
+
+static uint16_t mat_sum(uint16_t crc)
+{
+	uint32_t acc = 0;
+
+	for (int i = 0; i < MAT_N * MAT_N; i++) {
+		acc = (acc << 1 | acc >> 31) ^ (uint32_t)mat_c[i];
+	}
+	return crc32(acc, crc);
+}
+
+static uint16_t bench_matrix(uint16_t seed, uint16_t crc)
+{
+	uint32_t x = seed;
+	int16_t val = (int16_t)(seed & 0x3f) + 1;
+
+	for (int i = 0; i < MAT_N * MAT_N; i++) {
+		mat_a[i] = (int16_t)(lcg(&x) & 0xff) - 128;
+		mat_b[i] = (int16_t)(lcg(&x) & 0xff) - 128;
+	}
+
+	for (int i = 0; i < MAT_N * MAT_N; i++) {
+		mat_a[i] += val;
+	}
+
+	for (int i = 0; i < MAT_N * MAT_N; i++) {
+		mat_c[i] = (int32_t)mat_a[i] * val;
+	}
+	crc = mat_sum(crc);
+
+	for (int i = 0; i < MAT_N; i++) {
+		for (int j = 0; j < MAT_N; j++) {
+			int32_t acc = 0;
+
+			for (int k = 0; k < MAT_N; k++) {
+				acc += (int32_t)mat_a[i * MAT_N + k] * mat_b[k * MAT_N + j];
+			}
+			mat_c[i * MAT_N + j] = acc;
+		}
+	}
+	crc = mat_sum(crc);
+
+	/* Multiply with bit extraction: bits 2..5 and 5..11 of each product */
+	for (int i = 0; i < MAT_N; i++) {
+		for (int j = 0; j < MAT_N; j++) {
+			int32_t acc = 0;
+
+			for (int k = 0; k < MAT_N; k++) {
+				uint32_t p = (uint32_t)((int32_t)mat_a[i * MAT_N + k] *
+							mat_b[k * MAT_N + j]);
+
+				acc += (int32_t)(((p >> 2) & 0xf) * ((p >> 5) & 0x7f));
+			}
+			mat_c[i * MAT_N + j] = acc;
+		}
+	}
+	crc = mat_sum(crc);
+
+	for (int i = 0; i < MAT_N * MAT_N; i++) {
+		mat_a[i] -= val;
+	}
+	return crc16((uint16_t)mat_a[MAT_N * MAT_N - 1], crc);
+}
+
+/* State machine */
+
+enum num_state {
+	ST_START,
+	ST_INVALID,
+	ST_SIGN,
+	ST_INT,
+	ST_FLOAT,
+	ST_EXP,
+	ST_EXP_SIGN,
+	ST_SCI,
+	ST_COUNT,
+};
+
+static const char *const state_tokens[] = {
+	"5012", "1234", "-874", "-102", "+122", "0.9", "-0.5", "+5.1",
+	"1.4e-5", "-3.3E+1", "T0.3e-1F", "-T.T++Tq", "1T3.4e4z", "34.0e-T^",
+};
+
+static uint8_t state_buf[STATE_LEN];
+
+static bool is_digit(uint8_t c)
+{
+	return c >= '0' && c <= '9';
+}
+
+/* Classify one comma-separated token; returns the final state and
+ * advances *p past the comma.
+ */
+static enum num_state scan_token(const uint8_t **p, const uint8_t *end, uint32_t *transitions)
+{
+	enum num_state st = ST_START;
+
+	for (; *p < end && **p != ','; (*p)++) {
+		uint8_t c = **p;
+		enum num_state next = ST_INVALID;
+
+		switch (st) {
+		case ST_START:
+			if (is_digit(c)) {
+				next = ST_INT;
+			} else if (c == '+' || c == '-') {
+				next = ST_SIGN;
+			} else if (c == '.') {
+				next = ST_FLOAT;
+			}
+			break;
+		case ST_SIGN:
+			if (is_digit(c)) {
+				next = ST_INT;
+			} else if (c == '.') {
+				next = ST_FLOAT;
+			}
+			break;
+		case ST_INT:
+			if (is_digit(c)) {
+				next = ST_INT;
+			} else if (c == '.') {
+				next = ST_FLOAT;
+			}
+			break;
+		case ST_FLOAT:
+			if (is_digit(c)) {
+				next = ST_FLOAT;
+			} else if (c == 'e' || c == 'E') {
+				next = ST_EXP;
+			}
+			break;
+		case ST_EXP:
+			if (is_digit(c)) {
+				next = ST_SCI;
+			} else if (c == '+' || c == '-') {
+				next = ST_EXP_SIGN;
+			}
+			break;
+		case ST_EXP_SIGN:
+		case ST_SCI:
+			if (is_digit(c)) {
+				next = ST_SCI;
+			}
+			break;
+		default:
+			break;
+		}
+
+		if (next != st) {
+			transitions[st]++;
+		}
+		st = next;
+	}
+
+	if (*p < end) {
+		(*p)++;
+	}
+	return st;
+}
+
+static uint16_t state_pass(uint16_t crc)
+{
+	uint32_t finals[ST_COUNT] = { 0 };
+	uint32_t transitions[ST_COUNT] = { 0 };
+	const uint8_t *p = state_buf;
+	const uint8_t *end = state_buf + STATE_LEN;
+
+	while (p < end) {
+		finals[scan_token(&p, end, transitions)]++;
+	}
+
+	for (int i = 0; i < ST_COUNT; i++) {
+		crc = crc32(finals[i], crc);
+		crc = crc32(transitions[i], crc);
+	}
+	return crc;
+}
+
+static uint16_t bench_state(uint16_t seed, uint16_t crc)
+{
+	uint32_t x = seed;
+	size_t pos = 0;
+
+	while (pos < STATE_LEN) {
+		const char *t = state_tokens[lcg(&x) % ARRAY_SIZE(state_tokens)];
+
+		while (*t && pos < STATE_LEN) {
+			state_buf[pos++] = (uint8_t)*t++;
+		}
+		if (pos < STATE_LEN) {
+			state_buf[pos++] = ',';
+		}
+	}
+
+	crc = state_pass(crc);
+
+	/* Corrupt every 7th byte, scan again, restore */
+	for (size_t i = 0; i < STATE_LEN; i += 7) {
+		state_buf[i] ^= (uint8_t)seed;
+	}
+	crc = state_pass(crc);
+	for (size_t i = 0; i < STATE_LEN; i += 7) {
+		state_buf[i] ^= (uint8_t)seed;
+	}
+	return state_pass(crc);
+}
+
+uint16_t corebench_iteration(void)
+{
+	uint16_t crc = 0;
+
+	crc = bench_list(seed_list, crc);
+	crc = bench_matrix(seed_matrix, crc);
+	return bench_state(seed_state, crc);
+}
+
+static inline uint64_t now_us(void)
+{
+	return k_ticks_to_us_floor64(k_uptime_ticks());
+}
+
+void corebench_batch(uint32_t n, struct corebench_stats *acc)
+{
+	uint64_t start = now_us();
+
+	if (acc->iters == 0) {
+		acc->ok = true;
+	}
+
+	for (uint32_t i = 0; i < n; i++) {
+		acc->crc = corebench_iteration();
+		if (acc->crc != COREBENCH_CRC) {
+			acc->ok = false;
+		}
+	}
+
+	acc->us += now_us() - start;
+	acc->iters += n;
+}
+
+int corebench_run(const char *core, uint32_t mhz, uint32_t ms, struct corebench_stats *out)
+{
+	struct corebench_stats s = { 0 };
+	uint64_t window_us = (uint64_t)ms * 1000;
+
+	/* Batches of 8 keep the timer reads out of the measurement */
+	while (s.us < window_us) {
+		corebench_batch(8, &s);
+	}
+
+	corebench_print(core, mhz, &s);
+	if (out) {
+		*out = s;
+	}
+	return s.ok ? 0 : -EIO;
+}
+
+void corebench_print(const char *core, uint32_t mhz, const struct corebench_stats *s)
+{
+	uint64_t us = s->us ? s->us : 1;
+	/* iterations per second, x100 */
+	uint32_t ips_x100 = (uint32_t)((uint64_t)s->iters * 100000000 / us);
+	/* iterations per second per MHz, x1000 */
+	uint32_t ipm_x1000 = mhz ? (uint32_t)((uint64_t)s->iters * 1000000000 / us / mhz) : 0;
+
+	printk("COREBENCH core=%s mhz=%u iters=%u ms=%u: %u.%02u it/s, "
+	       "%u.%03u it/s/MHz, crc=0x%04x %s\n",
+	       core, mhz, s->iters, (uint32_t)(s->us / 1000),
+	       ips_x100 / 100, ips_x100 % 100, ipm_x1000 / 1000, ipm_x1000 % 1000,
+	       s->crc, s->ok ? "ok" : "BAD");
+}
@@ -0,0 +1,56 @@
+/*
+ * CoreMark-class compute benchmark, portable across the nRF54L15 M33,
+ * the FLPR (RV32E), the Alif M55 and QEMU.
+ *
+ * One iteration runs four kernels over about 3 KiB of static data:
+ *
+ *   list    build a 64-node linked list, find/reverse, merge-sort it by
+ *           value and back by index
+ *   matrix  16x16 int16 matrix: add and scale by a constant, multiply
+ *           by a second matrix, multiply with bit extraction
+ *   state   a number-format state machine over a 256-byte token buffer,
+ *           clean and then with every 7th byte corrupted
+ *   crc     CRC-16 folding every kernel's output into one signature
+ *
+ * The seeds are volatile, so no compiler can fold an iteration to a
+ * constant. Every iteration produces the same signature, which is
+ * checked against COREBENCH_CRC. A wrong answer from a miscompile or a
+ * broken core is reported rather than timed.
+ *
+ * Timing uses the kernel uptime, and an iteration takes well under a
+ * millisecond, so results come from a multi-second window (or from
+ * batches accumulated to one) rather than from single iterations. The
+ * FLPR's 1 MHz timer is then precise enough.
+ */
+
+#ifndef COMMON_COREBENCH_H_
+#define COMMON_COREBENCH_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Signature of one iteration with the default seeds */
+#define COREBENCH_CRC 0x66fe
+
+struct corebench_stats {
+	uint32_t iters;
+	uint64_t us;
+	uint16_t crc;        /* signature of the last iteration */
+	bool ok;             /* every iteration matched COREBENCH_CRC */
+};
+
+/* One iteration; returns its signature. */
+uint16_t corebench_iteration(void);
+
+/* Run n iterations and add them to acc (zero it first). */
+void corebench_batch(uint32_t n, struct corebench_stats *acc);
+
+/* Run iterations for ms, print a COREBENCH line and return 0, or -EIO
+ * on a signature mismatch.
+ */
+int corebench_run(const char *core, uint32_t mhz, uint32_t ms, struct corebench_stats *out);
+
+/* COREBENCH core=<core> mhz=<mhz> iters=<n> ms=<n>: <it/s> it/s, <it/s/MHz> it/s/MHz, crc=0x<crc> <ok|BAD> */
+void corebench_print(const char *core, uint32_t mhz, const struct corebench_stats *s);
+
+#endif /* COMMON_COREBENCH_H_ */
@@ -0,0 +1,295 @@
+/*
+ * Load-driven clock scaling
+ *
+ * The clock is switched through OSCILLATORS.PLL.FREQ, the 64/128 MHz
+ * selector the nRF54L15 exposes for the application core. On targets
+ * without it (e.g. simulators) the policy still runs and the counters
+ * still split by operating point, but the clock does not change; a
+ * one-time message says so.
+ *
+ * Runtime stats are kept in system clock cycles (GRTC), so the busy
+ * share is unaffected by the CPU clock it is measured at.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/spinlock.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
+#include <string.h>
+
+#if defined(CONFIG_SOC_SERIES_NRF54LX)
+#include <hal/nrf_oscillators.h>
+#endif
+
+#include "dvfs.h"
+
+BUILD_ASSERT(CONFIG_DVFS_DOWN_PCT < CONFIG_DVFS_UP_PCT,
+	     "DVFS_DOWN_PCT must be below DVFS_UP_PCT");
+
+enum sweep_mode {
+	SWEEP_FIXED_64,
+	SWEEP_FIXED_128,
+	SWEEP_POLICY,
+	SWEEP_MODES,
+};
+
+static const char *const sweep_names[SWEEP_MODES] = {
+	"fixed64", "fixed128", "policy",
+};
+
+static struct k_spinlock lock;
+static struct dvfs_op_stats op_stats[DVFS_OPS];
+static uint32_t cur_mhz = DVFS_MHZ_HIGH;
+static uint32_t pinned_mhz;
+static uint32_t local_pct;
+static uint32_t remote_pct;
+static bool pressure;
+static dvfs_switch_cb_t switch_cb;
+
+static uint32_t down_count;
+static int64_t high_since;
+static int64_t last_ms;
+static uint64_t prev_exec;
+static uint64_t prev_busy;
+
+/* Energy sweep */
+static enum sweep_mode sweep_mode;
+static int64_t sweep_start;
+static uint32_t sweep_phase;
+static uint64_t load_sum_local;
+static uint64_t load_sum_remote;
+static uint32_t load_samples;
+
+static void dvfs_tick(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(tick_work, dvfs_tick);
+
+static inline enum dvfs_op op_of(uint32_t mhz)
+{
+	return (mhz == DVFS_MHZ_LOW) ? DVFS_OP_64M : DVFS_OP_128M;
+}
+
+static int clock_set(uint32_t mhz)
+{
+#if defined(CONFIG_SOC_SERIES_NRF54LX)
+	nrf_oscillators_pll_freq_set(NRF_OSCILLATORS,
+				     (mhz == DVFS_MHZ_LOW) ? NRF_OSCILLATORS_PLL_FREQ_64M
+							   : NRF_OSCILLATORS_PLL_FREQ_128M);
+	SystemCoreClockUpdate();
+	return 0;
+#else
+	ARG_UNUSED(mhz);
+	return -ENOTSUP;
+#endif
+}
+
+static void switch_to(uint32_t mhz, const char *why)
+{
+	static bool warned;
+	uint32_t from = cur_mhz;
+	k_spinlock_key_t key;
+
+	if (mhz == from) {
+		return;
+	}
+
+	if (clock_set(mhz) < 0 && !warned) {
+		printk("DVFS: no clock control on this target, tracking only\n");
+		warned = true;
+	}
+
+	key = k_spin_lock(&lock);
+	cur_mhz = mhz;
+	op_stats[op_of(mhz)].entries++;
+	k_spin_unlock(&lock, key);
+
+	down_count = 0;
+	if (mhz == DVFS_MHZ_HIGH) {
+		high_since = k_uptime_get();
+	}
+
+	printk("DVFS: %u -> %u MHz (%s, m33 %u%%, remote %u%%)\n",
+	       from, mhz, why, local_pct, remote_pct);
+
+	if (switch_cb) {
+		switch_cb(mhz);
+	}
+}
+
+static void policy(uint32_t load, bool pressed, int64_t now)
+{
+	if (cur_mhz == DVFS_MHZ_LOW) {
+		if (pressed) {
+			switch_to(DVFS_MHZ_HIGH, "pressure");
+		} else if (load > CONFIG_DVFS_UP_PCT) {
+			switch_to(DVFS_MHZ_HIGH, "load");
+		}
+		return;
+	}
+
+	/* At 128 MHz: would the same work fit at 64? */
+	if (pressed || load * 2 >= CONFIG_DVFS_DOWN_PCT) {
+		down_count = 0;
+		return;
+	}
+	if (++down_count >= CONFIG_DVFS_DOWN_HOLD &&
+	    now - high_since >= CONFIG_DVFS_MIN_HIGH_MS) {
+		switch_to(DVFS_MHZ_LOW, "idle");
+	}
+}
+
+static void sweep_begin(enum sweep_mode mode, int64_t now)
+{
+	k_spinlock_key_t key;
+
+	sweep_mode = mode;
+	sweep_start = now;
+	pinned_mhz = (mode == SWEEP_FIXED_64) ? DVFS_MHZ_LOW :
+		     (mode == SWEEP_FIXED_128) ? DVFS_MHZ_HIGH : 0;
+	switch_to(pinned_mhz ? pinned_mhz : DVFS_MHZ_HIGH, "sweep");
+
+	/* The phase's own switch is not counted */
+	key = k_spin_lock(&lock);
+	memset(op_stats, 0, sizeof(op_stats));
+	load_sum_local = 0;
+	load_sum_remote = 0;
+	load_samples = 0;
+	k_spin_unlock(&lock, key);
+
+	printk("DVFS_PHASE %u mode=%s\n", sweep_phase, sweep_names[mode]);
+}
+
+static void sweep_end(void)
+{
+	const struct dvfs_op_stats *lo = &op_stats[DVFS_OP_64M];
+	const struct dvfs_op_stats *hi = &op_stats[DVFS_OP_128M];
+	uint32_t n = MAX(load_samples, 1U);
+
+	printk("DVFS_SUM %u mode=%s ms=%u t64=%u t128=%u frames=%u bytes=%u "
+	       "misses=%u switches=%u m33=%u remote=%u\n",
+	       sweep_phase, sweep_names[sweep_mode], lo->ms + hi->ms, lo->ms, hi->ms,
+	       lo->frames + hi->frames, lo->bytes + hi->bytes,
+	       lo->misses + hi->misses, lo->entries + hi->entries,
+	       (uint32_t)(load_sum_local / n), (uint32_t)(load_sum_remote / n));
+	sweep_phase++;
+}
+
+static void dvfs_tick(struct k_work *work)
+{
+	k_thread_runtime_stats_t rt;
+	int64_t now = k_uptime_get();
+	k_spinlock_key_t key;
+	uint64_t exec, busy;
+	bool pressed;
+
+	ARG_UNUSED(work);
+
+	k_thread_runtime_stats_all_get(&rt);
+	exec = rt.execution_cycles - prev_exec;
+	busy = rt.total_cycles - prev_busy;
+	prev_exec = rt.execution_cycles;
+	prev_busy = rt.total_cycles;
+
+	key = k_spin_lock(&lock);
+	local_pct = exec ? (uint32_t)((busy * 100U) / exec) : 0;
+	op_stats[op_of(cur_mhz)].ms += (uint32_t)(now - last_ms);
+	last_ms = now;
+	load_sum_local += local_pct;
+	load_sum_remote += remote_pct;
+	load_samples++;
+	pressed = pressure;
+	pressure = false;
+	k_spin_unlock(&lock, key);
+
+	if (CONFIG_DVFS_SWEEP_S > 0 &&
+	    now - sweep_start >= (int64_t)CONFIG_DVFS_SWEEP_S * MSEC_PER_SEC) {
+		sweep_end();
+		sweep_begin((sweep_mode + 1) % SWEEP_MODES, now);
+	} else if (pinned_mhz == 0) {
+		policy(MAX(local_pct, remote_pct), pressed, now);
+	}
+
+	k_work_reschedule(&tick_work, K_MSEC(CONFIG_DVFS_PERIOD_MS));
+}
+
+int dvfs_init(dvfs_switch_cb_t cb)
+{
+	k_thread_runtime_stats_t rt;
+
+	switch_cb = cb;
+	k_thread_runtime_stats_all_get(&rt);
+	prev_exec = rt.execution_cycles;
+	prev_busy = rt.total_cycles;
+	last_ms = k_uptime_get();
+	high_since = last_ms;
+
+	printk("DVFS: policy up >%u%% @64, down <%u%% projected @64 x%u periods of %u ms\n",
+	       CONFIG_DVFS_UP_PCT, CONFIG_DVFS_DOWN_PCT, CONFIG_DVFS_DOWN_HOLD,
+	       CONFIG_DVFS_PERIOD_MS);
+
+	if (CONFIG_DVFS_SWEEP_S > 0) {
+		sweep_begin(SWEEP_FIXED_64, last_ms);
+	}
+
+	k_work_schedule(&tick_work, K_MSEC(CONFIG_DVFS_PERIOD_MS));
+	return 0;
+}
+
+int dvfs_pin(uint32_t mhz)
+{
+	if (mhz != 0 && mhz != DVFS_MHZ_LOW && mhz != DVFS_MHZ_HIGH) {
+		return -EINVAL;
+	}
+
+	pinned_mhz = mhz;
+	if (mhz != 0) {
+		switch_to(mhz, "pinned");
+	}
+	return 0;
+}
+
+uint32_t dvfs_freq_mhz(void)
+{
+	return cur_mhz;
+}
+
+uint32_t dvfs_local_load_pct(void)
+{
+	return local_pct;
+}
+
+uint32_t dvfs_remote_load_pct(void)
+{
+	return remote_pct;
+}
+
+void dvfs_set_remote_load(uint32_t pct)
+{
+	remote_pct = MIN(pct, 100U);
+}
+
+void dvfs_pressure(void)
+{
+	pressure = true;
+}
+
+void dvfs_account(uint32_t frames, uint32_t bytes, uint32_t misses)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+	struct dvfs_op_stats *s = &op_stats[op_of(cur_mhz)];
+
+	s->frames += frames;
+	s->bytes += bytes;
+	s->misses += misses;
+	if (misses > 0) {
+		pressure = true;
+	}
+	k_spin_unlock(&lock, key);
+}
+
+void dvfs_get_stats(enum dvfs_op op, struct dvfs_op_stats *out)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	*out = op_stats[op];
+	k_spin_unlock(&lock, key);
+}
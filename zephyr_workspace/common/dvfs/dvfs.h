@@ -0,0 +1,96 @@
+/*
+ * Load-driven clock scaling for the nRF54L15 (64 / 128 MHz).
+ *
+ * Every CONFIG_DVFS_PERIOD_MS a work item reads this core's busy share
+ * from the idle-thread accounting (k_thread_runtime_stats_all_get())
+ * and takes the larger of it and the remote core's load reported with
+ * dvfs_set_remote_load(). Both are busy shares at the current clock.
+ *
+ *   64 -> 128   at once when the load exceeds CONFIG_DVFS_UP_PCT, or
+ *               when the app reported pressure (a missed frame
+ *               deadline, a full TX queue) with dvfs_pressure().
+ *   128 -> 64   when twice the load (its projection onto 64 MHz) stays
+ *               under CONFIG_DVFS_DOWN_PCT for CONFIG_DVFS_DOWN_HOLD
+ *               periods in a row, no pressure was reported, and at
+ *               least CONFIG_DVFS_MIN_HIGH_MS have passed since the
+ *               last switch up.
+ *
+ * Residency, frames, bytes and deadline misses are kept per operating
+ * point so energy per frame / per byte can be computed against a power
+ * capture (CONFIG_DVFS_SWEEP_S, power_comparison/dvfs_energy.py).
+ *
+ * Without CONFIG_DVFS the calls below compile to nothing and
+ * dvfs_freq_mhz() reports the fixed 128 MHz.
+ */
+
+#ifndef COMMON_DVFS_H_
+#define COMMON_DVFS_H_
+
+#include <errno.h>
+#include <stdint.h>
+
+#define DVFS_MHZ_LOW  64
+#define DVFS_MHZ_HIGH 128
+
+enum dvfs_op {
+	DVFS_OP_64M,
+	DVFS_OP_128M,
+	DVFS_OPS,
+};
+
+struct dvfs_op_stats {
+	uint32_t ms;          /* residency */
+	uint32_t frames;
+	uint32_t bytes;
+	uint32_t misses;      /* frame deadlines missed */
+	uint32_t entries;     /* switches into this point */
+};
+
+/* Called from the system workqueue after every switch, e.g. to tell
+ * the other core which clock it now runs at.
+ */
+typedef void (*dvfs_switch_cb_t)(uint32_t mhz);
+
+#if defined(CONFIG_DVFS)
+
+/* Start the policy at 128 MHz. */
+int dvfs_init(dvfs_switch_cb_t cb);
+
+/* Pin the clock to DVFS_MHZ_LOW / DVFS_MHZ_HIGH, or 0 for the policy. */
+int dvfs_pin(uint32_t mhz);
+
+uint32_t dvfs_freq_mhz(void);
+
+/* Busy share (%) over the last period, at the clock it ran at. */
+uint32_t dvfs_local_load_pct(void);
+uint32_t dvfs_remote_load_pct(void);
+
+void dvfs_set_remote_load(uint32_t pct);
+
+/* Switch up at the next period regardless of load. ISR safe. */
+void dvfs_pressure(void);
+
+/* Attribute work to the current operating point; misses > 0 also
+ * counts as pressure. ISR safe.
+ */
+void dvfs_account(uint32_t frames, uint32_t bytes, uint32_t misses);
+
+void dvfs_get_stats(enum dvfs_op op, struct dvfs_op_stats *out);
+
+#else
+
+static inline int dvfs_init(dvfs_switch_cb_t cb) { (void)cb; return 0; }
+static inline int dvfs_pin(uint32_t mhz) { (void)mhz; return -ENOTSUP; }
+static inline uint32_t dvfs_freq_mhz(void) { return DVFS_MHZ_HIGH; }
+static inline uint32_t dvfs_local_load_pct(void) { return 0; }
+static inline uint32_t dvfs_remote_load_pct(void) { return 0; }
+static inline void dvfs_set_remote_load(uint32_t pct) { (void)pct; }
+static inline void dvfs_pressure(void) { }
+static inline void dvfs_account(uint32_t frames, uint32_t bytes, uint32_t misses)
+{
+	(void)frames; (void)bytes; (void)misses;
+}
+
+#endif /* CONFIG_DVFS */
+
+#endif /* COMMON_DVFS_H_ */
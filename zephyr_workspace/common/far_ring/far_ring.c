@@ -0,0 +1,141 @@
+/*
+ * Far-end audio ring (see far_ring.h)
+ */
+
+#include "far_ring.h"
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/sys/barrier.h>
+
+void far_ring_init(struct far_ring *r)
+{
+	r->magic = 0;
+	barrier_dmem_fence_full();
+	r->head = 0;
+	r->tail = 0;
+	barrier_dmem_fence_full();
+	r->magic = FAR_RING_MAGIC;
+}
+
+int far_ring_push(struct far_ring *r, uint32_t seq, uint32_t play_us, const int16_t *pcm)
+{
+	uint32_t head = r->head;
+	struct far_ring_frame *f;
+
+	if (head - r->tail >= FAR_RING_SLOTS) {
+		return -ENOSPC;
+	}
+
+	f = &r->slot[head & (FAR_RING_SLOTS - 1)];
+	f->seq = seq;
+	f->play_us = play_us;
+	memcpy(f->pcm, pcm, sizeof(f->pcm));
+
+	/* Slot contents land before the index that hands them over */
+	barrier_dmem_fence_full();
+	r->head = head + 1;
+	return 0;
+}
+
+static bool far_ring_pop(struct far_ring *r, struct far_ring_frame *f)
+{
+	uint32_t tail;
+
+	if (r->magic != FAR_RING_MAGIC) {
+		return false;
+	}
+
+	tail = r->tail;
+	if (tail == r->head) {
+		return false;
+	}
+
+	barrier_dmem_fence_full();
+	memcpy(f, &r->slot[tail & (FAR_RING_SLOTS - 1)], sizeof(*f));
+	barrier_dmem_fence_full();
+	r->tail = tail + 1;
+	return true;
+}
+
+/* Time from a to b in us, across counter wrap */
+static inline int32_t us_diff(uint32_t b, uint32_t a)
+{
+	return (int32_t)(b - a);
+}
+
+/* Index of the sample played nearest to off_us after pcm[0], rounded
+ * down on a tie; negative when that is before the frame.
+ */
+static int32_t nearest_sample(int32_t off_us)
+{
+	int64_t num = (int64_t)off_us * FAR_RING_RATE_HZ + 500000;
+	int64_t q = num / 1000000;
+
+	if (num % 1000000 < 0) {
+		q--;
+	}
+	return (int32_t)q;
+}
+
+void far_ring_fetch(struct far_ring *r, struct far_ring_cursor *c, uint32_t t_us,
+		    int16_t *out, struct far_ring_align *align)
+{
+	uint32_t end_us = t_us + FAR_RING_FRAME_US;
+	int32_t lo[2], hi[2];
+	int32_t covered = 0;
+	int32_t worst_ns = 0;
+
+	/* Drop cached frames that finished playing before t */
+	while (c->n > 0 && us_diff(c->f[0].play_us + FAR_RING_FRAME_US, t_us) <= 0) {
+		c->f[0] = c->f[1];
+		c->n--;
+	}
+
+	/* Pull frames until the cache reaches the end of the window */
+	while (c->n < 2 &&
+	       !(c->n > 0 && us_diff(c->f[c->n - 1].play_us + FAR_RING_FRAME_US, end_us) >= 0)) {
+		struct far_ring_frame *f = &c->f[c->n];
+
+		if (!far_ring_pop(r, f)) {
+			break;
+		}
+		c->frames++;
+		if (us_diff(f->play_us + FAR_RING_FRAME_US, t_us) <= 0) {
+			c->stale++;
+			continue;
+		}
+		c->n++;
+	}
+
+	memset(out, 0, FAR_RING_FRAME * sizeof(out[0]));
+
+	for (int k = 0; k < c->n; k++) {
+		const struct far_ring_frame *f = &c->f[k];
+		int32_t off_us = us_diff(t_us, f->play_us);
+		int32_t s0 = nearest_sample(off_us);
+		int32_t err_ns = (int32_t)((int64_t)off_us * 1000 -
+					   (int64_t)s0 * 1000000000 / FAR_RING_RATE_HZ);
+
+		/* out[j] = pcm[s0 + j] where that exists */
+		lo[k] = MAX(0, -s0);
+		hi[k] = MIN(FAR_RING_FRAME, FAR_RING_FRAME - s0);
+		if (lo[k] >= hi[k]) {
+			continue;
+		}
+		memcpy(&out[lo[k]], &f->pcm[s0 + lo[k]], (hi[k] - lo[k]) * sizeof(out[0]));
+		covered += hi[k] - lo[k];
+		if ((err_ns < 0 ? -err_ns : err_ns) > (worst_ns < 0 ? -worst_ns : worst_ns)) {
+			worst_ns = err_ns;
+		}
+	}
+
+	/* Two frames overlap only after the producer re-anchored */
+	if (c->n == 2 && lo[0] < hi[0] && lo[1] < hi[1]) {
+		covered -= MAX(0, MIN(hi[0], hi[1]) - MAX(lo[0], lo[1]));
+	}
+
+	c->gap_samples += FAR_RING_FRAME - covered;
+	align->covered = covered;
+	align->err_ns = worst_ns;
+}
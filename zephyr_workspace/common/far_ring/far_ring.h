@@ -0,0 +1,111 @@
+/*
+ * Far-end audio ring: downlink frames from the M33 to the FLPR echo
+ * canceller through shared SRAM.
+ *
+ * One producer (the M33, from the GATT write handler) and one consumer
+ * (the FLPR audio workload). Each slot holds one frame of PCM and the
+ * time its first sample is played, on the GRTC system counter both
+ * cores read. The consumer asks for the frame of reference that lines
+ * up with a mic frame by time, not by count, so a lost or late BLE
+ * packet leaves a gap instead of shifting everything after it.
+ *
+ * Neither core caches SRAM data. The head and tail words sit in
+ * separate 32-byte lines and each is written by one side only; a full
+ * barrier orders the slot contents against the index that publishes
+ * them.
+ */
+
+#ifndef COMMON_FAR_RING_H_
+#define COMMON_FAR_RING_H_
+
+#include <stdint.h>
+#include <zephyr/kernel.h>
+
+#if defined(CONFIG_NRF_GRTC_TIMER)
+#include <zephyr/drivers/timer/nrf_grtc_timer.h>
+#endif
+
+#define FAR_RING_FRAME 128  /* samples per frame, 16 ms at 8 kHz */
+
+#if defined(CONFIG_FAR_RING_SLOTS)
+#define FAR_RING_SLOTS CONFIG_FAR_RING_SLOTS
+#else
+#define FAR_RING_SLOTS 8
+#endif
+
+#if defined(CONFIG_FAR_RING_RATE_HZ)
+#define FAR_RING_RATE_HZ CONFIG_FAR_RING_RATE_HZ
+#else
+#define FAR_RING_RATE_HZ 8000
+#endif
+
+#if (FAR_RING_SLOTS & (FAR_RING_SLOTS - 1)) != 0
+#error "FAR_RING_SLOTS must be a power of two"
+#endif
+
+#define FAR_RING_FRAME_US ((uint32_t)(1000000ull * FAR_RING_FRAME / FAR_RING_RATE_HZ))
+#define FAR_RING_MAGIC    0x46415245u  /* "FARE" */
+
+struct far_ring_frame {
+	uint32_t seq;      /* sender's frame number */
+	uint32_t play_us;  /* shared-clock time of pcm[0] */
+	int16_t pcm[FAR_RING_FRAME];
+};
+
+struct far_ring {
+	volatile uint32_t magic;
+	volatile uint32_t head;   /* written by the producer only */
+	uint32_t pad0[6];
+	volatile uint32_t tail;   /* written by the consumer only */
+	uint32_t pad1[7];
+	struct far_ring_frame slot[FAR_RING_SLOTS];
+};
+
+/* Consumer state: the two frames the current reference can straddle,
+ * copied out of shared SRAM, plus running counters.
+ */
+struct far_ring_cursor {
+	struct far_ring_frame f[2];
+	uint8_t n;
+	uint32_t frames;       /* frames taken from the ring */
+	uint32_t stale;        /* frames that ended before they were wanted */
+	uint32_t gap_samples;  /* reference samples zero-filled */
+};
+
+/* Alignment of one fetch */
+struct far_ring_align {
+	int32_t err_ns;    /* wanted time - play time of the sample used */
+	uint16_t covered;  /* samples taken from far-end frames */
+};
+
+/* Shared clock in microseconds. Both cores run their system timer off
+ * the GRTC, so the raw counter is common to them; k_uptime is not, as
+ * each kernel starts it at its own boot, and stamping against it would
+ * make the alignment meaningless. There is deliberately no fallback:
+ * without the GRTC this is not defined, and images that stamp frames
+ * assert CONFIG_NRF_GRTC_TIMER. The ring itself (push/fetch) takes
+ * caller-supplied times and builds anywhere.
+ */
+#if defined(CONFIG_NRF_GRTC_TIMER)
+static inline uint32_t far_ring_now_us(void)
+{
+	return (uint32_t)z_nrf_grtc_timer_read();
+}
+#endif
+
+/* Producer: empty the ring and mark it valid. Call before the first push. */
+void far_ring_init(struct far_ring *r);
+
+/* Producer: queue one frame. -ENOSPC if the consumer is a full ring
+ * behind; the frame is dropped.
+ */
+int far_ring_push(struct far_ring *r, uint32_t seq, uint32_t play_us, const int16_t *pcm);
+
+/* Consumer: fill out[0..FAR_RING_FRAME) with the far-end samples played
+ * from t_us on. Samples nobody sent, or that arrived too late, are
+ * zero. A ring that was never initialised reads as empty.
+ */
+void far_ring_fetch(struct far_ring *r, struct far_ring_cursor *c, uint32_t t_us,
+		    int16_t *out, struct far_ring_align *align);
+
+#endif /* COMMON_FAR_RING_H_ */
@@ -0,0 +1,79 @@
+/*
+ * PSE84 M33 <-> M55 doorbell (see ipc_bell.h).
+ */
+
+#include <zephyr/init.h>
+#include <zephyr/irq.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+#include "cy_ipc_drv.h"
+
+#include "ipc_bell.h"
+
+/* This core listens on its own interrupt structure and rings the
+ * other's. Both images are built with the same two numbers.
+ */
+#if defined(CONFIG_CPU_CORTEX_M55)
+#define RX_INTR CONFIG_IPC_BELL_M55_INTR
+#define TX_INTR CONFIG_IPC_BELL_M33_INTR
+#define RX_IRQN UTIL_CAT(UTIL_CAT(m55appcpuss_interrupts_ipc_dpslp_, RX_INTR), _IRQn)
+#else
+#define RX_INTR CONFIG_IPC_BELL_M33_INTR
+#define TX_INTR CONFIG_IPC_BELL_M55_INTR
+#define RX_IRQN UTIL_CAT(UTIL_CAT(m33syscpuss_interrupts_ipc_dpslp_, RX_INTR), _IRQn)
+#endif
+
+#if CONFIG_IPC_BELL_IRQ >= 0
+#define BELL_IRQ CONFIG_IPC_BELL_IRQ
+#else
+#define BELL_IRQ RX_IRQN
+#endif
+
+volatile uint32_t *ipc_bell_notify;
+uint32_t ipc_bell_peer_mask;
+
+static K_SEM_DEFINE(bell, 0, 1);
+static uint32_t rings;
+
+static void bell_isr(const void *arg)
+{
+	IPC_INTR_STRUCT_Type *intr = Cy_IPC_Drv_GetIntrBaseAddr(RX_INTR);
+	uint32_t status = Cy_IPC_Drv_GetInterruptStatusMasked(intr);
+
+	ARG_UNUSED(arg);
+
+	Cy_IPC_Drv_ClearInterrupt(intr, CY_IPC_NO_NOTIFICATION,
+				  Cy_IPC_Drv_ExtractAcquireMask(status));
+	rings++;
+	k_sem_give(&bell);
+}
+
+int ipc_bell_wait(k_timeout_t timeout)
+{
+	return k_sem_take(&bell, timeout);
+}
+
+uint32_t ipc_bell_count(void)
+{
+	return rings;
+}
+
+static int ipc_bell_init(void)
+{
+	IPC_STRUCT_Type *chan = Cy_IPC_Drv_GetIpcBaseAddress(CONFIG_IPC_BELL_CHANNEL);
+	IPC_INTR_STRUCT_Type *intr = Cy_IPC_Drv_GetIntrBaseAddr(RX_INTR);
+
+	/* Notify events name the channel that rang, not the ringer */
+	Cy_IPC_Drv_ClearInterrupt(intr, CY_IPC_NO_NOTIFICATION, BIT(CONFIG_IPC_BELL_CHANNEL));
+	Cy_IPC_Drv_SetInterruptMask(intr, CY_IPC_NO_NOTIFICATION, BIT(CONFIG_IPC_BELL_CHANNEL));
+
+	IRQ_CONNECT(BELL_IRQ, CONFIG_IPC_BELL_IRQ_PRIO, bell_isr, NULL, 0);
+	irq_enable(BELL_IRQ);
+
+	ipc_bell_peer_mask = BIT(TX_INTR);
+	ipc_bell_notify = &chan->NOTIFY;
+	return 0;
+}
+
+SYS_INIT(ipc_bell_init, POST_KERNEL, CONFIG_APPLICATION_INIT_PRIORITY);
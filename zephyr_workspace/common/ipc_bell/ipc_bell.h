@@ -0,0 +1,69 @@
+/*
+ * PSE84 M33 <-> M55 doorbell on an IPC interrupt structure.
+ *
+ * There is no Zephyr mbox driver for the PSE84 IPC block in this tree,
+ * so this drives it through the PDL: ringing writes the NOTIFY register
+ * of IPC channel CONFIG_IPC_BELL_CHANNEL with the peer's interrupt
+ * structure as target, and the peer's ISR gives a semaphore that its
+ * threads wait on. The channel is never locked; only its notify path
+ * is used, so no data goes through it. The data stays in whatever
+ * shared block the caller already has.
+ *
+ * One bell per image: every ring from the peer wakes ipc_bell_wait().
+ * A waiter re-checks its shared state on each wake, and waits with a
+ * timeout so a missed or unconfigured bell degrades to polling.
+ *
+ * ipc_bell_ring() is a single store to a register address worked out
+ * at boot, so it is safe from a __ramfunc while SMIF0 is out of XIP
+ * mode.
+ */
+
+#ifndef COMMON_IPC_BELL_H_
+#define COMMON_IPC_BELL_H_
+
+#include <errno.h>
+#include <stdint.h>
+#include <zephyr/kernel.h>
+#include <zephyr/toolchain.h>
+
+#if defined(CONFIG_IPC_BELL)
+
+/* NOTIFY register of the bell channel and the peer's structure bit;
+ * set up by ipc_bell.c at boot
+ */
+extern volatile uint32_t *ipc_bell_notify;
+extern uint32_t ipc_bell_peer_mask;
+
+static ALWAYS_INLINE void ipc_bell_ring(void)
+{
+	if (ipc_bell_notify != NULL) {
+		*ipc_bell_notify = ipc_bell_peer_mask;
+	}
+}
+
+/* Wait for a ring from the peer. 0 if rung, -EAGAIN on timeout. */
+int ipc_bell_wait(k_timeout_t timeout);
+
+/* Rings received since boot */
+uint32_t ipc_bell_count(void);
+
+#else
+
+static inline void ipc_bell_ring(void)
+{
+}
+
+static inline int ipc_bell_wait(k_timeout_t timeout)
+{
+	k_sleep(timeout);
+	return -EAGAIN;
+}
+
+static inline uint32_t ipc_bell_count(void)
+{
+	return 0;
+}
+
+#endif /* CONFIG_IPC_BELL */
+
+#endif /* COMMON_IPC_BELL_H_ */
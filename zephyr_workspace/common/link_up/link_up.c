@@ -0,0 +1,489 @@
+/*
+ * Event-driven BLE link bring-up (see link_up.h).
+ *
+ * Bluetooth callbacks only record results and submit step_work; every
+ * procedure is issued from step_work on the system workqueue, which
+ * holds its own reference to the connection for the duration, so a
+ * disconnect in the RX thread cannot pull it away mid-call.
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/bluetooth/gatt.h>
+#include <zephyr/kernel.h>
+#include <zephyr/spinlock.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/printk.h>
+
+#include "link_up.h"
+
+/* issue() result: target already in place, nothing sent */
+#define ALREADY 1
+
+static const struct link_up_cfg *cfg;
+static struct bt_conn *link;
+static struct k_spinlock lock;
+
+static uint32_t t_conn;
+static atomic_t started;
+static atomic_t finished;
+static atomic_t failed;
+static atomic_t skipped;
+static atomic_t reported;
+static uint32_t start_us[LINK_UP_PHASES];
+static uint32_t done_us[LINK_UP_PHASES];
+static int result[LINK_UP_PHASES];
+static uint32_t first_us;
+
+static struct link_up_stats stats;
+
+static struct k_work step_work;
+static struct k_work report_work;
+static struct k_work_delayable timeout_work;
+
+static const char *const phase_name[LINK_UP_PHASES] = {
+	[LINK_UP_DLE] = "dle",   [LINK_UP_PHY] = "phy",       [LINK_UP_MTU] = "mtu",
+	[LINK_UP_CI] = "ci",     [LINK_UP_DISCOVER] = "disc", [LINK_UP_OPEN] = "open",
+};
+
+static uint32_t since_conn_us(void)
+{
+	return k_cyc_to_us_floor32(k_cycle_get_32() - t_conn);
+}
+
+static struct bt_conn *link_get(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+	struct bt_conn *conn = link != NULL ? bt_conn_ref(link) : NULL;
+
+	k_spin_unlock(&lock, key);
+	return conn;
+}
+
+static bool is_link(struct bt_conn *conn)
+{
+	return cfg != NULL && conn == link;
+}
+
+static void finish(enum link_up_phase p, int err)
+{
+	if (link == NULL || !(cfg->steps & LINK_UP_STEP(p)) ||
+	    atomic_test_and_set_bit(&finished, p)) {
+		return;
+	}
+	done_us[p] = since_conn_us();
+	result[p] = err;
+	if (err != 0) {
+		atomic_set_bit(&failed, p);
+	}
+	if (cfg->phase_done != NULL) {
+		cfg->phase_done(p, err);
+	}
+	k_work_submit(&step_work);
+}
+
+/* ---- Procedures ---- */
+
+static void mtu_exchange_cb(struct bt_conn *conn, uint8_t err,
+			    struct bt_gatt_exchange_params *params)
+{
+	if (is_link(conn)) {
+		finish(LINK_UP_MTU, err ? -EIO : 0);
+	}
+}
+
+static int issue(enum link_up_phase p, struct bt_conn *conn)
+{
+	struct bt_conn_info info;
+
+	if (bt_conn_get_info(conn, &info) != 0) {
+		return -ENOTCONN;
+	}
+
+	switch (p) {
+	case LINK_UP_DLE: {
+#if defined(CONFIG_BT_USER_DATA_LEN_UPDATE)
+		const struct bt_conn_le_data_len_param param = {
+			.tx_max_len = cfg->tx_octets,
+			.tx_max_time = cfg->tx_time,
+		};
+
+		if (info.le.data_len->tx_max_len >= cfg->tx_octets) {
+			return ALREADY;
+		}
+		return bt_conn_le_data_len_update(conn, &param);
+#else
+		return -ENOTSUP;
+#endif
+	}
+	case LINK_UP_PHY: {
+#if defined(CONFIG_BT_USER_PHY_UPDATE)
+		const struct bt_conn_le_phy_param param = {
+			.options = BT_CONN_LE_PHY_OPT_NONE,
+			.pref_tx_phy = cfg->phy,
+			.pref_rx_phy = cfg->phy,
+		};
+
+		if (info.le.phy->tx_phy == cfg->phy && info.le.phy->rx_phy == cfg->phy) {
+			return ALREADY;
+		}
+		return bt_conn_le_phy_update(conn, &param);
+#else
+		return -ENOTSUP;
+#endif
+	}
+	case LINK_UP_MTU: {
+#if defined(CONFIG_BT_GATT_CLIENT)
+		static struct bt_gatt_exchange_params params;
+		int err;
+
+		params.func = mtu_exchange_cb;
+		err = bt_gatt_exchange_mtu(conn, &params);
+		return err == -EALREADY ? ALREADY : err;
+#else
+		/* Peripheral without a GATT client: wait for the peer's exchange. */
+		return 0;
+#endif
+	}
+	case LINK_UP_CI:
+		if (info.le.interval >= cfg->ci.interval_min &&
+		    info.le.interval <= cfg->ci.interval_max) {
+			return ALREADY;
+		}
+		return bt_conn_le_param_update(conn, &cfg->ci);
+	case LINK_UP_DISCOVER:
+		return cfg->discover != NULL ? cfg->discover(conn) : 0;
+	case LINK_UP_OPEN:
+		return cfg->open != NULL ? cfg->open(conn) : 0;
+	default:
+		return -EINVAL;
+	}
+}
+
+/* Phases the app says p needs (cfg->*_after), as opposed to the
+ * ordering-only wait of CI on PHY.
+ */
+static uint32_t needs(enum link_up_phase p)
+{
+	if (p == LINK_UP_DISCOVER) {
+		return cfg->discover_after & cfg->steps;
+	} else if (p == LINK_UP_OPEN) {
+		return cfg->open_after & cfg->steps;
+	}
+	return 0;
+}
+
+static bool deps_met(enum link_up_phase p)
+{
+	uint32_t after = needs(p);
+
+	if (p == LINK_UP_CI) {
+		/* Both are instant-based; never have two outstanding. */
+		after = LINK_UP_STEP(LINK_UP_PHY) & cfg->steps;
+	}
+	return ((uint32_t)atomic_get(&finished) & after) == after;
+}
+
+/* App phase with no hook: the peer drives it, we only time it. */
+static bool peer_driven(enum link_up_phase p)
+{
+	return (p == LINK_UP_DISCOVER && cfg->discover == NULL) ||
+	       (p == LINK_UP_OPEN && cfg->open == NULL);
+}
+
+/* A phase we would issue whose prerequisite failed: issuing it would
+ * act on state that never arrived (e.g. OPEN subscribing to a handle
+ * DISCOVER never found). Peer-driven phases still happen regardless.
+ */
+static bool dep_failed(enum link_up_phase p)
+{
+	return !peer_driven(p) && ((uint32_t)atomic_get(&failed) & needs(p)) != 0;
+}
+
+/* Started by us and still waiting for its completion event */
+static bool waiting(enum link_up_phase p)
+{
+	return atomic_test_bit(&started, p) && !atomic_test_bit(&finished, p) &&
+	       !peer_driven(p);
+}
+
+/* Point timeout_work at the earliest per-phase deadline, each counted
+ * from that phase's own start, or cancel it if nothing is waiting.
+ */
+static void arm_timeout(void)
+{
+	const uint32_t window = CONFIG_LINK_UP_TIMEOUT_MS * 1000U;
+	uint32_t now = since_conn_us();
+	uint32_t next = UINT32_MAX;
+
+	for (int p = 0; p < LINK_UP_PHASES; p++) {
+		uint32_t age = now - start_us[p];
+
+		if (waiting(p)) {
+			next = MIN(next, age >= window ? 0U : window - age);
+		}
+	}
+
+	if (next == UINT32_MAX) {
+		k_work_cancel_delayable(&timeout_work);
+	} else {
+		k_work_reschedule(&timeout_work, K_USEC(next));
+	}
+}
+
+static void step_handler(struct k_work *work)
+{
+	struct bt_conn *conn = link_get();
+
+	if (conn == NULL) {
+		return;
+	}
+
+	for (int p = 0; p < LINK_UP_PHASES; p++) {
+		int err;
+
+		if (!(cfg->steps & LINK_UP_STEP(p)) || !deps_met(p) ||
+		    atomic_test_and_set_bit(&started, p)) {
+			continue;
+		}
+
+		start_us[p] = since_conn_us();
+		if (dep_failed(p)) {
+			/* Fails its own dependents in turn via step_work */
+			finish(p, -ECANCELED);
+			continue;
+		}
+		err = issue(p, conn);
+		if (err == ALREADY) {
+			atomic_set_bit(&skipped, p);
+			finish(p, 0);
+		} else if (err < 0) {
+			finish(p, err);
+		}
+	}
+
+	arm_timeout();
+	bt_conn_unref(conn);
+}
+
+/* Safety net only: a phase whose completion event never arrives (the
+ * peer rejected a request, or the controller chose not to report an
+ * unchanged value) must not hold up the phases that depend on it.
+ * Each phase gets the full window from its own start, so CI (after
+ * PHY) and DISCOVER/OPEN (after their prerequisites) are not cut
+ * short by time spent before they could be issued. Peer-driven
+ * phases wait as long as the peer takes.
+ */
+static void timeout_handler(struct k_work *work)
+{
+	uint32_t now;
+
+	if (link == NULL) {
+		return;
+	}
+
+	now = since_conn_us();
+	for (int p = 0; p < LINK_UP_PHASES; p++) {
+		if (waiting(p) && now - start_us[p] >= CONFIG_LINK_UP_TIMEOUT_MS * 1000U) {
+			finish(p, -ETIMEDOUT);
+		}
+	}
+
+	arm_timeout();
+}
+
+/* ---- Report ---- */
+
+static void print_ms(const char *label, uint32_t us)
+{
+	printk(" %s %5u.%01u ms", label, us / 1000U, (us % 1000U) / 100U);
+}
+
+static void report_handler(struct k_work *work)
+{
+	uint32_t avg;
+
+	if (!IS_ENABLED(CONFIG_LINK_UP_REPORT)) {
+		return;
+	}
+
+	for (int p = 0; p < LINK_UP_PHASES; p++) {
+		if (!(cfg->steps & LINK_UP_STEP(p))) {
+			continue;
+		}
+		printk("LINKUP %-7s", phase_name[p]);
+		if (!atomic_test_bit(&started, p)) {
+			printk(" not started\n");
+			continue;
+		}
+		print_ms("start", start_us[p]);
+		if (!atomic_test_bit(&finished, p)) {
+			printk("  pending\n");
+			continue;
+		}
+		print_ms("done", done_us[p]);
+		if (atomic_test_bit(&skipped, p)) {
+			printk("  already\n");
+		} else if (result[p] == -ETIMEDOUT) {
+			printk("  timeout\n");
+		} else if (result[p] == -ECANCELED) {
+			printk("  cancelled\n");
+		} else if (result[p] != 0) {
+			printk("  err %d\n", result[p]);
+		} else {
+			printk("  ok\n");
+		}
+	}
+
+	avg = (uint32_t)(stats.sum_us / MAX(stats.links, 1U));
+	printk("LINKUP payload");
+	print_ms("first byte", first_us);
+	printk(" after connect (links %u, avg %u.%01u ms, max %u.%01u ms)\n", stats.links,
+	       avg / 1000U, (avg % 1000U) / 100U, stats.max_us / 1000U,
+	       (stats.max_us % 1000U) / 100U);
+}
+
+/* ---- Bluetooth callbacks ---- */
+
+static void on_connected(struct bt_conn *conn, uint8_t err)
+{
+	k_spinlock_key_t key;
+
+	struct bt_conn_info info;
+
+	if (cfg == NULL || err != 0U || link != NULL) {
+		return;
+	}
+	if (cfg->roles != 0U &&
+	    (bt_conn_get_info(conn, &info) != 0 || !(cfg->roles & BIT(info.role)))) {
+		return;
+	}
+
+	t_conn = k_cycle_get_32();
+	atomic_clear(&started);
+	atomic_clear(&finished);
+	atomic_clear(&failed);
+	atomic_clear(&skipped);
+	atomic_clear(&reported);
+	memset(result, 0, sizeof(result));
+
+	key = k_spin_lock(&lock);
+	link = bt_conn_ref(conn);
+	k_spin_unlock(&lock, key);
+
+	/* step_work arms the timeout for whatever it starts */
+	k_work_submit(&step_work);
+}
+
+static void on_disconnected(struct bt_conn *conn, uint8_t reason)
+{
+	k_spinlock_key_t key;
+	struct bt_conn *old;
+
+	if (!is_link(conn)) {
+		return;
+	}
+
+	key = k_spin_lock(&lock);
+	old = link;
+	link = NULL;
+	k_spin_unlock(&lock, key);
+
+	k_work_cancel_delayable(&timeout_work);
+	bt_conn_unref(old);
+}
+
+static void on_param_updated(struct bt_conn *conn, uint16_t interval, uint16_t latency,
+			     uint16_t timeout)
+{
+	if (is_link(conn)) {
+		finish(LINK_UP_CI, (interval >= cfg->ci.interval_min &&
+				    interval <= cfg->ci.interval_max) ? 0 : -ERANGE);
+	}
+}
+
+#if defined(CONFIG_BT_USER_PHY_UPDATE)
+static void on_phy_updated(struct bt_conn *conn, struct bt_conn_le_phy_info *info)
+{
+	if (is_link(conn)) {
+		finish(LINK_UP_PHY, info->tx_phy == cfg->phy ? 0 : -ERANGE);
+	}
+}
+#endif
+
+#if defined(CONFIG_BT_USER_DATA_LEN_UPDATE)
+static void on_data_len_updated(struct bt_conn *conn, struct bt_conn_le_data_len_info *info)
+{
+	if (is_link(conn)) {
+		finish(LINK_UP_DLE, info->tx_max_len >= cfg->tx_octets ? 0 : -ERANGE);
+	}
+}
+#endif
+
+static void on_mtu_updated(struct bt_conn *conn, uint16_t tx, uint16_t rx)
+{
+	if (is_link(conn)) {
+		finish(LINK_UP_MTU, 0);
+	}
+}
+
+BT_CONN_CB_DEFINE(link_up_conn_cb) = {
+	.connected = on_connected,
+	.disconnected = on_disconnected,
+	.le_param_updated = on_param_updated,
+#if defined(CONFIG_BT_USER_PHY_UPDATE)
+	.le_phy_updated = on_phy_updated,
+#endif
+#if defined(CONFIG_BT_USER_DATA_LEN_UPDATE)
+	.le_data_len_updated = on_data_len_updated,
+#endif
+};
+
+static struct bt_gatt_cb link_up_gatt_cb = {
+	.att_mtu_updated = on_mtu_updated,
+};
+
+/* ---- API ---- */
+
+void link_up_init(const struct link_up_cfg *c)
+{
+	k_work_init(&step_work, step_handler);
+	k_work_init(&report_work, report_handler);
+	k_work_init_delayable(&timeout_work, timeout_handler);
+	bt_gatt_cb_register(&link_up_gatt_cb);
+	cfg = c;
+}
+
+void link_up_done(enum link_up_phase phase, int err)
+{
+	finish(phase, err);
+}
+
+bool link_up_ok(uint32_t mask)
+{
+	uint32_t ok = (uint32_t)atomic_get(&finished) & ~(uint32_t)atomic_get(&failed);
+
+	return link != NULL && (ok & mask) == mask;
+}
+
+void link_up_first_payload(void)
+{
+	uint32_t us;
+
+	if (link == NULL || atomic_get(&reported) != 0 || atomic_set(&reported, 1) != 0) {
+		return;
+	}
+
+	us = since_conn_us();
+	first_us = us;
+	stats.links++;
+	stats.last_us = us;
+	stats.max_us = MAX(stats.max_us, us);
+	stats.sum_us += us;
+	k_work_submit(&report_work);
+}
+
+void link_up_get_stats(struct link_up_stats *out)
+{
+	*out = stats;
+}
@@ -0,0 +1,118 @@
+/*
+ * Event-driven BLE link bring-up.
+ *
+ * Replaces the "connected -> k_work_schedule(50 ms / 100 ms / 1 s) ->
+ * fire every procedure -> sleep -> discover" pattern. Each phase is
+ * started from the system workqueue as soon as the event it depends on
+ * has arrived, and finishes on the callback that reports its result:
+ *
+ *   DLE       bt_conn_le_data_len_update()  -> le_data_len_updated
+ *   PHY       bt_conn_le_phy_update()       -> le_phy_updated
+ *   MTU       bt_gatt_exchange_mtu()        -> exchange callback / att_mtu_updated
+ *   CI        bt_conn_le_param_update()     -> le_param_updated
+ *   DISCOVER  cfg->discover()               -> link_up_done(LINK_UP_DISCOVER, err)
+ *   OPEN      cfg->open()                   -> link_up_done(LINK_UP_OPEN, err)
+ *
+ * DLE, PHY and MTU have no prerequisite beyond the connection and are
+ * issued at once: DLE carries no instant, and the ATT exchange runs
+ * alongside the LL procedures. CI waits for PHY when both are enabled,
+ * since two instant-based procedures in flight (ours plus one the
+ * central starts) is what produced the LL response timeouts that the
+ * old 1 s delay papered over. DISCOVER and OPEN wait for the phases
+ * listed in cfg->discover_after / cfg->open_after.
+ * A phase whose target is already in place at connect time (e.g. the
+ * peer initiated DLE first) completes without being issued.
+ *
+ * Timestamps are taken relative to the connected callback and printed
+ * as LINKUP lines once the app reports its first payload byte with
+ * link_up_first_payload().
+ *
+ * One connection at a time (optionally only one role, cfg->roles);
+ * further connections are ignored until the tracked one disconnects.
+ */
+
+#ifndef COMMON_LINK_UP_H_
+#define COMMON_LINK_UP_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/sys/util.h>
+
+enum link_up_phase {
+	LINK_UP_DLE,
+	LINK_UP_PHY,
+	LINK_UP_MTU,
+	LINK_UP_CI,
+	LINK_UP_DISCOVER,
+	LINK_UP_OPEN,
+	LINK_UP_PHASES,
+};
+
+#define LINK_UP_STEP(phase) BIT(phase)
+
+struct link_up_cfg {
+	/* LINK_UP_STEP() mask of the phases to run. */
+	uint32_t steps;
+
+	/* BIT(BT_CONN_ROLE_*) mask of the roles to track; 0 tracks any.
+	 * Lets a dual-role app run the bring-up on one side only.
+	 */
+	uint8_t roles;
+
+	/* DLE target (octets, us). */
+	uint16_t tx_octets;
+	uint16_t tx_time;
+
+	/* PHY target, BT_GAP_LE_PHY_* for both directions. */
+	uint8_t phy;
+
+	/* CI target. A current interval already inside [min, max]
+	 * counts as done.
+	 */
+	struct bt_le_conn_param ci;
+
+	/* Application phases: start the procedure and return 0, then
+	 * report the result with link_up_done(). Called from the system
+	 * workqueue once every phase in the matching *_after mask has
+	 * finished. If any of them failed the hook is not called and the
+	 * phase fails with -ECANCELED, so list only real dependencies.
+	 * Leave NULL for a phase the peer drives (e.g. a peripheral
+	 * waiting for its CCC to be written): it is then only timed, from
+	 * link_up_done().
+	 */
+	int (*discover)(struct bt_conn *conn);
+	uint32_t discover_after;
+	int (*open)(struct bt_conn *conn);
+	uint32_t open_after;
+
+	/* Optional, called once per phase as it finishes; err is 0,
+	 * a negative errno, -ETIMEDOUT or -ECANCELED.
+	 */
+	void (*phase_done)(enum link_up_phase phase, int err);
+};
+
+struct link_up_stats {
+	uint32_t links;          /* connections that reached first payload */
+	uint32_t last_us;        /* connect -> first payload, last link */
+	uint32_t max_us;
+	uint64_t sum_us;
+};
+
+/* Register the configuration; call before bt_enable(). cfg must stay valid. */
+void link_up_init(const struct link_up_cfg *cfg);
+
+/* Report the result of an application phase (DISCOVER, OPEN). */
+void link_up_done(enum link_up_phase phase, int err);
+
+/* True once every phase in mask has finished successfully. */
+bool link_up_ok(uint32_t mask);
+
+/* Mark the first payload byte sent or received; prints the LINKUP
+ * report for this connection. Cheap after the first call.
+ */
+void link_up_first_payload(void);
+
+void link_up_get_stats(struct link_up_stats *out);
+
+#endif /* COMMON_LINK_UP_H_ */
@@ -0,0 +1,37 @@
+/*
+ * Memory-bound bandwidth loop for shared-SRAM contention measurements
+ * on the nRF54L15 M33 and FLPR.
+ *
+ * membench_run() sweeps a word buffer with unrolled read-modify-write
+ * passes until the window expires and reports the bytes moved (one
+ * read plus one write per word). Neither core caches SRAM data, so the
+ * rate follows the SRAM port the buffer sits on: run it on one core
+ * alone for the baseline, then with the other core busy, and the ratio
+ * is the slowdown caused by the other core.
+ *
+ * The buffer is CONFIG_MEMBENCH_BUF_SIZE bytes, in .bss or at
+ * CONFIG_MEMBENCH_BUF_ADDR.
+ */
+
+#ifndef COMMON_MEMBENCH_H_
+#define COMMON_MEMBENCH_H_
+
+#include <stdint.h>
+
+struct membench_result {
+	uint32_t bytes;       /* read + written */
+	uint32_t elapsed_us;
+	uint32_t passes;
+};
+
+/* Sweep for duration_ms, blocking the calling thread (it stays
+ * preemptible). Returns 0, or -EINVAL for a zero window.
+ */
+int membench_run(uint32_t duration_ms, struct membench_result *out);
+
+/* Bandwidth in 0.1 MB/s units (bytes per us == MB/s). */
+uint32_t membench_mbps_x10(uint32_t bytes, uint32_t elapsed_us);
+
+uintptr_t membench_buf_addr(void);
+
+#endif /* COMMON_MEMBENCH_H_ */
@@ -0,0 +1,173 @@
+#!/usr/bin/env python3
+"""
+Generate the FIR coefficients for common/pdm_dec (pdm_dec_coeffs.h).
+
+Two stages follow the order-4 CIC, each decimating by 2:
+
+  half-band   23 taps, Kaiser-windowed sinc (beta 7), at the CIC output
+              rate. Every other tap except the centre is zero.
+  compensator 40 taps, weighted least squares at twice the output rate.
+              Passband 0..0.4 fs_out is flattened against the CIC
+              (sinc^4) and half-band droop; stopband from 0.6 fs_out,
+              weighted 100x. The 0.4-0.6 band may alias into the
+              0.4-0.5 band, which is above the passband.
+
+The droop is computed for a CIC ratio of 32. Between 8 and 64 the
+sinc^4 shape in the passband changes by well under 0.01 dB, so one set
+serves every ratio.
+
+Pure Python (no numpy), so it runs in the Zephyr venv as is.
+
+Usage:
+    python3 gen_coeffs.py > pdm_dec_coeffs.h
+    python3 gen_coeffs.py --report      # print the response instead
+"""
+
+import argparse
+import math
+import sys
+
+HB_TAPS = 23
+HB_BETA = 7.0
+COMP_TAPS = 40
+COMP_PASS = 0.2       # of the compensator input rate (= 0.4 fs_out)
+COMP_STOP = 0.3       # (= 0.6 fs_out)
+COMP_STOP_WEIGHT = 100.0
+CIC_ORDER = 4
+CIC_RATIO = 32
+Q = 15
+
+
+def sinc(x):
+    return 1.0 if x == 0 else math.sin(math.pi * x) / (math.pi * x)
+
+
+def bessel_i0(x):
+    s = t = 1.0
+    for k in range(1, 40):
+        t *= (x / 2 / k) ** 2
+        s += t
+    return s
+
+
+def kaiser(n, length, beta):
+    r = 2 * n / (length - 1) - 1
+    return bessel_i0(beta * math.sqrt(max(0.0, 1 - r * r))) / bessel_i0(beta)
+
+
+def mag(h, f):
+    re = sum(c * math.cos(2 * math.pi * f * k) for k, c in enumerate(h))
+    im = sum(c * math.sin(2 * math.pi * f * k) for k, c in enumerate(h))
+    return math.hypot(re, im)
+
+
+def cic_mag(f):
+    """CIC magnitude, f in units of the CIC output rate."""
+    if f == 0:
+        return 1.0
+    return abs(math.sin(math.pi * f) / (CIC_RATIO * math.sin(math.pi * f / CIC_RATIO))) ** CIC_ORDER
+
+
+def halfband():
+    c = (HB_TAPS - 1) // 2
+    h = [0.5 * sinc(0.5 * (n - c)) * kaiser(n, HB_TAPS, HB_BETA) for n in range(HB_TAPS)]
+    s = sum(h)
+    return [x / s for x in h]
+
+
+def solve(a, b):
+    n = len(b)
+    for i in range(n):
+        p = max(range(i, n), key=lambda r: abs(a[r][i]))
+        a[i], a[p] = a[p], a[i]
+        b[i], b[p] = b[p], b[i]
+        for r in range(i + 1, n):
+            m = a[r][i] / a[i][i]
+            for k in range(i, n):
+                a[r][k] -= m * a[i][k]
+            b[r] -= m * b[i]
+    x = [0.0] * n
+    for i in reversed(range(n)):
+        x[i] = (b[i] - sum(a[i][k] * x[k] for k in range(i + 1, n))) / a[i][i]
+    return x
+
+
+def compensator(hb):
+    """Symmetric even-length FIR by weighted least squares."""
+    m = COMP_TAPS // 2
+    rows, target, weight = [], [], []
+    for i in range(2001):
+        f = 0.5 * i / 2000
+        if f <= COMP_PASS:
+            d, w = 1 / (cic_mag(f / 2) * mag(hb, f / 2)), 1.0
+        elif f >= COMP_STOP:
+            d, w = 0.0, COMP_STOP_WEIGHT
+        else:
+            continue
+        rows.append([2 * math.cos(2 * math.pi * f * (m - 0.5 - k)) for k in range(m)])
+        target.append(d)
+        weight.append(w)
+
+    a = [[sum(w * r[i] * r[j] for r, w in zip(rows, weight)) for j in range(m)] for i in range(m)]
+    b = [sum(w * r[i] * d for r, w, d in zip(rows, weight, target)) for i in range(m)]
+    half = solve(a, b)
+    return half + half[::-1]
+
+
+def quantize(h):
+    return [int(round(x * (1 << Q))) for x in h]
+
+
+def report(hb, comp):
+    hbq = [x / (1 << Q) for x in quantize(hb)]
+    cq = [x / (1 << Q) for x in quantize(comp)]
+    pb = [20 * math.log10(mag(cq, f) * mag(hbq, f / 2) * cic_mag(f / 2))
+          for f in (i / 1000 for i in range(0, 201))]
+    hb_stop = max(mag(hbq, i / 1000) for i in range(350, 501))
+    c_stop = max(mag(cq, i / 1000) for i in range(300, 501))
+    print(f"passband 0..0.4 fs_out: {min(pb):+.3f} .. {max(pb):+.3f} dB")
+    print(f"half-band stopband:     {20 * math.log10(hb_stop):.1f} dB")
+    print(f"compensator stopband:   {20 * math.log10(c_stop):.1f} dB")
+
+
+def c_array(name, vals):
+    lines = []
+    for i in range(0, len(vals), 8):
+        lines.append("\t" + " ".join(f"{v:6d}," for v in vals[i:i + 8]))
+    return f"static const int16_t {name}[{len(vals)}] = {{\n" + "\n".join(lines) + "\n};\n"
+
+
+def main():
+    parser = argparse.ArgumentParser(description="pdm_dec FIR coefficient generator")
+    parser.add_argument("--report", action="store_true", help="Print the quantized response")
+    args = parser.parse_args()
+
+    hb = halfband()
+    comp = compensator(hb)
+
+    if args.report:
+        report(hb, comp)
+        return 0
+
+    hbq = quantize(hb)
+    c = (HB_TAPS - 1) // 2
+    # Only the odd offsets from the centre are non-zero: store one side
+    hb_side = [hbq[c - o] for o in range(1, c + 1, 2)]
+
+    print("/* Generated by gen_coeffs.py; do not edit. Q15. */\n")
+    print("#ifndef COMMON_PDM_DEC_COEFFS_H_")
+    print("#define COMMON_PDM_DEC_COEFFS_H_\n")
+    print("#include <stdint.h>\n")
+    print(f"#define PDM_DEC_HB_TAPS   {HB_TAPS}")
+    print(f"#define PDM_DEC_HB_CENTER {hbq[c]}")
+    print(f"#define PDM_DEC_COMP_TAPS {COMP_TAPS}\n")
+    print("/* Half-band taps at centre offsets 1, 3, 5, ... (symmetric) */")
+    print(c_array("pdm_dec_hb_side", hb_side))
+    print("/* Compensator, first half (symmetric) */")
+    print(c_array("pdm_dec_comp_half", quantize(comp)[:COMP_TAPS // 2]))
+    print("#endif /* COMMON_PDM_DEC_COEFFS_H_ */")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,77 @@
+/*
+ * PDM-to-PCM decimation: order-4 CIC, half-band FIR, CIC-compensating
+ * FIR.
+ *
+ *   PDM (1 bit, fs_pdm) -> CIC /R -> half-band /2 -> compensator /2 -> PCM
+ *
+ * Total decimation is 4R, so a 1.024 MHz PDM clock gives 8 kHz with
+ * R = 32 and 16 kHz with R = 16. A 3.072 MHz clock gives 16 kHz with
+ * R = 48. R is a multiple of 8 from 8 to 64, so one CIC output spans
+ * whole bytes.
+ *
+ * Input is one byte stream per microphone, earliest sample in the MSB,
+ * 1 = positive. A stereo data line (two mics on opposite clock edges)
+ * is split with pdm_dec_deinterleave() first. Output is Q15 PCM with
+ * full scale at all-ones PDM, passband flat to 0.4 fs_out within
+ * +-0.03 dB, stopband below -65 dB.
+ *
+ * Each channel has its own struct pdm_dec. Nothing is shared apart from
+ * read-only tables, so channels can run on different threads.
+ */
+
+#ifndef COMMON_PDM_DEC_H_
+#define COMMON_PDM_DEC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pdm_dec_coeffs.h"
+
+#define PDM_DEC_FIR_DECIM 4   /* half-band x compensator */
+
+struct pdm_dec {
+	uint32_t integ[4];
+	uint32_t comb[4];
+	int64_t scale;            /* CIC output -> Q15, Q32 */
+	uint32_t half_range;      /* R^4 / 2 */
+	uint16_t ratio;
+	uint8_t hb_phase;
+	uint8_t comp_phase;
+	uint8_t hb_pos;
+	uint8_t comp_pos;
+	/* Delay lines written twice so a full window is always contiguous */
+	int16_t hb_dl[2 * PDM_DEC_HB_TAPS];
+	int16_t comp_dl[2 * PDM_DEC_COMP_TAPS];
+};
+
+/* Returns -EINVAL unless ratio is a multiple of 8 in 8..64. */
+int pdm_dec_init(struct pdm_dec *d, uint32_t ratio);
+
+/* PDM bytes per output sample (4R / 8). */
+static inline size_t pdm_dec_bytes_per_sample(const struct pdm_dec *d)
+{
+	return d->ratio / 2;
+}
+
+/* Decimate len bytes (a multiple of pdm_dec_bytes_per_sample()) into
+ * pcm. Returns the number of samples written.
+ */
+size_t pdm_dec_process(struct pdm_dec *d, const uint8_t *pdm, size_t len, int16_t *pcm);
+
+/* Split a stereo stream: even bits (MSB first) to a, odd bits to b.
+ * len is even; a and b each receive len / 2 bytes.
+ */
+void pdm_dec_deinterleave(const uint8_t *in, size_t len, uint8_t *a, uint8_t *b);
+
+/* Test signal: a second-order sigma-delta modulation of a sine, amp in
+ * Q15 of full scale, into len bytes at fs_pdm. phase carries the
+ * modulator and oscillator state across calls (zero it first).
+ */
+struct pdm_dec_tone {
+	int32_t i1, i2;
+	uint32_t phase;
+};
+void pdm_dec_tone_fill(struct pdm_dec_tone *t, uint8_t *out, size_t len,
+		       uint32_t fs_pdm, uint32_t tone_hz, int16_t amp);
+
+#endif /* COMMON_PDM_DEC_H_ */
@@ -0,0 +1,24 @@
+/* Generated by gen_coeffs.py; do not edit. Q15. */
+
+#ifndef COMMON_PDM_DEC_COEFFS_H_
+#define COMMON_PDM_DEC_COEFFS_H_
+
+#include <stdint.h>
+
+#define PDM_DEC_HB_TAPS   23
+#define PDM_DEC_HB_CENTER 16382
+#define PDM_DEC_COMP_TAPS 40
+
+/* Half-band taps at centre offsets 1, 3, 5, ... (symmetric) */
+static const int16_t pdm_dec_hb_side[6] = {
+	 10153,  -2720,   1031,   -345,     79,     -6,
+};
+
+/* Compensator, first half (symmetric) */
+static const int16_t pdm_dec_comp_half[20] = {
+	    -8,      1,     35,      9,    -86,    -36,    174,     95,
+	  -313,   -205,    523,    399,   -835,   -738,   1325,   1380,
+	 -2239,  -2996,   4948,  14955,
+};
+
+#endif /* COMMON_PDM_DEC_COEFFS_H_ */
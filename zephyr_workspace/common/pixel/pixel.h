@@ -0,0 +1,133 @@
+/*
+ * Pixel-format conversion, scaling, blend and fill kernels (RGB565 out).
+ *
+ * Every kernel has a portable scalar reference (*_ref, pixel_ref.c) and
+ * a Helium/MVE version (*_mve, pixel_mve.c) built when the compiler
+ * targets MVE (Cortex-M55 with +mve). The unsuffixed names pick the
+ * fastest available one. The two are bit-exact by construction: the
+ * MVE code evaluates the same integer expressions lane-wise, and
+ * pixel_kernel_test checks this under QEMU.
+ *
+ * Arithmetic:
+ *   RGB888 -> RGB565  truncate: (r >> 3) << 11 | (g >> 2) << 5 | b >> 3
+ *   YUV420 -> RGB565  BT.601 limited range, 8-bit fixed point
+ *                     C = Y - 16, D = U - 128, E = V - 128
+ *                     R = clamp((298C + 409E + 128) >> 8)
+ *                     G = clamp((298C - 100D - 208E + 128) >> 8)
+ *                     B = clamp((298C + 516D + 128) >> 8)
+ *   Scaling           Q16 source step, pixel-centre sampling; nearest
+ *                     covers integer upscales, bilinear uses 8-bit
+ *                     weights per channel
+ *   Blend             a' = a + (a >> 7); c = (fg * a' + bg * (256 - a')) >> 8
+ *                     per channel (a = 255 gives fg exactly)
+ */
+
+#ifndef COMMON_PIXEL_H_
+#define COMMON_PIXEL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__ARM_FEATURE_MVE) && (__ARM_FEATURE_MVE & 1)
+#define PIX_HAVE_MVE 1
+#else
+#define PIX_HAVE_MVE 0
+#endif
+
+/* Q16 horizontal/vertical source step for a src -> dst resize. */
+#define PIX_STEP(src, dst) ((uint32_t)(((uint32_t)(src) << 16) / (uint32_t)(dst)))
+
+#define PIX_RGB565(r, g, b) \
+	((uint16_t)((((r) >> 3) << 11) | (((g) >> 2) << 5) | ((b) >> 3)))
+
+/* ---- Scalar reference kernels ---- */
+
+void pix_rgb888_to_rgb565_ref(uint16_t *dst, const uint8_t *src, size_t n);
+void pix_yuv420_row_to_rgb565_ref(uint16_t *dst, const uint8_t *y, const uint8_t *u,
+				  const uint8_t *v, size_t width);
+void pix_scale_nearest_row_ref(uint16_t *dst, size_t dst_w, const uint16_t *src,
+			       size_t src_w);
+void pix_scale_bilinear_row_ref(uint16_t *dst, size_t dst_w, const uint16_t *row0,
+				const uint16_t *row1, size_t src_w, uint32_t fy);
+void pix_blend_rgb565_ref(uint16_t *dst, const uint16_t *fg, const uint16_t *bg,
+			  uint8_t alpha, size_t n);
+void pix_fill_rgb565_ref(uint16_t *dst, uint16_t color, size_t n);
+
+/* ---- Helium kernels ---- */
+
+#if PIX_HAVE_MVE
+void pix_rgb888_to_rgb565_mve(uint16_t *dst, const uint8_t *src, size_t n);
+void pix_yuv420_row_to_rgb565_mve(uint16_t *dst, const uint8_t *y, const uint8_t *u,
+				  const uint8_t *v, size_t width);
+void pix_scale_nearest_row_mve(uint16_t *dst, size_t dst_w, const uint16_t *src,
+			       size_t src_w);
+void pix_scale_bilinear_row_mve(uint16_t *dst, size_t dst_w, const uint16_t *row0,
+				const uint16_t *row1, size_t src_w, uint32_t fy);
+void pix_blend_rgb565_mve(uint16_t *dst, const uint16_t *fg, const uint16_t *bg,
+			  uint8_t alpha, size_t n);
+void pix_fill_rgb565_mve(uint16_t *dst, uint16_t color, size_t n);
+
+#define PIX_IMPL(name) name##_mve
+#else
+#define PIX_IMPL(name) name##_ref
+#endif
+
+/* ---- Row kernels (fastest available) ---- */
+
+/* Packed RGB888 (R, G, B byte order) to RGB565, n pixels. */
+static inline void pix_rgb888_to_rgb565(uint16_t *dst, const uint8_t *src, size_t n)
+{
+	PIX_IMPL(pix_rgb888_to_rgb565)(dst, src, n);
+}
+
+/* One I420 row: y has width samples, u/v are the half-width chroma
+ * rows for this line (row >> 1).
+ */
+static inline void pix_yuv420_row_to_rgb565(uint16_t *dst, const uint8_t *y,
+					    const uint8_t *u, const uint8_t *v,
+					    size_t width)
+{
+	PIX_IMPL(pix_yuv420_row_to_rgb565)(dst, y, u, v, width);
+}
+
+/* Nearest-neighbour horizontal resize of one RGB565 row. */
+static inline void pix_scale_nearest_row(uint16_t *dst, size_t dst_w,
+					 const uint16_t *src, size_t src_w)
+{
+	PIX_IMPL(pix_scale_nearest_row)(dst, dst_w, src, src_w);
+}
+
+/* Bilinear resize of one RGB565 row from two source rows; fy (0-255)
+ * is the weight of row1.
+ */
+static inline void pix_scale_bilinear_row(uint16_t *dst, size_t dst_w,
+					  const uint16_t *row0, const uint16_t *row1,
+					  size_t src_w, uint32_t fy)
+{
+	PIX_IMPL(pix_scale_bilinear_row)(dst, dst_w, row0, row1, src_w, fy);
+}
+
+/* dst = fg over bg with constant alpha (dst may alias bg). */
+static inline void pix_blend_rgb565(uint16_t *dst, const uint16_t *fg,
+				    const uint16_t *bg, uint8_t alpha, size_t n)
+{
+	PIX_IMPL(pix_blend_rgb565)(dst, fg, bg, alpha, n);
+}
+
+static inline void pix_fill_rgb565(uint16_t *dst, uint16_t color, size_t n)
+{
+	PIX_IMPL(pix_fill_rgb565)(dst, color, n);
+}
+
+/* ---- Frame helpers (built on the row kernels) ---- */
+
+/* Pitches are in pixels (dst) / bytes (planes). */
+void pix_yuv420_to_rgb565(uint16_t *dst, size_t dst_pitch, const uint8_t *y,
+			  const uint8_t *u, const uint8_t *v, size_t width,
+			  size_t height);
+
+void pix_scale_bilinear_rgb565(uint16_t *dst, size_t dst_pitch, size_t dst_w,
+			       size_t dst_h, const uint16_t *src, size_t src_pitch,
+			       size_t src_w, size_t src_h);
+
+#endif /* COMMON_PIXEL_H_ */
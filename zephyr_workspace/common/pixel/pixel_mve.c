@@ -0,0 +1,188 @@
+/*
+ * Helium (MVE) pixel kernels for the Cortex-M55.
+ *
+ * Each loop is tail-predicated (vctp + _z loads / _p stores), so any
+ * length is handled without a scalar epilogue and the compiler can map
+ * the loop onto DLSTP/LETP. Lane arithmetic mirrors pixel_ref.c
+ * expression for expression; widths were chosen so no intermediate
+ * overflows its lane:
+ *
+ *   rgb888 / blend / fill   8 x u16 (blend: 63 * 256 fits)
+ *   yuv420                  4 x s32 (298 * 239 does not fit s16)
+ *   nearest / bilinear      4 x u32 gather offsets and Q16 positions
+ */
+
+#include "pixel.h"
+
+#if PIX_HAVE_MVE
+
+#include <arm_mve.h>
+
+void pix_rgb888_to_rgb565_mve(uint16_t *dst, const uint8_t *src, size_t n)
+{
+	/* Byte offsets of R for 8 consecutive packed pixels: 0, 3, ... 21. */
+	const uint16x8_t off = vmulq_n_u16(vidupq_n_u16(0, 1), 3);
+
+	for (int32_t left = (int32_t)n; left > 0; left -= 8) {
+		mve_pred16_t p = vctp16q(left);
+		uint16x8_t r = vldrbq_gather_offset_z_u16(src, off, p);
+		uint16x8_t g = vldrbq_gather_offset_z_u16(src + 1, off, p);
+		uint16x8_t b = vldrbq_gather_offset_z_u16(src + 2, off, p);
+		uint16x8_t out = vshlq_n_u16(vshrq_n_u16(r, 3), 11);
+
+		out = vorrq_u16(out, vshlq_n_u16(vshrq_n_u16(g, 2), 5));
+		out = vorrq_u16(out, vshrq_n_u16(b, 3));
+		vst1q_p_u16(dst, out, p);
+
+		src += 24;
+		dst += 8;
+	}
+}
+
+static inline int32x4_t clamp_u8_s32(int32x4_t v)
+{
+	return vmaxq_s32(vminq_s32(v, vdupq_n_s32(255)), vdupq_n_s32(0));
+}
+
+void pix_yuv420_row_to_rgb565_mve(uint16_t *dst, const uint8_t *y, const uint8_t *u,
+				  const uint8_t *v, size_t width)
+{
+	/* Chroma offsets relative to u/v + i/2 for lanes i..i+3. */
+	const uint32x4_t coff = vshrq_n_u32(vidupq_n_u32(0, 1), 1);
+	size_t i = 0;
+
+	for (int32_t left = (int32_t)width; left > 0; left -= 4, i += 4) {
+		mve_pred16_t p = vctp32q(left);
+		int32x4_t c = vreinterpretq_s32_u32(vldrbq_z_u32(&y[i], p));
+		int32x4_t d = vreinterpretq_s32_u32(
+			vldrbq_gather_offset_z_u32(&u[i >> 1], coff, p));
+		int32x4_t e = vreinterpretq_s32_u32(
+			vldrbq_gather_offset_z_u32(&v[i >> 1], coff, p));
+		int32x4_t yc, r, g, b;
+		uint32x4_t out;
+
+		c = vsubq_n_s32(c, 16);
+		d = vsubq_n_s32(d, 128);
+		e = vsubq_n_s32(e, 128);
+		yc = vaddq_n_s32(vmulq_n_s32(c, 298), 128);
+
+		r = clamp_u8_s32(vshrq_n_s32(vmlaq_n_s32(yc, e, 409), 8));
+		g = clamp_u8_s32(vshrq_n_s32(vmlaq_n_s32(vmlaq_n_s32(yc, d, -100), e, -208), 8));
+		b = clamp_u8_s32(vshrq_n_s32(vmlaq_n_s32(yc, d, 516), 8));
+
+		out = vshlq_n_u32(vshrq_n_u32(vreinterpretq_u32_s32(r), 3), 11);
+		out = vorrq_u32(out, vshlq_n_u32(vshrq_n_u32(vreinterpretq_u32_s32(g), 2), 5));
+		out = vorrq_u32(out, vshrq_n_u32(vreinterpretq_u32_s32(b), 3));
+		vstrhq_p_u32(&dst[i], out, p);
+	}
+}
+
+void pix_scale_nearest_row_mve(uint16_t *dst, size_t dst_w, const uint16_t *src,
+			       size_t src_w)
+{
+	uint32_t step = PIX_STEP(src_w, dst_w);
+	const uint32x4_t max_x = vdupq_n_u32(src_w - 1);
+	uint32x4_t x = vaddq_n_u32(vmulq_n_u32(vidupq_n_u32(0, 1), step), step >> 1);
+
+	for (int32_t left = (int32_t)dst_w; left > 0; left -= 4) {
+		mve_pred16_t p = vctp32q(left);
+		uint32x4_t sx = vminq_u32(vshrq_n_u32(x, 16), max_x);
+
+		vstrhq_p_u32(dst, vldrhq_gather_shifted_offset_z_u32(src, sx, p), p);
+
+		x = vaddq_n_u32(x, step * 4);
+		dst += 4;
+	}
+}
+
+static inline uint32x4_t lerp2_mve(uint32x4_t c00, uint32x4_t c01, uint32x4_t c10,
+				   uint32x4_t c11, uint32x4_t fx, uint32x4_t ifx,
+				   uint32_t fy)
+{
+	uint32x4_t top = vmlaq_u32(vmulq_u32(c00, ifx), c01, fx);
+	uint32x4_t bot = vmlaq_u32(vmulq_u32(c10, ifx), c11, fx);
+	uint32x4_t acc = vmlaq_n_u32(vmulq_n_u32(top, 256 - fy), bot, fy);
+
+	return vshrq_n_u32(vaddq_n_u32(acc, 32768), 16);
+}
+
+void pix_scale_bilinear_row_mve(uint16_t *dst, size_t dst_w, const uint16_t *row0,
+				const uint16_t *row1, size_t src_w, uint32_t fy)
+{
+	uint32_t step = PIX_STEP(src_w, dst_w);
+	const uint32x4_t max_x = vdupq_n_u32(src_w - 1);
+	const uint32x4_t m6 = vdupq_n_u32(0x3F);
+	const uint32x4_t m5 = vdupq_n_u32(0x1F);
+	int32x4_t xq = vaddq_n_s32(vreinterpretq_s32_u32(vmulq_n_u32(vidupq_n_u32(0, 1), step)),
+				   (int32_t)(step >> 1) - 32768);
+
+	for (int32_t left = (int32_t)dst_w; left > 0; left -= 4) {
+		mve_pred16_t p = vctp32q(left);
+		uint32x4_t xu = vreinterpretq_u32_s32(vmaxq_s32(xq, vdupq_n_s32(0)));
+		uint32x4_t x0 = vminq_u32(vshrq_n_u32(xu, 16), max_x);
+		uint32x4_t x1 = vminq_u32(vaddq_n_u32(x0, 1), max_x);
+		uint32x4_t fx = vandq_u32(vshrq_n_u32(xu, 8), vdupq_n_u32(0xFF));
+		uint32x4_t ifx = vsubq_u32(vdupq_n_u32(256), fx);
+		uint32x4_t p00 = vldrhq_gather_shifted_offset_z_u32(row0, x0, p);
+		uint32x4_t p01 = vldrhq_gather_shifted_offset_z_u32(row0, x1, p);
+		uint32x4_t p10 = vldrhq_gather_shifted_offset_z_u32(row1, x0, p);
+		uint32x4_t p11 = vldrhq_gather_shifted_offset_z_u32(row1, x1, p);
+		uint32x4_t r, g, b;
+
+		r = lerp2_mve(vshrq_n_u32(p00, 11), vshrq_n_u32(p01, 11),
+			      vshrq_n_u32(p10, 11), vshrq_n_u32(p11, 11), fx, ifx, fy);
+		g = lerp2_mve(vandq_u32(vshrq_n_u32(p00, 5), m6), vandq_u32(vshrq_n_u32(p01, 5), m6),
+			      vandq_u32(vshrq_n_u32(p10, 5), m6), vandq_u32(vshrq_n_u32(p11, 5), m6),
+			      fx, ifx, fy);
+		b = lerp2_mve(vandq_u32(p00, m5), vandq_u32(p01, m5),
+			      vandq_u32(p10, m5), vandq_u32(p11, m5), fx, ifx, fy);
+
+		vstrhq_p_u32(dst, vorrq_u32(vorrq_u32(vshlq_n_u32(r, 11), vshlq_n_u32(g, 5)), b),
+			     p);
+
+		xq = vaddq_n_s32(xq, (int32_t)(step * 4));
+		dst += 4;
+	}
+}
+
+void pix_blend_rgb565_mve(uint16_t *dst, const uint16_t *fg, const uint16_t *bg,
+			  uint8_t alpha, size_t n)
+{
+	uint16_t a = alpha + (alpha >> 7);
+	uint16_t ia = 256 - a;
+	const uint16x8_t m6 = vdupq_n_u16(0x3F);
+	const uint16x8_t m5 = vdupq_n_u16(0x1F);
+
+	for (int32_t left = (int32_t)n; left > 0; left -= 8) {
+		mve_pred16_t p = vctp16q(left);
+		uint16x8_t f = vld1q_z_u16(fg, p);
+		uint16x8_t b = vld1q_z_u16(bg, p);
+		uint16x8_t r, g, bl;
+
+		r = vmlaq_n_u16(vmulq_n_u16(vshrq_n_u16(f, 11), a), vshrq_n_u16(b, 11), ia);
+		g = vmlaq_n_u16(vmulq_n_u16(vandq_u16(vshrq_n_u16(f, 5), m6), a),
+				vandq_u16(vshrq_n_u16(b, 5), m6), ia);
+		bl = vmlaq_n_u16(vmulq_n_u16(vandq_u16(f, m5), a), vandq_u16(b, m5), ia);
+
+		r = vshlq_n_u16(vshrq_n_u16(r, 8), 11);
+		g = vshlq_n_u16(vshrq_n_u16(g, 8), 5);
+		bl = vshrq_n_u16(bl, 8);
+		vst1q_p_u16(dst, vorrq_u16(vorrq_u16(r, g), bl), p);
+
+		fg += 8;
+		bg += 8;
+		dst += 8;
+	}
+}
+
+void pix_fill_rgb565_mve(uint16_t *dst, uint16_t color, size_t n)
+{
+	const uint16x8_t c = vdupq_n_u16(color);
+
+	for (int32_t left = (int32_t)n; left > 0; left -= 8) {
+		vst1q_p_u16(dst, c, vctp16q(left));
+		dst += 8;
+	}
+}
+
+#endif /* PIX_HAVE_MVE */
@@ -0,0 +1,143 @@
+/*
+ * Scalar reference pixel kernels (see pixel.h for the exact arithmetic).
+ * These define the expected output; the MVE kernels must match them
+ * bit for bit.
+ */
+
+#include "pixel.h"
+
+static inline uint32_t min_u32(uint32_t a, uint32_t b)
+{
+	return a < b ? a : b;
+}
+
+static inline int32_t clamp_u8(int32_t v)
+{
+	return v < 0 ? 0 : (v > 255 ? 255 : v);
+}
+
+void pix_rgb888_to_rgb565_ref(uint16_t *dst, const uint8_t *src, size_t n)
+{
+	for (size_t i = 0; i < n; i++) {
+		dst[i] = PIX_RGB565(src[0], src[1], src[2]);
+		src += 3;
+	}
+}
+
+void pix_yuv420_row_to_rgb565_ref(uint16_t *dst, const uint8_t *y, const uint8_t *u,
+				  const uint8_t *v, size_t width)
+{
+	for (size_t i = 0; i < width; i++) {
+		int32_t c = (int32_t)y[i] - 16;
+		int32_t d = (int32_t)u[i >> 1] - 128;
+		int32_t e = (int32_t)v[i >> 1] - 128;
+		int32_t yc = 298 * c + 128;
+		int32_t r = clamp_u8((yc + 409 * e) >> 8);
+		int32_t g = clamp_u8((yc - 100 * d - 208 * e) >> 8);
+		int32_t b = clamp_u8((yc + 516 * d) >> 8);
+
+		dst[i] = PIX_RGB565(r, g, b);
+	}
+}
+
+void pix_scale_nearest_row_ref(uint16_t *dst, size_t dst_w, const uint16_t *src,
+			       size_t src_w)
+{
+	uint32_t step = PIX_STEP(src_w, dst_w);
+	uint32_t x = step >> 1;
+
+	for (size_t i = 0; i < dst_w; i++) {
+		uint32_t sx = x >> 16;
+
+		dst[i] = src[sx < src_w - 1 ? sx : src_w - 1];
+		x += step;
+	}
+}
+
+static inline uint32_t lerp2(uint32_t c00, uint32_t c01, uint32_t c10, uint32_t c11,
+			     uint32_t fx, uint32_t fy)
+{
+	uint32_t top = c00 * (256 - fx) + c01 * fx;
+	uint32_t bot = c10 * (256 - fx) + c11 * fx;
+
+	return (top * (256 - fy) + bot * fy + 32768) >> 16;
+}
+
+void pix_scale_bilinear_row_ref(uint16_t *dst, size_t dst_w, const uint16_t *row0,
+				const uint16_t *row1, size_t src_w, uint32_t fy)
+{
+	uint32_t step = PIX_STEP(src_w, dst_w);
+	uint32_t max_x = src_w - 1;
+	int32_t xq = (int32_t)(step >> 1) - 32768;
+
+	for (size_t i = 0; i < dst_w; i++) {
+		uint32_t xu = xq < 0 ? 0 : (uint32_t)xq;
+		uint32_t x0 = min_u32(xu >> 16, max_x);
+		uint32_t x1 = min_u32(x0 + 1, max_x);
+		uint32_t fx = (xu >> 8) & 0xFF;
+		uint32_t p00 = row0[x0], p01 = row0[x1];
+		uint32_t p10 = row1[x0], p11 = row1[x1];
+		uint32_t r = lerp2(p00 >> 11, p01 >> 11, p10 >> 11, p11 >> 11, fx, fy);
+		uint32_t g = lerp2((p00 >> 5) & 0x3F, (p01 >> 5) & 0x3F,
+				   (p10 >> 5) & 0x3F, (p11 >> 5) & 0x3F, fx, fy);
+		uint32_t b = lerp2(p00 & 0x1F, p01 & 0x1F, p10 & 0x1F, p11 & 0x1F, fx, fy);
+
+		dst[i] = (uint16_t)((r << 11) | (g << 5) | b);
+		xq += (int32_t)step;
+	}
+}
+
+void pix_blend_rgb565_ref(uint16_t *dst, const uint16_t *fg, const uint16_t *bg,
+			  uint8_t alpha, size_t n)
+{
+	uint32_t a = alpha + (alpha >> 7);
+	uint32_t ia = 256 - a;
+
+	for (size_t i = 0; i < n; i++) {
+		uint32_t f = fg[i], b = bg[i];
+		uint32_t r = ((f >> 11) * a + (b >> 11) * ia) >> 8;
+		uint32_t g = (((f >> 5) & 0x3F) * a + ((b >> 5) & 0x3F) * ia) >> 8;
+		uint32_t bl = ((f & 0x1F) * a + (b & 0x1F) * ia) >> 8;
+
+		dst[i] = (uint16_t)((r << 11) | (g << 5) | bl);
+	}
+}
+
+void pix_fill_rgb565_ref(uint16_t *dst, uint16_t color, size_t n)
+{
+	for (size_t i = 0; i < n; i++) {
+		dst[i] = color;
+	}
+}
+
+/* ---- Frame helpers ---- */
+
+void pix_yuv420_to_rgb565(uint16_t *dst, size_t dst_pitch, const uint8_t *y,
+			  const uint8_t *u, const uint8_t *v, size_t width,
+			  size_t height)
+{
+	size_t cw = (width + 1) / 2;
+
+	for (size_t row = 0; row < height; row++) {
+		pix_yuv420_row_to_rgb565(&dst[row * dst_pitch], &y[row * width],
+					 &u[(row >> 1) * cw], &v[(row >> 1) * cw], width);
+	}
+}
+
+void pix_scale_bilinear_rgb565(uint16_t *dst, size_t dst_pitch, size_t dst_w,
+			       size_t dst_h, const uint16_t *src, size_t src_pitch,
+			       size_t src_w, size_t src_h)
+{
+	uint32_t step = PIX_STEP(src_h, dst_h);
+	int32_t yq = (int32_t)(step >> 1) - 32768;
+
+	for (size_t row = 0; row < dst_h; row++) {
+		uint32_t yu = yq < 0 ? 0 : (uint32_t)yq;
+		uint32_t y0 = min_u32(yu >> 16, src_h - 1);
+		uint32_t y1 = min_u32(y0 + 1, src_h - 1);
+
+		pix_scale_bilinear_row(&dst[row * dst_pitch], dst_w, &src[y0 * src_pitch],
+				       &src[y1 * src_pitch], src_w, (yu >> 8) & 0xFF);
+		yq += (int32_t)step;
+	}
+}
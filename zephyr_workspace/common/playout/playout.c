@@ -0,0 +1,360 @@
+/*
+ * Receive-side playout engine (see playout.h)
+ */
+
+#include "playout.h"
+
+#include <string.h>
+
+/* Drift is not fed forward until the window minima are this far apart */
+#define DRIFT_SPAN_MIN_US 8000000u
+
+/* Control bands on (offset - target) */
+#define SLIP_BAND_US  (PLAYOUT_FRAME_US / 4)
+#define HOLD_BAND_US  PLAYOUT_FRAME_US
+#define SKIP_BAND_US  (2 * PLAYOUT_FRAME_US)
+
+#define PPB 1000000000ll
+
+void playout_init(struct playout *p, const struct playout_cfg *cfg)
+{
+	memset(p, 0, sizeof(*p));
+	p->cfg = *cfg;
+	if (p->cfg.max_frames >= PLAYOUT_SLOTS) {
+		p->cfg.max_frames = PLAYOUT_SLOTS - 1;
+	}
+	if (p->cfg.min_frames > p->cfg.max_frames) {
+		p->cfg.min_frames = p->cfg.max_frames;
+	}
+	if (p->cfg.window_frames < PLAYOUT_SUBWIN) {
+		p->cfg.window_frames = PLAYOUT_SUBWIN;
+	}
+	if (!p->cfg.conceal) {
+		p->cfg.conceal = playout_conceal_fade;
+	}
+	p->cur_min = INT32_MAX;
+	p->cur_max = INT32_MIN;
+}
+
+void playout_conceal_fade(void *user, int16_t *out, const int16_t *last, uint32_t missing)
+{
+	for (int i = 0; i < PLAYOUT_FRAME; i++) {
+		out[i] = (missing >= 4) ? 0 : last[i] / 2;
+	}
+}
+
+/* ---- Transit window and drift ---- */
+
+/* Called as each sub-window closes. The minimum over the whole window,
+ * rather than the sub-window's own, rides out a burst of interference
+ * shorter than the window; the reference waits for the first full one.
+ */
+static void drift_update(struct playout *p, uint32_t now_us)
+{
+	int32_t win_min = p->sub_min[0];
+
+	if (p->sub_filled < PLAYOUT_SUBWIN) {
+		return;
+	}
+	for (int i = 1; i < PLAYOUT_SUBWIN; i++) {
+		if (p->sub_min[i] < win_min) {
+			win_min = p->sub_min[i];
+		}
+	}
+
+	if (!p->drift_ref) {
+		p->drift_ref = true;
+		p->drift_ref_min = win_min;
+		return;
+	}
+
+	/* Span kept in 64 bits so the estimate outlives the u32 clock wrap */
+	p->drift_span_us += now_us - p->drift_last_us;
+	if (p->drift_span_us >= DRIFT_SPAN_MIN_US) {
+		p->drift_ppb = (int32_t)((int64_t)(win_min - p->drift_ref_min) * PPB /
+					 (int64_t)p->drift_span_us);
+	}
+}
+
+static void window_add(struct playout *p, int32_t transit, uint32_t now_us)
+{
+	if (transit < p->cur_min) {
+		p->cur_min = transit;
+	}
+	if (transit > p->cur_max) {
+		p->cur_max = transit;
+	}
+
+	if (++p->sub_count < p->cfg.window_frames / PLAYOUT_SUBWIN) {
+		return;
+	}
+
+	p->sub_min[p->sub_idx] = p->cur_min;
+	p->sub_max[p->sub_idx] = p->cur_max;
+	p->sub_idx = (p->sub_idx + 1) % PLAYOUT_SUBWIN;
+	if (p->sub_filled < PLAYOUT_SUBWIN) {
+		p->sub_filled++;
+	}
+	drift_update(p, now_us);
+	p->drift_last_us = now_us;
+
+	p->cur_min = INT32_MAX;
+	p->cur_max = INT32_MIN;
+	p->sub_count = 0;
+}
+
+/* Minimum and maximum transit over the completed sub-windows and the
+ * open one
+ */
+static void window_range(const struct playout *p, int32_t *min, int32_t *max)
+{
+	int32_t lo = p->cur_min;
+	int32_t hi = p->cur_max;
+
+	for (int i = 0; i < p->sub_filled; i++) {
+		if (p->sub_min[i] < lo) {
+			lo = p->sub_min[i];
+		}
+		if (p->sub_max[i] > hi) {
+			hi = p->sub_max[i];
+		}
+	}
+	*min = lo;
+	*max = hi;
+}
+
+static int32_t target_us(const struct playout *p, int32_t spread)
+{
+	/* A frame is due up to one frame before its own play time, since
+	 * a pull writes the next 16 ms at once; the slip band sits on top
+	 */
+	int32_t t = spread + PLAYOUT_FRAME_US + SLIP_BAND_US;
+
+	if (t < p->cfg.min_frames * PLAYOUT_FRAME_US) {
+		t = p->cfg.min_frames * PLAYOUT_FRAME_US;
+	}
+	if (t > p->cfg.max_frames * PLAYOUT_FRAME_US) {
+		t = p->cfg.max_frames * PLAYOUT_FRAME_US;
+	}
+	return t;
+}
+
+/* Sender time of a frame, from the newest one and the nominal period */
+static uint32_t ts_of(const struct playout *p, uint16_t seq)
+{
+	return p->newest_ts - (int32_t)(int16_t)(p->newest_seq - seq) * PLAYOUT_FRAME_US;
+}
+
+/* Sender time of the next sample out */
+static uint32_t ts_play(const struct playout *p)
+{
+	if (p->state != PLAYOUT_PLAYING) {
+		return ts_of(p, p->next_seq);
+	}
+	return ts_of(p, p->cur_seq) + p->pos * PLAYOUT_SAMPLE_US;
+}
+
+/* Delay of the next sample out above the fastest frame in the window */
+static int32_t offset_us(const struct playout *p, uint32_t now_us, int32_t win_min)
+{
+	return (int32_t)(now_us - ts_play(p) - p->transit_base) - win_min;
+}
+
+/* ---- Receive ---- */
+
+void playout_put(struct playout *p, uint16_t seq, uint32_t ts_us, uint32_t arrival_us,
+		 const int16_t *pcm)
+{
+	struct playout_slot *slot;
+	int32_t transit;
+	int16_t ahead;
+
+	if (p->state == PLAYOUT_IDLE) {
+		p->transit_base = arrival_us - ts_us;
+		p->transit_prev = 0;
+		p->newest_seq = seq;
+		p->newest_ts = ts_us;
+		p->next_seq = seq;
+		p->state = PLAYOUT_PREFILL;
+	} else if ((int16_t)(seq - p->newest_seq) > 0) {
+		p->newest_seq = seq;
+		p->newest_ts = ts_us;
+	}
+
+	/* Relative to the first frame, so spreads cannot overflow */
+	transit = (int32_t)(arrival_us - ts_us - p->transit_base);
+	if (p->frames_in > 0) {
+		int32_t d = transit - p->transit_prev;
+
+		/* J += (|D| - J) / 16, with J held x 16 */
+		p->jitter_q4 += (uint32_t)(d < 0 ? -d : d) - ((p->jitter_q4 + 8) >> 4);
+	}
+	p->transit_prev = transit;
+	p->frames_in++;
+	window_add(p, transit, arrival_us);
+
+	ahead = (int16_t)(seq - p->next_seq);
+	if (ahead < 0) {
+		p->late++;
+		return;
+	}
+	if (ahead >= PLAYOUT_SLOTS) {
+		/* The ring is full of the past: give up the oldest frames
+		 * until this one fits
+		 */
+		while ((int16_t)(seq - p->next_seq) >= PLAYOUT_SLOTS) {
+			p->slot[p->next_seq % PLAYOUT_SLOTS].full = false;
+			p->next_seq++;
+			p->overruns++;
+		}
+	}
+
+	slot = &p->slot[seq % PLAYOUT_SLOTS];
+	if (slot->full && slot->seq == seq) {
+		p->dups++;
+		return;
+	}
+	slot->seq = seq;
+	slot->full = true;
+	slot->arrival_us = arrival_us;
+	memcpy(slot->pcm, pcm, sizeof(slot->pcm));
+}
+
+/* ---- Playout ---- */
+
+static void conceal(struct playout *p)
+{
+	p->cfg.conceal(p->cfg.user, p->spare, p->cur, ++p->missing);
+	memcpy(p->cur, p->spare, sizeof(p->cur));
+	p->concealed++;
+}
+
+/* Make next_seq the current frame, from the buffer or the conceal hook */
+static void load_next(struct playout *p, uint32_t now_us)
+{
+	struct playout_slot *slot = &p->slot[p->next_seq % PLAYOUT_SLOTS];
+
+	if (slot->full && slot->seq == p->next_seq) {
+		uint32_t wait = now_us - slot->arrival_us;
+
+		memcpy(p->cur, slot->pcm, sizeof(p->cur));
+		slot->full = false;
+		p->missing = 0;
+		p->played++;
+		p->wait_sum_us += wait;
+		p->wait_n++;
+		if (wait > p->wait_max_us) {
+			p->wait_max_us = wait;
+		}
+	} else {
+		/* A hole with later frames behind it is a loss; with none
+		 * the buffer has run dry
+		 */
+		if ((int16_t)(p->newest_seq - p->next_seq) <= 0) {
+			p->underruns++;
+		}
+		conceal(p);
+	}
+	p->cur_seq = p->next_seq++;
+	p->pos = 0;
+}
+
+enum playout_state playout_pull(struct playout *p, uint32_t now_us, int16_t *out)
+{
+	int32_t lo, hi, err;
+	int adj = 0;
+
+	if (p->state == PLAYOUT_IDLE) {
+		memset(out, 0, PLAYOUT_FRAME * sizeof(*out));
+		return p->state;
+	}
+
+	window_range(p, &lo, &hi);
+	err = offset_us(p, now_us, lo) - target_us(p, hi - lo);
+
+	if (p->state == PLAYOUT_PREFILL) {
+		if (err < 0) {
+			memset(out, 0, PLAYOUT_FRAME * sizeof(*out));
+			return p->state;
+		}
+		/* Start on next_seq; the first sample loads it */
+		p->state = PLAYOUT_PLAYING;
+		p->cur_seq = p->next_seq - 1;
+		p->pos = PLAYOUT_FRAME;
+		err = 0;
+	}
+
+	if (err < -HOLD_BAND_US) {
+		/* Too little delay: hold the position for one frame */
+		conceal(p);
+		p->held++;
+		memcpy(out, p->cur, PLAYOUT_FRAME * sizeof(*out));
+		return p->state;
+	}
+	if (err > SKIP_BAND_US) {
+		/* Too much: drop the next frame, here or not */
+		p->slot[p->next_seq % PLAYOUT_SLOTS].full = false;
+		p->next_seq++;
+		p->skipped++;
+	} else {
+		/* Drift fed forward, in billionths of a sample */
+		p->slip_acc += (int64_t)p->drift_ppb * PLAYOUT_FRAME;
+		if (p->slip_acc >= PPB) {
+			p->slip_acc -= PPB;
+			adj = -1;
+		} else if (p->slip_acc <= -PPB) {
+			p->slip_acc += PPB;
+			adj = 1;
+		}
+
+		if (adj == 0 && err > SLIP_BAND_US) {
+			adj = 1;
+		} else if (adj == 0 && err < -SLIP_BAND_US) {
+			adj = -1;
+		}
+	}
+
+	/* adj -1 repeats one sample, +1 drops one */
+	for (int i = 0; i < PLAYOUT_FRAME; i++) {
+		if (p->pos >= PLAYOUT_FRAME) {
+			load_next(p, now_us);
+		}
+		out[i] = p->cur[p->pos];
+
+		if (i == PLAYOUT_FRAME / 2 && adj < 0) {
+			p->slips_repeat++;
+			continue;
+		}
+		p->pos++;
+		if (i == PLAYOUT_FRAME / 2 && adj > 0) {
+			if (p->pos >= PLAYOUT_FRAME) {
+				load_next(p, now_us);
+			}
+			p->pos++;
+			p->slips_drop++;
+		}
+	}
+	return p->state;
+}
+
+void playout_status(const struct playout *p, uint32_t now_us, struct playout_status *s)
+{
+	int32_t lo, hi;
+
+	memset(s, 0, sizeof(*s));
+	if (p->state == PLAYOUT_IDLE) {
+		return;
+	}
+
+	window_range(p, &lo, &hi);
+	s->spread_us = hi - lo;
+	s->target_us = target_us(p, s->spread_us);
+	s->offset_us = offset_us(p, now_us, lo);
+	s->jitter_us = p->jitter_q4 >> 4;
+	s->depth_us = (int32_t)(ts_of(p, p->newest_seq) + PLAYOUT_FRAME_US - ts_play(p));
+	if (s->depth_us < 0) {
+		s->depth_us = 0;
+	}
+	s->drift_ppb = p->drift_ppb;
+	s->play_ts_us = ts_play(p);
+}
@@ -0,0 +1,172 @@
+/*
+ * Receive-side playout engine: an adaptive jitter buffer and playout
+ * clock for 16 ms PCM frames that arrive over BLE.
+ *
+ * Frames go in with the sender's capture time (audio_pkt ts_us) and the
+ * local arrival time; frames come out once per local 16 ms tick. Frame
+ * k plays at ts_k + offset on the local clock. The engine steers the
+ * offset towards the smallest one that every frame of the last window
+ * would have met:
+ *
+ *   transit   = arrival - ts        (clock offset + air + queueing)
+ *   target    = min transit + max(spread + 1.25 frames, min depth)
+ *   spread    = max transit - min transit over the window
+ *
+ * A longer spread raises the target at once; a calmer link lowers it
+ * only once the window has passed. Small errors are taken up by
+ * dropping or repeating one sample per frame, large ones by skipping a
+ * frame or holding with a concealed one.
+ *
+ * The two clocks drift apart: when the sender's runs slow, every frame
+ * arrives a little later than the last. The slope of the window
+ * minimum of transit gives the drift, which is fed forward as
+ * sample slips so the depth does not have to sag before it is
+ * corrected.
+ *
+ * A frame missing when it is due is concealed through a hook; frames
+ * that turn up after their slot has played are counted late and
+ * dropped.
+ *
+ * Pure C with no kernel calls: the caller passes in the times, which
+ * is what lets audio_dsp_test run it on a host.
+ */
+
+#ifndef COMMON_PLAYOUT_H_
+#define COMMON_PLAYOUT_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define PLAYOUT_FRAME     128   /* samples per frame, 16 ms at 8 kHz */
+#define PLAYOUT_FRAME_US  16000
+#define PLAYOUT_SAMPLE_US 125
+
+#if defined(CONFIG_PLAYOUT_SLOTS)
+#define PLAYOUT_SLOTS CONFIG_PLAYOUT_SLOTS
+#else
+#define PLAYOUT_SLOTS 16
+#endif
+
+/* A power of two, so slots stay put across the u16 sequence wrap */
+#if (PLAYOUT_SLOTS & (PLAYOUT_SLOTS - 1)) != 0
+#error "PLAYOUT_SLOTS must be a power of two"
+#endif
+
+#define PLAYOUT_SUBWIN 4   /* jitter window sub-windows */
+
+/* Fill out with a stand-in for a frame that did not arrive. last is
+ * the frame played before it (real or concealed) and missing counts
+ * the frames concealed in a row, this one included.
+ */
+typedef void (*playout_conceal_fn)(void *user, int16_t *out, const int16_t *last,
+				   uint32_t missing);
+
+struct playout_cfg {
+	uint8_t min_frames;      /* target never below this */
+	uint8_t max_frames;      /* or above this; < PLAYOUT_SLOTS */
+	uint16_t window_frames;  /* jitter window, split into PLAYOUT_SUBWIN */
+	playout_conceal_fn conceal;  /* NULL: playout_conceal_fade */
+	void *user;
+};
+
+struct playout_slot {
+	uint16_t seq;
+	bool full;
+	uint32_t arrival_us;
+	int16_t pcm[PLAYOUT_FRAME];
+};
+
+enum playout_state {
+	PLAYOUT_IDLE,     /* nothing received yet */
+	PLAYOUT_PREFILL,  /* waiting for the first frame's play time */
+	PLAYOUT_PLAYING,
+};
+
+struct playout {
+	struct playout_cfg cfg;
+	struct playout_slot slot[PLAYOUT_SLOTS];
+	enum playout_state state;
+
+	/* Sender timeline, from the newest frame */
+	uint16_t newest_seq;
+	uint32_t newest_ts;
+
+	/* Play position: sample pos of frame cur_seq, next_seq to load */
+	int16_t cur[PLAYOUT_FRAME];
+	int16_t spare[PLAYOUT_FRAME];
+	uint16_t cur_seq;
+	uint16_t next_seq;
+	uint16_t pos;
+	uint32_t missing;
+
+	/* Transit window, relative to the first frame's */
+	uint32_t transit_base;
+	int32_t transit_prev;
+	uint32_t jitter_q4;      /* RFC 3550 interarrival jitter, us x 16 */
+	int32_t cur_min;
+	int32_t cur_max;
+	int32_t sub_min[PLAYOUT_SUBWIN];
+	int32_t sub_max[PLAYOUT_SUBWIN];
+	uint16_t sub_count;
+	uint8_t sub_idx;
+	uint8_t sub_filled;
+	uint32_t frames_in;
+
+	/* Drift: window minimum now against the first one */
+	bool drift_ref;
+	int32_t drift_ref_min;
+	uint32_t drift_last_us;
+	uint64_t drift_span_us;
+	int32_t drift_ppb;
+	int64_t slip_acc;        /* fed-forward samples x 1e9 */
+
+	/* Counters since init; the caller may zero them between reports */
+	uint32_t played;         /* frames played as received */
+	uint32_t concealed;      /* frames played from the conceal hook */
+	uint32_t underruns;      /* concealed with nothing newer buffered */
+	uint32_t late;           /* arrived after their slot played */
+	uint32_t overruns;       /* dropped unplayed to make room in the ring */
+	uint32_t dups;
+	uint32_t skipped;        /* frames dropped to cut the delay */
+	uint32_t held;           /* concealed frames added to raise it */
+	uint32_t slips_drop;
+	uint32_t slips_repeat;
+
+	/* Time frames waited in the buffer */
+	uint64_t wait_sum_us;
+	uint32_t wait_max_us;
+	uint32_t wait_n;
+};
+
+/* Snapshot for a report line */
+struct playout_status {
+	int32_t target_us;    /* wanted delay above the fastest frame */
+	int32_t offset_us;    /* current delay above the fastest frame */
+	int32_t spread_us;    /* transit spread over the window */
+	uint32_t jitter_us;   /* RFC 3550 estimate */
+	int32_t depth_us;     /* received audio not yet played */
+	int32_t drift_ppb;    /* + : the sender's clock runs slow */
+	uint32_t play_ts_us;  /* sender time of the next sample out */
+};
+
+void playout_init(struct playout *p, const struct playout_cfg *cfg);
+
+/* One received frame: seq and ts_us from the sender, arrival_us on the
+ * local clock that also drives playout_pull()
+ */
+void playout_put(struct playout *p, uint16_t seq, uint32_t ts_us, uint32_t arrival_us,
+		 const int16_t *pcm);
+
+/* One local 16 ms tick: write PLAYOUT_FRAME samples to out (silence
+ * until the first frame is due) and return the state after the tick
+ */
+enum playout_state playout_pull(struct playout *p, uint32_t now_us, int16_t *out);
+
+void playout_status(const struct playout *p, uint32_t now_us, struct playout_status *s);
+
+/* Default conceal hook: repeat the last frame, 6 dB quieter for each
+ * frame in a row, and silence from the fourth
+ */
+void playout_conceal_fade(void *user, int16_t *out, const int16_t *last, uint32_t missing);
+
+#endif /* COMMON_PLAYOUT_H_ */
@@ -0,0 +1,165 @@
+#!/usr/bin/env python3
+"""
+Symbolise a common/profiler console dump and emit folded stacks.
+
+Reads the PROF_BEGIN ... PROF_END block from a serial capture, maps each
+PC and return address to a function in zephyr.elf (via nm) and writes
+one "thread;caller;function count" line per unique stack - the input
+format of flamegraph.pl and speedscope.
+
+Usage:
+    # M33 app core
+    python3 prof_fold.py m33_console.log \\
+        --elf ../../nrf54l15_dual_core_test/build/nrf54l15_dual_core_test/zephyr/zephyr.elf \\
+        -o m33.folded
+    flamegraph.pl m33.folded > m33.svg
+
+    # FLPR (RISC-V) - separate console, separate ELF
+    python3 prof_fold.py flpr_console.log \\
+        --elf ../../nrf54l15_dual_core_test/build/cpuflpr/zephyr/zephyr.elf -o flpr.folded
+
+The return address is exact for leaf functions and best-effort for
+non-leaf ones (LR/RA may already have been reused), so the caller
+frame should be read as a hint.
+"""
+
+import argparse
+import bisect
+import collections
+import glob
+import os
+import re
+import shutil
+import subprocess
+import sys
+
+BEGIN_RE = re.compile(r"PROF_BEGIN arch=(\S+) board=(\S+) rate=(\d+) samples=(\d+) isr=(\d+)")
+THREAD_RE = re.compile(r"PROF_THREAD ([0-9a-f]{8}) (.+)$")
+SAMPLE_RE = re.compile(r"PROF ([0-9a-f]{8}) ([0-9a-f]{8}) ([0-9a-f]{8})")
+
+NM_PREFIXES = {
+    "arm": ["arm-zephyr-eabi-", "arm-none-eabi-"],
+    "riscv": ["riscv64-zephyr-elf-", "riscv32-zephyr-elf-", "riscv64-unknown-elf-"],
+}
+
+
+def find_nm(arch):
+    """Locate a cross nm for arch on PATH or in the Zephyr SDK, else host nm."""
+    sdk = os.environ.get("ZEPHYR_SDK_INSTALL_DIR", "")
+    for prefix in NM_PREFIXES.get(arch, []):
+        tool = shutil.which(prefix + "nm")
+        if tool:
+            return tool
+        if sdk:
+            hits = glob.glob(os.path.join(sdk, "*", "bin", prefix + "nm"))
+            if hits:
+                return hits[0]
+    return shutil.which("llvm-nm") or "nm"
+
+
+class Symbolizer:
+    def __init__(self, elf, nm):
+        out = subprocess.run([nm, "-n", "-S", "--defined-only", elf],
+                             capture_output=True, text=True, check=True).stdout
+        self.addrs = []
+        self.entries = []
+        for line in out.splitlines():
+            parts = line.split()
+            if len(parts) == 4 and parts[2] in "tTwW":
+                addr, size, name = int(parts[0], 16), int(parts[1], 16), parts[3]
+            elif len(parts) == 3 and parts[1] in "tTwW":
+                addr, size, name = int(parts[0], 16), 0, parts[2]
+            else:
+                continue
+            self.addrs.append(addr & ~1)
+            self.entries.append((addr & ~1, size, name))
+
+    def lookup(self, addr):
+        addr &= ~1
+        i = bisect.bisect_right(self.addrs, addr) - 1
+        if i < 0:
+            return None
+        start, size, name = self.entries[i]
+        if size and addr >= start + size:
+            return None
+        return name
+
+
+def parse_dump(lines):
+    """Return (meta, {thread: name}, [(thread, pc, ra)]) for the last dump."""
+    meta, threads, samples = None, {}, []
+    for line in lines:
+        m = BEGIN_RE.search(line)
+        if m:
+            meta = {"arch": m.group(1), "board": m.group(2), "rate": int(m.group(3)),
+                    "samples": int(m.group(4)), "isr": int(m.group(5))}
+            threads, samples = {}, []
+            continue
+        if meta is None:
+            continue
+        m = THREAD_RE.search(line)
+        if m:
+            threads[int(m.group(1), 16)] = m.group(2).strip()
+            continue
+        m = SAMPLE_RE.search(line)
+        if m:
+            samples.append(tuple(int(g, 16) for g in m.groups()))
+    return meta, threads, samples
+
+
+def valid_return_address(arch, ra):
+    # EXC_RETURN values and null are not code addresses
+    return ra != 0 and not (arch == "arm" and ra >= 0xFFFFFF00)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Fold profiler samples for flame graphs")
+    parser.add_argument("log", help="Console capture containing a PROF_BEGIN/PROF_END block")
+    parser.add_argument("--elf", required=True, help="zephyr.elf of the profiled core")
+    parser.add_argument("--nm", help="nm to use (default: toolchain nm for the dump's arch)")
+    parser.add_argument("--no-caller", action="store_true", help="Only fold thread;function")
+    parser.add_argument("-o", "--output", help="Folded stacks output (default: stdout)")
+    args = parser.parse_args()
+
+    with open(args.log, errors="replace") as f:
+        meta, threads, samples = parse_dump(f)
+
+    if meta is None or not samples:
+        print("ERROR: no PROF_BEGIN/PROF samples found", file=sys.stderr)
+        return 1
+
+    sym = Symbolizer(args.elf, args.nm or find_nm(meta["arch"]))
+    folded = collections.Counter()
+    functions = collections.Counter()
+
+    for thread, pc, ra in samples:
+        if thread == 0:
+            folded["[isr]"] += 1
+            continue
+        tname = threads.get(thread, f"thread_{thread:08x}")
+        func = sym.lookup(pc) or f"0x{pc:08x}"
+        stack = [tname]
+        if not args.no_caller and valid_return_address(meta["arch"], ra):
+            caller = sym.lookup(ra)
+            if caller and caller != func:
+                stack.append(caller)
+        stack.append(func)
+        folded[";".join(stack)] += 1
+        functions[func] += 1
+
+    out = open(args.output, "w") if args.output else sys.stdout
+    for stack, count in sorted(folded.items()):
+        out.write(f"{stack} {count}\n")
+    if args.output:
+        out.close()
+
+    total = len(samples)
+    print(f"{meta['board']} ({meta['arch']}): {total} samples at {meta['rate']} Hz, "
+          f"{meta['isr']} in ISRs", file=sys.stderr)
+    for func, count in functions.most_common(15):
+        print(f"  {count * 100.0 / total:5.1f}%  {func}", file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
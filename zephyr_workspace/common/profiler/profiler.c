@@ -0,0 +1,185 @@
+/*
+ * Timer-driven sampling profiler
+ *
+ * The k_timer expiry runs in the system timer ISR, so the interrupted
+ * context is recovered from the exception state:
+ *
+ * Cortex-M33: when SCB->ICSR.RETTOBASE is set the timer ISR is the only
+ * active exception, i.e. it interrupted a thread. The hardware-stacked
+ * basic frame {r0-r3, r12, lr, pc, xpsr} is at the bottom of PSP.
+ *
+ * RISC-V (FLPR): the ISR wrapper pushes the arch_esf on the thread
+ * stack, switches to the interrupt stack and stores the old sp in the
+ * first slot below irq_stack. nested == 1 means a thread was
+ * interrupted.
+ *
+ * Samples taken while another ISR was running are counted as "isr"
+ * without a PC; their frame is on MSP / the IRQ stack at an unknown
+ * depth.
+ *
+ * The automatic dump on a full buffer prints for seconds, so it runs
+ * on a private work queue at the lowest application priority rather
+ * than the system workqueue, which the BT host needs while streaming.
+ */
+
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/kernel_structs.h>
+#include <zephyr/sys/printk.h>
+
+#if defined(CONFIG_ARM)
+#include <cmsis_core.h>
+#endif
+
+#include "profiler.h"
+
+struct prof_sample {
+	uint32_t pc;
+	uint32_t ra;
+	uint32_t thread;
+};
+
+static struct prof_sample samples[CONFIG_PROFILER_MAX_SAMPLES];
+static volatile uint32_t sample_count;
+static volatile uint32_t isr_count;
+static uint32_t sample_rate_hz;
+static volatile bool running;
+
+static void prof_timer_handler(struct k_timer *timer);
+static void prof_dump_work_handler(struct k_work *work);
+
+static K_TIMER_DEFINE(prof_timer, prof_timer_handler, NULL);
+static K_WORK_DEFINE(prof_dump_work, prof_dump_work_handler);
+static K_THREAD_STACK_DEFINE(prof_dump_stack, CONFIG_PROFILER_DUMP_STACK_SIZE);
+static struct k_work_q prof_dump_q;
+
+static bool interrupted_thread_context(uint32_t *pc, uint32_t *ra)
+{
+#if defined(CONFIG_ARM)
+	if (SCB->ICSR & SCB_ICSR_RETTOBASE_Msk) {
+		const uint32_t *frame = (const uint32_t *)__get_PSP();
+
+		*ra = frame[5];
+		*pc = frame[6];
+		return true;
+	}
+	return false;
+#elif defined(CONFIG_RISCV)
+	if (_current_cpu->nested == 1) {
+		const struct arch_esf *esf =
+			*(const struct arch_esf **)(_current_cpu->irq_stack - 16);
+
+		*pc = esf->mepc;
+		*ra = esf->ra;
+		return true;
+	}
+	return false;
+#else
+	return false;
+#endif
+}
+
+static void prof_timer_handler(struct k_timer *timer)
+{
+	uint32_t n = sample_count;
+	struct prof_sample *s;
+
+	if (n >= CONFIG_PROFILER_MAX_SAMPLES) {
+		return;
+	}
+
+	s = &samples[n];
+	if (interrupted_thread_context(&s->pc, &s->ra)) {
+		s->thread = (uint32_t)(uintptr_t)k_current_get();
+	} else {
+		s->pc = 0;
+		s->ra = 0;
+		s->thread = 0;
+		isr_count++;
+	}
+	sample_count = n + 1;
+
+	if (sample_count == CONFIG_PROFILER_MAX_SAMPLES) {
+		k_timer_stop(&prof_timer);
+		running = false;
+		k_work_submit_to_queue(&prof_dump_q, &prof_dump_work);
+	}
+}
+
+int profiler_start(uint32_t rate_hz)
+{
+	uint32_t period_us;
+
+	if (running) {
+		return -EBUSY;
+	}
+
+	sample_rate_hz = rate_hz ? rate_hz : CONFIG_PROFILER_RATE_HZ;
+	period_us = MAX(1000000U / sample_rate_hz, 1U);
+
+	sample_count = 0;
+	isr_count = 0;
+	running = true;
+	k_timer_start(&prof_timer, K_USEC(period_us), K_USEC(period_us));
+
+	printk("Profiler started: %u Hz, %u samples\n", sample_rate_hz,
+	       CONFIG_PROFILER_MAX_SAMPLES);
+	return 0;
+}
+
+void profiler_stop(void)
+{
+	k_timer_stop(&prof_timer);
+	running = false;
+}
+
+bool profiler_running(void)
+{
+	return running;
+}
+
+static void print_thread(const struct k_thread *thread, void *user_data)
+{
+	const char *name = k_thread_name_get((k_tid_t)thread);
+
+	printk("PROF_THREAD %08x %s\n", (uint32_t)(uintptr_t)thread,
+	       (name && name[0]) ? name : "unnamed");
+}
+
+void profiler_dump(void)
+{
+	uint32_t n;
+
+	profiler_stop();
+	n = sample_count;
+
+	printk("PROF_BEGIN arch=%s board=%s rate=%u samples=%u isr=%u\n",
+	       IS_ENABLED(CONFIG_RISCV) ? "riscv" : "arm", CONFIG_BOARD,
+	       sample_rate_hz, n, isr_count);
+
+	k_thread_foreach(print_thread, NULL);
+
+	for (uint32_t i = 0; i < n; i++) {
+		printk("PROF %08x %08x %08x\n", samples[i].thread, samples[i].pc,
+		       samples[i].ra);
+	}
+
+	printk("PROF_END\n");
+}
+
+static void prof_dump_work_handler(struct k_work *work)
+{
+	profiler_dump();
+}
+
+static int prof_dump_q_init(void)
+{
+	const struct k_work_queue_config cfg = { .name = "prof_dump" };
+
+	k_work_queue_start(&prof_dump_q, prof_dump_stack,
+			   K_THREAD_STACK_SIZEOF(prof_dump_stack),
+			   K_LOWEST_APPLICATION_THREAD_PRIO, &cfg);
+	return 0;
+}
+
+SYS_INIT(prof_dump_q_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
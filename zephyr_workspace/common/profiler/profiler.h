@@ -0,0 +1,53 @@
+/*
+ * Timer-driven sampling profiler for the Cortex-M33 app core and the
+ * RISC-V FLPR.
+ *
+ * A k_timer samples the interrupted PC plus the return address (LR/RA)
+ * and the current thread into a RAM buffer. When the buffer fills, or
+ * on profiler_dump(), it is printed over the console:
+ *
+ *   PROF_BEGIN arch=<arm|riscv> board=<board> rate=<hz> samples=<n> isr=<n>
+ *   PROF_THREAD <thread> <name>
+ *   PROF <thread> <pc> <ra>
+ *   PROF_END
+ *
+ * prof_fold.py symbolises the dump against zephyr.elf and emits folded
+ * stacks for flamegraph.pl / speedscope.
+ *
+ * Enable with CONFIG_PROFILER=y (see profile.conf in the apps). Without
+ * it the calls below compile to nothing.
+ */
+
+#ifndef COMMON_PROFILER_H_
+#define COMMON_PROFILER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(CONFIG_PROFILER)
+
+/* Clear the buffer and start sampling at rate_hz (0 = CONFIG_PROFILER_RATE_HZ).
+ * Returns -EBUSY if already running.
+ */
+int profiler_start(uint32_t rate_hz);
+
+/* Stop sampling; the buffer is kept for profiler_dump(). */
+void profiler_stop(void);
+
+/* Stop sampling and print the buffer. Blocks on the console; call it
+ * from thread context at the end of a test.
+ */
+void profiler_dump(void);
+
+bool profiler_running(void);
+
+#else
+
+static inline int profiler_start(uint32_t rate_hz) { (void)rate_hz; return 0; }
+static inline void profiler_stop(void) { }
+static inline void profiler_dump(void) { }
+static inline bool profiler_running(void) { return false; }
+
+#endif /* CONFIG_PROFILER */
+
+#endif /* COMMON_PROFILER_H_ */
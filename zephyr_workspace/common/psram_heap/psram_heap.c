@@ -0,0 +1,259 @@
+/*
+ * PSRAM shared heap (see psram_heap.h).
+ *
+ * mem_attr_heap does the region discovery and allocation; this file
+ * adds the use -> attribute/alignment policy, a live-block table for
+ * byte accounting, and the latency/bandwidth measurements.
+ * shared_multi_heap is not locked internally, so every heap call is
+ * made under heap_lock.
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/kernel.h>
+#include <zephyr/mem_mgmt/mem_attr_heap.h>
+#include <zephyr/dt-bindings/memory-attr/memory-attr-sw.h>
+#include <zephyr/sys/printk.h>
+
+#include "psram_heap.h"
+
+#define CACHE_LINE     32U
+#define FB_ALIGN       128U /* DC fetches 128-byte bursts (stride 832 px) */
+
+#define HAVE_CACHED_POOL  DT_NODE_EXISTS(DT_NODELABEL(psram_cached))
+#define HAVE_NOCACHE_POOL DT_NODE_EXISTS(DT_NODELABEL(psram_nocache))
+
+/* Must match the DT_MEM_SW() bits in psram_regions.dtsi exactly:
+ * shared_multi_heap selects a pool by the full attribute value.
+ */
+static const uint32_t pool_attr[PSRAM_POOL_COUNT] = {
+	[PSRAM_POOL_CACHED] = DT_MEM_SW_ALLOC_CACHE,
+	[PSRAM_POOL_NOCACHE] = DT_MEM_SW_ALLOC_NON_CACHE | DT_MEM_SW_ALLOC_DMA,
+};
+
+static const char *const pool_name[PSRAM_POOL_COUNT] = {
+	[PSRAM_POOL_CACHED] = "cached",
+	[PSRAM_POOL_NOCACHE] = "nocache",
+};
+
+struct psram_block {
+	void *ptr;
+	size_t size;
+	uint8_t pool;
+};
+
+static struct psram_block blocks[CONFIG_PSRAM_HEAP_MAX_BLOCKS];
+static struct psram_pool_stats stats[PSRAM_POOL_COUNT];
+static K_MUTEX_DEFINE(heap_lock);
+static bool initialized;
+
+static void use_policy(enum psram_use use, enum psram_pool *pool, size_t *align)
+{
+	switch (use) {
+	case PSRAM_USE_FRAMEBUFFER:
+		*pool = PSRAM_POOL_NOCACHE;
+		*align = FB_ALIGN;
+		break;
+	case PSRAM_USE_DMA:
+		*pool = PSRAM_POOL_NOCACHE;
+		*align = CACHE_LINE;
+		break;
+	case PSRAM_USE_CPU:
+	case PSRAM_USE_ASSET_CACHE:
+	default:
+		/* Line-aligned here and line-padded in psram_aligned_alloc()
+		 * so a cached block never shares a line with a neighbour (or
+		 * heap metadata) that might be invalidated independently.
+		 */
+		*pool = PSRAM_POOL_CACHED;
+		*align = CACHE_LINE;
+		break;
+	}
+}
+
+static struct psram_block *find_block(const void *ptr)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(blocks); i++) {
+		if (blocks[i].ptr == ptr) {
+			return &blocks[i];
+		}
+	}
+	return NULL;
+}
+
+int psram_heap_init(void)
+{
+	int ret;
+
+	if (!HAVE_CACHED_POOL && !HAVE_NOCACHE_POOL) {
+		return -ENODEV;
+	}
+
+	ret = mem_attr_heap_pool_init();
+	if (ret < 0 && ret != -EALREADY) {
+		return ret;
+	}
+
+	for (int p = 0; p < PSRAM_POOL_COUNT; p++) {
+		stats[p].lat_min_ns = UINT32_MAX;
+	}
+	initialized = true;
+	return 0;
+}
+
+void *psram_aligned_alloc(enum psram_use use, size_t align, size_t size)
+{
+	enum psram_pool pool;
+	size_t min_align;
+	struct psram_block *blk;
+	struct psram_pool_stats *st;
+	uint32_t t0, lat_ns = 0;
+	void *ptr = NULL;
+
+	if (!initialized || size == 0) {
+		return NULL;
+	}
+
+	use_policy(use, &pool, &min_align);
+	align = MAX(align, min_align);
+	if (pool == PSRAM_POOL_CACHED) {
+		size = ROUND_UP(size, CACHE_LINE);
+	}
+	st = &stats[pool];
+
+	k_mutex_lock(&heap_lock, K_FOREVER);
+
+	blk = find_block(NULL);
+	if (blk != NULL) {
+		t0 = k_cycle_get_32();
+		ptr = mem_attr_heap_aligned_alloc(pool_attr[pool], align, size);
+		lat_ns = k_cyc_to_ns_floor32(k_cycle_get_32() - t0);
+	}
+
+	if (ptr == NULL) {
+		st->failures++;
+		k_mutex_unlock(&heap_lock);
+		return NULL;
+	}
+
+	blk->ptr = ptr;
+	blk->size = size;
+	blk->pool = pool;
+
+	st->allocs++;
+	st->bytes_in_use += size;
+	st->bytes_peak = MAX(st->bytes_peak, st->bytes_in_use);
+	st->lat_min_ns = MIN(st->lat_min_ns, lat_ns);
+	st->lat_max_ns = MAX(st->lat_max_ns, lat_ns);
+	st->lat_sum_ns += lat_ns;
+
+	k_mutex_unlock(&heap_lock);
+	return ptr;
+}
+
+void *psram_alloc(enum psram_use use, size_t size)
+{
+	return psram_aligned_alloc(use, 0, size);
+}
+
+void psram_free(void *ptr)
+{
+	struct psram_block *blk;
+
+	if (ptr == NULL) {
+		return;
+	}
+
+	k_mutex_lock(&heap_lock, K_FOREVER);
+
+	blk = find_block(ptr);
+	if (blk != NULL) {
+		mem_attr_heap_free(ptr);
+		stats[blk->pool].frees++;
+		stats[blk->pool].bytes_in_use -= blk->size;
+		blk->ptr = NULL;
+	}
+
+	k_mutex_unlock(&heap_lock);
+}
+
+int psram_pool_of(const void *ptr)
+{
+	struct psram_block *blk;
+	int pool = -EINVAL;
+
+	k_mutex_lock(&heap_lock, K_FOREVER);
+	blk = find_block(ptr);
+	if (ptr != NULL && blk != NULL) {
+		pool = blk->pool;
+	}
+	k_mutex_unlock(&heap_lock);
+
+	return pool;
+}
+
+void psram_heap_stats(enum psram_pool pool, struct psram_pool_stats *out)
+{
+	k_mutex_lock(&heap_lock, K_FOREVER);
+	*out = stats[pool];
+	k_mutex_unlock(&heap_lock);
+}
+
+void psram_heap_print_stats(void)
+{
+	for (int p = 0; p < PSRAM_POOL_COUNT; p++) {
+		struct psram_pool_stats st;
+
+		psram_heap_stats(p, &st);
+		printk("psram %-7s: allocs=%u frees=%u fail=%u in_use=%u peak=%u",
+		       pool_name[p], st.allocs, st.frees, st.failures,
+		       (unsigned int)st.bytes_in_use, (unsigned int)st.bytes_peak);
+		if (st.allocs > 0) {
+			printk(" alloc_ns min=%u avg=%u max=%u", st.lat_min_ns,
+			       (uint32_t)(st.lat_sum_ns / st.allocs), st.lat_max_ns);
+		}
+		printk("\n");
+	}
+}
+
+static uint32_t kbps(size_t bytes, uint32_t cycles)
+{
+	uint64_t ns = MAX(k_cyc_to_ns_floor64(cycles), 1U);
+
+	return (uint32_t)(((uint64_t)bytes * 1000000000ULL / 1024U) / ns);
+}
+
+int psram_heap_measure_bw(enum psram_pool pool, struct psram_bw *out)
+{
+	const size_t len = CONFIG_PSRAM_HEAP_BW_BYTES;
+	const size_t half = len / 2U;
+	enum psram_use use = pool == PSRAM_POOL_CACHED ? PSRAM_USE_CPU : PSRAM_USE_DMA;
+	uint8_t *buf = psram_alloc(use, len);
+	const volatile uint32_t *rd;
+	uint32_t t0, sum = 0;
+
+	if (buf == NULL) {
+		return -ENOMEM;
+	}
+
+	t0 = k_cycle_get_32();
+	memset(buf, 0x5A, len);
+	out->write_kbps = kbps(len, k_cycle_get_32() - t0);
+
+	rd = (const volatile uint32_t *)buf;
+	t0 = k_cycle_get_32();
+	for (size_t i = 0; i < len / sizeof(uint32_t); i++) {
+		sum += rd[i];
+	}
+	out->read_kbps = kbps(len, k_cycle_get_32() - t0);
+
+	t0 = k_cycle_get_32();
+	memcpy(buf, buf + half, half);
+	out->copy_kbps = kbps(half, k_cycle_get_32() - t0);
+
+	psram_free(buf);
+
+	/* The sweep also keeps the reads live; check it against the fill. */
+	return sum == (uint32_t)(0x5A5A5A5AULL * (len / sizeof(uint32_t))) ? 0 : -EIO;
+}
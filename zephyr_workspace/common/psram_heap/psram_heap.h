@@ -0,0 +1,88 @@
+/*
+ * PSRAM shared heap.
+ *
+ * Thin policy layer over mem_attr_heap: the PSRAM regions declared in
+ * psram_regions.dtsi become two pools (cached, non-cached + DMA), and
+ * callers ask for memory by intended use rather than by attribute:
+ *
+ *   PSRAM_USE_FRAMEBUFFER  non-cached, 128-byte aligned (DC DMA bursts)
+ *   PSRAM_USE_DMA          non-cached, 32-byte aligned (audio rings,
+ *                          peripheral DMA; no cache maintenance needed)
+ *   PSRAM_USE_CPU          cached, 32-byte (cache-line) aligned
+ *   PSRAM_USE_ASSET_CACHE  cached, 32-byte aligned, read-mostly
+ *
+ * Cached blocks are also padded to a whole number of lines, so an
+ * invalidate over one block never reaches into another.
+ *
+ * Every allocation is timed and accounted per pool; psram_heap_stats()
+ * and psram_heap_print_stats() expose counts, bytes in use / peak and
+ * allocation latency. psram_heap_measure_bw() reports write, read and
+ * copy bandwidth of a pool.
+ */
+
+#ifndef COMMON_PSRAM_HEAP_H_
+#define COMMON_PSRAM_HEAP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+enum psram_use {
+	PSRAM_USE_FRAMEBUFFER,
+	PSRAM_USE_DMA,
+	PSRAM_USE_CPU,
+	PSRAM_USE_ASSET_CACHE,
+};
+
+enum psram_pool {
+	PSRAM_POOL_CACHED,
+	PSRAM_POOL_NOCACHE,
+	PSRAM_POOL_COUNT,
+};
+
+struct psram_pool_stats {
+	uint32_t allocs;
+	uint32_t frees;
+	uint32_t failures;
+	size_t bytes_in_use;
+	size_t bytes_peak;
+	uint32_t lat_min_ns;
+	uint32_t lat_max_ns;
+	uint64_t lat_sum_ns;
+};
+
+/* Bandwidth in KB/s (1 KB = 1024 bytes). */
+struct psram_bw {
+	uint32_t write_kbps;
+	uint32_t read_kbps;
+	uint32_t copy_kbps;
+};
+
+/* Register the PSRAM pools. Call once, after the PSRAM is up (the M33
+ * companion initialises SMIF1 before releasing the M55, so any time
+ * after main() starts is fine). Returns 0, or -ENODEV if no pool was
+ * found in devicetree.
+ */
+int psram_heap_init(void);
+
+/* Allocate for `use` with that use's default alignment. */
+void *psram_alloc(enum psram_use use, size_t size);
+
+/* As psram_alloc() with a larger alignment (must be a power of two;
+ * smaller values are raised to the use's default).
+ */
+void *psram_aligned_alloc(enum psram_use use, size_t align, size_t size);
+
+void psram_free(void *ptr);
+
+/* Pool an allocation came from, or -EINVAL if not a PSRAM block. */
+int psram_pool_of(const void *ptr);
+
+void psram_heap_stats(enum psram_pool pool, struct psram_pool_stats *out);
+void psram_heap_print_stats(void);
+
+/* Allocate CONFIG_PSRAM_HEAP_BW_BYTES from `pool`, time memset, a
+ * 32-bit read sweep and a half-to-half memcpy, then free it.
+ */
+int psram_heap_measure_bw(enum psram_pool pool, struct psram_bw *out);
+
+#endif /* COMMON_PSRAM_HEAP_H_ */
@@ -0,0 +1,40 @@
+/*
+ * Per-core busy time from the scheduler's runtime stats
+ * (CONFIG_SCHED_THREAD_USAGE_ALL, selected by CPU_LOAD_STATS).
+ * Used on both ends of the render offload to report utilisation.
+ */
+
+#ifndef COMMON_CPU_LOAD_H_
+#define COMMON_CPU_LOAD_H_
+
+#include <stdint.h>
+#include <zephyr/kernel.h>
+
+struct cpu_load {
+	uint64_t exec;
+	uint64_t idle;
+};
+
+/* Non-idle time since the previous call, per mille. The first call
+ * only takes the baseline and returns 0.
+ */
+static inline uint32_t cpu_load_update(struct cpu_load *l)
+{
+	k_thread_runtime_stats_t s;
+	uint64_t d_exec, d_idle;
+	uint32_t permille = 0;
+
+	if (k_thread_runtime_stats_all_get(&s) != 0) {
+		return 0;
+	}
+	d_exec = s.execution_cycles - l->exec;
+	d_idle = s.idle_cycles - l->idle;
+	if (l->exec != 0U && d_exec > 0U) {
+		permille = (uint32_t)(((d_exec - MIN(d_idle, d_exec)) * 1000U) / d_exec);
+	}
+	l->exec = s.execution_cycles;
+	l->idle = s.idle_cycles;
+	return permille;
+}
+
+#endif /* COMMON_CPU_LOAD_H_ */
@@ -0,0 +1,92 @@
+/*
+ * M55 -> M33 frame decode offload over shared SOCMEM.
+ *
+ * The area at CONFIG_RENDER_IPC_SHARED_ADDR holds two cache lines of
+ * control and two frame slots:
+ *
+ *   +0    struct render_ipc_host    written only by the M55
+ *   +32   struct render_ipc_worker  written only by the M33
+ *   +256  slot 0, then slot 1 (frame_bytes each, 32-byte aligned)
+ *
+ * Each side writes only its own line and cleans it; the other side
+ * invalidates before reading, so neither cache can write back stale
+ * copies of the other's fields. A request is one word per slot,
+ * (seq << 16) | frame, so it is seen atomically; the worker echoes it
+ * into done[] once the slot holds that frame.
+ *
+ * The sequence words are the state; common/ipc_bell is the event. Each
+ * side rings the other after publishing its line and waits on its own
+ * bell, re-reading the words on each wake and at least every
+ * CONFIG_RENDER_IPC_POLL_MS in case a ring is lost.
+ */
+
+#ifndef COMMON_RENDER_IPC_H_
+#define COMMON_RENDER_IPC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/toolchain.h>
+
+#define RENDER_IPC_HOST_MAGIC   0x48504952U /* "RIPH" */
+#define RENDER_IPC_WORKER_MAGIC 0x57504952U /* "RIPW" */
+#define RENDER_IPC_SLOTS        2U
+#define RENDER_IPC_SLOT_BASE    256U
+
+struct render_ipc_host {
+	uint32_t magic;
+	uint32_t blob_addr;   /* VRL1 blob, M55 view */
+	uint32_t blob_size;
+	uint32_t frame_bytes;
+	volatile uint32_t req[RENDER_IPC_SLOTS];
+	uint32_t reserved[2];
+} __aligned(32);
+
+struct render_ipc_worker {
+	uint32_t magic;
+	volatile uint32_t heartbeat;
+	volatile uint32_t done[RENDER_IPC_SLOTS];
+	volatile int32_t status[RENDER_IPC_SLOTS];
+	uint32_t busy_permille; /* M33 non-idle time, last ~1 s */
+	uint32_t decode_us;     /* last decode */
+} __aligned(32);
+
+#define RENDER_IPC_REQ(seq, frame) (((uint32_t)(seq) << 16) | ((frame) & 0xFFFFU))
+#define RENDER_IPC_REQ_FRAME(req)  ((req) & 0xFFFFU)
+
+static inline struct render_ipc_host *render_ipc_host_blk(void)
+{
+	return (struct render_ipc_host *)(uintptr_t)CONFIG_RENDER_IPC_SHARED_ADDR;
+}
+
+static inline struct render_ipc_worker *render_ipc_worker_blk(void)
+{
+	return (struct render_ipc_worker *)(uintptr_t)(CONFIG_RENDER_IPC_SHARED_ADDR + 32U);
+}
+
+static inline uint8_t *render_ipc_slot(uint32_t slot, uint32_t frame_bytes)
+{
+	return (uint8_t *)(uintptr_t)(CONFIG_RENDER_IPC_SHARED_ADDR + RENDER_IPC_SLOT_BASE +
+			   slot * ROUND_UP(frame_bytes, 32U));
+}
+
+/* M55 client (render_ipc_client.c) */
+
+/* Publish the blob and wait up to CONFIG_RENDER_IPC_TIMEOUT_MS for the
+ * worker. Returns 0, -ENODEV (no worker) or -ENOMEM (slots do not fit
+ * the shared area).
+ */
+int render_ipc_init(const void *blob, size_t size, uint32_t frame_bytes);
+
+/* Ask for frame `frame` (< 65536) in `slot`; returns immediately. */
+void render_ipc_request(uint32_t slot, uint32_t frame);
+
+/* Wait for the last request on `slot`. Returns the slot buffer (cache
+ * invalidated), or NULL on timeout or decode error.
+ */
+const uint8_t *render_ipc_wait(uint32_t slot);
+
+/* Snapshot of the worker's status line. */
+void render_ipc_worker_status(struct render_ipc_worker *out);
+
+#endif /* COMMON_RENDER_IPC_H_ */
@@ -0,0 +1,118 @@
+/*
+ * M55 side of the render offload (see render_ipc.h).
+ */
+
+#include <errno.h>
+#include <zephyr/cache.h>
+#include <zephyr/kernel.h>
+
+#include "ipc_bell.h"
+#include "render_ipc.h"
+
+#define POLL K_MSEC(CONFIG_RENDER_IPC_POLL_MS)
+
+static uint32_t frame_bytes;
+static uint16_t seq[RENDER_IPC_SLOTS];
+
+static void worker_refresh(void)
+{
+	(void)sys_cache_data_invd_range(render_ipc_worker_blk(),
+					sizeof(struct render_ipc_worker));
+}
+
+int render_ipc_init(const void *blob, size_t size, uint32_t bytes)
+{
+	struct render_ipc_host *h = render_ipc_host_blk();
+	struct render_ipc_worker *w = render_ipc_worker_blk();
+	int64_t deadline = k_uptime_get() + CONFIG_RENDER_IPC_TIMEOUT_MS;
+
+	BUILD_ASSERT(sizeof(struct render_ipc_host) == 32, "host line layout");
+	BUILD_ASSERT(sizeof(struct render_ipc_worker) == 32, "worker line layout");
+
+	if (RENDER_IPC_SLOT_BASE + RENDER_IPC_SLOTS * ROUND_UP(bytes, 32U) >
+	    CONFIG_RENDER_IPC_SHARED_SIZE) {
+		return -ENOMEM;
+	}
+
+	/* Start from whatever the worker last completed so a stale echo
+	 * from a previous run cannot match a new request.
+	 */
+	worker_refresh();
+	for (uint32_t s = 0; s < RENDER_IPC_SLOTS; s++) {
+		seq[s] = (uint16_t)(w->done[s] >> 16) + 1U;
+		h->req[s] = w->done[s];
+	}
+
+	frame_bytes = bytes;
+	h->blob_addr = (uint32_t)(uintptr_t)blob;
+	h->blob_size = size;
+	h->frame_bytes = bytes;
+	h->magic = RENDER_IPC_HOST_MAGIC;
+	(void)sys_cache_data_flush_range(h, sizeof(*h));
+	ipc_bell_ring();
+
+	for (;;) {
+		uint32_t hb;
+
+		worker_refresh();
+		hb = w->heartbeat;
+		if (w->magic == RENDER_IPC_WORKER_MAGIC) {
+			/* Magic survives a dead M33; require it to tick. An
+			 * idle worker ticks once per ring or poll period.
+			 */
+			ipc_bell_ring();
+			k_sleep(K_MSEC(2 * CONFIG_RENDER_IPC_POLL_MS + 3));
+			worker_refresh();
+			if (w->heartbeat != hb) {
+				return 0;
+			}
+		}
+		if (k_uptime_get() > deadline) {
+			return -ENODEV;
+		}
+		(void)ipc_bell_wait(POLL);
+	}
+}
+
+void render_ipc_request(uint32_t slot, uint32_t frame)
+{
+	struct render_ipc_host *h = render_ipc_host_blk();
+
+	h->req[slot] = RENDER_IPC_REQ(seq[slot]++, frame);
+	(void)sys_cache_data_flush_range(h, sizeof(*h));
+	ipc_bell_ring();
+}
+
+const uint8_t *render_ipc_wait(uint32_t slot)
+{
+	struct render_ipc_host *h = render_ipc_host_blk();
+	struct render_ipc_worker *w = render_ipc_worker_blk();
+	int64_t deadline = k_uptime_get() + CONFIG_RENDER_IPC_TIMEOUT_MS;
+	uint8_t *buf = render_ipc_slot(slot, frame_bytes);
+
+	for (;;) {
+		worker_refresh();
+		if (w->done[slot] == h->req[slot]) {
+			break;
+		}
+		if (k_uptime_get() > deadline) {
+			return NULL;
+		}
+		(void)ipc_bell_wait(POLL);
+	}
+
+	if (w->status[slot] != 0) {
+		return NULL;
+	}
+	/* The M55 never writes the slots, so there is nothing dirty to
+	 * lose; drop whatever is cached from the previous frame.
+	 */
+	(void)sys_cache_data_invd_range(buf, frame_bytes);
+	return buf;
+}
+
+void render_ipc_worker_status(struct render_ipc_worker *out)
+{
+	worker_refresh();
+	*out = *render_ipc_worker_blk();
+}
@@ -0,0 +1,122 @@
+/*
+ * M33 side of the render offload (see render_ipc.h).
+ *
+ * Built into the enable_cm55 companion through the app's m33/ Zephyr
+ * module, so it runs next to the stock companion code: a thread that
+ * waits for the M55 to publish its blob, then decodes requested
+ * frames into the shared slots. It sleeps on the doorbell between
+ * requests and rings the M55 once a slot is done. The companion has
+ * no console, so status and load go back through the worker line for
+ * the M55 to print.
+ */
+
+#include <errno.h>
+#include <zephyr/cache.h>
+#include <zephyr/kernel.h>
+
+#include "cpu_load.h"
+#include "ipc_bell.h"
+#include "render_ipc.h"
+#include "vrle.h"
+
+#define POLL          K_MSEC(CONFIG_RENDER_IPC_POLL_MS)
+#define LOAD_EVERY_MS 1000
+
+static void publish(struct render_ipc_worker *w)
+{
+	(void)sys_cache_data_flush_range(w, sizeof(*w));
+}
+
+static const struct render_ipc_host *host_refresh(void)
+{
+	struct render_ipc_host *h = render_ipc_host_blk();
+
+	(void)sys_cache_data_invd_range(h, sizeof(*h));
+	return h;
+}
+
+static int open_blob(struct vrle *v, uint32_t *frame_bytes)
+{
+	const struct render_ipc_host *h;
+	int n;
+
+	do {
+		(void)ipc_bell_wait(POLL);
+		h = host_refresh();
+	} while (h->magic != RENDER_IPC_HOST_MAGIC);
+
+	*frame_bytes = h->frame_bytes;
+	if (RENDER_IPC_SLOT_BASE + RENDER_IPC_SLOTS * ROUND_UP(h->frame_bytes, 32U) >
+	    CONFIG_RENDER_IPC_SHARED_SIZE) {
+		return -ENOMEM;
+	}
+
+	n = vrle_open(v, (const void *)(uintptr_t)(h->blob_addr + CONFIG_RENDER_IPC_XIP_ALIAS),
+		      h->blob_size);
+	if (n < 0) {
+		return n;
+	}
+	return vrle_frame_pixels(v) * 2U == h->frame_bytes ? 0 : -EINVAL;
+}
+
+static void worker_main(void *p1, void *p2, void *p3)
+{
+	struct render_ipc_worker *w = render_ipc_worker_blk();
+	struct cpu_load load = {0};
+	uint32_t frame_bytes;
+	int64_t next_load;
+	struct vrle v;
+	int err;
+
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	w->magic = RENDER_IPC_WORKER_MAGIC;
+	publish(w);
+
+	err = open_blob(&v, &frame_bytes);
+	(void)cpu_load_update(&load);
+	next_load = k_uptime_get() + LOAD_EVERY_MS;
+
+	for (;;) {
+		const struct render_ipc_host *h = host_refresh();
+		bool idle = true;
+
+		for (uint32_t s = 0; s < RENDER_IPC_SLOTS; s++) {
+			uint32_t req = h->req[s];
+			uint32_t t0;
+			uint16_t *dst;
+
+			if (req == w->done[s]) {
+				continue;
+			}
+
+			dst = (uint16_t *)render_ipc_slot(s, frame_bytes);
+			t0 = k_cycle_get_32();
+			w->status[s] = err < 0 ? err :
+				vrle_decode(&v, RENDER_IPC_REQ_FRAME(req) % v.hdr->count, dst);
+			w->decode_us = k_cyc_to_us_floor32(k_cycle_get_32() - t0);
+			(void)sys_cache_data_flush_range(dst, frame_bytes);
+
+			w->done[s] = req;
+			idle = false;
+		}
+
+		if (k_uptime_get() >= next_load) {
+			w->busy_permille = cpu_load_update(&load);
+			next_load += LOAD_EVERY_MS;
+		}
+		w->heartbeat++;
+		publish(w);
+
+		if (!idle) {
+			ipc_bell_ring();
+		} else {
+			(void)ipc_bell_wait(POLL);
+		}
+	}
+}
+
+K_THREAD_DEFINE(render_ipc_worker, CONFIG_RENDER_IPC_WORKER_STACK_SIZE, worker_main, NULL,
+		NULL, NULL, K_LOWEST_APPLICATION_THREAD_PRIO, 0, 0);
@@ -0,0 +1,338 @@
+/*
+ * Streaming STFT noise suppression
+ *
+ * Real FFT: the N real samples of a frame are packed as N/2 complex
+ * values (even samples real, odd imaginary), transformed with one
+ * N/2-point complex FFT and split into the N/2 + 1 one-sided bins.
+ * The inverse runs the same steps backwards. The forward FFT halves
+ * every stage, so bins come out as 2/N times the DFT and cannot
+ * overflow; the inverse is unscaled and lands back on the input scale.
+ * Input is shifted up IN_SHIFT bits first to keep the low bits through
+ * the Q15 multiplies.
+ *
+ * Noise: each bin's periodogram is smoothed over about eight hops and
+ * its minimum taken over STFT_NS_SUBWIN sub-windows (R. Martin,
+ * "Noise power spectral density estimation based on optimal smoothing
+ * and minimum statistics", 2001, without the adaptive smoothing). A
+ * minimum sits below the mean, so it is scaled up by NOISE_BIAS.
+ *
+ * Gain: decision-directed Wiener (Ephraim-Malah). The speech power is
+ * a blend of last hop's cleaned power and this hop's excess over the
+ * noise, and the gain is speech / (speech + noise), held above the
+ * floor. The divide is done in 32 bits after both sides are normalised
+ * to 16, which is all the precision a Q15 gain needs.
+ *
+ * One table, sin(pi j / 512) for j = 0..256, serves the windows and
+ * every twiddle for N up to 512.
+ */
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "stft_ns.h"
+
+#define FFT_M        (STFT_NS_N / 2)      /* complex FFT size */
+#define TAB_STRIDE   (512 / STFT_NS_N)    /* table steps per sample of pi/N */
+#define IN_SHIFT     4
+#define POW_SHIFT    6                    /* |X|^2 -> 32-bit power */
+#define SMOOTH_SHIFT 2                    /* periodogram smoothing, 1 - 1/4 */
+#define DD_ALPHA     32113                /* 0.98, Q15 */
+#define NOISE_BIAS   43                   /* minimum -> mean, Q4 */
+#define Q15_ONE      32768
+
+/* sin(pi j / 512), Q15, j = 0..256 */
+static const uint16_t sin_tab[257] = {
+	0, 201, 402, 603, 804, 1005, 1206, 1407, 1608, 1809,
+	2009, 2210, 2411, 2611, 2811, 3012, 3212, 3412, 3612, 3812,
+	4011, 4211, 4410, 4609, 4808, 5007, 5205, 5404, 5602, 5800,
+	5998, 6195, 6393, 6590, 6787, 6983, 7180, 7376, 7571, 7767,
+	7962, 8157, 8351, 8546, 8740, 8933, 9127, 9319, 9512, 9704,
+	9896, 10088, 10279, 10469, 10660, 10850, 11039, 11228, 11417, 11605,
+	11793, 11980, 12167, 12354, 12540, 12725, 12910, 13095, 13279, 13463,
+	13646, 13828, 14010, 14192, 14373, 14553, 14733, 14912, 15091, 15269,
+	15447, 15624, 15800, 15976, 16151, 16326, 16500, 16673, 16846, 17018,
+	17190, 17361, 17531, 17700, 17869, 18037, 18205, 18372, 18538, 18703,
+	18868, 19032, 19195, 19358, 19520, 19681, 19841, 20001, 20160, 20318,
+	20475, 20632, 20788, 20943, 21097, 21251, 21403, 21555, 21706, 21856,
+	22006, 22154, 22302, 22449, 22595, 22740, 22884, 23028, 23170, 23312,
+	23453, 23593, 23732, 23870, 24008, 24144, 24279, 24414, 24548, 24680,
+	24812, 24943, 25073, 25202, 25330, 25457, 25583, 25708, 25833, 25956,
+	26078, 26199, 26320, 26439, 26557, 26674, 26791, 26906, 27020, 27133,
+	27246, 27357, 27467, 27576, 27684, 27791, 27897, 28002, 28106, 28209,
+	28311, 28411, 28511, 28610, 28707, 28803, 28899, 28993, 29086, 29178,
+	29269, 29359, 29448, 29535, 29622, 29707, 29792, 29875, 29957, 30038,
+	30118, 30196, 30274, 30350, 30425, 30499, 30572, 30644, 30715, 30784,
+	30853, 30920, 30986, 31050, 31114, 31177, 31238, 31298, 31357, 31415,
+	31471, 31527, 31581, 31634, 31686, 31737, 31786, 31834, 31881, 31927,
+	31972, 32015, 32058, 32099, 32138, 32177, 32214, 32251, 32286, 32319,
+	32352, 32383, 32413, 32442, 32470, 32496, 32522, 32546, 32568, 32590,
+	32610, 32629, 32647, 32664, 32679, 32693, 32706, 32718, 32729, 32738,
+	32746, 32753, 32758, 32762, 32766, 32767, 32768,
+};
+
+/* Angles in units of pi / 512, 0..512 */
+static inline int32_t tab_sin(uint32_t j)
+{
+	return (j <= 256) ? sin_tab[j] : sin_tab[512 - j];
+}
+
+static inline int32_t tab_cos(uint32_t j)
+{
+	return (j <= 256) ? sin_tab[256 - j] : -(int32_t)sin_tab[j - 256];
+}
+
+static inline int32_t mul_q15(int32_t a, int32_t b)
+{
+	return (int32_t)(((int64_t)a * b + (1 << 14)) >> 15);
+}
+
+/* In-place radix-2 FFT of FFT_M complex values (re/im pairs). The
+ * forward transform halves every stage; the inverse is unscaled.
+ */
+static void fft(int32_t *z, bool inverse)
+{
+	for (uint32_t i = 1, j = 0; i < FFT_M; i++) {
+		uint32_t bit = FFT_M >> 1;
+
+		for (; j & bit; bit >>= 1) {
+			j ^= bit;
+		}
+		j |= bit;
+		if (i < j) {
+			int32_t tr = z[2 * i], ti = z[2 * i + 1];
+
+			z[2 * i] = z[2 * j];
+			z[2 * i + 1] = z[2 * j + 1];
+			z[2 * j] = tr;
+			z[2 * j + 1] = ti;
+		}
+	}
+
+	const int shift = inverse ? 0 : 1;
+
+	for (uint32_t size = 2; size <= FFT_M; size <<= 1) {
+		uint32_t half = size / 2;
+		uint32_t step = 1024 / size;      /* 2 pi / size in table units */
+
+		for (uint32_t k = 0; k < half; k++) {
+			int32_t wr = tab_cos(k * step);
+			int32_t wi = inverse ? tab_sin(k * step) : -tab_sin(k * step);
+
+			for (uint32_t s = k; s < FFT_M; s += size) {
+				int32_t *a = &z[2 * s];
+				int32_t *b = &z[2 * (s + half)];
+				int32_t tr, ti;
+
+				if (k == 0) {
+					tr = b[0];
+					ti = b[1];
+				} else {
+					tr = mul_q15(b[0], wr) - mul_q15(b[1], wi);
+					ti = mul_q15(b[0], wi) + mul_q15(b[1], wr);
+				}
+				b[0] = (a[0] - tr) >> shift;
+				b[1] = (a[1] - ti) >> shift;
+				a[0] = (a[0] + tr) >> shift;
+				a[1] = (a[1] + ti) >> shift;
+			}
+		}
+	}
+}
+
+/* FFT_M complex -> STFT_NS_BINS one-sided bins, in place */
+static void rfft_split(int32_t *x)
+{
+	int32_t z0r = x[0], z0i = x[1];
+
+	x[0] = z0r + z0i;
+	x[1] = 0;
+	x[2 * FFT_M] = z0r - z0i;
+	x[2 * FFT_M + 1] = 0;
+
+	for (uint32_t k = 1; k <= FFT_M / 2; k++) {
+		int32_t *a = &x[2 * k];
+		int32_t *b = &x[2 * (FFT_M - k)];
+		int32_t c = tab_cos(k * 2 * TAB_STRIDE);
+		int32_t s = tab_sin(k * 2 * TAB_STRIDE);
+		/* Even and odd half-spectra */
+		int32_t er = (a[0] + b[0]) / 2, ei = (a[1] - b[1]) / 2;
+		int32_t od_r = (a[1] + b[1]) / 2, od_i = (b[0] - a[0]) / 2;
+		/* Twiddled odd part, e^(-2 pi i k / N) */
+		int32_t tr = mul_q15(od_r, c) + mul_q15(od_i, s);
+		int32_t ti = mul_q15(od_i, c) - mul_q15(od_r, s);
+
+		a[0] = er + tr;
+		a[1] = ei + ti;
+		b[0] = er - tr;
+		b[1] = ti - ei;
+	}
+}
+
+/* STFT_NS_BINS one-sided bins -> FFT_M complex, in place */
+static void rfft_merge(int32_t *x)
+{
+	int32_t x0 = x[0], xm = x[2 * FFT_M];
+
+	x[0] = (x0 + xm) / 2;
+	x[1] = (x0 - xm) / 2;
+
+	for (uint32_t k = 1; k <= FFT_M / 2; k++) {
+		int32_t *a = &x[2 * k];
+		int32_t *b = &x[2 * (FFT_M - k)];
+		int32_t c = tab_cos(k * 2 * TAB_STRIDE);
+		int32_t s = tab_sin(k * 2 * TAB_STRIDE);
+		int32_t er = (a[0] + b[0]) / 2, ei = (a[1] - b[1]) / 2;
+		int32_t dr = (a[0] - b[0]) / 2, di = (a[1] + b[1]) / 2;
+		/* Odd part, e^(+2 pi i k / N) * d */
+		int32_t od_r = mul_q15(dr, c) - mul_q15(di, s);
+		int32_t od_i = mul_q15(dr, s) + mul_q15(di, c);
+
+		/* Z[k] = E + iO, Z[M - k] = conj(E - iO) */
+		a[0] = er - od_i;
+		a[1] = ei + od_r;
+		b[0] = er + od_i;
+		b[1] = od_r - ei;
+	}
+}
+
+static inline uint32_t noise_min(const struct stft_ns *ns, int k)
+{
+	uint32_t m = ns->min_cur[k];
+
+	for (int i = 0; i < STFT_NS_SUBWIN; i++) {
+		if (ns->min_sub[i][k] < m) {
+			m = ns->min_sub[i][k];
+		}
+	}
+	return m;
+}
+
+static inline uint32_t sat_u32(uint64_t v)
+{
+	return (v > UINT32_MAX) ? UINT32_MAX : (uint32_t)v;
+}
+
+uint32_t stft_ns_noise(const struct stft_ns *ns, int bin)
+{
+	return sat_u32(((uint64_t)noise_min(ns, bin) * NOISE_BIAS) >> 4);
+}
+
+/* num / den in Q15, num <= den */
+static uint32_t ratio_q15(uint64_t num, uint64_t den)
+{
+	while (den >= (1u << 16)) {
+		num >>= 1;
+		den >>= 1;
+	}
+	if (den == 0) {
+		return Q15_ONE;
+	}
+	return ((uint32_t)num << 15) / (uint32_t)den;
+}
+
+static void update_gains(struct stft_ns *ns)
+{
+	bool roll = (++ns->sub_count >= ns->sub_frames);
+
+	for (int k = 0; k < STFT_NS_BINS; k++) {
+		int32_t re = ns->spec[2 * k], im = ns->spec[2 * k + 1];
+		uint32_t p = sat_u32(((uint64_t)((int64_t)re * re) +
+				      (uint64_t)((int64_t)im * im)) >> POW_SHIFT);
+
+		if (!ns->primed) {
+			ns->smooth[k] = p;
+			ns->min_cur[k] = p;
+			for (int i = 0; i < STFT_NS_SUBWIN; i++) {
+				ns->min_sub[i][k] = p;
+			}
+		} else {
+			ns->smooth[k] += (p >> SMOOTH_SHIFT) - (ns->smooth[k] >> SMOOTH_SHIFT);
+		}
+		if (ns->smooth[k] < ns->min_cur[k]) {
+			ns->min_cur[k] = ns->smooth[k];
+		}
+
+		uint32_t noise = stft_ns_noise(ns, k);
+
+		if (roll) {
+			ns->min_sub[ns->sub_idx][k] = ns->min_cur[k];
+			ns->min_cur[k] = ns->smooth[k];
+		}
+
+		/* Decision-directed speech power, then Wiener gain */
+		uint32_t excess = (p > noise) ? p - noise : 0;
+		uint64_t speech = ((uint64_t)DD_ALPHA * ns->speech[k] +
+				   (uint64_t)(Q15_ONE - DD_ALPHA) * excess) >> 15;
+		uint32_t g = ratio_q15(speech, speech + noise);
+
+		if (g < ns->floor_q15) {
+			g = ns->floor_q15;
+		}
+
+		ns->spec[2 * k] = mul_q15(re, g);
+		ns->spec[2 * k + 1] = mul_q15(im, g);
+		ns->speech[k] = (uint32_t)(((uint64_t)g * g >> 15) * p >> 15);
+	}
+
+	if (roll) {
+		ns->sub_idx = (ns->sub_idx + 1) % STFT_NS_SUBWIN;
+		ns->sub_count = 0;
+	}
+	ns->primed = 1;
+}
+
+void stft_ns_init(struct stft_ns *ns, int floor_db, uint32_t track_frames)
+{
+	uint32_t floor = Q15_ONE;
+
+	memset(ns, 0, sizeof(*ns));
+
+	/* 10^(-1/20) per dB */
+	for (int db = 0; db > floor_db; db--) {
+		floor = (floor * 29205 + (1 << 14)) >> 15;
+	}
+	ns->floor_q15 = floor;
+	ns->sub_frames = (track_frames >= STFT_NS_SUBWIN) ? track_frames / STFT_NS_SUBWIN : 1;
+}
+
+void stft_ns_process(struct stft_ns *ns, const int16_t *in, int16_t *out)
+{
+	int32_t *x = ns->spec;
+
+	memmove(ns->in, ns->in + STFT_NS_HOP, STFT_NS_HOP * sizeof(ns->in[0]));
+	memcpy(ns->in + STFT_NS_HOP, in, STFT_NS_HOP * sizeof(ns->in[0]));
+
+	/* sqrt-Hann analysis window, sin(pi n / N) */
+	for (int n = 0; n < STFT_NS_N; n++) {
+		x[n] = ((int32_t)ns->in[n] * tab_sin(n * TAB_STRIDE)) >> (15 - IN_SHIFT);
+	}
+
+	fft(x, false);
+	rfft_split(x);
+	update_gains(ns);
+	rfft_merge(x);
+	fft(x, true);
+
+	/* Synthesis window and overlap-add; sin^2 + cos^2 = 1 across the
+	 * two halves
+	 */
+	for (int n = 0; n < STFT_NS_HOP; n++) {
+		int32_t y = ns->tail[n] + mul_q15(x[n], tab_sin(n * TAB_STRIDE));
+
+		y = (y + (1 << (IN_SHIFT - 1))) >> IN_SHIFT;
+		out[n] = (y > INT16_MAX) ? INT16_MAX : (y < INT16_MIN) ? INT16_MIN : y;
+		ns->tail[n] = mul_q15(x[STFT_NS_HOP + n],
+				      tab_sin((STFT_NS_HOP + n) * TAB_STRIDE));
+	}
+}
+
+void stft_ns_skip(struct stft_ns *ns, const int16_t *in)
+{
+	memmove(ns->in, ns->in + STFT_NS_HOP, STFT_NS_HOP * sizeof(ns->in[0]));
+	memcpy(ns->in + STFT_NS_HOP, in, STFT_NS_HOP * sizeof(ns->in[0]));
+
+	/* The pending half frame was never output; don't let it leak into
+	 * the first hop after the bypass
+	 */
+	memset(ns->tail, 0, sizeof(ns->tail));
+}
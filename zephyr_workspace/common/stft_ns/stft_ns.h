@@ -0,0 +1,81 @@
+/*
+ * Streaming STFT noise suppression.
+ *
+ *   x -> sqrt-Hann -> real FFT -> |X|^2 -> minimum-statistics noise
+ *     -> decision-directed Wiener gain -> IFFT -> sqrt-Hann -> overlap-add
+ *
+ * Frames are STFT_NS_N samples with 50% overlap, so every call takes
+ * and returns one hop of STFT_NS_HOP samples, one hop late. At 8 kHz
+ * the default N = 256 gives a 16 ms hop; at 16 kHz N = 512 gives the
+ * same hop in time.
+ *
+ * Integer only: Q15 windows and twiddles, 32-bit data with 64-bit
+ * products. The FLPR has no FPU, and every target computes the same
+ * output bits, which is what lets sim_test check a golden CRC.
+ *
+ * The noise estimate and the previous frame's gain persist in struct
+ * stft_ns, one per channel. A tone that holds steady for longer than
+ * the tracking window is taken for noise, as with any minimum-statistics
+ * tracker; speech never holds that long.
+ */
+
+#ifndef COMMON_STFT_NS_H_
+#define COMMON_STFT_NS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(CONFIG_STFT_NS_FFT_SIZE)
+#define STFT_NS_N CONFIG_STFT_NS_FFT_SIZE
+#else
+#define STFT_NS_N 256
+#endif
+
+#if (STFT_NS_N != 256) && (STFT_NS_N != 512)
+#error "STFT_NS_N must be 256 or 512"
+#endif
+
+#define STFT_NS_HOP    (STFT_NS_N / 2)
+#define STFT_NS_BINS   (STFT_NS_N / 2 + 1)
+#define STFT_NS_SUBWIN 4   /* minimum-statistics sub-windows */
+
+struct stft_ns {
+	int16_t in[STFT_NS_N];              /* last N input samples */
+	int32_t tail[STFT_NS_HOP];          /* second half of the last frame */
+	int32_t spec[2 * STFT_NS_BINS];     /* FFT work area, re/im pairs */
+	uint32_t smooth[STFT_NS_BINS];      /* smoothed periodogram */
+	uint32_t min_cur[STFT_NS_BINS];     /* minimum in the open sub-window */
+	uint32_t min_sub[STFT_NS_SUBWIN][STFT_NS_BINS];
+	uint32_t speech[STFT_NS_BINS];      /* last frame's G^2 |X|^2 */
+	uint16_t floor_q15;
+	uint16_t sub_frames;
+	uint16_t sub_count;
+	uint8_t sub_idx;
+	uint8_t primed;
+};
+
+/* floor_db (<= 0) limits the attenuation per bin; 0 passes the input
+ * through unchanged, one hop late. track_frames is the length of the
+ * noise tracking window in hops (about 1.5 s is typical) and is split
+ * into STFT_NS_SUBWIN sub-windows.
+ */
+void stft_ns_init(struct stft_ns *ns, int floor_db, uint32_t track_frames);
+
+/* Denoise one hop: in and out are STFT_NS_HOP Q15 samples. out is the
+ * input from one hop earlier; in and out may be the same buffer.
+ */
+void stft_ns_process(struct stft_ns *ns, const int16_t *in, int16_t *out);
+
+/* Bypass one hop: take the input into the frame history but skip the
+ * transform and leave the noise tracker and gains as they are, for a
+ * pipeline that stops running the stage while nobody speaks. The first
+ * hop processed afterwards fades in over the window, as at start-up.
+ */
+void stft_ns_skip(struct stft_ns *ns, const int16_t *in);
+
+/* Current noise estimate for a bin, in the units of the internal power
+ * spectrum. For tests and debug output.
+ */
+uint32_t stft_ns_noise(const struct stft_ns *ns, int bin);
+
+#endif /* COMMON_STFT_NS_H_ */
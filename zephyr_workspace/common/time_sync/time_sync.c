@@ -0,0 +1,211 @@
+/*
+ * Peer clock estimate from connection event anchors (see time_sync.h)
+ */
+
+#include "time_sync.h"
+
+#include <string.h>
+
+/* Pairs older than this are dropped, which also bounds the sums below */
+#define SPAN_MAX_US 60000000ll
+
+/* A pair this far off the newest is not a clock sample at all */
+#define GROSS_US    100000
+
+#define DRIFT_MAX_PPB 1000000
+#define PPB 1000000000ll
+
+void time_sync_init(struct time_sync *ts)
+{
+	memset(ts, 0, sizeof(*ts));
+}
+
+void time_sync_local(struct time_sync *ts, uint16_t event, uint64_t anchor_us)
+{
+	ts->local[ts->local_head].event = event;
+	ts->local[ts->local_head].us = anchor_us;
+	ts->local_head = (ts->local_head + 1) % TIME_SYNC_LOCAL;
+	if (ts->local_n < TIME_SYNC_LOCAL) {
+		ts->local_n++;
+	}
+}
+
+/* Least-squares line through the kept (dx, de) points. The sums are
+ * taken about the mean, so with SPAN_MAX_US and GROSS_US bounding the
+ * points they stay within int64 up to 64 pairs. The mean is rounded
+ * to a whole us, which moves sxx by less than m us^2.
+ */
+static int line(const int64_t *dx, const int64_t *de, const bool *keep, int n,
+		int64_t *a, int32_t *drift)
+{
+	int64_t m = 0, sx = 0, se = 0, sxx = 0, sxe = 0;
+	int64_t mx, me, d = 0;
+
+	for (int i = 0; i < n; i++) {
+		if (keep[i]) {
+			m++;
+			sx += dx[i];
+			se += de[i];
+		}
+	}
+	if (m == 0) {
+		return 0;
+	}
+	mx = sx / m;
+	me = se / m;
+
+	for (int i = 0; i < n; i++) {
+		if (keep[i]) {
+			int64_t cx = dx[i] - mx;
+
+			sxx += cx * cx;
+			sxe += cx * (de[i] - me);
+		}
+	}
+
+	if (sxx >= 1000000) {
+		/* Only a long, noisy fit needs this; the ratio is kept */
+		while (sxe > INT64_MAX / PPB || sxe < -(INT64_MAX / PPB)) {
+			sxe /= 2;
+			sxx /= 2;
+		}
+		d = sxe * PPB / sxx;
+		if (d > DRIFT_MAX_PPB) {
+			d = DRIFT_MAX_PPB;
+		} else if (d < -DRIFT_MAX_PPB) {
+			d = -DRIFT_MAX_PPB;
+		}
+	}
+	*drift = (int32_t)d;
+	*a = me - d * mx / PPB;
+	return (int)m;
+}
+
+static int64_t residual(int64_t dx, int64_t de, int64_t a, int32_t drift)
+{
+	int64_t r = de - a - (int64_t)drift * dx / PPB;
+
+	return r < 0 ? -r : r;
+}
+
+/* Refit over the stored pairs, relative to the newest one */
+static void fit(struct time_sync *ts)
+{
+	int n = ts->pair_n;
+	int newest = (ts->pair_head + n - 1) % TIME_SYNC_PAIRS;
+	uint64_t x0 = ts->pair_local[newest];
+	int64_t e0 = (int64_t)(ts->pair_peer[newest] - x0);
+	int64_t dx[TIME_SYNC_PAIRS], de[TIME_SYNC_PAIRS];
+	bool keep[TIME_SYNC_PAIRS], bad[TIME_SYNC_PAIRS];
+	int64_t a, worst = 0;
+	int32_t drift;
+	int m, dropped = 0;
+
+	if (n == 0) {
+		return;
+	}
+
+	for (int i = 0; i < n; i++) {
+		int k = (ts->pair_head + i) % TIME_SYNC_PAIRS;
+
+		dx[i] = (int64_t)(ts->pair_local[k] - x0);
+		de[i] = (int64_t)(ts->pair_peer[k] - ts->pair_local[k]) - e0;
+		keep[i] = de[i] > -GROSS_US && de[i] < GROSS_US;
+	}
+
+	m = line(dx, de, keep, n, &a, &drift);
+	for (int i = 0; i < n; i++) {
+		bad[i] = keep[i] && residual(dx[i], de[i], a, drift) > TIME_SYNC_OUTLIER_US;
+		dropped += bad[i];
+	}
+	/* If nothing agrees, keep the first fit until more pairs come */
+	if (dropped > 0 && dropped < m) {
+		for (int i = 0; i < n; i++) {
+			keep[i] = keep[i] && !bad[i];
+		}
+		m = line(dx, de, keep, n, &a, &drift);
+	}
+
+	for (int i = 0; i < n; i++) {
+		if (keep[i]) {
+			int64_t r = residual(dx[i], de[i], a, drift);
+
+			if (r > worst) {
+				worst = r;
+			}
+		}
+	}
+
+	ts->valid = true;
+	ts->ref_local = x0;
+	ts->ref_offset_us = e0 + a;
+	ts->drift_ppb = drift;
+	ts->resid_us = (uint32_t)worst;
+	ts->fit_n = (uint8_t)m;
+	/* Only the newest pair is new to this fit */
+	if (!keep[n - 1]) {
+		ts->outliers++;
+	}
+}
+
+bool time_sync_peer(struct time_sync *ts, uint16_t event, uint64_t anchor_us)
+{
+	const struct time_sync_anchor *l = NULL;
+	int slot;
+
+	for (int i = 0; i < ts->local_n; i++) {
+		if (ts->local[i].event == event) {
+			l = &ts->local[i];
+			break;
+		}
+	}
+	if (l == NULL) {
+		ts->unmatched++;
+		return false;
+	}
+
+	/* Age out pairs the new one leaves too far behind */
+	while (ts->pair_n > 0 &&
+	       (int64_t)(l->us - ts->pair_local[ts->pair_head]) > SPAN_MAX_US) {
+		ts->pair_head = (ts->pair_head + 1) % TIME_SYNC_PAIRS;
+		ts->pair_n--;
+	}
+
+	if (ts->pair_n == TIME_SYNC_PAIRS) {
+		ts->pair_head = (ts->pair_head + 1) % TIME_SYNC_PAIRS;
+		ts->pair_n--;
+	}
+	slot = (ts->pair_head + ts->pair_n) % TIME_SYNC_PAIRS;
+	ts->pair_local[slot] = l->us;
+	ts->pair_peer[slot] = anchor_us;
+	ts->pair_n++;
+	ts->pairs++;
+
+	fit(ts);
+	return true;
+}
+
+bool time_sync_to_peer(const struct time_sync *ts, uint64_t local_us, uint64_t *peer_us)
+{
+	int64_t d;
+
+	if (!ts->valid) {
+		return false;
+	}
+	d = (int64_t)(local_us - ts->ref_local);
+	*peer_us = local_us + ts->ref_offset_us + (int64_t)ts->drift_ppb * d / PPB;
+	return true;
+}
+
+bool time_sync_to_local(const struct time_sync *ts, uint64_t peer_us, uint64_t *local_us)
+{
+	int64_t d;
+
+	if (!ts->valid) {
+		return false;
+	}
+	/* One step of the inverse; the error is drift squared */
+	d = (int64_t)(peer_us - ts->ref_offset_us - ts->ref_local);
+	*local_us = peer_us - ts->ref_offset_us - (int64_t)ts->drift_ppb * d / PPB;
+	return true;
+}
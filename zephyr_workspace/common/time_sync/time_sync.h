@@ -0,0 +1,90 @@
+/*
+ * Peer clock estimate from connection event anchors.
+ *
+ * Both ends of a BLE connection see the same connection event: the
+ * central transmits at its anchor point and the peripheral receives at
+ * the same instant, give or take the propagation time. Each controller
+ * stamps the event on its own clock, so the pair (local anchor, peer
+ * anchor) for one event counter is a sample of the mapping between the
+ * two clocks, good to the controllers' timestamp resolution.
+ *
+ * The estimator keeps the last TIME_SYNC_PAIRS such samples and fits
+ *
+ *   peer = local + offset + drift * (local - local_newest)
+ *
+ * by least squares, after dropping samples more than
+ * TIME_SYNC_OUTLIER_US off a first fit (a peripheral that missed the
+ * central's packet reports a predicted anchor, not a received one).
+ * Conversions in either direction then extrapolate from the newest
+ * sample, so a link that stops exchanging samples keeps its drift
+ * model rather than freezing the offset.
+ *
+ * Local anchors arrive first (from this controller); the peer's come
+ * over the air a few events later and are matched by event counter
+ * against the last TIME_SYNC_LOCAL local ones.
+ *
+ * Pure C with no kernel calls, so audio_dsp_test can run it on a host.
+ * time_sync_bt.h is the Bluetooth side that feeds it.
+ */
+
+#ifndef COMMON_TIME_SYNC_H_
+#define COMMON_TIME_SYNC_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(CONFIG_TIME_SYNC_PAIRS)
+#define TIME_SYNC_PAIRS CONFIG_TIME_SYNC_PAIRS
+#else
+#define TIME_SYNC_PAIRS 16
+#endif
+
+#define TIME_SYNC_LOCAL      16   /* local anchors kept for matching */
+#define TIME_SYNC_OUTLIER_US 40
+
+struct time_sync_anchor {
+	uint16_t event;
+	uint64_t us;
+};
+
+struct time_sync {
+	/* Local anchors waiting for the peer's */
+	struct time_sync_anchor local[TIME_SYNC_LOCAL];
+	uint8_t local_head;
+	uint8_t local_n;
+
+	/* Matched pairs, oldest first from pair_head */
+	uint64_t pair_local[TIME_SYNC_PAIRS];
+	uint64_t pair_peer[TIME_SYNC_PAIRS];
+	uint8_t pair_head;
+	uint8_t pair_n;
+
+	/* Fit: peer - local at the newest pair, and its slope */
+	bool valid;
+	uint64_t ref_local;
+	int64_t ref_offset_us;
+	int32_t drift_ppb;       /* + : the peer's clock runs fast */
+	uint32_t resid_us;       /* largest residual of the kept pairs */
+	uint8_t fit_n;           /* pairs kept in the last fit */
+
+	/* Counters since init */
+	uint32_t pairs;
+	uint32_t unmatched;      /* peer anchors with no local one */
+	uint32_t outliers;
+};
+
+void time_sync_init(struct time_sync *ts);
+
+/* This controller's anchor for connection event `event` */
+void time_sync_local(struct time_sync *ts, uint16_t event, uint64_t anchor_us);
+
+/* The peer's anchor for the same event; refits once it is matched.
+ * Returns false if no local anchor for the event is left.
+ */
+bool time_sync_peer(struct time_sync *ts, uint16_t event, uint64_t anchor_us);
+
+/* Either clock to the other; false until the first pair is in */
+bool time_sync_to_peer(const struct time_sync *ts, uint64_t local_us, uint64_t *peer_us);
+bool time_sync_to_local(const struct time_sync *ts, uint64_t peer_us, uint64_t *local_us);
+
+#endif /* COMMON_TIME_SYNC_H_ */
@@ -0,0 +1,399 @@
+/*
+ * Shared timebase over a BLE connection (see time_sync_bt.h).
+ *
+ * Anchor reports arrive in the RX thread and GATT callbacks in the RX
+ * thread too, but peer_time_now() is called from any thread, so the
+ * estimator sits behind a spinlock. Sends go out from the system
+ * workqueue, where ATT allocations do not block.
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/gatt.h>
+#include <zephyr/bluetooth/hci.h>
+#include <zephyr/bluetooth/uuid.h>
+#include <zephyr/kernel.h>
+#include <zephyr/spinlock.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/sys/util.h>
+
+#include <sdc_hci_vs.h>
+#include <bluetooth/hci_vs_sdc.h>
+
+#include "time_sync.h"
+#include "time_sync_bt.h"
+
+#if defined(CONFIG_BOARD_NRF54L15BSIM)
+/* Simulator time, for the ground truth in the TSYNC line: this
+ * device's hardware time and the phy's (shared by every device) for it
+ */
+extern uint64_t nsi_hws_get_time(void);
+extern uint64_t hwll_phy_time_from_dev(uint64_t dev_time);
+#endif
+
+#define BT_UUID_TIME_SYNC_SERVICE BT_UUID_DECLARE_128(BT_UUID_TIME_SYNC_SERVICE_VAL)
+#define BT_UUID_TIME_SYNC_CHAR    BT_UUID_DECLARE_128(BT_UUID_TIME_SYNC_CHAR_VAL)
+
+/* u16 event counter, u64 anchor (us); little-endian */
+#define MSG_LEN 10
+
+static struct k_spinlock lock;
+static struct time_sync ts;
+static struct bt_conn *link;
+static uint16_t link_handle;
+static bool link_central;
+
+/* Newest local anchor not yet sent */
+static uint16_t out_event;
+static uint64_t out_us;
+static bool out_pending;
+static struct k_work send_work;
+
+/* Peripheral: the central has enabled notifications */
+static bool notify_on;
+
+/* Central: the peer's characteristic */
+static uint16_t peer_handle;
+static struct bt_gatt_discover_params disc_params;
+static struct bt_gatt_subscribe_params sub_params;
+
+/* Counters since connect */
+static uint32_t anchors;
+static uint32_t sent;
+static uint32_t send_failed;
+
+uint64_t time_sync_local_us(void)
+{
+	return k_cyc_to_us_floor64(k_cycle_get_64());
+}
+
+/* ---- Estimator input ---- */
+
+static void peer_anchor(struct bt_conn *conn, const uint8_t *msg)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	if (conn == link) {
+		time_sync_peer(&ts, sys_get_le16(msg), sys_get_le64(msg + 2));
+	}
+	k_spin_unlock(&lock, key);
+}
+
+static bool on_vs_event(struct net_buf_simple *buf)
+{
+	const sdc_hci_subevent_vs_conn_anchor_point_update_report_t *evt;
+	k_spinlock_key_t key;
+	bool send = false;
+
+	if (buf->len < 1 + sizeof(*evt) ||
+	    buf->data[0] != SDC_HCI_SUBEVENT_VS_CONN_ANCHOR_POINT_UPDATE_REPORT) {
+		return false;
+	}
+	evt = (const void *)&buf->data[1];
+
+	key = k_spin_lock(&lock);
+	if (link != NULL && evt->conn_handle == link_handle &&
+	    evt->event_counter % CONFIG_TIME_SYNC_STRIDE == 0) {
+		time_sync_local(&ts, evt->event_counter, evt->anchor_point_us);
+		out_event = evt->event_counter;
+		out_us = evt->anchor_point_us;
+		out_pending = true;
+		anchors++;
+		send = true;
+	}
+	k_spin_unlock(&lock, key);
+
+	if (send) {
+		k_work_submit(&send_work);
+	}
+	return true;
+}
+
+/* ---- GATT server (the peripheral's end) ---- */
+
+static ssize_t write_anchor(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+			    const void *buf, uint16_t len, uint16_t offset, uint8_t flags)
+{
+	if (offset != 0 || len != MSG_LEN) {
+		return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
+	}
+	peer_anchor(conn, buf);
+	return len;
+}
+
+static void ccc_changed(const struct bt_gatt_attr *attr, uint16_t value)
+{
+	notify_on = (value == BT_GATT_CCC_NOTIFY);
+}
+
+BT_GATT_SERVICE_DEFINE(time_sync_svc,
+	BT_GATT_PRIMARY_SERVICE(BT_UUID_TIME_SYNC_SERVICE),
+	BT_GATT_CHARACTERISTIC(BT_UUID_TIME_SYNC_CHAR,
+			       BT_GATT_CHRC_WRITE_WITHOUT_RESP | BT_GATT_CHRC_NOTIFY,
+			       BT_GATT_PERM_WRITE,
+			       NULL, write_anchor, NULL),
+	BT_GATT_CCC(ccc_changed, BT_GATT_PERM_READ | BT_GATT_PERM_WRITE),
+);
+
+/* ---- Anchor exchange ---- */
+
+static void send_handler(struct k_work *work)
+{
+	uint8_t msg[MSG_LEN];
+	struct bt_conn *conn = NULL;
+	bool central = false;
+	uint16_t handle = 0;
+	bool on = false;
+	k_spinlock_key_t key = k_spin_lock(&lock);
+	int err;
+
+	if (link != NULL && out_pending) {
+		conn = bt_conn_ref(link);
+		central = link_central;
+		handle = peer_handle;
+		on = notify_on;
+		sys_put_le16(out_event, msg);
+		sys_put_le64(out_us, msg + 2);
+		out_pending = false;
+	}
+	k_spin_unlock(&lock, key);
+
+	if (conn == NULL) {
+		return;
+	}
+
+	if (central) {
+		err = handle ? bt_gatt_write_without_response(conn, handle, msg, MSG_LEN, false)
+			     : -ENOTCONN;
+	} else {
+		err = on ? bt_gatt_notify(conn, &time_sync_svc.attrs[1], msg, MSG_LEN) : -ENOTCONN;
+	}
+	bt_conn_unref(conn);
+
+	/* Before the peer is set up there is nobody to send to */
+	if (err == 0) {
+		sent++;
+	} else if (err != -ENOTCONN) {
+		send_failed++;
+	}
+}
+
+/* ---- GATT client (the central's end) ---- */
+
+static uint8_t notify_cb(struct bt_conn *conn, struct bt_gatt_subscribe_params *params,
+			 const void *data, uint16_t length)
+{
+	if (data == NULL) {
+		return BT_GATT_ITER_STOP;
+	}
+	if (length == MSG_LEN) {
+		peer_anchor(conn, data);
+	}
+	return BT_GATT_ITER_CONTINUE;
+}
+
+static uint8_t discover_cb(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+			   struct bt_gatt_discover_params *params)
+{
+	const struct bt_gatt_chrc *chrc;
+	int err;
+
+	if (attr == NULL) {
+		printk("Time sync: service not found on the peer\n");
+		return BT_GATT_ITER_STOP;
+	}
+
+	if (params->type == BT_GATT_DISCOVER_PRIMARY) {
+		const struct bt_gatt_service_val *svc = attr->user_data;
+
+		params->uuid = BT_UUID_TIME_SYNC_CHAR;
+		params->start_handle = attr->handle + 1;
+		params->end_handle = svc->end_handle;
+		params->type = BT_GATT_DISCOVER_CHARACTERISTIC;
+		err = bt_gatt_discover(conn, params);
+		if (err) {
+			printk("Time sync: characteristic discovery failed (err %d)\n", err);
+		}
+		return BT_GATT_ITER_STOP;
+	}
+
+	chrc = attr->user_data;
+	sub_params.notify = notify_cb;
+	sub_params.value = BT_GATT_CCC_NOTIFY;
+	sub_params.value_handle = chrc->value_handle;
+	sub_params.ccc_handle = 0; /* auto-discover CCC */
+	sub_params.end_handle = params->end_handle;
+	sub_params.disc_params = &disc_params;
+	err = bt_gatt_subscribe(conn, &sub_params);
+	if (err && err != -EALREADY) {
+		printk("Time sync: subscribe failed (err %d)\n", err);
+		return BT_GATT_ITER_STOP;
+	}
+
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	peer_handle = chrc->value_handle;
+	k_spin_unlock(&lock, key);
+	return BT_GATT_ITER_STOP;
+}
+
+int time_sync_bt_subscribe(struct bt_conn *conn)
+{
+	memset(&disc_params, 0, sizeof(disc_params));
+	disc_params.uuid = BT_UUID_TIME_SYNC_SERVICE;
+	disc_params.func = discover_cb;
+	disc_params.start_handle = BT_ATT_FIRST_ATTRIBUTE_HANDLE;
+	disc_params.end_handle = BT_ATT_LAST_ATTRIBUTE_HANDLE;
+	disc_params.type = BT_GATT_DISCOVER_PRIMARY;
+	return bt_gatt_discover(conn, &disc_params);
+}
+
+/* ---- Connection tracking ---- */
+
+static void on_connected(struct bt_conn *conn, uint8_t err)
+{
+	struct bt_conn_info info;
+	uint16_t handle;
+	k_spinlock_key_t key;
+
+	if (err != 0U || link != NULL || bt_conn_get_info(conn, &info) != 0 ||
+	    bt_hci_get_conn_handle(conn, &handle) != 0) {
+		return;
+	}
+
+	key = k_spin_lock(&lock);
+	time_sync_init(&ts);
+	link = bt_conn_ref(conn);
+	link_handle = handle;
+	link_central = (info.role == BT_CONN_ROLE_CENTRAL);
+	out_pending = false;
+	notify_on = false;
+	peer_handle = 0;
+	anchors = 0;
+	sent = 0;
+	send_failed = 0;
+	k_spin_unlock(&lock, key);
+}
+
+static void on_disconnected(struct bt_conn *conn, uint8_t reason)
+{
+	struct bt_conn *old = NULL;
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	if (conn == link) {
+		old = link;
+		link = NULL;
+	}
+	k_spin_unlock(&lock, key);
+
+	if (old != NULL) {
+		bt_conn_unref(old);
+	}
+}
+
+BT_CONN_CB_DEFINE(time_sync_conn_cb) = {
+	.connected = on_connected,
+	.disconnected = on_disconnected,
+};
+
+/* ---- API ---- */
+
+int time_sync_bt_init(void)
+{
+	const sdc_hci_cmd_vs_conn_anchor_point_update_event_report_enable_t params = {
+		.enable = 1,
+	};
+	int err;
+
+	k_work_init(&send_work, send_handler);
+
+	err = bt_hci_register_vnd_evt_cb(on_vs_event);
+	if (err) {
+		printk("Time sync: vendor event callback failed (err %d)\n", err);
+		return err;
+	}
+	err = hci_vs_sdc_conn_anchor_point_update_event_report_enable(&params);
+	if (err) {
+		printk("Time sync: anchor reports not enabled (err %d)\n", err);
+	}
+	return err;
+}
+
+int peer_time_from_local(uint64_t local_us, uint64_t *peer_us)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+	bool ok = time_sync_to_peer(&ts, local_us, peer_us);
+
+	k_spin_unlock(&lock, key);
+	return ok ? 0 : -EAGAIN;
+}
+
+int local_time_from_peer(uint64_t peer_us, uint64_t *local_us)
+{
+	k_spinlock_key_t key = k_spin_lock(&lock);
+	bool ok = time_sync_to_local(&ts, peer_us, local_us);
+
+	k_spin_unlock(&lock, key);
+	return ok ? 0 : -EAGAIN;
+}
+
+int peer_time_now(uint64_t *peer_us)
+{
+	return peer_time_from_local(time_sync_local_us(), peer_us);
+}
+
+/* us as seconds with six decimals, for full 64-bit times */
+static void print_s(const char *label, uint64_t us)
+{
+	printk(" %s %u.%06u", label, (uint32_t)(us / 1000000U), (uint32_t)(us % 1000000U));
+}
+
+/* TSYNC: offset <ms> drift <ppm> ppm resid <us> us | pairs <n> fit <n> outliers <n>
+ *        unmatched <n> | anchors <n> sent <n> failed <n> | local <s> peer <s> [phy <s>]
+ */
+void time_sync_bt_report(void)
+{
+	uint32_t resid, pairs, fit_n, outliers, unmatched, n_anchors, n_sent, n_failed;
+	uint64_t local, peer = 0;
+	int64_t off;
+	int32_t drift;
+	bool ok;
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	local = time_sync_local_us();
+#if defined(CONFIG_BOARD_NRF54L15BSIM)
+	uint64_t phy = hwll_phy_time_from_dev(nsi_hws_get_time());
+#endif
+	ok = time_sync_to_peer(&ts, local, &peer);
+	drift = ts.drift_ppb;
+	resid = ts.resid_us;
+	pairs = ts.pairs;
+	fit_n = ts.fit_n;
+	outliers = ts.outliers;
+	unmatched = ts.unmatched;
+	n_anchors = anchors;
+	n_sent = sent;
+	n_failed = send_failed;
+	k_spin_unlock(&lock, key);
+
+	if (!ok) {
+		printk("TSYNC: no fit | anchors %u sent %u failed %u\n", n_anchors, n_sent,
+		       n_failed);
+		return;
+	}
+
+	off = (int64_t)(peer - local);
+	printk("TSYNC: offset %s%u.%03u ms drift %s%u.%03u ppm resid %u us | pairs %u fit %u "
+	       "outliers %u unmatched %u | anchors %u sent %u failed %u |",
+	       off < 0 ? "-" : "", (uint32_t)(ABS(off) / 1000), (uint32_t)(ABS(off) % 1000),
+	       drift < 0 ? "-" : "", ABS(drift) / 1000, ABS(drift) % 1000, resid,
+	       pairs, fit_n, outliers, unmatched, n_anchors, n_sent, n_failed);
+	print_s("local", local);
+	print_s("peer", peer);
+#if defined(CONFIG_BOARD_NRF54L15BSIM)
+	print_s("phy", phy);
+#endif
+	printk("\n");
+}
@@ -0,0 +1,58 @@
+/*
+ * Shared timebase over a BLE connection: connection event anchors from
+ * the SoftDevice Controller, exchanged with the peer over GATT and fed
+ * to the common/time_sync estimator.
+ *
+ * The controller reports the anchor point of each connection event
+ * (vendor event "connection anchor point update report") in
+ * microseconds of its own clock. On nRF54L that clock is the GRTC,
+ * which is also the kernel's cycle counter, so anchors and
+ * time_sync_local_us() are on one timebase with no conversion.
+ *
+ * Every CONFIG_TIME_SYNC_STRIDE-th event (the event counter is a
+ * multiple of it, so both ends pick the same events without agreeing
+ * on anything) each side sends its anchor to the other: the peripheral
+ * as a notification on the time sync characteristic, the central as a
+ * write without response to it. Each side runs its own estimator, so
+ * both can call peer_time_now().
+ *
+ * One connection at a time, like common/link_up; a second one is
+ * ignored until the first goes.
+ */
+
+#ifndef COMMON_TIME_SYNC_BT_H_
+#define COMMON_TIME_SYNC_BT_H_
+
+#include <stdint.h>
+#include <zephyr/bluetooth/conn.h>
+
+/* Time Sync Service, next to the PSM discovery service (...DEF0/DEF1) */
+#define BT_UUID_TIME_SYNC_SERVICE_VAL \
+	BT_UUID_128_ENCODE(0x12345678, 0x1234, 0x5678, 0x1234, 0x56789ABCDEF2)
+#define BT_UUID_TIME_SYNC_CHAR_VAL \
+	BT_UUID_128_ENCODE(0x12345678, 0x1234, 0x5678, 0x1234, 0x56789ABCDEF3)
+
+/* Register for the controller's anchor reports; after bt_enable() */
+int time_sync_bt_init(void);
+
+/* Central: find the peer's time sync characteristic and subscribe to
+ * it. Call once discovery for the app's own service has finished, so
+ * the two do not share the ATT bearer.
+ */
+int time_sync_bt_subscribe(struct bt_conn *conn);
+
+/* This board's clock, in the controller's microseconds */
+uint64_t time_sync_local_us(void);
+
+/* The peer's clock now, or either clock from the other. -EAGAIN until
+ * the first anchor pair is in; afterwards the last fit is extrapolated,
+ * across a disconnect too.
+ */
+int peer_time_now(uint64_t *peer_us);
+int peer_time_from_local(uint64_t local_us, uint64_t *peer_us);
+int local_time_from_peer(uint64_t peer_us, uint64_t *local_us);
+
+/* One TSYNC line; see README.md */
+void time_sync_bt_report(void);
+
+#endif /* COMMON_TIME_SYNC_BT_H_ */
@@ -0,0 +1,67 @@
+/*
+ * Front-end voice activity gate (see vad_gate.h)
+ */
+
+#include "vad_gate.h"
+
+#define ENERGY_SHIFT  6   /* x^2 >> 6 keeps 128 samples in 32 bits */
+#define ENERGY_MIN    4   /* below rms 16 LSB nothing is speech */
+#define FALL_SHIFT    2   /* floor follows a drop within a few frames */
+#define RISE_SHIFT    6   /* ... and a rise over about a second */
+#define RISE_SHIFT_SP 10  /* ... and 16x slower while speech is on */
+
+void vad_gate_init(struct vad_gate *g, int threshold_db, uint32_t hang_frames)
+{
+	uint32_t ratio = 256;
+
+	/* 10^(dB/10) in Q8, one 1.259x step per dB */
+	for (int i = 0; i < threshold_db; i++) {
+		ratio = (ratio * 322 + 128) >> 8;
+	}
+
+	g->noise = 0;
+	g->ratio_q8 = ratio;
+	g->energy = 0;
+	g->hang_frames = hang_frames;
+	g->hang = 0;
+	g->primed = false;
+}
+
+enum vad_gate_state vad_gate_update(struct vad_gate *g, const int16_t *x, int n)
+{
+	uint32_t sum = 0;
+	uint32_t e;
+	bool speech;
+
+	for (int i = 0; i < n; i++) {
+		sum += ((int32_t)x[i] * x[i]) >> ENERGY_SHIFT;
+	}
+	e = sum / n;
+	g->energy = e;
+
+	if (!g->primed) {
+		g->noise = e;
+		g->primed = true;
+	}
+
+	speech = e > ENERGY_MIN &&
+		 (uint64_t)e * 256 > (uint64_t)g->noise * g->ratio_q8;
+
+	if (e < g->noise) {
+		g->noise -= (g->noise - e) >> FALL_SHIFT;
+	} else {
+		uint32_t step = (e - g->noise) >> (speech ? RISE_SHIFT_SP : RISE_SHIFT);
+
+		g->noise += (step > 0) ? step : (e > g->noise);
+	}
+
+	if (speech) {
+		g->hang = g->hang_frames;
+		return VAD_GATE_SPEECH;
+	}
+	if (g->hang > 0) {
+		g->hang--;
+		return VAD_GATE_HANGOVER;
+	}
+	return VAD_GATE_SILENCE;
+}
@@ -0,0 +1,49 @@
+/*
+ * Front-end voice activity gate.
+ *
+ * Runs on one raw mic frame before anything else in the pipeline and
+ * says whether the heavy stages need to run. Frame power is compared
+ * with a noise floor that falls quickly and rises slowly, more slowly
+ * still while speech is present. The floor settles back in the gaps
+ * between words, so a long utterance does not lift it; sound that holds
+ * steady for several seconds without a gap is taken for noise. After
+ * the last speech frame the gate stays open for the hangover.
+ *
+ * About 3 operations per sample; expects DC-free input.
+ */
+
+#ifndef COMMON_VAD_GATE_H_
+#define COMMON_VAD_GATE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+enum vad_gate_state {
+	VAD_GATE_SILENCE = 0,
+	VAD_GATE_SPEECH,
+	VAD_GATE_HANGOVER,  /* no speech this frame, still inside the hangover */
+};
+
+struct vad_gate {
+	uint32_t noise;        /* noise floor, mean of x^2 / 64 */
+	uint32_t ratio_q8;     /* speech threshold over the floor */
+	uint32_t energy;       /* last frame, same units */
+	uint16_t hang_frames;
+	uint16_t hang;
+	bool primed;
+};
+
+/* threshold_db above the floor counts as speech; the gate stays open
+ * for hang_frames frames after the last one
+ */
+void vad_gate_init(struct vad_gate *g, int threshold_db, uint32_t hang_frames);
+
+/* Classify one frame of n samples and update the floor */
+enum vad_gate_state vad_gate_update(struct vad_gate *g, const int16_t *x, int n);
+
+static inline bool vad_gate_open(enum vad_gate_state s)
+{
+	return s != VAD_GATE_SILENCE;
+}
+
+#endif /* COMMON_VAD_GATE_H_ */
@@ -0,0 +1,81 @@
+/*
+ * Run-length frame decoder (see vrle.h).
+ *
+ * Builds for both PSE84 cores: the M55 uses it when it decodes for
+ * itself, the M33 render worker (common/render_ipc) when it decodes
+ * on the M55's behalf.
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include "vrle.h"
+
+int vrle_open(struct vrle *v, const void *blob, size_t size)
+{
+	const struct vrle_header *h = blob;
+	size_t table;
+
+	if (size < sizeof(*h) || h->magic != VRLE_MAGIC || h->count == 0U) {
+		return -EINVAL;
+	}
+
+	table = sizeof(*h) + (h->count + 1U) * sizeof(uint32_t);
+	if (size < table) {
+		return -EINVAL;
+	}
+
+	v->hdr = h;
+	v->offset = (const uint32_t *)(h + 1);
+	v->tokens = (const uint16_t *)((const uint8_t *)blob + table);
+	v->tokens_size = size - table;
+
+	if (v->offset[h->count] > v->tokens_size) {
+		return -EINVAL;
+	}
+	return (int)h->count;
+}
+
+int vrle_decode(const struct vrle *v, uint32_t idx, uint16_t *dst)
+{
+	const uint16_t *p, *end;
+	uint32_t left = vrle_frame_pixels(v);
+
+	if (idx >= v->hdr->count || v->offset[idx] > v->offset[idx + 1U]) {
+		return -EINVAL;
+	}
+
+	p = v->tokens + v->offset[idx] / 2U;
+	end = v->tokens + v->offset[idx + 1U] / 2U;
+
+	while (p < end) {
+		uint32_t t = *p++;
+		uint32_t n = t & VRLE_LEN_MAX;
+
+		if (n == 0U || n > left) {
+			return -EBADMSG;
+		}
+
+		if (t & VRLE_RUN) {
+			uint16_t px;
+
+			if (p >= end) {
+				return -EBADMSG;
+			}
+			px = *p++;
+			for (uint32_t i = 0; i < n; i++) {
+				dst[i] = px;
+			}
+		} else {
+			if ((size_t)(end - p) < n) {
+				return -EBADMSG;
+			}
+			memcpy(dst, p, n * sizeof(uint16_t));
+			p += n;
+		}
+		dst += n;
+		left -= n;
+	}
+
+	return left == 0U ? 0 : -EBADMSG;
+}
@@ -0,0 +1,57 @@
+/*
+ * Run-length coded RGB565 frame sequence (produced by vrle_pack.py).
+ *
+ * Layout, all little-endian:
+ *   struct vrle_header
+ *   uint32_t offset[count + 1]  token offsets in bytes from the end of
+ *                               the table; offset[count] = stream size
+ *   uint16_t tokens[]
+ *
+ * A token t covers n = t & 0x7FFF pixels (n >= 1). If bit 15 is set
+ * the next word is a pixel repeated n times, otherwise n literal
+ * pixels follow. Runs continue across rows; each frame starts on a
+ * fresh token.
+ */
+
+#ifndef COMMON_VRLE_H_
+#define COMMON_VRLE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define VRLE_MAGIC   0x314C5256U /* "VRL1" */
+#define VRLE_RUN     0x8000U
+#define VRLE_LEN_MAX 0x7FFFU
+
+struct vrle_header {
+	uint32_t magic;
+	uint16_t width;
+	uint16_t height;
+	uint32_t count;
+	uint32_t reserved;
+};
+
+struct vrle {
+	const struct vrle_header *hdr;
+	const uint32_t *offset;
+	const uint16_t *tokens;
+	size_t tokens_size;
+};
+
+/* Validate the header and offset table of a blob of `size` bytes.
+ * Returns the frame count, or -EINVAL.
+ */
+int vrle_open(struct vrle *v, const void *blob, size_t size);
+
+static inline uint32_t vrle_frame_pixels(const struct vrle *v)
+{
+	return (uint32_t)v->hdr->width * v->hdr->height;
+}
+
+/* Decode frame `idx` into dst (vrle_frame_pixels() pixels). Returns 0,
+ * -EINVAL for a bad index or -EBADMSG if the tokens over- or underrun
+ * the frame.
+ */
+int vrle_decode(const struct vrle *v, uint32_t idx, uint16_t *dst);
+
+#endif /* COMMON_VRLE_H_ */
@@ -0,0 +1,152 @@
+#!/usr/bin/env python3
+"""
+Build-time run-length coder for raw RGB565 frame sequences (common/vrle).
+
+Takes a raw little-endian RGB565 stream of back-to-back frames and
+writes the VRL1 format decoded by vrle.c:
+
+    header   16 bytes   magic "VRL1", width, height, frame count
+    offsets  4 bytes * (count + 1), byte offset of each frame's tokens
+             from the end of this table; the last entry is the total
+    tokens   uint16; t & 0x7fff = pixel count, bit 15 set = run of the
+             following pixel, clear = that many literal pixels follow
+
+Runs of three or more equal pixels become run tokens; anything shorter
+is cheaper as literals. Runs cross row boundaries but not frames.
+
+Usage:
+    # Pack the 240x144 video_test animation
+    python3 vrle_pack.py --width 240 --height 144 src/frames.bin -o frames.vrle
+
+    # Decode it back and compare against the source
+    python3 vrle_pack.py --width 240 --height 144 src/frames.bin --verify frames.vrle
+"""
+
+import argparse
+import struct
+import sys
+
+MAGIC = 0x314C5256
+HEADER_FMT = "<IHHII"
+RUN = 0x8000
+LEN_MAX = 0x7FFF
+MIN_RUN = 3
+
+
+def encode_frame(px):
+    """Token list (uint16 values) for one frame of pixels."""
+    out = []
+    lit = []
+    i, n = 0, len(px)
+
+    def flush_literals():
+        for s in range(0, len(lit), LEN_MAX):
+            chunk = lit[s:s + LEN_MAX]
+            out.append(len(chunk))
+            out.extend(chunk)
+        lit.clear()
+
+    while i < n:
+        j = i + 1
+        while j < n and px[j] == px[i] and j - i < LEN_MAX:
+            j += 1
+        if j - i >= MIN_RUN:
+            flush_literals()
+            out.extend((RUN | (j - i), px[i]))
+        else:
+            lit.extend(px[i:j])
+        i = j
+    flush_literals()
+    return out
+
+
+def decode_frame(tokens, npx):
+    px = []
+    i = 0
+    while i < len(tokens):
+        t = tokens[i]
+        n = t & LEN_MAX
+        if t & RUN:
+            px.extend([tokens[i + 1]] * n)
+            i += 2
+        else:
+            px.extend(tokens[i + 1:i + 1 + n])
+            i += 1 + n
+    if len(px) != npx:
+        raise ValueError("frame decodes to %d pixels, expected %d" % (len(px), npx))
+    return px
+
+
+def read_frames(path, npx):
+    with open(path, "rb") as f:
+        raw = f.read()
+    fb = npx * 2
+    if len(raw) == 0 or len(raw) % fb:
+        raise ValueError("%s: %d bytes is not a multiple of the %d-byte frame"
+                         % (path, len(raw), fb))
+    return [list(struct.unpack_from("<%dH" % npx, raw, o)) for o in range(0, len(raw), fb)]
+
+
+def pack(args, frames):
+    offsets = [0]
+    stream = []
+    for px in frames:
+        stream.extend(encode_frame(px))
+        offsets.append(len(stream) * 2)
+
+    blob = struct.pack(HEADER_FMT, MAGIC, args.width, args.height, len(frames), 0)
+    blob += struct.pack("<%dI" % len(offsets), *offsets)
+    blob += struct.pack("<%dH" % len(stream), *stream)
+    with open(args.output, "wb") as f:
+        f.write(blob)
+
+    raw = len(frames) * args.width * args.height * 2
+    print("%s: %d frames %dx%d, %d -> %d bytes (%.1f%%)"
+          % (args.output, len(frames), args.width, args.height, raw, len(blob),
+             100.0 * len(blob) / raw))
+    return 0
+
+
+def verify(args, frames):
+    with open(args.verify, "rb") as f:
+        blob = f.read()
+    magic, w, h, count, _ = struct.unpack_from(HEADER_FMT, blob)
+    if magic != MAGIC or (w, h, count) != (args.width, args.height, len(frames)):
+        print("header mismatch", file=sys.stderr)
+        return 1
+    base = struct.calcsize(HEADER_FMT)
+    offsets = struct.unpack_from("<%dI" % (count + 1), blob, base)
+    base += 4 * (count + 1)
+    for k, px in enumerate(frames):
+        n = (offsets[k + 1] - offsets[k]) // 2
+        tokens = struct.unpack_from("<%dH" % n, blob, base + offsets[k])
+        if decode_frame(tokens, w * h) != px:
+            print("frame %d differs" % k, file=sys.stderr)
+            return 1
+    print("%s: %d frames OK" % (args.verify, count))
+    return 0
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("input", help="raw RGB565 frames, back to back")
+    ap.add_argument("-o", "--output", default="frames.vrle")
+    ap.add_argument("--width", type=int, required=True)
+    ap.add_argument("--height", type=int, required=True)
+    ap.add_argument("--verify", metavar="VRLE", help="check an existing image against input")
+    args = ap.parse_args()
+
+    try:
+        frames = read_frames(args.input, args.width * args.height)
+    except (OSError, ValueError) as e:
+        print(str(e), file=sys.stderr)
+        return 1
+
+    if args.verify:
+        return verify(args, frames)
+    return pack(args, frames)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -1,6 +1,7 @@
 /*
  * BLE Throughput Test for nRF54L15
  * Measures MIPS during BLE data streaming
+ * Link setup is driven by common/link_up.
  */
 
 #include <zephyr/kernel.h>
@@ -12,6 +13,8 @@
 #include <zephyr/timing/timing.h>
 #include <zephyr/sys/printk.h>
 
+#include "link_up.h"
+
 #define DEVICE_NAME CONFIG_BT_DEVICE_NAME
 #define DEVICE_NAME_LEN (sizeof(DEVICE_NAME) - 1)
 
@@ -49,7 +52,7 @@ static uint8_t test_data[TEST_DATA_SIZE];
 
 static bool notify_enabled = false;
 static volatile bool dle_ready = false;
-static struct k_work_delayable conn_param_work;
+static K_SEM_DEFINE(stream_ready, 0, 1);
 
 
 /* TX rate control: 0 = disabled, >0 = target kbps */
@@ -65,48 +68,43 @@ static const struct bt_data sd[] = {
 	BT_DATA_BYTES(BT_DATA_UUID128_ALL, BT_UUID_THROUGHPUT_SERVICE_VAL),
 };
 
-static void conn_param_work_handler(struct k_work *work)
+static void link_phase_done(enum link_up_phase phase, int err)
 {
-	if (!current_conn) {
-		return;
-	}
-
-	printk("Requesting PHY update to 2M and connection params...\n");
-
-	/* Request PHY update to 2M */
-	int err = bt_conn_le_phy_update(current_conn, BT_CONN_LE_PHY_PARAM_2M);
-	if (err) {
-		printk("PHY update request failed (err %d)\n", err);
-	}
-
-	/* Request Data Length Update for max PDU size */
-	struct bt_conn_le_data_len_param dl_param = {
-		.tx_max_len = 251,
-		.tx_max_time = 2120, /* 2120us for 251 bytes at 1M PHY */
-	};
-	err = bt_conn_le_data_len_update(current_conn, &dl_param);
-	if (err) {
-		printk("Data length update failed (err %d)\n", err);
+	if (phase == LINK_UP_DLE && err == 0) {
+		dle_ready = true;
+		k_sem_give(&stream_ready);
 	}
+}
 
-	/* Request connection parameter update for better throughput */
-	/* Give macOS a range: 7.5ms-15ms (interval 6-12) */
-	struct bt_le_conn_param param = {
+/* PHY, DLE and CI requests go out together on connect; the CCC write
+ * (OPEN) comes from the central and is only timed.
+ * Give macOS a CI range: 7.5ms-15ms (interval 6-12).
+ */
+static const struct link_up_cfg link_cfg = {
+	.steps = LINK_UP_STEP(LINK_UP_DLE) | LINK_UP_STEP(LINK_UP_PHY) |
+		 LINK_UP_STEP(LINK_UP_CI) | LINK_UP_STEP(LINK_UP_MTU) |
+		 LINK_UP_STEP(LINK_UP_OPEN),
+	.tx_octets = 251,
+	.tx_time = 2120, /* 2120us for 251 bytes at 1M PHY */
+	.phy = BT_GAP_LE_PHY_2M,
+	.ci = {
 		.interval_min = 6,
 		.interval_max = 12,
 		.latency = 0,
 		.timeout = 400,
-	};
-	err = bt_conn_le_param_update(current_conn, &param);
-	if (err) {
-		printk("Conn param update request failed (err %d)\n", err);
-	}
-}
+	},
+	.phase_done = link_phase_done,
+};
 
 static void tx_ccc_cfg_changed(const struct bt_gatt_attr *attr, uint16_t value)
 {
 	notify_enabled = (value == BT_GATT_CCC_NOTIFY);
 	printk("TX notifications %s\n", notify_enabled ? "enabled" : "disabled");
+
+	if (notify_enabled) {
+		link_up_done(LINK_UP_OPEN, 0);
+		k_sem_give(&stream_ready);
+	}
 }
 
 static ssize_t on_receive(struct bt_conn *conn,
@@ -173,9 +171,6 @@ static void connected(struct bt_conn *conn, uint8_t err)
 
 	/* Stop advertising to free radio time for data transfer */
 	bt_le_adv_stop();
-
-	/* Schedule param updates quickly */
-	k_work_schedule(&conn_param_work, K_MSEC(50));
 }
 
 static void disconnected(struct bt_conn *conn, uint8_t reason)
@@ -190,9 +185,6 @@ static void disconnected(struct bt_conn *conn, uint8_t reason)
 		current_conn = NULL;
 	}
 
-	/* Cancel any pending work */
-	k_work_cancel_delayable(&conn_param_work);
-
 	bytes_sent = 0;
 	bytes_received = 0;
 	total_cycles = 0;
@@ -223,10 +215,6 @@ static void le_data_len_updated(struct bt_conn *conn,
 	printk("*** Data Length updated: TX max_len=%u max_time=%u, RX max_len=%u max_time=%u ***\n",
 	       info->tx_max_len, info->tx_max_time,
 	       info->rx_max_len, info->rx_max_time);
-
-	if (info->tx_max_len >= 251) {
-		dle_ready = true;
-	}
 }
 
 static void mtu_updated(struct bt_conn *conn, uint16_t tx, uint16_t rx)
@@ -333,6 +321,7 @@ void stream_thread(void)
 			int err = send_data(test_data, TEST_DATA_SIZE);
 
 			if (err == 0) {
+				link_up_first_payload();
 				bytes_sent += TEST_DATA_SIZE;
 				iterations++;
 			}
@@ -349,7 +338,7 @@ void stream_thread(void)
 				k_sleep(K_MSEC(delay_ms));
 			}
 		} else {
-			k_sleep(K_MSEC(100));
+			k_sem_take(&stream_ready, K_MSEC(100));
 		}
 	}
 }
@@ -363,8 +352,7 @@ int main(void)
 
 	printk("Starting nRF54L15 BLE Throughput Test\n");
 
-	/* Initialize delayed work for connection parameter updates */
-	k_work_init_delayable(&conn_param_work, conn_param_work_handler);
+	link_up_init(&link_cfg);
 
 	err = bt_enable(NULL);
 	if (err) {
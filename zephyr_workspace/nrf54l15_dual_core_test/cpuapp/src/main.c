@@ -2,6 +2,7 @@
  * BLE Throughput Test for nRF54L15 (ARM Cortex-M33)
  * Measures MIPS during BLE data streaming
  * Communicates with RISC-V core for workload testing
+ * Link setup (PHY, CI) is driven by common/link_up.
  */
 
 #include <zephyr/kernel.h>
@@ -15,6 +16,33 @@
 #include <zephyr/ipc/ipc_service.h>
 #include <string.h>
 
+#include "dvfs.h"
+#include "link_up.h"
+#include "profiler.h"
+
+#if defined(CONFIG_DUAL_CORE_CONTENTION)
+#include <zephyr/irq_offload.h>
+#include "membench.h"
+#endif
+
+#if defined(CONFIG_AEAD)
+#include "aead.h"
+#endif
+
+#if defined(CONFIG_COREBENCH)
+#include "corebench.h"
+#endif
+
+#if defined(CONFIG_DUAL_CORE_FAR_END)
+#include <zephyr/sys/byteorder.h>
+#include "far_ring.h"
+#endif
+
+#if defined(CONFIG_DUAL_CORE_PACKETISER)
+#include <zephyr/bluetooth/l2cap.h>
+#include "audio_pkt.h"
+#endif
+
 #define DEVICE_NAME CONFIG_BT_DEVICE_NAME
 #define DEVICE_NAME_LEN (sizeof(DEVICE_NAME) - 1)
 
@@ -41,11 +69,16 @@
 #define BT_UUID_RISCV_WORKLOAD_VAL \
 	BT_UUID_128_ENCODE(0x6E400005, 0xB5A3, 0xF393, 0xE0A9, 0xE50E24DCCA9E)
 
+/* Far-end Audio UUID: 6E400007-B5A3-F393-E0A9-E50E24DCCA9E */
+#define BT_UUID_FAR_END_AUDIO_VAL \
+	BT_UUID_128_ENCODE(0x6E400007, 0xB5A3, 0xF393, 0xE0A9, 0xE50E24DCCA9E)
+
 #define BT_UUID_THROUGHPUT_SERVICE  BT_UUID_DECLARE_128(BT_UUID_THROUGHPUT_SERVICE_VAL)
 #define BT_UUID_THROUGHPUT_TX       BT_UUID_DECLARE_128(BT_UUID_THROUGHPUT_TX_VAL)
 #define BT_UUID_THROUGHPUT_RX       BT_UUID_DECLARE_128(BT_UUID_THROUGHPUT_RX_VAL)
 #define BT_UUID_THROUGHPUT_CTRL     BT_UUID_DECLARE_128(BT_UUID_THROUGHPUT_CTRL_VAL)
 #define BT_UUID_RISCV_WORKLOAD      BT_UUID_DECLARE_128(BT_UUID_RISCV_WORKLOAD_VAL)
+#define BT_UUID_FAR_END_AUDIO       BT_UUID_DECLARE_128(BT_UUID_FAR_END_AUDIO_VAL)
 
 /* IPC message types */
 enum ipc_msg_type {
@@ -53,6 +86,10 @@ enum ipc_msg_type {
 	IPC_MSG_SET_WORKLOAD = 2,
 	IPC_MSG_HEARTBEAT = 3,
 	IPC_MSG_AUDIO_DATA = 4,
+	IPC_MSG_MEMBENCH = 5,
+	IPC_MSG_MEMBENCH_RESULT = 6,
+	IPC_MSG_SET_FREQ = 7,
+	IPC_MSG_LOAD = 8,
 };
 
 struct ipc_message {
@@ -79,11 +116,15 @@ static uint32_t iterations = 0;
 static uint8_t test_data[TEST_DATA_SIZE];
 
 static bool notify_enabled = false;
-static struct k_work_delayable conn_param_work;
 
 /* TX rate control: 0 = disabled, >0 = target kbps */
 static uint32_t target_tx_kbps = 0;  /* Default: max speed (0 = no delay) */
 
+/* Set by the contention benchmark to keep the stream quiet outside its
+ * streaming cases, and by the AEAD and core benches while they run.
+ */
+static volatile bool stream_hold;
+
 /* IPC for RISC-V communication */
 static struct ipc_ept ep;
 static uint32_t riscv_mips = 0;
@@ -91,8 +132,52 @@ static uint32_t riscv_workload = 0;
 static uint32_t riscv_cpu_pct = 0;
 static uint32_t audio_frames_received = 0;
 static uint32_t audio_voice_detected = 0;
+static uint32_t riscv_frames = 0;
+static uint32_t riscv_frames_missed = 0;
 static bool ipc_ready = false;
 
+#if defined(CONFIG_DUAL_CORE_CONTENTION)
+/* Last IPC_MSG_MEMBENCH_RESULT from the FLPR */
+static struct {
+	uint32_t bytes;
+	uint32_t elapsed_us;
+	uint32_t passes;
+	uint32_t buf_addr;
+} flpr_membench;
+static K_SEM_DEFINE(flpr_membench_sem, 0, 1);
+#endif
+
+#if defined(CONFIG_DUAL_CORE_FAR_END)
+/* Downlink frame: seq (LE u16), reserved (u16), FAR_RING_FRAME LE s16 */
+#define FAR_END_HDR_SIZE   4
+#define FAR_END_FRAME_SIZE (FAR_END_HDR_SIZE + FAR_RING_FRAME * 2)
+
+#define far_ring_shm ((struct far_ring *)DT_REG_ADDR(DT_NODELABEL(far_ring)))
+BUILD_ASSERT(sizeof(struct far_ring) <= DT_REG_SIZE(DT_NODELABEL(far_ring)),
+	     "far_ring region too small for CONFIG_FAR_RING_SLOTS");
+BUILD_ASSERT(IS_ENABLED(CONFIG_NRF_GRTC_TIMER),
+	     "far_ring play times must be on the GRTC the FLPR also reads");
+
+/* Playout schedule and counters for the far-end stream. Frame seq is
+ * played at anchor_us + (seq - seq_base) * FAR_RING_FRAME_US; the anchor
+ * is the first frame's arrival plus the playout delay.
+ */
+static struct {
+	bool anchored;
+	uint32_t seq_base;
+	uint32_t anchor_us;
+	uint32_t last_seq;
+	uint32_t frames;
+	uint32_t lost;     /* sequence numbers skipped */
+	uint32_t late;     /* arrived after their play time */
+	uint32_t dropped;  /* ring full */
+	uint32_t resync;   /* re-anchored after a stall or restart */
+	int32_t margin_min_us;
+	int32_t margin_max_us;
+	uint64_t cycles;
+} far_end;
+#endif
+
 /* BLE Advertising data */
 static const struct bt_data ad[] = {
 	BT_DATA_BYTES(BT_DATA_FLAGS, (BT_LE_AD_GENERAL | BT_LE_AD_NO_BREDR)),
@@ -103,38 +188,30 @@ static const struct bt_data sd[] = {
 	BT_DATA_BYTES(BT_DATA_UUID128_ALL, BT_UUID_THROUGHPUT_SERVICE_VAL),
 };
 
-static void conn_param_work_handler(struct k_work *work)
-{
-	if (!current_conn) {
-		return;
-	}
-
-	printk("Requesting PHY update to 2M and connection params...\n");
-
-	/* Request PHY update to 2M */
-	int err = bt_conn_le_phy_update(current_conn, BT_CONN_LE_PHY_PARAM_2M);
-	if (err) {
-		printk("PHY update request failed (err %d)\n", err);
-	}
-
-	/* Request connection parameter update for better throughput */
-	/* Using 15ms (interval=12) instead of 7.5ms - macOS more likely to accept */
-	struct bt_le_conn_param param = {
+/* PHY and CI requests go out as soon as the link is up rather than
+ * after a fixed settle time; the CCC write (OPEN) is only timed.
+ * Using 15ms (interval=12) instead of 7.5ms - macOS more likely to accept.
+ */
+static const struct link_up_cfg link_cfg = {
+	.steps = LINK_UP_STEP(LINK_UP_PHY) | LINK_UP_STEP(LINK_UP_CI) |
+		 LINK_UP_STEP(LINK_UP_MTU) | LINK_UP_STEP(LINK_UP_OPEN),
+	.phy = BT_GAP_LE_PHY_2M,
+	.ci = {
 		.interval_min = 12,
 		.interval_max = 12,
 		.latency = 0,
 		.timeout = 400,
-	};
-	err = bt_conn_le_param_update(current_conn, &param);
-	if (err) {
-		printk("Conn param update request failed (err %d)\n", err);
-	}
-}
+	},
+};
 
 static void tx_ccc_cfg_changed(const struct bt_gatt_attr *attr, uint16_t value)
 {
 	notify_enabled = (value == BT_GATT_CCC_NOTIFY);
 	printk("TX notifications %s\n", notify_enabled ? "enabled" : "disabled");
+
+	if (notify_enabled) {
+		link_up_done(LINK_UP_OPEN, 0);
+	}
 }
 
 static ssize_t on_receive(struct bt_conn *conn,
@@ -150,6 +227,88 @@ static ssize_t on_receive(struct bt_conn *conn,
 	return len;
 }
 
+#if defined(CONFIG_DUAL_CORE_FAR_END)
+/* Stamp a downlink frame with its play time and queue it for the FLPR */
+static ssize_t on_far_end_write(struct bt_conn *conn,
+				const struct bt_gatt_attr *attr,
+				const void *buf,
+				uint16_t len,
+				uint16_t offset,
+				uint8_t flags)
+{
+	timing_t start = timing_counter_get();
+	uint32_t now = far_ring_now_us();
+	const uint8_t *p = buf;
+	uint32_t seq, play_us;
+	int32_t margin;
+
+	if (offset != 0 || len != FAR_END_FRAME_SIZE) {
+		return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
+	}
+	bytes_received += len;
+
+	/* Extend the 16-bit sequence number around the last one seen */
+	seq = far_end.last_seq + (int16_t)(sys_get_le16(p) - (uint16_t)far_end.last_seq);
+
+	if (far_end.anchored) {
+		play_us = far_end.anchor_us + (seq - far_end.seq_base) * FAR_RING_FRAME_US;
+		margin = (int32_t)(play_us - now);
+
+		/* A stalled or restarted stream starts a new schedule */
+		if ((int32_t)(seq - far_end.last_seq) <= 0 ||
+		    margin < -CONFIG_DUAL_CORE_FAR_END_PLAYOUT_US) {
+			far_end.anchored = false;
+			far_end.resync++;
+		} else {
+			far_end.lost += seq - far_end.last_seq - 1;
+		}
+	}
+	if (!far_end.anchored) {
+		far_end.anchored = true;
+		far_end.seq_base = seq;
+		far_end.anchor_us = now + CONFIG_DUAL_CORE_FAR_END_PLAYOUT_US;
+		play_us = far_end.anchor_us;
+		margin = CONFIG_DUAL_CORE_FAR_END_PLAYOUT_US;
+	}
+	far_end.last_seq = seq;
+
+	if (margin < 0) {
+		far_end.late++;
+	}
+	if (far_end.frames == 0 || margin < far_end.margin_min_us) {
+		far_end.margin_min_us = margin;
+	}
+	if (far_end.frames == 0 || margin > far_end.margin_max_us) {
+		far_end.margin_max_us = margin;
+	}
+
+	/* PCM is little-endian like both cores */
+	if (far_ring_push(far_ring_shm, seq, play_us,
+			  (const int16_t *)(p + FAR_END_HDR_SIZE)) < 0) {
+		far_end.dropped++;
+	}
+	far_end.frames++;
+
+	timing_t end = timing_counter_get();
+
+	far_end.cycles += timing_cycles_get(&start, &end);
+
+	return len;
+}
+#else
+static ssize_t on_far_end_write(struct bt_conn *conn,
+				const struct bt_gatt_attr *attr,
+				const void *buf,
+				uint16_t len,
+				uint16_t offset,
+				uint8_t flags)
+{
+	/* No FLPR reference path in this build (far_end.conf) */
+	bytes_received += len;
+	return len;
+}
+#endif
+
 static ssize_t on_control_write(struct bt_conn *conn,
 				 const struct bt_gatt_attr *attr,
 				 const void *buf,
@@ -202,6 +361,10 @@ static ssize_t on_riscv_workload_write(struct bt_conn *conn,
 			printk("ARM: Failed to send workload to RISC-V (err %d)\n", ret);
 		} else {
 			printk("ARM: Set RISC-V workload to %u\n", workload);
+
+			/* Profile the same window as the FLPR (needs CONFIG_PROFILER) */
+			profiler_stop();
+			profiler_start(0);
 		}
 		#else
 		printk("ARM: Workload %u requested but IPC not available\n", workload);
@@ -210,11 +373,40 @@ static ssize_t on_riscv_workload_write(struct bt_conn *conn,
 	return len;
 }
 
+static int flpr_send(uint8_t type, uint8_t workload, uint32_t arg)
+{
+	struct ipc_message msg;
+
+	memset(&msg, 0, sizeof(msg));
+	msg.type = type;
+	msg.workload = workload;
+	msg.data[0] = arg;
+	return ipc_service_send(&ep, &msg, sizeof(msg));
+}
+
+/* Tell the FLPR which clock the shared PLL now runs at */
+static void flpr_set_freq(uint32_t mhz)
+{
+	if (!ipc_ready) {
+		return;
+	}
+
+	int ret = flpr_send(IPC_MSG_SET_FREQ, 0, mhz);
+	if (ret < 0) {
+		printk("ARM: Failed to send clock to RISC-V (err %d)\n", ret);
+	}
+}
+
 /* IPC callbacks */
 static void ep_bound(void *priv)
 {
 	ipc_ready = true;
 	printk("ARM: IPC endpoint bound and ready\n");
+
+	/* The policy may have switched before the FLPR was listening */
+	if (dvfs_freq_mhz() != DVFS_MHZ_HIGH) {
+		flpr_set_freq(dvfs_freq_mhz());
+	}
 }
 
 static void ep_recv(const void *data, size_t len, void *priv)
@@ -258,6 +450,20 @@ static void ep_recv(const void *data, size_t len, void *priv)
 		/* For now, just track reception */
 		(void)sample0; (void)sample1; (void)sample2; (void)sample3;
 		(void)zero_crossings;
+	} else if (msg->type == IPC_MSG_LOAD) {
+		/* Measured FLPR load and frame deadlines feed the clock policy */
+		riscv_frames += msg->data[0];
+		riscv_frames_missed += msg->data[1];
+		dvfs_set_remote_load(msg->data[2]);
+		dvfs_account(msg->data[0], 0, msg->data[1]);
+	} else if (msg->type == IPC_MSG_MEMBENCH_RESULT) {
+#if defined(CONFIG_DUAL_CORE_CONTENTION)
+		flpr_membench.bytes = msg->data[0];
+		flpr_membench.elapsed_us = msg->data[1];
+		flpr_membench.passes = msg->data[2];
+		flpr_membench.buf_addr = msg->data[3];
+		k_sem_give(&flpr_membench_sem);
+#endif
 	}
 }
 
@@ -290,6 +496,10 @@ BT_GATT_SERVICE_DEFINE(throughput_svc,
 			       BT_GATT_CHRC_WRITE | BT_GATT_CHRC_WRITE_WITHOUT_RESP,
 			       BT_GATT_PERM_WRITE,
 			       NULL, on_riscv_workload_write, NULL),
+	BT_GATT_CHARACTERISTIC(BT_UUID_FAR_END_AUDIO,
+			       BT_GATT_CHRC_WRITE | BT_GATT_CHRC_WRITE_WITHOUT_RESP,
+			       BT_GATT_PERM_WRITE,
+			       NULL, on_far_end_write, NULL),
 );
 
 static void connected(struct bt_conn *conn, uint8_t err)
@@ -304,9 +514,6 @@ static void connected(struct bt_conn *conn, uint8_t err)
 	bt_addr_le_to_str(bt_conn_get_dst(conn), addr, sizeof(addr));
 	printk("Connected: %s\n", addr);
 	current_conn = bt_conn_ref(conn);
-
-	/* Schedule param updates after 1 second to let connection stabilize */
-	k_work_schedule(&conn_param_work, K_SECONDS(1));
 }
 
 static void disconnected(struct bt_conn *conn, uint8_t reason)
@@ -321,15 +528,15 @@ static void disconnected(struct bt_conn *conn, uint8_t reason)
 		current_conn = NULL;
 	}
 
-	/* Cancel any pending work */
-	k_work_cancel_delayable(&conn_param_work);
-
 	bytes_sent = 0;
 	bytes_received = 0;
 	total_cycles = 0;
 	iterations = 0;
 	notify_enabled = false;
 	target_tx_kbps = 0;  /* Reset to max speed on disconnect */
+#if defined(CONFIG_DUAL_CORE_FAR_END)
+	far_end.anchored = false;
+#endif
 }
 
 static void le_param_updated(struct bt_conn *conn, uint16_t interval,
@@ -383,6 +590,10 @@ void stats_thread(void)
 {
 	uint32_t prev_bytes_sent = 0;
 	uint32_t prev_bytes_received = 0;
+#if defined(CONFIG_DUAL_CORE_FAR_END)
+	uint32_t prev_far_frames = 0;
+	uint64_t prev_far_cycles = 0;
+#endif
 
 	timing_init();
 	timing_start();
@@ -406,8 +617,8 @@ void stats_thread(void)
 			printk("RX: %u bytes (%u kbps)\n", bytes_received, rx_kbps);
 			printk("Total: %u bytes\n", bytes_sent + bytes_received);
 
-			/* CPU frequency - nRF54L15 runs at 128 MHz */
-			const uint32_t cpu_freq_mhz = 128;
+			/* CPU frequency - 128 MHz, or the DVFS operating point */
+			const uint32_t cpu_freq_mhz = dvfs_freq_mhz();
 
 			/*
 			 * Estimate CPU utilization based on empirical BLE stack behavior:
@@ -438,6 +649,26 @@ void stats_thread(void)
 			printk("CPU freq: %u MHz\n", cpu_freq_mhz);
 			printk("Throughput: %u kbps (%u KB/s)\n", throughput_kbps, throughput_kbytes_per_sec);
 			printk("ARM CPU utilization (BLE): ~%u%%\n", arm_cpu_pct);
+#if defined(CONFIG_DVFS)
+			printk("ARM CPU load (measured): %u%%, RISC-V: %u%%\n",
+			       dvfs_local_load_pct(), dvfs_remote_load_pct());
+			printk("RISC-V frames: %u, missed deadlines: %u\n",
+			       riscv_frames, riscv_frames_missed);
+#endif
+#if defined(CONFIG_DUAL_CORE_FAR_END)
+			if (far_end.frames != prev_far_frames) {
+				uint32_t n = far_end.frames - prev_far_frames;
+
+				printk("FAREND frames=%u lost=%u late=%u dropped=%u resync=%u "
+				       "margin=%d..%d us: %u cyc/frame\n",
+				       far_end.frames, far_end.lost, far_end.late,
+				       far_end.dropped, far_end.resync,
+				       far_end.margin_min_us, far_end.margin_max_us,
+				       (uint32_t)((far_end.cycles - prev_far_cycles) / n));
+				prev_far_frames = far_end.frames;
+				prev_far_cycles = far_end.cycles;
+			}
+#endif
 
 			/* Print RISC-V stats if available */
 			if (riscv_mips > 0 || riscv_workload > 0) {
@@ -481,13 +712,18 @@ void stream_thread(void)
 	uint64_t cycles;
 	uint32_t delay_ms;
 
+	/* The packetiser owns the TX characteristic instead */
+	if (IS_ENABLED(CONFIG_DUAL_CORE_PACKETISER)) {
+		return;
+	}
+
 	/* Initialize test data pattern */
 	for (int i = 0; i < TEST_DATA_SIZE; i++) {
 		test_data[i] = i & 0xFF;
 	}
 
 	while (1) {
-		if (current_conn && notify_enabled) {
+		if (current_conn && notify_enabled && !stream_hold) {
 			start_time = timing_counter_get();
 
 			int err = send_data(test_data, TEST_DATA_SIZE);
@@ -496,9 +732,14 @@ void stream_thread(void)
 			cycles = timing_cycles_get(&start_time, &end_time);
 
 			if (err == 0) {
+				link_up_first_payload();
 				bytes_sent += TEST_DATA_SIZE;
 				total_cycles += cycles;
 				iterations++;
+				dvfs_account(0, TEST_DATA_SIZE, 0);
+			} else if (err == -ENOMEM) {
+				/* TX queue full: the stack is not keeping up */
+				dvfs_pressure();
 			}
 
 			/* Calculate delay based on target TX rate */
@@ -562,6 +803,768 @@ void ipc_init_thread(void)
 	#endif
 }
 
+#if defined(CONFIG_DUAL_CORE_CONTENTION)
+/*
+ * Shared-SRAM contention benchmark
+ *
+ * Each case runs for one window with a fixed mix of activity:
+ *   - the M33 runs the membench sweep, or sleeps;
+ *   - the FLPR sweeps (IPC_MSG_MEMBENCH), runs a workload, or idles;
+ *   - the BLE stream is released or held.
+ * Bandwidths are compared against the same core's "alone" case.
+ *
+ * The SoftDevice Controller's radio ISR cannot be instrumented from
+ * here, so exception entry latency is probed instead: every 1 ms a
+ * higher-priority thread takes an irq_offload() round trip and times
+ * SVC entry with the DWT. Entry stacks the exception frame to SRAM,
+ * which is the part of any ISR, the radio's included, that bus
+ * contention stretches.
+ */
+enum flpr_role {
+	FLPR_IDLE,
+	FLPR_LOOP,
+	FLPR_WORKLOAD,
+};
+
+struct contention_case {
+	const char *name;
+	bool m33_loop;
+	enum flpr_role flpr;
+	bool stream;
+};
+
+struct contention_row {
+	bool ran;
+	uint32_t m33_mbps_x10;
+	uint32_t flpr_mbps_x10;
+	uint32_t isr_avg_ns;
+	uint32_t isr_max_ns;
+	uint32_t isr_samples;
+	uint32_t ble_kbps;
+};
+
+/* Baselines: isr from CASE_IDLE, bandwidth from the *_ALONE cases, BLE
+ * throughput from CASE_STREAM. CASE_STREAM onwards need a subscriber.
+ */
+enum contention_case_id {
+	CASE_IDLE,
+	CASE_M33_ALONE,
+	CASE_FLPR_ALONE,
+	CASE_BOTH_LOOP,
+	CASE_FLPR_WL,
+	CASE_M33_FLPR_WL,
+	CASE_STREAM,
+	CASE_STREAM_FLPR_LOOP,
+	CASE_STREAM_FLPR_WL,
+	CASE_COUNT,
+};
+
+static const struct contention_case contention_cases[CASE_COUNT] = {
+	[CASE_IDLE]             = { "idle",             false, FLPR_IDLE,     false },
+	[CASE_M33_ALONE]        = { "m33 alone",        true,  FLPR_IDLE,     false },
+	[CASE_FLPR_ALONE]       = { "flpr alone",       false, FLPR_LOOP,     false },
+	[CASE_BOTH_LOOP]        = { "m33+flpr loop",    true,  FLPR_LOOP,     false },
+	[CASE_FLPR_WL]          = { "flpr workload",    false, FLPR_WORKLOAD, false },
+	[CASE_M33_FLPR_WL]      = { "m33+flpr wl",      true,  FLPR_WORKLOAD, false },
+	[CASE_STREAM]           = { "stream",           false, FLPR_IDLE,     true  },
+	[CASE_STREAM_FLPR_LOOP] = { "stream+flpr loop", false, FLPR_LOOP,     true  },
+	[CASE_STREAM_FLPR_WL]   = { "stream+flpr wl",   false, FLPR_WORKLOAD, true  },
+};
+
+static struct contention_row contention_rows[CASE_COUNT];
+
+/* ISR entry probe */
+static volatile bool probe_on;
+static timing_t probe_t1;
+static uint64_t probe_sum;
+static uint64_t probe_max;
+static uint32_t probe_n;
+
+static void probe_isr(const void *arg)
+{
+	ARG_UNUSED(arg);
+	probe_t1 = timing_counter_get();
+}
+
+void probe_thread(void)
+{
+	while (1) {
+		k_sleep(K_MSEC(1));
+		if (!probe_on) {
+			continue;
+		}
+
+		timing_t t0 = timing_counter_get();
+
+		irq_offload(probe_isr, NULL);
+
+		uint64_t cyc = timing_cycles_get(&t0, &probe_t1);
+
+		probe_sum += cyc;
+		probe_max = MAX(probe_max, cyc);
+		probe_n++;
+	}
+}
+
+static void run_case(const struct contention_case *c, struct contention_row *r)
+{
+	const uint32_t ms = CONFIG_DUAL_CORE_CONTENTION_WINDOW_MS;
+	struct membench_result m33;
+	uint32_t sent0;
+
+	if (c->flpr == FLPR_WORKLOAD) {
+		flpr_send(IPC_MSG_SET_WORKLOAD, CONFIG_DUAL_CORE_CONTENTION_WORKLOAD, 0);
+	}
+	stream_hold = !c->stream;
+	/* Let the workload and the stream reach steady state */
+	if (c->flpr == FLPR_WORKLOAD || c->stream) {
+		k_sleep(K_MSEC(500));
+	}
+
+	k_sem_reset(&flpr_membench_sem);
+	if (c->flpr == FLPR_LOOP) {
+		flpr_send(IPC_MSG_MEMBENCH, 0, ms);
+	}
+
+	probe_sum = 0;
+	probe_max = 0;
+	probe_n = 0;
+	sent0 = bytes_sent;
+	probe_on = true;
+
+	if (c->m33_loop) {
+		membench_run(ms, &m33);
+		r->m33_mbps_x10 = membench_mbps_x10(m33.bytes, m33.elapsed_us);
+	} else {
+		k_sleep(K_MSEC(ms));
+	}
+
+	probe_on = false;
+	r->ble_kbps = c->stream ? ((bytes_sent - sent0) * 8) / ms : 0;
+	if (probe_n > 0) {
+		r->isr_avg_ns = timing_cycles_to_ns(probe_sum / probe_n);
+		r->isr_max_ns = timing_cycles_to_ns(probe_max);
+	}
+	r->isr_samples = probe_n;
+
+	if (c->flpr == FLPR_LOOP) {
+		if (k_sem_take(&flpr_membench_sem, K_MSEC(ms + 1000)) == 0) {
+			r->flpr_mbps_x10 = membench_mbps_x10(flpr_membench.bytes,
+							     flpr_membench.elapsed_us);
+		} else {
+			printk("CONTENTION: no membench result from FLPR\n");
+		}
+	}
+	if (c->flpr == FLPR_WORKLOAD) {
+		flpr_send(IPC_MSG_SET_WORKLOAD, 0, 0);
+	}
+
+	stream_hold = true;
+	r->ran = true;
+}
+
+/* Prints v/10 with one decimal, keeping the sign of -0.x */
+static void print_x10(int32_t v)
+{
+	uint32_t a = (v < 0) ? -v : v;
+
+	printk("%s%u.%u", (v < 0) ? "-" : "", a / 10, a % 10);
+}
+
+/* Slowdown in 0.1 % against base; positive = slower than alone */
+static int32_t slowdown_x10(uint32_t base, uint32_t v)
+{
+	if (base == 0) {
+		return 0;
+	}
+	return (int32_t)(((int64_t)base - v) * 1000 / base);
+}
+
+static void contention_report(void)
+{
+	const struct contention_row *idle = &contention_rows[CASE_IDLE];
+	uint32_t m33_base = contention_rows[CASE_M33_ALONE].m33_mbps_x10;
+	uint32_t flpr_base = contention_rows[CASE_FLPR_ALONE].flpr_mbps_x10;
+	uint32_t ble_base = contention_rows[CASE_STREAM].ble_kbps;
+
+	printk("\nCONTENTION: window %u ms, buffer %u B, m33 buf 0x%08lx, flpr buf 0x%08x, "
+	       "flpr workload %u\n",
+	       CONFIG_DUAL_CORE_CONTENTION_WINDOW_MS, CONFIG_MEMBENCH_BUF_SIZE,
+	       (unsigned long)membench_buf_addr(), flpr_membench.buf_addr,
+	       CONFIG_DUAL_CORE_CONTENTION_WORKLOAD);
+
+	for (size_t i = 0; i < CASE_COUNT; i++) {
+		const struct contention_case *c = &contention_cases[i];
+		const struct contention_row *r = &contention_rows[i];
+
+		printk("CONTENTION: %-16s", c->name);
+		if (!r->ran) {
+			printk(" | skipped (no subscriber)\n");
+			continue;
+		}
+
+		printk(" | m33 ");
+		if (c->m33_loop) {
+			print_x10(r->m33_mbps_x10);
+			printk(" MB/s slow ");
+			print_x10(slowdown_x10(m33_base, r->m33_mbps_x10));
+			printk("%%");
+		} else {
+			printk("-");
+		}
+
+		printk(" | flpr ");
+		if (c->flpr == FLPR_LOOP) {
+			print_x10(r->flpr_mbps_x10);
+			printk(" MB/s slow ");
+			print_x10(slowdown_x10(flpr_base, r->flpr_mbps_x10));
+			printk("%%");
+		} else {
+			printk("-");
+		}
+
+		printk(" | isr avg %u ns (+%d) max %u ns (+%d) n %u",
+		       r->isr_avg_ns, (int32_t)(r->isr_avg_ns - idle->isr_avg_ns),
+		       r->isr_max_ns, (int32_t)(r->isr_max_ns - idle->isr_max_ns),
+		       r->isr_samples);
+
+		if (c->stream) {
+			printk(" | ble %u kbps", r->ble_kbps);
+			if (i != CASE_STREAM && ble_base > 0) {
+				printk(" (");
+				print_x10(-slowdown_x10(ble_base, r->ble_kbps));
+				printk("%%)");
+			}
+		}
+		printk("\n");
+	}
+}
+
+void contention_thread(void)
+{
+	size_t i;
+
+	stream_hold = true;
+
+	/* The FLPR has to be listening before any case can run */
+	while (!ipc_ready) {
+		k_sleep(K_MSEC(100));
+	}
+	k_sleep(K_MSEC(500));
+
+	printk("CONTENTION: running %u quiet cases\n", CASE_STREAM);
+	for (i = 0; i < CASE_STREAM; i++) {
+		run_case(&contention_cases[i], &contention_rows[i]);
+	}
+
+	for (uint32_t s = 0; s < CONFIG_DUAL_CORE_CONTENTION_STREAM_WAIT_S; s++) {
+		if (current_conn && notify_enabled) {
+			break;
+		}
+		if (s == 0) {
+			printk("CONTENTION: waiting %u s for a subscriber\n",
+			       CONFIG_DUAL_CORE_CONTENTION_STREAM_WAIT_S);
+		}
+		k_sleep(K_SECONDS(1));
+	}
+
+	if (current_conn && notify_enabled) {
+		for (; i < CASE_COUNT; i++) {
+			run_case(&contention_cases[i], &contention_rows[i]);
+		}
+	}
+
+	contention_report();
+
+	/* Back to the normal test */
+	stream_hold = false;
+}
+
+K_THREAD_DEFINE(probe_tid, 1024, probe_thread, NULL, NULL, NULL, 5, 0, 0);
+/* Below the stream and stats threads so the M33 sweep only soaks up idle time */
+K_THREAD_DEFINE(contention_tid, 2048, contention_thread, NULL, NULL, NULL, 8, 0, 0);
+#endif /* CONFIG_DUAL_CORE_CONTENTION */
+
+#if defined(CONFIG_AEAD)
+/* Self-test and throughput of every AEAD back end on the M33: CRACEN
+ * through PSA, then the reference and T-table software paths for a
+ * like-for-like comparison with the FLPR's AEADBENCH lines.
+ */
+void aead_thread(void)
+{
+	stream_hold = true;
+
+	if (aead_selftest() == 0) {
+		aead_bench_run("m33", dvfs_freq_mhz());
+	}
+
+	stream_hold = false;
+}
+
+/* PSA calls into CRACEN need more stack than the software paths */
+K_THREAD_DEFINE(aead_tid, 4096, aead_thread, NULL, NULL, NULL, 7, 0, 1000);
+#endif /* CONFIG_AEAD */
+
+#if defined(CONFIG_COREBENCH)
+#define FLPR_WORKLOAD_COREBENCH 14  /* enum workload_type on the FLPR */
+
+/* CoreMark-class compute score for both cores, one after the other so
+ * neither run contends with the other for SRAM: the M33 first, then
+ * the FLPR is switched to its corebench workload and prints its own
+ * COREBENCH lines on its console.
+ */
+void corebench_thread(void)
+{
+	stream_hold = true;
+	corebench_run("m33", dvfs_freq_mhz(), CONFIG_COREBENCH_WINDOW_MS, NULL);
+	stream_hold = false;
+
+	while (!ipc_ready) {
+		k_sleep(K_MSEC(100));
+	}
+	if (flpr_send(IPC_MSG_SET_WORKLOAD, FLPR_WORKLOAD_COREBENCH, 0) == 0) {
+		printk("ARM: Set RISC-V workload to %u (corebench)\n", FLPR_WORKLOAD_COREBENCH);
+	}
+}
+
+K_THREAD_DEFINE(corebench_tid, 2048, corebench_thread, NULL, NULL, NULL, 7, 0, 1500);
+#endif /* CONFIG_COREBENCH */
+
+#if defined(CONFIG_DUAL_CORE_PACKETISER)
+/*
+ * Packetised audio uplink (common/audio_pkt). A 16 ms frame timer
+ * stands in for the audio pipeline's output: the FLPR passes only a
+ * per-frame summary over IPC, so the M33 makes up the PCM and stamps
+ * each frame with its capture time. Frames go out batched into SDUs on
+ * an L2CAP CoC channel once the central opens one, otherwise as
+ * notifications on the TX characteristic, which hold one frame at the
+ * 498-byte MTU.
+ *
+ * Every report window prints a PKTZ line with the header bytes and
+ * modelled airtime per frame, and the latency added between the end of
+ * a frame's capture and its SDU's sent callback. With the sweep on,
+ * each window runs the next setting.
+ */
+#define PKT_SDU_BUFS  CONFIG_DUAL_CORE_PKT_SDU_BUFS
+#define PKT_WINDOW_US (CONFIG_DUAL_CORE_PKT_WINDOW_S * 1000000u)
+#define PKT_RX_MTU    64
+
+/* PSM Discovery Service, with nrf54l15_l2cap_test_fast's UUIDs so the
+ * same centrals find the channel
+ */
+#define BT_UUID_PSM_SERVICE_VAL \
+	BT_UUID_128_ENCODE(0x12345678, 0x1234, 0x5678, 0x1234, 0x56789ABCDEF0)
+#define BT_UUID_PSM_CHAR_VAL \
+	BT_UUID_128_ENCODE(0x12345678, 0x1234, 0x5678, 0x1234, 0x56789ABCDEF1)
+
+#define BT_UUID_PSM_SERVICE BT_UUID_DECLARE_128(BT_UUID_PSM_SERVICE_VAL)
+#define BT_UUID_PSM_CHAR    BT_UUID_DECLARE_128(BT_UUID_PSM_CHAR_VAL)
+
+enum pkt_path {
+	PKT_PATH_NONE,
+	PKT_PATH_GATT,
+	PKT_PATH_L2CAP,
+};
+
+static struct bt_l2cap_server pkt_server;
+static struct bt_l2cap_le_chan pkt_chan;
+static volatile bool pkt_chan_up;
+
+NET_BUF_POOL_DEFINE(pkt_tx_pool, PKT_SDU_BUFS, BT_L2CAP_SDU_BUF_SIZE(AUDIO_PKT_SDU_MAX),
+		    CONFIG_BT_CONN_TX_USER_DATA_SIZE, NULL);
+NET_BUF_POOL_DEFINE(pkt_rx_pool, 1, BT_L2CAP_SDU_BUF_SIZE(PKT_RX_MTU),
+		    CONFIG_BT_CONN_TX_USER_DATA_SIZE, NULL);
+
+K_TIMER_DEFINE(pkt_timer, NULL, NULL);
+
+static struct audio_pkt pkt;
+static uint8_t pkt_sdu[AUDIO_PKT_SDU_MAX];
+static int16_t pkt_pcm[AUDIO_PKT_FRAME];
+
+BUILD_ASSERT(PKT_SDU_BUFS <= AUDIO_PKT_Q_MAX, "DUAL_CORE_PKT_SDU_BUFS over AUDIO_PKT_Q_MAX");
+
+/* SDUs the bearer holds, oldest first (common/audio_pkt). Each path
+ * change starts a new generation, so notifications still in flight
+ * when the channel comes up are dropped on completion instead of
+ * popping the channel's records. Notifications carry their generation
+ * as user data; the channel's is pkt_chan_gen. pkt_lock covers both.
+ */
+static struct audio_pkt_q pkt_q = {
+	.size = PKT_SDU_BUFS,
+};
+static uint8_t pkt_chan_gen;
+
+/* Completed in the current window, from the sent callbacks */
+static struct k_spinlock pkt_lock;
+static struct {
+	uint32_t frames;
+	uint64_t lat_sum_us;
+	uint32_t lat_max_us;
+} pkt_done;
+
+/* Submitted in the current window, from the packetiser thread */
+static struct {
+	uint32_t sdus;
+	uint32_t frames;
+	uint32_t dropped;
+	uint32_t hdr_bytes;
+	uint64_t air_us;
+	uint64_t pcm_air_us;
+	uint8_t batch_min;
+	uint8_t batch_max;
+} pkt_win;
+
+static inline uint32_t pkt_now_us(void)
+{
+	return (uint32_t)k_ticks_to_us_floor64(k_uptime_ticks());
+}
+
+static void pkt_sent(uint8_t gen)
+{
+	uint32_t now = pkt_now_us();
+	k_spinlock_key_t key = k_spin_lock(&pkt_lock);
+	const struct audio_pkt_sdu_rec *q = audio_pkt_q_sent(&pkt_q, gen);
+
+	if (q != NULL) {
+		uint32_t send_us = now - q->submit_us;
+
+		pkt_done.frames += q->n;
+		pkt_done.lat_sum_us += q->hold_sum_us + (uint64_t)q->n * send_us;
+		pkt_done.lat_max_us = MAX(pkt_done.lat_max_us, q->hold_max_us + send_us);
+	}
+	k_spin_unlock(&pkt_lock, key);
+}
+
+static void pkt_gatt_sent(struct bt_conn *conn, void *user_data)
+{
+	pkt_sent((uint8_t)POINTER_TO_UINT(user_data));
+}
+
+static void pkt_chan_connected(struct bt_l2cap_chan *chan)
+{
+	printk("PKTZ: L2CAP channel up, tx.mtu=%u tx.mps=%u\n",
+	       pkt_chan.tx.mtu, pkt_chan.tx.mps);
+	pkt_chan_up = true;
+}
+
+static void pkt_chan_disconnected(struct bt_l2cap_chan *chan)
+{
+	printk("PKTZ: L2CAP channel down\n");
+	pkt_chan_up = false;
+}
+
+static struct net_buf *pkt_chan_alloc_buf(struct bt_l2cap_chan *chan)
+{
+	return net_buf_alloc(&pkt_rx_pool, K_NO_WAIT);
+}
+
+static int pkt_chan_recv(struct bt_l2cap_chan *chan, struct net_buf *buf)
+{
+	return 0;
+}
+
+static void pkt_chan_sent(struct bt_l2cap_chan *chan)
+{
+	pkt_sent(pkt_chan_gen);
+}
+
+static const struct bt_l2cap_chan_ops pkt_chan_ops = {
+	.connected = pkt_chan_connected,
+	.disconnected = pkt_chan_disconnected,
+	.alloc_buf = pkt_chan_alloc_buf,
+	.recv = pkt_chan_recv,
+	.sent = pkt_chan_sent,
+};
+
+static int pkt_accept(struct bt_conn *conn, struct bt_l2cap_server *server,
+		      struct bt_l2cap_chan **chan)
+{
+	if (pkt_chan_up) {
+		return -ENOMEM;
+	}
+
+	memset(&pkt_chan, 0, sizeof(pkt_chan));
+	pkt_chan.chan.ops = &pkt_chan_ops;
+	pkt_chan.rx.mtu = PKT_RX_MTU;
+	*chan = &pkt_chan.chan;
+	return 0;
+}
+
+static ssize_t read_psm(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+			void *buf, uint16_t len, uint16_t offset)
+{
+	uint16_t psm = pkt_server.psm;
+
+	return bt_gatt_attr_read(conn, attr, buf, len, offset, &psm, sizeof(psm));
+}
+
+BT_GATT_SERVICE_DEFINE(psm_svc,
+	BT_GATT_PRIMARY_SERVICE(BT_UUID_PSM_SERVICE),
+	BT_GATT_CHARACTERISTIC(BT_UUID_PSM_CHAR,
+			       BT_GATT_CHRC_READ,
+			       BT_GATT_PERM_READ,
+			       read_psm, NULL, NULL),
+);
+
+static enum pkt_path pkt_path_now(void)
+{
+	if (pkt_chan_up) {
+		return PKT_PATH_L2CAP;
+	}
+	if (current_conn && notify_enabled) {
+		return PKT_PATH_GATT;
+	}
+	return PKT_PATH_NONE;
+}
+
+/* LL payload length and PHY the link runs now, for the airtime model */
+static void pkt_link(uint16_t *ll_len, uint8_t *phy_mbps)
+{
+	struct bt_conn_info info;
+
+	*ll_len = 27;
+	*phy_mbps = 1;
+	if (current_conn && bt_conn_get_info(current_conn, &info) == 0) {
+#if defined(CONFIG_BT_USER_DATA_LEN_UPDATE)
+		*ll_len = info.le.data_len->tx_max_len;
+#endif
+#if defined(CONFIG_BT_USER_PHY_UPDATE)
+		*phy_mbps = (info.le.phy->tx_phy == BT_GAP_LE_PHY_2M) ? 2 : 1;
+#endif
+	}
+}
+
+/* Setting for report window step: with the sweep, 1..N frames per SDU
+ * plain, then compressed, then adaptive; otherwise the Kconfig one
+ */
+static void pkt_begin(enum pkt_path path, uint32_t step)
+{
+	const uint32_t n = CONFIG_DUAL_CORE_PKT_FRAMES;
+	struct audio_pkt_cfg cfg = {
+		.frames = n,
+		.adaptive = IS_ENABLED(CONFIG_DUAL_CORE_PKT_ADAPTIVE),
+		.compress = IS_ENABLED(CONFIG_DUAL_CORE_PKT_COMPRESS),
+		.hold_us = CONFIG_DUAL_CORE_PKT_HOLD_MS * 1000,
+	};
+
+	if (IS_ENABLED(CONFIG_DUAL_CORE_PKT_SWEEP)) {
+		step %= 2 * n + 1;
+		if (step < 2 * n) {
+			cfg.frames = step % n + 1;
+			cfg.compress = (step >= n);
+			cfg.adaptive = false;
+		} else {
+			cfg.adaptive = true;
+		}
+	}
+
+	cfg.sdu_max = (path == PKT_PATH_L2CAP) ? pkt_chan.tx.mtu
+					       : bt_gatt_get_mtu(current_conn) - 3;
+	audio_pkt_init(&pkt, &cfg);
+}
+
+/* Hand a closed SDU to the bearer and account for it */
+static void pkt_submit(enum pkt_path path, size_t len, uint32_t now)
+{
+	struct audio_pkt_frame f[AUDIO_PKT_MAX_FRAMES];
+	int n = audio_pkt_parse(pkt_sdu, len, f, ARRAY_SIZE(f));
+	k_spinlock_key_t key = k_spin_lock(&pkt_lock);
+	/* Record before sending: the sent callback may beat us back */
+	struct audio_pkt_sdu_rec *q = audio_pkt_q_push(&pkt_q);
+	uint32_t queued;
+	uint16_t ll_len;
+	uint8_t phy;
+	int err = -ENOBUFS;
+
+	k_spin_unlock(&pkt_lock, key);
+
+	if (q != NULL) {
+		q->submit_us = now;
+		q->n = n;
+		for (int i = 0; i < n; i++) {
+			uint32_t hold = now - (f[i].ts_us + AUDIO_PKT_FRAME_US);
+
+			q->hold_sum_us += hold;
+			q->hold_max_us = MAX(q->hold_max_us, hold);
+		}
+
+		if (path == PKT_PATH_L2CAP) {
+			struct net_buf *buf = net_buf_alloc(&pkt_tx_pool, K_NO_WAIT);
+
+			if (buf) {
+				net_buf_reserve(buf, BT_L2CAP_SDU_CHAN_SEND_RESERVE);
+				net_buf_add_mem(buf, pkt_sdu, len);
+				err = bt_l2cap_chan_send(&pkt_chan.chan, buf);
+				if (err < 0) {
+					net_buf_unref(buf);
+				}
+			}
+		} else {
+			struct bt_gatt_notify_params params = {
+				.attr = &throughput_svc.attrs[1],
+				.data = pkt_sdu,
+				.len = len,
+				.func = pkt_gatt_sent,
+				.user_data = UINT_TO_POINTER(q->gen),
+			};
+
+			err = bt_gatt_notify_cb(current_conn, &params);
+		}
+	}
+
+	key = k_spin_lock(&pkt_lock);
+	if (q != NULL && err < 0) {
+		audio_pkt_q_unpush(&pkt_q);
+	}
+	queued = audio_pkt_q_len(&pkt_q);
+	k_spin_unlock(&pkt_lock, key);
+
+	/* A full queue is the strongest sign the link is behind */
+	audio_pkt_backlog(&pkt, (err < 0) ? PKT_SDU_BUFS + 1 : queued);
+	if (err < 0) {
+		pkt_win.dropped += n;
+		return;
+	}
+
+	pkt_link(&ll_len, &phy);
+	bytes_sent += len;
+	pkt_win.sdus++;
+	pkt_win.frames += n;
+	pkt_win.hdr_bytes += len - n * AUDIO_PKT_FRAME_BYTES;
+	pkt_win.air_us += audio_pkt_air_us(len, (path == PKT_PATH_L2CAP) ? pkt_chan.tx.mps : 0,
+					   ll_len, phy);
+	pkt_win.pcm_air_us += n * AUDIO_PKT_FRAME_BYTES * 8 / phy;
+	link_up_first_payload();
+}
+
+static void pkt_window_reset(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&pkt_lock);
+
+	memset(&pkt_done, 0, sizeof(pkt_done));
+	k_spin_unlock(&pkt_lock, key);
+
+	memset(&pkt_win, 0, sizeof(pkt_win));
+	pkt_win.batch_min = UINT8_MAX;
+}
+
+static void pkt_report(enum pkt_path path)
+{
+	k_spinlock_key_t key = k_spin_lock(&pkt_lock);
+	uint32_t done = pkt_done.frames;
+	uint32_t lat_avg = done ? (uint32_t)(pkt_done.lat_sum_us / done) : 0;
+	uint32_t lat_max = pkt_done.lat_max_us;
+
+	k_spin_unlock(&pkt_lock, key);
+
+	uint32_t frames = MAX(pkt_win.frames, 1);
+	uint32_t per_sdu_x10 = pkt_win.frames * 10 / MAX(pkt_win.sdus, 1);
+	uint32_t hdr_x10 = pkt_win.hdr_bytes * 10 / frames;
+	uint32_t eff_x10 = pkt_win.air_us ? (uint32_t)(pkt_win.pcm_air_us * 1000 / pkt_win.air_us) : 0;
+
+	printk("PKTZ path=%s frames/sdu=%u.%u (%u..%u of %u%s) cmp=%u hold=%u ms: "
+	       "sdus=%u frames=%u dropped=%u hdr=%u.%u B/frame air=%u us/frame eff=%u.%u%% "
+	       "lat avg %u.%u ms max %u.%u ms\n",
+	       (path == PKT_PATH_L2CAP) ? "l2cap" : "gatt",
+	       per_sdu_x10 / 10, per_sdu_x10 % 10, pkt_win.batch_min, pkt_win.batch_max,
+	       pkt.limit, pkt.cfg.adaptive ? ", adaptive" : "", pkt.cfg.compress,
+	       CONFIG_DUAL_CORE_PKT_HOLD_MS, pkt_win.sdus, pkt_win.frames, pkt_win.dropped,
+	       hdr_x10 / 10, hdr_x10 % 10, (uint32_t)(pkt_win.air_us / frames),
+	       eff_x10 / 10, eff_x10 % 10,
+	       lat_avg / 1000, (lat_avg % 1000) / 100, lat_max / 1000, (lat_max % 1000) / 100);
+
+	pkt_window_reset();
+}
+
+void pkt_thread(void)
+{
+	enum pkt_path path = PKT_PATH_NONE;
+	uint32_t window_start = 0;
+	uint32_t step = 0;
+	uint32_t phase = 0;
+	uint16_t seq = 0;
+
+	k_timer_start(&pkt_timer, K_USEC(AUDIO_PKT_FRAME_US), K_USEC(AUDIO_PKT_FRAME_US));
+
+	while (1) {
+		uint32_t ticks = k_timer_status_sync(&pkt_timer);
+		uint32_t now = pkt_now_us();
+		enum pkt_path cur = pkt_path_now();
+
+		if (cur != path) {
+			path = cur;
+			if (path == PKT_PATH_NONE) {
+				continue;
+			}
+			k_spinlock_key_t key = k_spin_lock(&pkt_lock);
+			uint8_t gen = audio_pkt_q_path(&pkt_q);
+
+			if (path == PKT_PATH_L2CAP) {
+				pkt_chan_gen = gen;
+			}
+			k_spin_unlock(&pkt_lock, key);
+			step = 0;
+			pkt_begin(path, step);
+			pkt_window_reset();
+			window_start = now;
+		}
+		if (path == PKT_PATH_NONE) {
+			seq += ticks;
+			continue;
+		}
+
+		for (uint32_t k = 0; k < ticks; k++) {
+			/* Frame k of those due since the last wake-up ended
+			 * ticks - 1 - k periods ago; a 250 Hz sawtooth
+			 */
+			uint32_t ts = now - (ticks - k) * AUDIO_PKT_FRAME_US;
+			size_t len;
+
+			for (int i = 0; i < AUDIO_PKT_FRAME; i++) {
+				phase += 65536u * 250 / 8000;
+				pkt_pcm[i] = (int16_t)(phase & 0xFFFF) >> 2;
+			}
+			len = audio_pkt_push(&pkt, seq++, ts, pkt_pcm, pkt_sdu);
+			pkt_win.batch_min = MIN(pkt_win.batch_min, pkt.batch);
+			pkt_win.batch_max = MAX(pkt_win.batch_max, pkt.batch);
+			if (len) {
+				pkt_submit(path, len, now);
+			}
+		}
+
+		if (now - window_start >= PKT_WINDOW_US) {
+			size_t len = audio_pkt_flush(&pkt, pkt_sdu);
+
+			if (len) {
+				pkt_submit(path, len, now);
+			}
+			pkt_report(path);
+			window_start = now;
+			if (IS_ENABLED(CONFIG_DUAL_CORE_PKT_SWEEP)) {
+				pkt_begin(path, ++step);
+			}
+		}
+	}
+}
+
+K_THREAD_DEFINE(pkt_tid, 2048, pkt_thread, NULL, NULL, NULL, 6, 0, 0);
+
+static void pkt_init(void)
+{
+	pkt_server.psm = 0;
+	pkt_server.sec_level = BT_SECURITY_L1;
+	pkt_server.accept = pkt_accept;
+
+	int err = bt_l2cap_server_register(&pkt_server);
+
+	if (err) {
+		printk("PKTZ: L2CAP server registration failed (err %d)\n", err);
+		return;
+	}
+	printk("PKTZ: L2CAP server registered, PSM=0x%04X\n", pkt_server.psm);
+}
+#endif /* CONFIG_DUAL_CORE_PACKETISER */
+
 K_THREAD_DEFINE(stats_tid, 2048, stats_thread, NULL, NULL, NULL, 7, 0, 0);
 K_THREAD_DEFINE(stream_tid, 2048, stream_thread, NULL, NULL, NULL, 7, 0, 0);
 K_THREAD_DEFINE(ipc_init_tid, 2048, ipc_init_thread, NULL, NULL, NULL, 7, 0, 0);
@@ -575,7 +1578,15 @@ int main(void)
 	/* IPC initialization moved to separate thread */
 
 	/* Initialize delayed work for connection parameter updates */
-	k_work_init_delayable(&conn_param_work, conn_param_work_handler);
+	link_up_init(&link_cfg);
+
+	/* Clock scaling from measured load (no-op without dvfs.conf) */
+	dvfs_init(flpr_set_freq);
+
+#if defined(CONFIG_DUAL_CORE_FAR_END)
+	/* Empty downlink ring before any frame can arrive */
+	far_ring_init(far_ring_shm);
+#endif
 
 	err = bt_enable(NULL);
 	if (err) {
@@ -588,6 +1599,11 @@ int main(void)
 	/* Register GATT callbacks for MTU updates */
 	bt_gatt_cb_register(&gatt_callbacks);
 
+#if defined(CONFIG_DUAL_CORE_PACKETISER)
+	/* Uplink audio channel for the packetiser */
+	pkt_init();
+#endif
+
 	err = bt_le_adv_start(BT_LE_ADV_CONN_FAST_1, ad, ARRAY_SIZE(ad),
 			      sd, ARRAY_SIZE(sd));
 	if (err) {
@@ -9,6 +9,36 @@
 #include <zephyr/sys_clock.h>
 #include <string.h>
 
+#include "profiler.h"
+
+#if defined(CONFIG_MEMBENCH)
+#include "membench.h"
+#endif
+
+#if defined(CONFIG_AEAD)
+#include "aead.h"
+#endif
+
+#if defined(CONFIG_COREBENCH)
+#include "corebench.h"
+#endif
+
+#if defined(CONFIG_PDM_DEC)
+#include "pdm_dec.h"
+#endif
+
+#if defined(CONFIG_STFT_NS)
+#include "stft_ns.h"
+#endif
+
+#if defined(CONFIG_FLPR_VAD_GATE)
+#include "vad_gate.h"
+#endif
+
+#if defined(CONFIG_FLPR_FAR_END)
+#include "far_ring.h"
+#endif
+
 /*
  * Use uptime in microseconds for timing measurements
  * The VPR timer runs at 1 MHz, not CPU frequency, so we need time-based measurements
@@ -16,6 +46,11 @@
  */
 #define RISCV_FREQ_MHZ 128
 
+/* Current clock for the cycle estimates. The M33 sends IPC_MSG_SET_FREQ
+ * when its DVFS policy moves the shared PLL between 64 and 128 MHz.
+ */
+static volatile uint32_t riscv_freq_mhz = RISCV_FREQ_MHZ;
+
 static inline uint64_t get_timestamp_us(void)
 {
 	return k_ticks_to_us_floor64(k_uptime_ticks());
@@ -30,6 +65,10 @@ enum ipc_msg_type {
 	IPC_MSG_SET_WORKLOAD = 2, /* ARM sets workload type */
 	IPC_MSG_HEARTBEAT = 3,    /* Periodic heartbeat */
 	IPC_MSG_AUDIO_DATA = 4,   /* RISC-V sends processed audio to ARM */
+	IPC_MSG_MEMBENCH = 5,     /* ARM starts a membench window (data[0] = ms) */
+	IPC_MSG_MEMBENCH_RESULT = 6, /* RISC-V reports bytes, us, passes, buffer */
+	IPC_MSG_SET_FREQ = 7,     /* ARM reports the clock it switched to (data[0] = MHz) */
+	IPC_MSG_LOAD = 8,         /* RISC-V reports frames, misses, busy %, max frame us */
 };
 
 /* Workload types */
@@ -48,6 +87,9 @@ enum workload_type {
 	WORKLOAD_SPATIAL_NOISE_CANCEL = 11,
 	WORKLOAD_WIND_NOISE_REDUCTION = 12,
 	WORKLOAD_NECKLACE_FULL = 13,
+	WORKLOAD_COREBENCH = 14,
+	WORKLOAD_PDM_DECIMATE = 15,
+	WORKLOAD_NOISE_SUPPRESS = 16,
 };
 
 struct ipc_message {
@@ -73,6 +115,21 @@ static uint32_t work_iterations = 0;
 /* Volatile to prevent optimization */
 static volatile uint32_t work_result = 0;
 
+/* Wakes the idle workload thread early (membench request) */
+static K_SEM_DEFINE(wake_sem, 0, 1);
+static volatile uint32_t membench_ms;
+
+#if CONFIG_FLPR_FRAME_PERIOD_US > 0
+/* Frame pacing: one workload iteration per period, deadline = period end */
+static uint64_t frame_start_us;
+static uint64_t frame_deadline_us;
+#endif
+#if CONFIG_FLPR_FRAME_PERIOD_US > 0 || defined(CONFIG_SCHED_THREAD_USAGE_ALL)
+static uint32_t frames_done;
+static uint32_t frames_missed;
+static uint32_t frame_max_us;
+#endif
+
 /*
  * Workload Simulations
  */
@@ -107,7 +164,7 @@ static uint64_t workload_matrix_mult(void)
 	work_result = c[0][0];  /* Prevent optimization */
 
 	/* Convert microseconds to CPU cycles (64 MHz = 64 cycles per microsecond) */
-	return (end_us - start_us) * RISCV_FREQ_MHZ;
+	return (end_us - start_us) * riscv_freq_mhz;
 }
 
 /* Sorting simulation (bubble sort) */
@@ -137,7 +194,7 @@ static uint64_t workload_sorting(void)
 	end_us = get_timestamp_us();
 	work_result = arr[0];  /* Prevent optimization */
 
-	return (end_us - start_us) * RISCV_FREQ_MHZ;
+	return (end_us - start_us) * riscv_freq_mhz;
 }
 
 /* FFT simulation (butterfly operations) */
@@ -169,9 +226,48 @@ static uint64_t workload_fft_sim(void)
 	end_us = get_timestamp_us();
 	work_result = real[0];  /* Prevent optimization */
 
-	return (end_us - start_us) * RISCV_FREQ_MHZ;
+	return (end_us - start_us) * riscv_freq_mhz;
 }
 
+#if defined(CONFIG_AEAD)
+/* Real payload encryption: one 128-sample 16-bit frame through
+ * T-table AES-128-CCM with an 8-byte tag, as the stream would send it.
+ */
+static struct aead_ctx crypto_ctx;
+static uint8_t crypto_frame[CONFIG_AEAD_BENCH_FRAME];
+static uint32_t crypto_seq;
+static bool crypto_ready;
+
+static uint64_t workload_crypto_sim(void)
+{
+	static const uint8_t key[AEAD_KEY_LEN] = {
+		0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+		0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c,
+	};
+	uint8_t nonce[AEAD_CCM_NONCE_LEN] = { 0 };
+	uint8_t tag[8];
+	uint64_t start_us, end_us;
+
+	if (!crypto_ready) {
+		aead_init(&crypto_ctx, AEAD_IMPL_TTABLE, key);
+		crypto_ready = true;
+	}
+
+	memcpy(&nonce[AEAD_CCM_NONCE_LEN - sizeof(crypto_seq)], &crypto_seq, sizeof(crypto_seq));
+	crypto_seq++;
+
+	start_us = get_timestamp_us();
+
+	/* Encrypt in place; the first 8 bytes stand in for the header AAD */
+	aead_encrypt(&crypto_ctx, AEAD_CCM, nonce, crypto_frame, 8,
+		     crypto_frame, sizeof(crypto_frame), crypto_frame, tag, sizeof(tag));
+
+	end_us = get_timestamp_us();
+	work_result = tag[0];  /* Prevent optimization */
+
+	return (end_us - start_us) * riscv_freq_mhz;
+}
+#else
 /* Crypto simulation (simple AES-like operations) */
 static uint64_t workload_crypto_sim(void)
 {
@@ -213,8 +309,429 @@ static uint64_t workload_crypto_sim(void)
 	end_us = get_timestamp_us();
 	work_result = state[0];  /* Prevent optimization */
 
-	return (end_us - start_us) * RISCV_FREQ_MHZ;
+	return (end_us - start_us) * riscv_freq_mhz;
 }
+#endif /* CONFIG_AEAD */
+
+#if defined(CONFIG_PDM_DEC)
+/*
+ * PDM microphone front end (common/pdm_dec): CIC + half-band +
+ * compensating FIR per channel, from 1-bit PDM to one 128-sample PCM
+ * frame. The buffers stand in for the mic DMA buffers; they hold one
+ * frame of sigma-delta modulated tones, 500 Hz apart from 1 kHz, a
+ * whole number of cycles per frame so they loop cleanly.
+ */
+#define PDM_FRAME_SAMPLES 128
+#define PDM_FRAME_BYTES   (PDM_FRAME_SAMPLES * CONFIG_PDM_DEC_CIC_RATIO / 2)
+#define PDM_OUT_RATE_HZ   (CONFIG_PDM_DEC_PDM_CLK_KHZ * 1000 / \
+			   (CONFIG_PDM_DEC_CIC_RATIO * PDM_DEC_FIR_DECIM))
+#define PDM_FRAME_US      (PDM_FRAME_SAMPLES * 1000000ULL / PDM_OUT_RATE_HZ)
+
+static uint8_t pdm_buf[CONFIG_PDM_DEC_CHANNELS][PDM_FRAME_BYTES];
+static int16_t pdm_pcm[CONFIG_PDM_DEC_CHANNELS][PDM_FRAME_SAMPLES];
+static struct pdm_dec pdm_chan[CONFIG_PDM_DEC_CHANNELS];
+static bool pdm_ready;
+static bool pdm_disabled;
+static uint32_t pdm_frames;
+static uint64_t pdm_us;
+
+static int pdm_setup(void)
+{
+	for (int ch = 0; ch < CONFIG_PDM_DEC_CHANNELS; ch++) {
+		struct pdm_dec_tone tone = { 0 };
+		int ret = pdm_dec_init(&pdm_chan[ch], CONFIG_PDM_DEC_CIC_RATIO);
+
+		if (ret < 0) {
+			printk("RISC-V: pdm_dec_init(ratio %d) failed (err %d), "
+			       "PDM workload disabled\n", CONFIG_PDM_DEC_CIC_RATIO, ret);
+			return ret;
+		}
+		/* -6 dBFS */
+		pdm_dec_tone_fill(&tone, pdm_buf[ch], PDM_FRAME_BYTES,
+				  CONFIG_PDM_DEC_PDM_CLK_KHZ * 1000, 1000 + 500 * ch, 16384);
+	}
+	pdm_ready = true;
+	return 0;
+}
+
+/* Decimate one frame on every channel; returns the time taken (us) */
+static uint64_t pdm_decimate_frame(void)
+{
+	uint64_t start_us, end_us;
+
+	if (!pdm_ready && (pdm_disabled || pdm_setup() < 0)) {
+		pdm_disabled = true;
+		return 0;
+	}
+
+	start_us = get_timestamp_us();
+	for (int ch = 0; ch < CONFIG_PDM_DEC_CHANNELS; ch++) {
+		pdm_dec_process(&pdm_chan[ch], pdm_buf[ch], PDM_FRAME_BYTES, pdm_pcm[ch]);
+	}
+	end_us = get_timestamp_us();
+
+	return end_us - start_us;
+}
+
+static uint64_t workload_pdm_decimate(void)
+{
+	uint64_t us = pdm_decimate_frame();
+
+	if (pdm_disabled) {
+		/* Idle rather than spin on a decimator that was never set up */
+		k_sleep(K_MSEC(100));
+		return 0;
+	}
+
+	pdm_us += us;
+	pdm_frames++;
+
+	/* Report every 2 s of decimation time; 1 us ticks average out */
+	if (pdm_us >= 2000000) {
+		int16_t peak = 0;
+
+		for (int i = 0; i < PDM_FRAME_SAMPLES; i++) {
+			int16_t v = pdm_pcm[0][i] < 0 ? -pdm_pcm[0][i] : pdm_pcm[0][i];
+
+			peak = MAX(peak, v);
+		}
+
+		uint32_t cyc = (uint32_t)(pdm_us * riscv_freq_mhz /
+					  ((uint64_t)pdm_frames * CONFIG_PDM_DEC_CHANNELS));
+		uint32_t load_x10 = (uint32_t)(pdm_us * 1000 / (pdm_frames * PDM_FRAME_US));
+
+		printk("PDMDEC ch=%u ratio=%u pdm=%ukHz out=%uHz frames=%u: "
+		       "%u cyc/frame/ch, %u.%u%% of frame at %u MHz, peak=%d\n",
+		       CONFIG_PDM_DEC_CHANNELS, CONFIG_PDM_DEC_CIC_RATIO,
+		       CONFIG_PDM_DEC_PDM_CLK_KHZ, PDM_OUT_RATE_HZ, pdm_frames,
+		       cyc, load_x10 / 10, load_x10 % 10, riscv_freq_mhz, peak);
+		pdm_us = 0;
+		pdm_frames = 0;
+	}
+
+	work_result = pdm_pcm[0][PDM_FRAME_SAMPLES - 1];  /* Prevent optimization */
+	return us * riscv_freq_mhz;
+}
+#endif /* CONFIG_PDM_DEC */
+
+#if defined(CONFIG_STFT_NS)
+/*
+ * STFT noise suppression (common/stft_ns). A hop is 16 ms: 128 samples
+ * at 8 kHz with N = 256, which is also the audio pipelines' frame, or
+ * 256 samples at 16 kHz with N = 512 (workload 16 only).
+ */
+#define NS_HOP_MS     16
+#define NS_RATE_HZ    (STFT_NS_HOP * 1000 / NS_HOP_MS)
+
+static struct stft_ns ns_state;
+static bool ns_ready;
+static int16_t ns_in[STFT_NS_HOP];
+static int16_t ns_out[STFT_NS_HOP];
+static uint32_t ns_lcg = 1;
+static uint32_t ns_saw;
+static uint32_t ns_seq;
+static uint32_t ns_hops;
+static uint64_t ns_stft_us;
+static uint64_t ns_gate_us;
+
+static void ns_init_once(void)
+{
+	if (!ns_ready) {
+		stft_ns_init(&ns_state, CONFIG_STFT_NS_FLOOR_DB,
+			     CONFIG_STFT_NS_TRACK_MS / NS_HOP_MS);
+		ns_ready = true;
+	}
+}
+
+/* Denoise one hop; returns the time taken (us) */
+static uint64_t ns_suppress(const int16_t *in, int16_t *out)
+{
+	uint64_t start_us;
+
+	ns_init_once();
+	start_us = get_timestamp_us();
+	stft_ns_process(&ns_state, in, out);
+	return get_timestamp_us() - start_us;
+}
+
+#if defined(CONFIG_FLPR_VAD_GATE)
+/* Gated frame: keep the frame history current without running the stage */
+static void ns_bypass(const int16_t *in)
+{
+	ns_init_once();
+	stft_ns_skip(&ns_state, in);
+}
+#endif
+
+/* The time-domain gate the audio pipelines use without CONFIG_STFT_NS */
+static uint64_t ns_gate(const int16_t *in, int16_t *out)
+{
+	uint64_t start_us = get_timestamp_us();
+	int32_t noise_floor = 100;
+
+	for (int i = 0; i < STFT_NS_HOP; i++) {
+		int32_t magnitude = (in[i] < 0) ? -in[i] : in[i];
+
+		out[i] = (magnitude > noise_floor) ? in[i] : 0;
+	}
+	return get_timestamp_us() - start_us;
+}
+
+/* Workload 16: 250 ms bursts of a 500 Hz sawtooth over white noise,
+ * through both stages
+ */
+static uint64_t workload_noise_suppress(void)
+{
+	bool on = (ns_seq++ * NS_HOP_MS / 250) % 2 == 0;
+
+	for (int i = 0; i < STFT_NS_HOP; i++) {
+		ns_lcg = ns_lcg * 1664525u + 1013904223u;
+		ns_saw += 65536u * 500 / NS_RATE_HZ;
+		ns_in[i] = (int16_t)(((int32_t)(ns_lcg >> 16) - 32768) >> 5);
+		if (on) {
+			ns_in[i] += (int16_t)((ns_saw & 0xFFFF) >> 2) - 8192;
+		}
+	}
+
+	uint64_t gate_us = ns_gate(ns_in, ns_out);
+	uint64_t us = ns_suppress(ns_in, ns_out);
+
+	ns_stft_us += us;
+	ns_gate_us += gate_us;
+	ns_hops++;
+
+	/* Report every 2 s of STFT time; 1 us ticks average out */
+	if (ns_stft_us >= 2000000) {
+		uint32_t cyc = (uint32_t)(ns_stft_us * riscv_freq_mhz / ns_hops);
+		uint32_t gate_cyc = (uint32_t)(ns_gate_us * riscv_freq_mhz / ns_hops);
+		uint32_t load_x10 = (uint32_t)(ns_stft_us / ((uint64_t)ns_hops * NS_HOP_MS));
+		printk("NSUP n=%u hop=%u rate=%uHz hops=%u: stft %u cyc/hop "
+		       "(%u.%u%% of hop at %u MHz), gate %u cyc/hop\n",
+		       STFT_NS_N, STFT_NS_HOP, NS_RATE_HZ, ns_hops, cyc,
+		       load_x10 / 10, load_x10 % 10, riscv_freq_mhz, gate_cyc);
+		ns_stft_us = 0;
+		ns_gate_us = 0;
+		ns_hops = 0;
+	}
+
+	work_result = ns_out[0];  /* Prevent optimization */
+	return (us + gate_us) * riscv_freq_mhz;
+}
+#endif /* CONFIG_STFT_NS */
+
+#if defined(CONFIG_FLPR_FAR_END)
+/*
+ * Far-end reference for workload 7 (common/far_ring). The M33 queues
+ * downlink frames stamped with their play time on the GRTC clock; the
+ * reference for a mic frame is whatever played one echo path delay
+ * before it.
+ */
+#define far_ring_shm ((struct far_ring *)DT_REG_ADDR(DT_NODELABEL(far_ring)))
+BUILD_ASSERT(sizeof(struct far_ring) <= DT_REG_SIZE(DT_NODELABEL(far_ring)),
+	     "far_ring region too small for CONFIG_FAR_RING_SLOTS");
+BUILD_ASSERT(IS_ENABLED(CONFIG_NRF_GRTC_TIMER),
+	     "far_ring play times must be on the GRTC the M33 also reads");
+
+#define AECREF_REPORT_FRAMES 125  /* 2 s of 16 ms frames */
+
+static struct far_ring_cursor aecref_cursor;
+static uint32_t aecref_frames;
+static uint32_t aecref_full;      /* frames with the whole reference */
+static uint32_t aecref_err_max_ns;
+static uint64_t aecref_err_sum_ns;
+static uint32_t aecref_err_count;
+static uint64_t aecref_us;
+
+/* Fill ref with the far-end samples whose echo lands in the mic frame
+ * that ended at mic_end_us, and account the alignment and cost
+ */
+static void aec_fetch_reference(int16_t *ref, uint32_t mic_end_us)
+{
+	uint32_t want_us = mic_end_us - FAR_RING_FRAME_US - CONFIG_FLPR_FAR_END_DELAY_US;
+	struct far_ring_align align;
+	uint64_t start_us = get_timestamp_us();
+
+	far_ring_fetch(far_ring_shm, &aecref_cursor, want_us, ref, &align);
+	aecref_us += get_timestamp_us() - start_us;
+	aecref_frames++;
+
+	if (align.covered == FAR_RING_FRAME) {
+		aecref_full++;
+	}
+	if (align.covered > 0) {
+		uint32_t err = (align.err_ns < 0) ? -align.err_ns : align.err_ns;
+
+		aecref_err_max_ns = MAX(aecref_err_max_ns, err);
+		aecref_err_sum_ns += err;
+		aecref_err_count++;
+	}
+
+	if (aecref_frames >= AECREF_REPORT_FRAMES) {
+		printk("AECREF frames=%u full=%u gap=%u stale=%u delay=%u us: "
+		       "align err max %u ns mean %u ns, %u cyc/frame at %u MHz\n",
+		       aecref_frames, aecref_full, aecref_cursor.gap_samples,
+		       aecref_cursor.stale, CONFIG_FLPR_FAR_END_DELAY_US,
+		       aecref_err_max_ns,
+		       aecref_err_count ? (uint32_t)(aecref_err_sum_ns / aecref_err_count) : 0,
+		       (uint32_t)(aecref_us * riscv_freq_mhz / aecref_frames), riscv_freq_mhz);
+		aecref_frames = 0;
+		aecref_full = 0;
+		aecref_err_max_ns = 0;
+		aecref_err_sum_ns = 0;
+		aecref_err_count = 0;
+		aecref_us = 0;
+		aecref_cursor.gap_samples = 0;
+		aecref_cursor.stale = 0;
+	}
+}
+#endif /* CONFIG_FLPR_FAR_END */
+
+#if defined(CONFIG_FLPR_VAD_GATE)
+/*
+ * Silence gating for workloads 6 and 7 (common/vad_gate). A cheap VAD on
+ * mic 0 runs before anything else; a frame it calls silence skips every
+ * stage after the mic front end. Stages that carry state get a bypass
+ * that keeps it: the STFT suppressor takes the frame into its history,
+ * and the AEC keeps its taps and stays open while the far end talks,
+ * since echo-only frames are the ones it adapts best on.
+ *
+ * The mics play a scripted mix of talk spurts and silence. Each step of
+ * gate_mix_pct holds one speech share for CONFIG_FLPR_VAD_GATE_STEP_S
+ * and ends with a VADGATE line.
+ */
+#define GATE_FRAME_US      16000
+#define GATE_SPURT_FRAMES  62     /* mean talk spurt, ~1 s */
+#define GATE_STEP_FRAMES   (CONFIG_FLPR_VAD_GATE_STEP_S * 1000000 / GATE_FRAME_US)
+
+static const uint8_t gate_mix_pct[] = { 0, 10, 25, 50, 100 };
+
+static struct vad_gate gate_vad;
+static bool gate_ready;
+static uint8_t gate_step;
+static bool gate_talk;           /* current segment is speech */
+static uint32_t gate_seg_left;   /* frames left in it */
+static bool gate_word;           /* voiced within the spurt */
+static uint32_t gate_word_left;
+static uint32_t gate_lcg = 1;
+static uint32_t gate_saw;
+static uint32_t gate_frames;
+static uint32_t gate_open;
+static uint32_t gate_hang;       /* open on hangover only */
+static uint32_t gate_far;        /* open for the far end only */
+static uint64_t gate_open_us;
+static uint64_t gate_closed_us;
+
+static uint32_t gate_rand(uint32_t lo, uint32_t hi)
+{
+	gate_lcg = gate_lcg * 1664525u + 1013904223u;
+	return lo + (gate_lcg >> 8) % (hi - lo + 1);
+}
+
+/* Next frame of the mix for n_mics mics of n samples: a 200 Hz buzz
+ * peaking at -18 dBFS during talk spurts, over noise about 36 dB below
+ * it. Spurt and pause lengths are uniform around their means, which are
+ * set by the step's speech share. Within a spurt the buzz comes in words
+ * of 48-192 ms with 16-48 ms gaps, as speech does; the hangover bridges
+ * the gaps, and they let the noise floor settle back during a long
+ * spurt.
+ */
+static void gate_mix_frame(int16_t *mic, int n_mics, int n)
+{
+	uint32_t pct = gate_mix_pct[gate_step];
+
+	if (gate_seg_left == 0) {
+		if (pct == 0 || pct == 100) {
+			gate_talk = (pct == 100);
+			gate_seg_left = GATE_SPURT_FRAMES;
+		} else {
+			uint32_t mean;
+
+			gate_talk = !gate_talk;
+			mean = gate_talk ? GATE_SPURT_FRAMES
+					 : GATE_SPURT_FRAMES * (100 - pct) / pct;
+			gate_seg_left = gate_rand(mean / 2, mean + mean / 2);
+		}
+	}
+	gate_seg_left--;
+
+	if (gate_word_left == 0) {
+		gate_word = !gate_word;
+		gate_word_left = gate_word ? gate_rand(3, 12) : gate_rand(1, 3);
+	}
+	gate_word_left--;
+
+	for (int i = 0; i < n; i++) {
+		int16_t voice = 0;
+
+		gate_saw += 65536u * 200 / 8000;
+		if (gate_talk && gate_word) {
+			voice = (int16_t)(gate_saw & 0xFFFF) >> 3;
+		}
+		for (int m = 0; m < n_mics; m++) {
+			gate_lcg = gate_lcg * 1664525u + 1013904223u;
+			mic[m * n + i] = voice + (((int32_t)(gate_lcg >> 16) - 32768) >> 9);
+		}
+	}
+}
+
+/* Whether the heavy stages run for this frame */
+static bool gate_frame(const int16_t *mic0, int n, bool far_active)
+{
+	enum vad_gate_state st;
+
+	if (!gate_ready) {
+		vad_gate_init(&gate_vad, CONFIG_VAD_GATE_THRESHOLD_DB,
+			      CONFIG_VAD_GATE_HANGOVER_MS * 1000 / GATE_FRAME_US);
+		gate_ready = true;
+	}
+
+	st = vad_gate_update(&gate_vad, mic0, n);
+	if (st == VAD_GATE_HANGOVER) {
+		gate_hang++;
+	}
+	if (!vad_gate_open(st) && far_active) {
+		gate_far++;
+	}
+	return vad_gate_open(st) || far_active;
+}
+
+/* Account one frame's time; each step of the mix ends with a VADGATE line */
+static void gate_account(enum workload_type wl, bool open, uint64_t us)
+{
+	gate_frames++;
+	if (open) {
+		gate_open++;
+		gate_open_us += us;
+	} else {
+		gate_closed_us += us;
+	}
+
+	if (gate_frames < GATE_STEP_FRAMES) {
+		return;
+	}
+
+	uint32_t closed = gate_frames - gate_open;
+	uint64_t busy_us = gate_open_us + gate_closed_us;
+	uint32_t duty_x10 = (uint32_t)(busy_us * 1000 / ((uint64_t)gate_frames * GATE_FRAME_US));
+
+	printk("VADGATE wl=%u speech=%u%% frames=%u open=%u (hang %u, far %u): "
+	       "avg %u cyc/frame, open %u, gated %u, duty %u.%u%% at %u MHz\n",
+	       wl, gate_mix_pct[gate_step], gate_frames, gate_open, gate_hang, gate_far,
+	       (uint32_t)(busy_us * riscv_freq_mhz / gate_frames),
+	       gate_open ? (uint32_t)(gate_open_us * riscv_freq_mhz / gate_open) : 0,
+	       closed ? (uint32_t)(gate_closed_us * riscv_freq_mhz / closed) : 0,
+	       duty_x10 / 10, duty_x10 % 10, riscv_freq_mhz);
+
+	gate_frames = 0;
+	gate_open = 0;
+	gate_hang = 0;
+	gate_far = 0;
+	gate_open_us = 0;
+	gate_closed_us = 0;
+	gate_step = (gate_step + 1) % ARRAY_SIZE(gate_mix_pct);
+	gate_seg_left = 0;
+}
+#endif /* CONFIG_FLPR_VAD_GATE */
 
 /*
  * Audio Processing Pipeline Simulation
@@ -232,8 +749,22 @@ static uint64_t workload_audio_pipeline(void)
 	int16_t beamformed_output[FRAME_SIZE];
 	int16_t processed_output[FRAME_SIZE];
 
+#if defined(CONFIG_FLPR_VAD_GATE)
+	/* Scripted talk spurts and silence stand in for the mics; not timed */
+	gate_mix_frame(&mic_data[0][0], NUM_MICS, FRAME_SIZE);
+#endif
+
 	start_us = get_timestamp_us();
 
+#if defined(CONFIG_PDM_DEC)
+	/* ===== 1. Decimate the PDM mic buffers to 8 kHz PCM ===== */
+	pdm_decimate_frame();
+#if !defined(CONFIG_FLPR_VAD_GATE)
+	for (int mic = 0; mic < NUM_MICS; mic++) {
+		memcpy(mic_data[mic], pdm_pcm[mic % CONFIG_PDM_DEC_CHANNELS], sizeof(mic_data[mic]));
+	}
+#endif
+#elif !defined(CONFIG_FLPR_VAD_GATE)
 	/* ===== 1. Simulate ADC reads from 3 microphones ===== */
 	for (int mic = 0; mic < NUM_MICS; mic++) {
 		for (int i = 0; i < FRAME_SIZE; i++) {
@@ -241,6 +772,20 @@ static uint64_t workload_audio_pipeline(void)
 			mic_data[mic][i] = (i * (mic + 1) * 37 + work_result) & 0xFFF;
 		}
 	}
+#endif
+
+#if defined(CONFIG_FLPR_VAD_GATE)
+	/* ===== Front-end VAD: silent frames stop here ===== */
+	if (!gate_frame(mic_data[0], FRAME_SIZE, false)) {
+#if defined(CONFIG_STFT_NS) && STFT_NS_HOP == FRAME_SIZE
+		ns_bypass(mic_data[0]);
+#endif
+		end_us = get_timestamp_us();
+		gate_account(WORKLOAD_AUDIO_PIPELINE, false, end_us - start_us);
+		work_result = 0;
+		return (end_us - start_us) * riscv_freq_mhz;
+	}
+#endif
 
 	/* ===== 2. Pre-processing: DC removal and noise filtering ===== */
 	for (int mic = 0; mic < NUM_MICS; mic++) {
@@ -282,8 +827,16 @@ static uint64_t workload_audio_pipeline(void)
 	}
 
 	/* ===== 4. Post-processing: Noise suppression and AGC ===== */
-	/* Simulate spectral subtraction for noise reduction */
 	int32_t signal_energy = 0;
+
+#if defined(CONFIG_STFT_NS) && STFT_NS_HOP == FRAME_SIZE
+	/* STFT noise suppression; output is one frame behind */
+	ns_suppress(beamformed_output, processed_output);
+	for (int i = 0; i < FRAME_SIZE; i++) {
+		signal_energy += (processed_output[i] * processed_output[i]);
+	}
+#else
+	/* Simulate spectral subtraction for noise reduction */
 	int32_t noise_floor = 100;  /* Estimated noise floor */
 
 	for (int i = 0; i < FRAME_SIZE; i++) {
@@ -299,6 +852,7 @@ static uint64_t workload_audio_pipeline(void)
 
 		signal_energy += (processed_output[i] * processed_output[i]);
 	}
+#endif
 
 	/* Apply Automatic Gain Control (AGC) */
 	int32_t rms = signal_energy / FRAME_SIZE;
@@ -337,6 +891,9 @@ static uint64_t workload_audio_pipeline(void)
 	bool voice_detected = (frame_energy > 1000) && (zero_crossings > 10) && (zero_crossings < 80);
 
 	end_us = get_timestamp_us();
+#if defined(CONFIG_FLPR_VAD_GATE)
+	gate_account(WORKLOAD_AUDIO_PIPELINE, true, end_us - start_us);
+#endif
 
 	/* ===== 6. Transfer to ARM core via IPC ===== */
 	/* Only send if voice is detected to save bandwidth */
@@ -365,7 +922,7 @@ static uint64_t workload_audio_pipeline(void)
 		work_result = 0;  /* No voice detected */
 	}
 
-	return (end_us - start_us) * RISCV_FREQ_MHZ;
+	return (end_us - start_us) * riscv_freq_mhz;
 }
 
 /* Audio Pipeline with Acoustic Echo Cancellation (AEC) */
@@ -389,16 +946,72 @@ static uint64_t workload_audio_pipeline_aec(void)
 	int16_t echo_estimate[FRAME_SIZE];
 	int16_t error_signal[FRAME_SIZE];
 
+#if defined(CONFIG_FLPR_FAR_END)
+	BUILD_ASSERT(FAR_RING_FRAME == FRAME_SIZE, "far-end frames must match mic frames");
+
+	/* The mic frame processed now is the one that just finished */
+	uint32_t mic_end_us = far_ring_now_us();
+#endif
+
+#if defined(CONFIG_FLPR_VAD_GATE)
+	/* Scripted talk spurts and silence stand in for the mics; not timed */
+	gate_mix_frame(&mic_data[0][0], NUM_MICS, FRAME_SIZE);
+#endif
+
 	start_us = get_timestamp_us();
 
 	/* ===== STAGES 1-5: Full Audio Pipeline (same as workload 6) ===== */
 
+#if defined(CONFIG_PDM_DEC)
+	/* 1. Decimate the PDM mic buffers to 8 kHz PCM */
+	pdm_decimate_frame();
+#if !defined(CONFIG_FLPR_VAD_GATE)
+	for (int mic = 0; mic < NUM_MICS; mic++) {
+		memcpy(mic_data[mic], pdm_pcm[mic % CONFIG_PDM_DEC_CHANNELS], sizeof(mic_data[mic]));
+	}
+#endif
+#elif !defined(CONFIG_FLPR_VAD_GATE)
 	/* 1. Simulate ADC reads from 3 microphones */
 	for (int mic = 0; mic < NUM_MICS; mic++) {
 		for (int i = 0; i < FRAME_SIZE; i++) {
 			mic_data[mic][i] = (i * (mic + 1) * 37 + work_result) & 0xFFF;
 		}
 	}
+#endif
+
+	/* Far-end reference for stage 6, taken every frame so it keeps pace */
+#if defined(CONFIG_FLPR_FAR_END)
+	/* Downlink audio from the M33, lined up with this mic frame */
+	aec_fetch_reference(far_end_buffer, mic_end_us);
+#else
+	/* Simulate far-end signal (speaker output that creates echo) */
+	for (int i = 0; i < FRAME_SIZE && i < AEC_FILTER_TAPS; i++) {
+		far_end_buffer[i] = (i * 29 + work_result) & 0x7FF;  /* Simulated reference signal */
+	}
+#endif
+
+	int32_t far_end_energy = 0;
+	for (int i = 0; i < FRAME_SIZE; i++) {
+		far_end_energy += (far_end_buffer[i] * far_end_buffer[i]);
+	}
+	far_end_energy /= FRAME_SIZE;
+
+#if defined(CONFIG_FLPR_VAD_GATE)
+	/* Front-end VAD: silent frames stop here and the AEC keeps its taps.
+	 * A real far end keeps the gate open so the AEC adapts on echo; the
+	 * synthetic reference never stops, so it is ignored.
+	 */
+	if (!gate_frame(mic_data[0], FRAME_SIZE,
+			IS_ENABLED(CONFIG_FLPR_FAR_END) && far_end_energy > 500)) {
+#if defined(CONFIG_STFT_NS) && STFT_NS_HOP == FRAME_SIZE
+		ns_bypass(mic_data[0]);
+#endif
+		end_us = get_timestamp_us();
+		gate_account(WORKLOAD_AUDIO_PIPELINE_AEC, false, end_us - start_us);
+		work_result = 0;
+		return (end_us - start_us) * riscv_freq_mhz;
+	}
+#endif
 
 	/* 2. Pre-processing: DC removal and noise filtering */
 	for (int mic = 0; mic < NUM_MICS; mic++) {
@@ -432,6 +1045,13 @@ static uint64_t workload_audio_pipeline_aec(void)
 
 	/* 4. Post-processing: Noise suppression and AGC */
 	int32_t signal_energy = 0;
+
+#if defined(CONFIG_STFT_NS) && STFT_NS_HOP == FRAME_SIZE
+	ns_suppress(beamformed_output, processed_output);
+	for (int i = 0; i < FRAME_SIZE; i++) {
+		signal_energy += (processed_output[i] * processed_output[i]);
+	}
+#else
 	int32_t noise_floor = 100;
 
 	for (int i = 0; i < FRAME_SIZE; i++) {
@@ -446,6 +1066,7 @@ static uint64_t workload_audio_pipeline_aec(void)
 
 		signal_energy += (processed_output[i] * processed_output[i]);
 	}
+#endif
 
 	/* Apply AGC */
 	int32_t rms = signal_energy / FRAME_SIZE;
@@ -480,11 +1101,6 @@ static uint64_t workload_audio_pipeline_aec(void)
 
 	/* ===== STAGE 6: ACOUSTIC ECHO CANCELLATION ===== */
 
-	/* Simulate far-end signal (speaker output that creates echo) */
-	for (int i = 0; i < FRAME_SIZE && i < AEC_FILTER_TAPS; i++) {
-		far_end_buffer[i] = (i * 29 + work_result) & 0x7FF;  /* Simulated reference signal */
-	}
-
 	/* AEC: Adaptive NLMS (Normalized Least Mean Squares) Filter */
 	/* Update every 2nd sample to reduce computational cost */
 	for (int n = 0; n < FRAME_SIZE; n++) {
@@ -526,11 +1142,6 @@ static uint64_t workload_audio_pipeline_aec(void)
 
 	/* Double-talk detection: Check if near-end and far-end both have energy */
 	int32_t near_end_energy = frame_energy;
-	int32_t far_end_energy = 0;
-	for (int i = 0; i < FRAME_SIZE; i++) {
-		far_end_energy += (far_end_buffer[i] * far_end_buffer[i]);
-	}
-	far_end_energy /= FRAME_SIZE;
 
 	/* If double-talk detected, freeze filter adaptation */
 	bool double_talk = (near_end_energy > 500) && (far_end_energy > 500);
@@ -555,6 +1166,9 @@ static uint64_t workload_audio_pipeline_aec(void)
 	}
 
 	end_us = get_timestamp_us();
+#if defined(CONFIG_FLPR_VAD_GATE)
+	gate_account(WORKLOAD_AUDIO_PIPELINE_AEC, true, end_us - start_us);
+#endif
 
 	/* ===== 7. Transfer to ARM core via IPC ===== */
 	if (voice_detected) {
@@ -581,7 +1195,7 @@ static uint64_t workload_audio_pipeline_aec(void)
 		work_result = 0;
 	}
 
-	return (end_us - start_us) * RISCV_FREQ_MHZ;
+	return (end_us - start_us) * riscv_freq_mhz;
 }
 
 /* Proximity-Based VAD - Distinguish wearer from far-field speakers */
@@ -671,7 +1285,7 @@ static uint64_t workload_proximity_vad(void)
 	end_us = get_timestamp_us();
 
 	work_result = is_wearer_voice ? 1 : 0;
-	return (end_us - start_us) * RISCV_FREQ_MHZ;
+	return (end_us - start_us) * riscv_freq_mhz;
 }
 
 /* Chest Resonance Detection - Detect low-frequency resonance from chest cavity */
@@ -740,7 +1354,7 @@ static uint64_t workload_chest_resonance(void)
 	end_us = get_timestamp_us();
 
 	work_result = chest_resonance_detected ? energy_avg : 0;
-	return (end_us - start_us) * RISCV_FREQ_MHZ;
+	return (end_us - start_us) * riscv_freq_mhz;
 }
 
 /* Clothing Rustle Suppression - Detect and suppress impulse noise from clothing */
@@ -816,7 +1430,7 @@ static uint64_t workload_clothing_rustle(void)
 	end_us = get_timestamp_us();
 
 	work_result = rustles_suppressed;
-	return (end_us - start_us) * RISCV_FREQ_MHZ;
+	return (end_us - start_us) * riscv_freq_mhz;
 }
 
 /* Spatial Noise Cancellation - Use mic geometry to cancel ambient noise */
@@ -896,7 +1510,7 @@ static uint64_t workload_spatial_noise_cancel(void)
 	end_us = get_timestamp_us();
 
 	work_result = output_energy / FRAME_SIZE;
-	return (end_us - start_us) * RISCV_FREQ_MHZ;
+	return (end_us - start_us) * riscv_freq_mhz;
 }
 
 /* Wind Noise Reduction - Detect and suppress wind noise */
@@ -984,7 +1598,7 @@ static uint64_t workload_wind_noise_reduction(void)
 	end_us = get_timestamp_us();
 
 	work_result = wind_detected ? 1 : 0;
-	return (end_us - start_us) * RISCV_FREQ_MHZ;
+	return (end_us - start_us) * riscv_freq_mhz;
 }
 
 /* Full Necklace Pipeline - Complete audio processing for necklace form factor */
@@ -1120,7 +1734,7 @@ static uint64_t workload_necklace_full(void)
 	end_us = get_timestamp_us();
 
 	work_result = voice_detected ? final_output[0] : 0;
-	return (end_us - start_us) * RISCV_FREQ_MHZ;
+	return (end_us - start_us) * riscv_freq_mhz;
 }
 
 /* Mixed workload */
@@ -1134,6 +1748,29 @@ static uint64_t workload_mixed(void)
 	return cycles;
 }
 
+#if defined(CONFIG_COREBENCH)
+static struct corebench_stats corebench_acc;
+
+/* One batch of the CoreMark-class benchmark (common/corebench). Prints
+ * a COREBENCH line each time CONFIG_COREBENCH_WINDOW_MS of run time has
+ * accumulated, so the score does not depend on the 1 MHz timer.
+ */
+static uint64_t workload_corebench(void)
+{
+	uint64_t before_us = corebench_acc.us;
+
+	corebench_batch(CONFIG_COREBENCH_BATCH, &corebench_acc);
+	uint64_t batch_us = corebench_acc.us - before_us;
+
+	if (corebench_acc.us >= (uint64_t)CONFIG_COREBENCH_WINDOW_MS * 1000) {
+		corebench_print("flpr", riscv_freq_mhz, &corebench_acc);
+		memset(&corebench_acc, 0, sizeof(corebench_acc));
+	}
+
+	return batch_us * riscv_freq_mhz;
+}
+#endif
+
 /* Execute current workload */
 static uint64_t execute_workload(void)
 {
@@ -1164,6 +1801,18 @@ static uint64_t execute_workload(void)
 		return workload_wind_noise_reduction();
 	case WORKLOAD_NECKLACE_FULL:
 		return workload_necklace_full();
+#if defined(CONFIG_COREBENCH)
+	case WORKLOAD_COREBENCH:
+		return workload_corebench();
+#endif
+#if defined(CONFIG_PDM_DEC)
+	case WORKLOAD_PDM_DECIMATE:
+		return workload_pdm_decimate();
+#endif
+#if defined(CONFIG_STFT_NS)
+	case WORKLOAD_NOISE_SUPPRESS:
+		return workload_noise_suppress();
+#endif
 	case WORKLOAD_IDLE:
 	default:
 		k_sleep(K_MSEC(100));
@@ -1190,6 +1839,20 @@ static void ep_recv(const void *data, size_t len, void *priv)
 		/* Reset stats */
 		total_work_cycles = 0;
 		work_iterations = 0;
+#if CONFIG_FLPR_FRAME_PERIOD_US > 0
+		frame_deadline_us = 0;
+#endif
+
+		/* Profile the new workload (no-op without CONFIG_PROFILER) */
+		profiler_stop();
+		profiler_start(0);
+	} else if (msg->type == IPC_MSG_MEMBENCH) {
+		/* Run from the workload thread, not the IPC callback */
+		membench_ms = msg->data[0];
+		k_sem_give(&wake_sem);
+	} else if (msg->type == IPC_MSG_SET_FREQ) {
+		riscv_freq_mhz = msg->data[0];
+		printk("RISC-V: Clock now %u MHz\n", riscv_freq_mhz);
 	} else {
 		printk("RISC-V: Unknown message type %d\n", msg->type);
 	}
@@ -1210,6 +1873,12 @@ void stats_thread(void)
 	struct stats_data *stats;
 	uint64_t prev_cycles = 0;
 	uint32_t prev_iterations = 0;
+#if defined(CONFIG_SCHED_THREAD_USAGE_ALL)
+	uint64_t prev_exec = 0;
+	uint64_t prev_busy = 0;
+	uint32_t prev_frames = 0;
+	uint32_t prev_missed = 0;
+#endif
 
 	while (1) {
 		k_sleep(K_MSEC(STATS_INTERVAL_MS));
@@ -1230,10 +1899,23 @@ void stats_thread(void)
 
 		/* Calculate CPU utilization percentage */
 		/* CPU% = (MIPS / MHz) * 100 */
-		uint32_t cpu_pct = (mips * 100) / RISCV_FREQ_MHZ;
+#if defined(CONFIG_SCHED_THREAD_USAGE_ALL)
+		/* Measured: non-idle share from the idle-thread accounting */
+		k_thread_runtime_stats_t rt;
+
+		k_thread_runtime_stats_all_get(&rt);
+		uint64_t exec_delta = rt.execution_cycles - prev_exec;
+		uint64_t busy_delta = rt.total_cycles - prev_busy;
+
+		prev_exec = rt.execution_cycles;
+		prev_busy = rt.total_cycles;
+		uint32_t cpu_pct = exec_delta ? (uint32_t)((busy_delta * 100) / exec_delta) : 0;
+#else
+		uint32_t cpu_pct = (mips * 100) / riscv_freq_mhz;
 		if (cpu_pct > 100) {
 			cpu_pct = 100;  /* Cap at 100% */
 		}
+#endif
 
 		/* Send stats via IPC */
 		memset(&msg, 0, sizeof(msg));
@@ -1252,17 +1934,95 @@ void stats_thread(void)
 			printk("RISC-V: Failed to send stats (err %d)\n", ret);
 		}
 
+#if defined(CONFIG_SCHED_THREAD_USAGE_ALL)
+		/* Load and frame deadlines for the M33's clock policy */
+		memset(&msg, 0, sizeof(msg));
+		msg.type = IPC_MSG_LOAD;
+		msg.workload = current_workload;
+		msg.data[0] = frames_done - prev_frames;
+		msg.data[1] = frames_missed - prev_missed;
+		msg.data[2] = cpu_pct;
+		msg.data[3] = frame_max_us;
+		prev_frames = frames_done;
+		prev_missed = frames_missed;
+		frame_max_us = 0;
+
+		ret = ipc_service_send(&ep, &msg, sizeof(msg));
+		if (ret < 0) {
+			printk("RISC-V: Failed to send load (err %d)\n", ret);
+		}
+#endif
+
 		/* Also print locally */
 		printk("\n=== RISC-V Stats (Workload: %d) ===\n", current_workload);
-		printk("CPU freq: %u MHz\n", RISCV_FREQ_MHZ);
+		printk("CPU freq: %u MHz\n", riscv_freq_mhz);
 		printk("Est. MIPS: %u\n", mips);
 		printk("CPU utilization: %u%%\n", cpu_pct);
 		printk("Cycles: %llu\n", cycle_delta);
 		printk("Iterations: %u\n", iter_delta);
+#if CONFIG_FLPR_FRAME_PERIOD_US > 0
+		printk("Frames: %u, missed %u (period %u us)\n",
+		       frames_done, frames_missed, CONFIG_FLPR_FRAME_PERIOD_US);
+#endif
 		printk("=====================================\n\n");
 	}
 }
 
+#if defined(CONFIG_MEMBENCH)
+/* One contention window: sweep for the requested time and report back */
+static void membench_window(void)
+{
+	struct membench_result res;
+	struct ipc_message msg;
+
+	membench_run(membench_ms, &res);
+	membench_ms = 0;
+
+	memset(&msg, 0, sizeof(msg));
+	msg.type = IPC_MSG_MEMBENCH_RESULT;
+	msg.data[0] = res.bytes;
+	msg.data[1] = res.elapsed_us;
+	msg.data[2] = res.passes;
+	msg.data[3] = (uint32_t)membench_buf_addr();
+
+	int ret = ipc_service_send(&ep, &msg, sizeof(msg));
+	if (ret < 0) {
+		printk("RISC-V: Failed to send membench result (err %d)\n", ret);
+	}
+
+	printk("RISC-V: membench %u bytes in %u us (%u passes)\n",
+	       res.bytes, res.elapsed_us, res.passes);
+}
+#endif
+
+#if CONFIG_FLPR_FRAME_PERIOD_US > 0
+static void frame_begin(void)
+{
+	frame_start_us = get_timestamp_us();
+	if (frame_deadline_us == 0) {
+		frame_deadline_us = frame_start_us + CONFIG_FLPR_FRAME_PERIOD_US;
+	}
+}
+
+/* Sleep out the rest of the frame, or count a miss and restart the grid */
+static void frame_end(void)
+{
+	uint64_t now = get_timestamp_us();
+
+	frames_done++;
+	frame_max_us = MAX(frame_max_us, (uint32_t)(now - frame_start_us));
+
+	if (now > frame_deadline_us) {
+		frames_missed++;
+		frame_deadline_us = now + CONFIG_FLPR_FRAME_PERIOD_US;
+		return;
+	}
+
+	k_sleep(K_USEC(frame_deadline_us - now));
+	frame_deadline_us += CONFIG_FLPR_FRAME_PERIOD_US;
+}
+#endif
+
 /* Workload execution thread */
 void workload_thread(void)
 {
@@ -1278,7 +2038,16 @@ void workload_thread(void)
 	       test_start, test_end, test_end - test_start);
 
 	while (1) {
+#if defined(CONFIG_MEMBENCH)
+		if (membench_ms != 0) {
+			membench_window();
+			continue;
+		}
+#endif
 		if (current_workload != WORKLOAD_IDLE) {
+#if CONFIG_FLPR_FRAME_PERIOD_US > 0
+			frame_begin();
+#endif
 			uint64_t cycles = execute_workload();
 			total_work_cycles += cycles;
 			work_iterations++;
@@ -1287,8 +2056,11 @@ void workload_thread(void)
 			if (work_iterations <= 3) {
 				printk("RISC-V: Iteration %u: cycles=%llu\n", work_iterations, cycles);
 			}
+#if CONFIG_FLPR_FRAME_PERIOD_US > 0
+			frame_end();
+#endif
 		} else {
-			k_sleep(K_MSEC(100));
+			k_sem_take(&wake_sem, K_MSEC(100));
 		}
 	}
 }
@@ -1328,6 +2100,21 @@ int main(void)
 	printk("WARNING: IPC not configured in device tree\n");
 	#endif
 
+#if defined(CONFIG_AEAD)
+	/* Before any workload arrives, so the bench has the core to itself */
+	if (aead_selftest() == 0) {
+		aead_bench_run("flpr", riscv_freq_mhz);
+	}
+#endif
+
+#if defined(CONFIG_STFT_NS) && STFT_NS_HOP != FRAME_SIZE
+	/* Only workload 16 runs at the STFT hop; say so rather than let
+	 * the pipelines fall back to the gate unnoticed.
+	 */
+	printk("RISC-V: STFT NS hop %d != pipeline frame %d, workloads 6/7 keep "
+	       "the time-domain gate\n", STFT_NS_HOP, FRAME_SIZE);
+#endif
+
 	printk("RISC-V: Ready for workload commands\n");
 
 	return 0;
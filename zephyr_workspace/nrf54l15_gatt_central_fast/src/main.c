@@ -3,6 +3,8 @@
  *
  * Scans for "nRF54L15_Test", connects, exchanges MTU, discovers the
  * NUS TX characteristic, subscribes to notifications, and measures throughput.
+ * Link setup is driven by common/link_up: DLE, PHY and MTU go out together
+ * on connect and discovery starts as soon as the MTU exchange completes.
  */
 
 #include <zephyr/kernel.h>
@@ -13,6 +15,8 @@
 #include <zephyr/bluetooth/gatt.h>
 #include <zephyr/sys/printk.h>
 
+#include "link_up.h"
+
 #define TARGET_NAME     "nRF54L15_Test"
 #define TARGET_NAME_LEN (sizeof(TARGET_NAME) - 1)
 
@@ -35,9 +39,7 @@ static volatile bool subscribed;
 /* GATT discovery state */
 static struct bt_gatt_discover_params disc_params;
 static struct bt_gatt_subscribe_params sub_params;
-
-/* Delayed work */
-static struct k_work_delayable conn_setup_work;
+static uint16_t nus_tx_handle;
 
 /* ---- Notification Callback ---- */
 
@@ -51,10 +53,18 @@ static uint8_t notify_cb(struct bt_conn *conn,
 		return BT_GATT_ITER_STOP;
 	}
 
+	link_up_first_payload();
 	rx_bytes += length;
 	return BT_GATT_ITER_CONTINUE;
 }
 
+/* CCC write completed: the data path is open */
+static void subscribe_cb(struct bt_conn *conn, uint8_t err,
+			 struct bt_gatt_subscribe_params *params)
+{
+	link_up_done(LINK_UP_OPEN, err ? -EIO : 0);
+}
+
 /* ---- GATT Discovery ---- */
 
 static uint8_t gatt_discover_cb(struct bt_conn *conn,
@@ -67,6 +77,7 @@ static uint8_t gatt_discover_cb(struct bt_conn *conn,
 		} else {
 			printk("NUS TX characteristic not found\n");
 		}
+		link_up_done(LINK_UP_DISCOVER, -ENOENT);
 		return BT_GATT_ITER_STOP;
 	}
 
@@ -86,6 +97,7 @@ static uint8_t gatt_discover_cb(struct bt_conn *conn,
 		int err = bt_gatt_discover(conn, &disc_params);
 		if (err) {
 			printk("Char discovery failed (err %d)\n", err);
+			link_up_done(LINK_UP_DISCOVER, err);
 		}
 		return BT_GATT_ITER_STOP;
 	}
@@ -100,31 +112,37 @@ static uint8_t gatt_discover_cb(struct bt_conn *conn,
 
 		printk("Found NUS TX characteristic (value handle %u)\n",
 		       chrc->value_handle);
-
-		/* Subscribe to notifications */
-		sub_params.notify = notify_cb;
-		sub_params.value_handle = chrc->value_handle;
-		sub_params.ccc_handle = 0; /* auto-discover CCC */
-		sub_params.end_handle = disc_params.end_handle;
-		sub_params.disc_params = &disc_params;
-		sub_params.value = BT_GATT_CCC_NOTIFY;
-
-		int err = bt_gatt_subscribe(conn, &sub_params);
-		if (err) {
-			printk("Subscribe failed (err %d)\n", err);
-		} else {
-			printk("Subscribed to notifications\n");
-			subscribed = true;
-			rx_bytes = 0;
-			rx_start_time = k_uptime_get();
-		}
+		nus_tx_handle = chrc->value_handle;
+		link_up_done(LINK_UP_DISCOVER, 0);
 		return BT_GATT_ITER_STOP;
 	}
 
 	return BT_GATT_ITER_STOP;
 }
 
-static void start_gatt_discovery(void)
+static int subscribe_nus(struct bt_conn *conn)
+{
+	sub_params.notify = notify_cb;
+	sub_params.subscribe = subscribe_cb;
+	sub_params.value_handle = nus_tx_handle;
+	sub_params.ccc_handle = 0; /* auto-discover CCC */
+	sub_params.end_handle = disc_params.end_handle;
+	sub_params.disc_params = &disc_params;
+	sub_params.value = BT_GATT_CCC_NOTIFY;
+
+	int err = bt_gatt_subscribe(conn, &sub_params);
+	if (err) {
+		printk("Subscribe failed (err %d)\n", err);
+	} else {
+		printk("Subscribed to notifications\n");
+		subscribed = true;
+		rx_bytes = 0;
+		rx_start_time = k_uptime_get();
+	}
+	return err;
+}
+
+static int start_gatt_discovery(struct bt_conn *conn)
 {
 	printk("Starting GATT discovery for NUS service...\n");
 
@@ -134,65 +152,30 @@ static void start_gatt_discovery(void)
 	disc_params.end_handle = BT_ATT_LAST_ATTRIBUTE_HANDLE;
 	disc_params.type = BT_GATT_DISCOVER_PRIMARY;
 
-	int err = bt_gatt_discover(current_conn, &disc_params);
+	int err = bt_gatt_discover(conn, &disc_params);
 	if (err) {
 		printk("GATT discovery failed (err %d)\n", err);
 	}
+	return err;
 }
 
-/* ---- Connection Setup (delayed) ---- */
-
-static void mtu_exchange_cb(struct bt_conn *conn, uint8_t err,
-			    struct bt_gatt_exchange_params *params)
-{
-	if (err) {
-		printk("MTU exchange failed (err %u)\n", err);
-	} else {
-		printk("MTU exchange done\n");
-	}
-}
+/* ---- Connection Setup ---- */
 
-static void conn_setup_work_handler(struct k_work *work)
-{
-	if (!current_conn) {
-		return;
-	}
-
-	int err;
-
-	/* Request DLE */
-	struct bt_conn_le_data_len_param dl_param = {
-		.tx_max_len = 251,
-		.tx_max_time = 2120,
-	};
-	err = bt_conn_le_data_len_update(current_conn, &dl_param);
-	if (err) {
-		printk("DLE update failed (err %d)\n", err);
-	}
-
-	/* Request 2M PHY */
-	const struct bt_conn_le_phy_param phy_param = {
-		.options = BT_CONN_LE_PHY_OPT_NONE,
-		.pref_tx_phy = BT_GAP_LE_PHY_2M,
-		.pref_rx_phy = BT_GAP_LE_PHY_2M,
-	};
-	err = bt_conn_le_phy_update(current_conn, &phy_param);
-	if (err) {
-		printk("PHY update failed (err %d)\n", err);
-	}
-
-	/* Exchange MTU */
-	static struct bt_gatt_exchange_params mtu_params;
-	mtu_params.func = mtu_exchange_cb;
-	err = bt_gatt_exchange_mtu(current_conn, &mtu_params);
-	if (err) {
-		printk("MTU exchange failed (err %d)\n", err);
-	}
-
-	/* Start GATT discovery after a small delay for params to settle */
-	k_sleep(K_MSEC(200));
-	start_gatt_discovery();
-}
+/* DLE, PHY and MTU on connect; discovery once the MTU is settled and
+ * the CCC subscription (OPEN) as soon as the characteristic is found.
+ */
+static const struct link_up_cfg link_cfg = {
+	.steps = LINK_UP_STEP(LINK_UP_DLE) | LINK_UP_STEP(LINK_UP_PHY) |
+		 LINK_UP_STEP(LINK_UP_MTU) | LINK_UP_STEP(LINK_UP_DISCOVER) |
+		 LINK_UP_STEP(LINK_UP_OPEN),
+	.tx_octets = 251,
+	.tx_time = 2120,
+	.phy = BT_GAP_LE_PHY_2M,
+	.discover = start_gatt_discovery,
+	.discover_after = LINK_UP_STEP(LINK_UP_MTU),
+	.open = subscribe_nus,
+	.open_after = LINK_UP_STEP(LINK_UP_DISCOVER),
+};
 
 /* ---- Connection Callbacks ---- */
 
@@ -218,8 +201,6 @@ static void connected(struct bt_conn *conn, uint8_t err)
 		       (info.le.interval * 125 % 100),
 		       info.le.latency, info.le.timeout);
 	}
-
-	k_work_schedule(&conn_setup_work, K_MSEC(100));
 }
 
 static void disconnected(struct bt_conn *conn, uint8_t reason)
@@ -231,7 +212,6 @@ static void disconnected(struct bt_conn *conn, uint8_t reason)
 		current_conn = NULL;
 	}
 
-	k_work_cancel_delayable(&conn_setup_work);
 	subscribed = false;
 	rx_bytes = 0;
 }
@@ -373,7 +353,7 @@ int main(void)
 
 	printk("Starting nRF54L15 GATT Notification Central\n");
 
-	k_work_init_delayable(&conn_setup_work, conn_setup_work_handler);
+	link_up_init(&link_cfg);
 
 	err = bt_enable(NULL);
 	if (err) {
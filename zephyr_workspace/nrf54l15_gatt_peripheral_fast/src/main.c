@@ -13,6 +13,8 @@
 #include <zephyr/bluetooth/gatt.h>
 #include <zephyr/sys/printk.h>
 
+#include "link_up.h"
+
 #define DEVICE_NAME     CONFIG_BT_DEVICE_NAME
 #define DEVICE_NAME_LEN (sizeof(DEVICE_NAME) - 1)
 
@@ -34,7 +36,9 @@ static struct k_sem tx_sem;
 static uint32_t bytes_sent;
 static volatile bool notify_enabled;
 static volatile bool dle_ready;
-static struct k_work_delayable conn_param_work;
+
+/* Given when notifications are enabled or DLE completes */
+static K_SEM_DEFINE(stream_ready, 0, 1);
 
 static uint8_t tx_data[NOTIFY_SIZE];
 
@@ -57,6 +61,8 @@ static void tx_ccc_cfg_changed(const struct bt_gatt_attr *attr, uint16_t value)
 		for (int i = 0; i < TX_BUF_COUNT; i++) {
 			k_sem_give(&tx_sem);
 		}
+		link_up_done(LINK_UP_OPEN, 0);
+		k_sem_give(&stream_ready);
 	} else {
 		k_sem_reset(&tx_sem);
 	}
@@ -85,22 +91,25 @@ static const struct bt_data sd[] = {
 
 /* ---- Connection Callbacks ---- */
 
-static void conn_param_work_handler(struct k_work *work)
+static void link_phase_done(enum link_up_phase phase, int err)
 {
-	if (!current_conn) {
-		return;
-	}
-
-	struct bt_conn_le_data_len_param dl_param = {
-		.tx_max_len = 251,
-		.tx_max_time = 2120,
-	};
-	int err = bt_conn_le_data_len_update(current_conn, &dl_param);
-	if (err) {
-		printk("DLE update failed (err %d)\n", err);
+	if (phase == LINK_UP_DLE && err == 0) {
+		dle_ready = true;
+		k_sem_give(&stream_ready);
 	}
 }
 
+/* DLE is ours to request; MTU and the CCC write (OPEN) come from the
+ * central and are only timed.
+ */
+static const struct link_up_cfg link_cfg = {
+	.steps = LINK_UP_STEP(LINK_UP_DLE) | LINK_UP_STEP(LINK_UP_MTU) |
+		 LINK_UP_STEP(LINK_UP_OPEN),
+	.tx_octets = 251,
+	.tx_time = 2120,
+	.phase_done = link_phase_done,
+};
+
 static void connected(struct bt_conn *conn, uint8_t err)
 {
 	char addr[BT_ADDR_LE_STR_LEN];
@@ -115,7 +124,6 @@ static void connected(struct bt_conn *conn, uint8_t err)
 	current_conn = bt_conn_ref(conn);
 
 	bt_le_adv_stop();
-	k_work_schedule(&conn_param_work, K_MSEC(50));
 }
 
 static void disconnected(struct bt_conn *conn, uint8_t reason)
@@ -127,7 +135,6 @@ static void disconnected(struct bt_conn *conn, uint8_t reason)
 		current_conn = NULL;
 	}
 
-	k_work_cancel_delayable(&conn_param_work);
 	notify_enabled = false;
 	dle_ready = false;
 	bytes_sent = 0;
@@ -153,10 +160,6 @@ static void le_data_len_updated(struct bt_conn *conn,
 	printk("DLE updated: TX len=%u time=%u, RX len=%u time=%u\n",
 	       info->tx_max_len, info->tx_max_time,
 	       info->rx_max_len, info->rx_max_time);
-
-	if (info->tx_max_len >= 251) {
-		dle_ready = true;
-	}
 }
 
 static void mtu_updated(struct bt_conn *conn, uint16_t tx, uint16_t rx)
@@ -187,7 +190,7 @@ void stream_thread(void)
 
 	while (1) {
 		if (!notify_enabled || !dle_ready) {
-			k_sleep(K_MSEC(100));
+			k_sem_take(&stream_ready, K_MSEC(100));
 			continue;
 		}
 
@@ -209,6 +212,7 @@ void stream_thread(void)
 			k_sem_give(&tx_sem);
 			k_sleep(K_MSEC(10));
 		} else {
+			link_up_first_payload();
 			bytes_sent += NOTIFY_SIZE;
 		}
 	}
@@ -244,7 +248,7 @@ int main(void)
 	printk("Starting nRF54L15 GATT Notification Throughput Test\n");
 
 	k_sem_init(&tx_sem, 0, TX_BUF_COUNT);
-	k_work_init_delayable(&conn_param_work, conn_param_work_handler);
+	link_up_init(&link_cfg);
 
 	err = bt_enable(NULL);
 	if (err) {
@@ -3,6 +3,9 @@
  *
  * Scans for the peripheral "nRF54L15_Test", connects, discovers PSM via GATT,
  * opens an L2CAP CoC channel, receives data, and prints throughput stats.
+ * Link setup is driven by common/link_up: DLE and PHY go out on connect
+ * alongside the PSM discovery, and the channel opens as soon as the PSM
+ * has been read.
  */
 
 #include <zephyr/kernel.h>
@@ -14,6 +17,8 @@
 #include <zephyr/bluetooth/l2cap.h>
 #include <zephyr/sys/printk.h>
 
+#include "link_up.h"
+
 #define TARGET_NAME     "nRF54L15_Test"
 #define TARGET_NAME_LEN (sizeof(TARGET_NAME) - 1)
 
@@ -44,9 +49,7 @@ static volatile bool l2cap_connected;
 static struct bt_gatt_discover_params disc_params;
 static struct bt_gatt_read_params read_params;
 static uint16_t psm_char_handle;
-
-/* Delayed connection setup */
-static struct k_work_delayable conn_setup_work;
+static uint16_t peer_psm;
 
 /* ---- L2CAP Channel Callbacks ---- */
 
@@ -62,6 +65,7 @@ static void l2cap_chan_connected(struct bt_l2cap_chan *chan)
 	rx_bytes = 0;
 	rx_start_time = k_uptime_get();
 	l2cap_connected = true;
+	link_up_done(LINK_UP_OPEN, 0);
 
 	/* Give additional credits now that channel is connected */
 	bt_l2cap_chan_give_credits(chan, INITIAL_CREDITS);
@@ -71,11 +75,13 @@ static void l2cap_chan_disconnected(struct bt_l2cap_chan *chan)
 {
 	printk("L2CAP channel disconnected\n");
 	l2cap_connected = false;
+	link_up_done(LINK_UP_OPEN, -ECONNREFUSED);
 }
 
 static void l2cap_chan_seg_recv(struct bt_l2cap_chan *chan, size_t sdu_len,
 				off_t seg_offset, struct net_buf_simple *seg)
 {
+	link_up_first_payload();
 	rx_bytes += seg->len;
 
 	/* Replenish 1 credit per segment to keep pipeline full */
@@ -92,8 +98,9 @@ static const struct bt_l2cap_chan_ops l2cap_chan_ops = {
 
 /* ---- L2CAP Connect ---- */
 
-static void l2cap_connect(uint16_t psm)
+static int l2cap_connect(struct bt_conn *conn)
 {
+	uint16_t psm = peer_psm;
 	int err;
 
 	memset(&l2cap_chan, 0, sizeof(l2cap_chan));
@@ -107,13 +114,14 @@ static void l2cap_connect(uint16_t psm)
 		printk("Initial credits failed (err %d)\n", err);
 	}
 
-	err = bt_l2cap_chan_connect(current_conn, &l2cap_chan.chan, psm);
+	err = bt_l2cap_chan_connect(conn, &l2cap_chan.chan, psm);
 	if (err) {
 		printk("L2CAP connect failed (err %d)\n", err);
 	} else {
 		printk("L2CAP connect initiated (PSM=0x%04X, %u initial credits)\n",
 		       psm, INITIAL_CREDITS);
 	}
+	return err;
 }
 
 /* ---- GATT Discovery ---- */
@@ -124,11 +132,13 @@ static uint8_t gatt_read_psm_cb(struct bt_conn *conn, uint8_t err,
 {
 	if (err) {
 		printk("PSM read failed (err %u)\n", err);
+		link_up_done(LINK_UP_DISCOVER, -EIO);
 		return BT_GATT_ITER_STOP;
 	}
 
 	if (!data || length < 2) {
 		printk("PSM read: no data\n");
+		link_up_done(LINK_UP_DISCOVER, -ENODATA);
 		return BT_GATT_ITER_STOP;
 	}
 
@@ -136,7 +146,8 @@ static uint8_t gatt_read_psm_cb(struct bt_conn *conn, uint8_t err,
 		       (((const uint8_t *)data)[1] << 8);
 	printk("Discovered PSM: 0x%04X\n", psm);
 
-	l2cap_connect(psm);
+	peer_psm = psm;
+	link_up_done(LINK_UP_DISCOVER, 0);
 	return BT_GATT_ITER_STOP;
 }
 
@@ -150,6 +161,7 @@ static uint8_t gatt_discover_cb(struct bt_conn *conn,
 		} else {
 			printk("PSM characteristic not found\n");
 		}
+		link_up_done(LINK_UP_DISCOVER, -ENOENT);
 		return BT_GATT_ITER_STOP;
 	}
 
@@ -168,6 +180,7 @@ static uint8_t gatt_discover_cb(struct bt_conn *conn,
 		int err = bt_gatt_discover(conn, &disc_params);
 		if (err) {
 			printk("Characteristic discovery failed (err %d)\n", err);
+			link_up_done(LINK_UP_DISCOVER, err);
 		}
 		return BT_GATT_ITER_STOP;
 	}
@@ -192,6 +205,7 @@ static uint8_t gatt_discover_cb(struct bt_conn *conn,
 		int err = bt_gatt_read(conn, &read_params);
 		if (err) {
 			printk("PSM read request failed (err %d)\n", err);
+			link_up_done(LINK_UP_DISCOVER, err);
 		}
 		return BT_GATT_ITER_STOP;
 	}
@@ -199,7 +213,7 @@ static uint8_t gatt_discover_cb(struct bt_conn *conn,
 	return BT_GATT_ITER_STOP;
 }
 
-static void start_gatt_discovery(void)
+static int start_gatt_discovery(struct bt_conn *conn)
 {
 	int err;
 
@@ -211,43 +225,28 @@ static void start_gatt_discovery(void)
 	disc_params.end_handle = BT_ATT_LAST_ATTRIBUTE_HANDLE;
 	disc_params.type = BT_GATT_DISCOVER_PRIMARY;
 
-	err = bt_gatt_discover(current_conn, &disc_params);
+	err = bt_gatt_discover(conn, &disc_params);
 	if (err) {
 		printk("GATT discovery failed (err %d)\n", err);
 	}
+	return err;
 }
 
-/* ---- Connection Setup (delayed) ---- */
-
-static void conn_setup_work_handler(struct k_work *work)
-{
-	if (!current_conn) {
-		return;
-	}
-
-	int err;
-
-	struct bt_conn_le_data_len_param dl_param = {
-		.tx_max_len = 251,
-		.tx_max_time = 2120,
-	};
-	err = bt_conn_le_data_len_update(current_conn, &dl_param);
-	if (err) {
-		printk("Data length update request failed (err %d)\n", err);
-	}
-
-	const struct bt_conn_le_phy_param phy_param = {
-		.options = BT_CONN_LE_PHY_OPT_NONE,
-		.pref_tx_phy = BT_GAP_LE_PHY_2M,
-		.pref_rx_phy = BT_GAP_LE_PHY_2M,
-	};
-	err = bt_conn_le_phy_update(current_conn, &phy_param);
-	if (err) {
-		printk("PHY update request failed (err %d)\n", err);
-	}
+/* ---- Connection Setup ---- */
 
-	start_gatt_discovery();
-}
+/* DLE, PHY and PSM discovery all start on connect; the ATT read does
+ * not need the larger PDUs. The channel opens once the PSM is known.
+ */
+static const struct link_up_cfg link_cfg = {
+	.steps = LINK_UP_STEP(LINK_UP_DLE) | LINK_UP_STEP(LINK_UP_PHY) |
+		 LINK_UP_STEP(LINK_UP_DISCOVER) | LINK_UP_STEP(LINK_UP_OPEN),
+	.tx_octets = 251,
+	.tx_time = 2120,
+	.phy = BT_GAP_LE_PHY_2M,
+	.discover = start_gatt_discovery,
+	.open = l2cap_connect,
+	.open_after = LINK_UP_STEP(LINK_UP_DISCOVER),
+};
 
 /* ---- Connection Callbacks ---- */
 
@@ -273,8 +272,6 @@ static void connected(struct bt_conn *conn, uint8_t err)
 		       (info.le.interval * 125 % 100),
 		       info.le.latency, info.le.timeout);
 	}
-
-	k_work_schedule(&conn_setup_work, K_MSEC(100));
 }
 
 static void disconnected(struct bt_conn *conn, uint8_t reason)
@@ -289,7 +286,6 @@ static void disconnected(struct bt_conn *conn, uint8_t reason)
 		current_conn = NULL;
 	}
 
-	k_work_cancel_delayable(&conn_setup_work);
 	l2cap_connected = false;
 	rx_bytes = 0;
 }
@@ -431,7 +427,7 @@ int main(void)
 
 	printk("Starting nRF54L15 L2CAP CoC Central\n");
 
-	k_work_init_delayable(&conn_setup_work, conn_setup_work_handler);
+	link_up_init(&link_cfg);
 
 	err = bt_enable(NULL);
 	if (err) {
@@ -1,8 +1,20 @@
 /*
  * L2CAP CoC Throughput Central for nRF54L15
  *
- * Scans for the peripheral "nRF54L15_Test", connects, discovers PSM via GATT,
+ * Scans for CONFIG_L2CAP_CENTRAL_TARGET_NAME ("nRF54L15_Test", or the
+ * relay with relay.conf), connects, discovers PSM via GATT,
  * opens an L2CAP CoC channel, receives data, and prints throughput stats.
+ * Link setup is driven by common/link_up: DLE and PHY go out on connect
+ * alongside the PSM discovery, and the channel opens as soon as the PSM
+ * has been read.
+ *
+ * With playout.conf the SDUs are common/audio_pkt audio: they are
+ * reassembled from their segments, split into frames and played out
+ * through common/playout's jitter buffer on a local 16 ms clock.
+ *
+ * time_sync.conf adds common/time_sync: connection anchors swapped
+ * with the peripheral give both boards the other's clock, printed as a
+ * TSYNC line, and the PLAYOUT line gains the end-to-end latency.
  */
 
 #include <zephyr/kernel.h>
@@ -14,7 +26,17 @@
 #include <zephyr/bluetooth/l2cap.h>
 #include <zephyr/sys/printk.h>
 
-#define TARGET_NAME     "nRF54L15_Test"
+#include "link_up.h"
+
+#if defined(CONFIG_L2CAP_CENTRAL_PLAYOUT)
+#include "audio_pkt.h"
+#include "playout.h"
+#endif
+#if defined(CONFIG_TIME_SYNC)
+#include "time_sync_bt.h"
+#endif
+
+#define TARGET_NAME     CONFIG_L2CAP_CENTRAL_TARGET_NAME
 #define TARGET_NAME_LEN (sizeof(TARGET_NAME) - 1)
 
 #define SDU_LEN          2000
@@ -45,10 +67,197 @@ static volatile bool l2cap_connected;
 static struct bt_gatt_discover_params disc_params;
 static struct bt_gatt_read_params read_params;
 static uint16_t psm_char_handle;
+static uint16_t peer_psm;
+
+/* ---- Audio Playout ---- */
+
+#if defined(CONFIG_L2CAP_CENTRAL_PLAYOUT)
+K_TIMER_DEFINE(playout_timer, NULL, NULL);
+
+/* put() runs in the BT RX thread, pull() in playout_thread */
+static struct k_spinlock po_lock;
+static struct playout po;
+static int16_t po_out[PLAYOUT_FRAME];
+static int16_t po_in[PLAYOUT_FRAME];
+
+/* SDU being reassembled */
+static uint8_t po_sdu[AUDIO_PKT_SDU_MAX];
+static size_t po_sdu_len;
+static bool po_sdu_bad;
+static uint32_t po_bad_sdus;
+
+/* The cycle counter: on nRF54L the GRTC, which the controller stamps
+ * connection anchors with too (common/time_sync)
+ */
+static inline uint64_t po_now64_us(void)
+{
+	return k_cyc_to_us_floor64(k_cycle_get_64());
+}
+
+static inline uint32_t po_now_us(void)
+{
+	return (uint32_t)po_now64_us();
+}
+
+static void po_reset(void)
+{
+	struct playout_cfg cfg = {
+		.min_frames = CONFIG_L2CAP_CENTRAL_PLAYOUT_MIN_FRAMES,
+		.max_frames = CONFIG_L2CAP_CENTRAL_PLAYOUT_MAX_FRAMES,
+		.window_frames = CONFIG_L2CAP_CENTRAL_PLAYOUT_WINDOW_MS * 1000 / PLAYOUT_FRAME_US,
+	};
+	k_spinlock_key_t key = k_spin_lock(&po_lock);
+
+	playout_init(&po, &cfg);
+	po_sdu_len = 0;
+	po_sdu_bad = false;
+	po_bad_sdus = 0;
+	k_spin_unlock(&po_lock, key);
+}
+
+/* One segment of an SDU; the frames go in once the SDU is whole, with
+ * the arrival time of its last segment
+ */
+static void po_segment(size_t sdu_len, off_t offset, const struct net_buf_simple *seg)
+{
+	struct audio_pkt_frame f[AUDIO_PKT_MAX_FRAMES];
+	uint32_t now = po_now_us();
+	int n;
+
+	if (offset == 0) {
+		po_sdu_len = 0;
+		po_sdu_bad = sdu_len > sizeof(po_sdu);
+	}
+	if (!po_sdu_bad && offset == po_sdu_len) {
+		memcpy(po_sdu + po_sdu_len, seg->data, seg->len);
+		po_sdu_len += seg->len;
+	} else {
+		po_sdu_bad = true;
+	}
+	if (offset + seg->len < sdu_len) {
+		return;
+	}
 
-/* Delayed connection setup */
-static struct k_work_delayable conn_setup_work;
-static struct k_work_delayable ci_update_work;
+	n = po_sdu_bad ? -1 : audio_pkt_parse(po_sdu, po_sdu_len, f, AUDIO_PKT_MAX_FRAMES);
+	if (n < 0) {
+		po_bad_sdus++;
+		return;
+	}
+
+	for (int k = 0; k < n; k++) {
+		for (int i = 0; i < PLAYOUT_FRAME; i++) {
+			po_in[i] = (int16_t)(f[k].pcm[2 * i] | (f[k].pcm[2 * i + 1] << 8));
+		}
+
+		k_spinlock_key_t key = k_spin_lock(&po_lock);
+
+		playout_put(&po, f[k].seq, f[k].ts_us, now, po_in);
+		k_spin_unlock(&po_lock, key);
+	}
+}
+
+/* The local playout clock. There is no codec on this board, so each
+ * frame stops here, where an I2S driver would take it.
+ */
+void playout_thread(void)
+{
+	k_timer_start(&playout_timer, K_USEC(PLAYOUT_FRAME_US), K_USEC(PLAYOUT_FRAME_US));
+
+	while (1) {
+		uint32_t ticks = k_timer_status_sync(&playout_timer);
+		uint32_t now = po_now_us();
+
+		for (uint32_t k = 0; k < ticks; k++) {
+			k_spinlock_key_t key = k_spin_lock(&po_lock);
+
+			playout_pull(&po, now - (ticks - 1 - k) * PLAYOUT_FRAME_US, po_out);
+			k_spin_unlock(&po_lock, key);
+		}
+	}
+}
+
+K_THREAD_DEFINE(playout_tid, 1024, playout_thread, NULL, NULL, NULL, 5, 0, 0);
+
+/* value / 1000 with one decimal: us as ms, ppb as ppm */
+static void po_milli(char *buf, size_t len, int32_t v)
+{
+	snprintk(buf, len, "%s%d.%d", v < 0 ? "-" : "", ABS(v) / 1000, ABS(v) % 1000 / 100);
+}
+
+/* End-to-end latency: from the capture of the next sample out, on the
+ * peripheral's clock, to now. "-" without a shared clock.
+ */
+static void po_e2e(char *buf, size_t len, uint64_t now, uint32_t play_ts)
+{
+#if defined(CONFIG_TIME_SYNC)
+	uint64_t peer_now, play;
+
+	/* Widen the sender's 32-bit time from the peer clock now */
+	if (peer_time_from_local(now, &peer_now) == 0 &&
+	    local_time_from_peer(peer_now - (uint32_t)((uint32_t)peer_now - play_ts), &play) == 0) {
+		po_milli(buf, len, (int32_t)(now - play));
+		return;
+	}
+#endif
+	snprintk(buf, len, "-");
+}
+
+/* PLAYOUT: delay <ms> target <ms> depth <ms> | jitter <ms> spread <ms> | drift <ppm> ppm |
+ *          played <n> concealed <n> underruns <n> late <n> overruns <n> skipped <n> held <n> |
+ *          wait avg <ms> max <ms> | bad SDUs <n> | e2e <ms>
+ * Counts are per report. Delay and target are above the fastest frame
+ * of the window; wait is arrival to playout on this board.
+ */
+static void po_report(void)
+{
+	struct playout_status s;
+	uint32_t played, concealed, underruns, late, overruns, skipped, held;
+	uint32_t wait_avg, wait_max;
+	enum playout_state state;
+	char delay[12], target[12], depth[12], jitter[12], spread[12], drift[12];
+	char avg[12], max[12], e2e[12];
+	uint64_t now = po_now64_us();
+	k_spinlock_key_t key = k_spin_lock(&po_lock);
+
+	playout_status(&po, (uint32_t)now, &s);
+	state = po.state;
+	played = po.played;
+	concealed = po.concealed;
+	underruns = po.underruns;
+	late = po.late;
+	overruns = po.overruns;
+	skipped = po.skipped;
+	held = po.held;
+	wait_avg = po.wait_n ? (uint32_t)(po.wait_sum_us / po.wait_n) : 0;
+	wait_max = po.wait_max_us;
+	po.played = po.concealed = po.underruns = po.late = 0;
+	po.overruns = po.skipped = po.held = 0;
+	po.wait_sum_us = 0;
+	po.wait_max_us = po.wait_n = 0;
+	k_spin_unlock(&po_lock, key);
+
+	if (state != PLAYOUT_PLAYING) {
+		return;
+	}
+
+	po_milli(delay, sizeof(delay), s.offset_us);
+	po_milli(target, sizeof(target), s.target_us);
+	po_milli(depth, sizeof(depth), s.depth_us);
+	po_milli(jitter, sizeof(jitter), s.jitter_us);
+	po_milli(spread, sizeof(spread), s.spread_us);
+	po_milli(drift, sizeof(drift), s.drift_ppb);
+	po_milli(avg, sizeof(avg), wait_avg);
+	po_milli(max, sizeof(max), wait_max);
+	po_e2e(e2e, sizeof(e2e), now, s.play_ts_us);
+
+	printk("PLAYOUT: delay %s target %s depth %s | jitter %s spread %s | drift %s ppm | "
+	       "played %u concealed %u underruns %u late %u overruns %u skipped %u held %u | "
+	       "wait avg %s max %s | bad SDUs %u | e2e %s\n",
+	       delay, target, depth, jitter, spread, drift,
+	       played, concealed, underruns, late, overruns, skipped, held,
+	       avg, max, po_bad_sdus, e2e);
+}
+#endif /* CONFIG_L2CAP_CENTRAL_PLAYOUT */
 
 /* ---- L2CAP Channel Callbacks ---- */
 
@@ -63,7 +272,15 @@ static void l2cap_chan_connected(struct bt_l2cap_chan *chan)
 
 	rx_bytes = 0;
 	rx_start_time = k_uptime_get();
+#if defined(CONFIG_L2CAP_CENTRAL_PLAYOUT)
+	po_reset();
+#endif
 	l2cap_connected = true;
+	link_up_done(LINK_UP_OPEN, 0);
+#if defined(CONFIG_TIME_SYNC)
+	/* PSM discovery is done, so the ATT bearer is free */
+	time_sync_bt_subscribe(chan->conn);
+#endif
 
 	/* Give additional credits now that channel is connected */
 	bt_l2cap_chan_give_credits(chan, INITIAL_CREDITS);
@@ -73,6 +290,7 @@ static void l2cap_chan_disconnected(struct bt_l2cap_chan *chan)
 {
 	printk("L2CAP channel disconnected\n");
 	l2cap_connected = false;
+	link_up_done(LINK_UP_OPEN, -ECONNREFUSED);
 }
 
 static uint32_t seg_count;
@@ -80,8 +298,12 @@ static uint32_t seg_count;
 static void l2cap_chan_seg_recv(struct bt_l2cap_chan *chan, size_t sdu_len,
 				off_t seg_offset, struct net_buf_simple *seg)
 {
+	link_up_first_payload();
 	rx_bytes += seg->len;
 	seg_count++;
+#if defined(CONFIG_L2CAP_CENTRAL_PLAYOUT)
+	po_segment(sdu_len, seg_offset, seg);
+#endif
 
 	/* Replenish credits in batches to reduce credit PDU overhead */
 	if (l2cap_connected && (seg_count % 10 == 0)) {
@@ -97,8 +319,9 @@ static const struct bt_l2cap_chan_ops l2cap_chan_ops = {
 
 /* ---- L2CAP Connect ---- */
 
-static void l2cap_connect(uint16_t psm)
+static int l2cap_connect(struct bt_conn *conn)
 {
+	uint16_t psm = peer_psm;
 	int err;
 
 	memset(&l2cap_chan, 0, sizeof(l2cap_chan));
@@ -112,13 +335,14 @@ static void l2cap_connect(uint16_t psm)
 		printk("Initial credits failed (err %d)\n", err);
 	}
 
-	err = bt_l2cap_chan_connect(current_conn, &l2cap_chan.chan, psm);
+	err = bt_l2cap_chan_connect(conn, &l2cap_chan.chan, psm);
 	if (err) {
 		printk("L2CAP connect failed (err %d)\n", err);
 	} else {
 		printk("L2CAP connect initiated (PSM=0x%04X, %u initial credits)\n",
 		       psm, INITIAL_CREDITS);
 	}
+	return err;
 }
 
 /* ---- GATT Discovery ---- */
@@ -129,11 +353,13 @@ static uint8_t gatt_read_psm_cb(struct bt_conn *conn, uint8_t err,
 {
 	if (err) {
 		printk("PSM read failed (err %u)\n", err);
+		link_up_done(LINK_UP_DISCOVER, -EIO);
 		return BT_GATT_ITER_STOP;
 	}
 
 	if (!data || length < 2) {
 		printk("PSM read: no data\n");
+		link_up_done(LINK_UP_DISCOVER, -ENODATA);
 		return BT_GATT_ITER_STOP;
 	}
 
@@ -141,7 +367,8 @@ static uint8_t gatt_read_psm_cb(struct bt_conn *conn, uint8_t err,
 		       (((const uint8_t *)data)[1] << 8);
 	printk("Discovered PSM: 0x%04X\n", psm);
 
-	l2cap_connect(psm);
+	peer_psm = psm;
+	link_up_done(LINK_UP_DISCOVER, 0);
 	return BT_GATT_ITER_STOP;
 }
 
@@ -155,6 +382,7 @@ static uint8_t gatt_discover_cb(struct bt_conn *conn,
 		} else {
 			printk("PSM characteristic not found\n");
 		}
+		link_up_done(LINK_UP_DISCOVER, -ENOENT);
 		return BT_GATT_ITER_STOP;
 	}
 
@@ -173,6 +401,7 @@ static uint8_t gatt_discover_cb(struct bt_conn *conn,
 		int err = bt_gatt_discover(conn, &disc_params);
 		if (err) {
 			printk("Characteristic discovery failed (err %d)\n", err);
+			link_up_done(LINK_UP_DISCOVER, err);
 		}
 		return BT_GATT_ITER_STOP;
 	}
@@ -197,6 +426,7 @@ static uint8_t gatt_discover_cb(struct bt_conn *conn,
 		int err = bt_gatt_read(conn, &read_params);
 		if (err) {
 			printk("PSM read request failed (err %d)\n", err);
+			link_up_done(LINK_UP_DISCOVER, err);
 		}
 		return BT_GATT_ITER_STOP;
 	}
@@ -204,7 +434,7 @@ static uint8_t gatt_discover_cb(struct bt_conn *conn,
 	return BT_GATT_ITER_STOP;
 }
 
-static void start_gatt_discovery(void)
+static int start_gatt_discovery(struct bt_conn *conn)
 {
 	int err;
 
@@ -216,63 +446,28 @@ static void start_gatt_discovery(void)
 	disc_params.end_handle = BT_ATT_LAST_ATTRIBUTE_HANDLE;
 	disc_params.type = BT_GATT_DISCOVER_PRIMARY;
 
-	err = bt_gatt_discover(current_conn, &disc_params);
+	err = bt_gatt_discover(conn, &disc_params);
 	if (err) {
 		printk("GATT discovery failed (err %d)\n", err);
 	}
+	return err;
 }
 
-/* ---- Connection Setup (delayed) ---- */
-
-static void ci_update_work_handler(struct k_work *work)
-{
-	if (!current_conn) {
-		return;
-	}
+/* ---- Connection Setup ---- */
 
-	const struct bt_le_conn_param ci_param = {
-		.interval_min = 40,  /* 50ms */
-		.interval_max = 40,  /* 50ms */
-		.latency = 0,
-		.timeout = 400,
-	};
-	int err = bt_conn_le_param_update(current_conn, &ci_param);
-	if (err) {
-		printk("CI update to 50ms failed (err %d)\n", err);
-	} else {
-		printk("Requested CI update to 50ms\n");
-	}
-}
-
-static void conn_setup_work_handler(struct k_work *work)
-{
-	if (!current_conn) {
-		return;
-	}
-
-	int err;
-
-	struct bt_conn_le_data_len_param dl_param = {
-		.tx_max_len = 251,
-		.tx_max_time = 2120,
-	};
-	err = bt_conn_le_data_len_update(current_conn, &dl_param);
-	if (err) {
-		printk("Data length update request failed (err %d)\n", err);
-	}
-
-	const struct bt_conn_le_phy_param phy_param = {
-		.options = BT_CONN_LE_PHY_OPT_NONE,
-		.pref_tx_phy = BT_GAP_LE_PHY_2M,
-		.pref_rx_phy = BT_GAP_LE_PHY_2M,
-	};
-	err = bt_conn_le_phy_update(current_conn, &phy_param);
-	if (err) {
-		printk("PHY update request failed (err %d)\n", err);
-	}
-
-	start_gatt_discovery();
-}
+/* DLE, PHY and PSM discovery all start on connect; the ATT read does
+ * not need the larger PDUs. The channel opens once the PSM is known.
+ */
+static const struct link_up_cfg link_cfg = {
+	.steps = LINK_UP_STEP(LINK_UP_DLE) | LINK_UP_STEP(LINK_UP_PHY) |
+		 LINK_UP_STEP(LINK_UP_DISCOVER) | LINK_UP_STEP(LINK_UP_OPEN),
+	.tx_octets = 251,
+	.tx_time = 2120,
+	.phy = BT_GAP_LE_PHY_2M,
+	.discover = start_gatt_discovery,
+	.open = l2cap_connect,
+	.open_after = LINK_UP_STEP(LINK_UP_DISCOVER),
+};
 
 /* ---- Connection Callbacks ---- */
 
@@ -298,8 +493,6 @@ static void connected(struct bt_conn *conn, uint8_t err)
 		       (info.le.interval * 125 % 100),
 		       info.le.latency, info.le.timeout);
 	}
-
-	k_work_schedule(&conn_setup_work, K_MSEC(100));
 }
 
 static void disconnected(struct bt_conn *conn, uint8_t reason)
@@ -314,8 +507,6 @@ static void disconnected(struct bt_conn *conn, uint8_t reason)
 		current_conn = NULL;
 	}
 
-	k_work_cancel_delayable(&conn_setup_work);
-	k_work_cancel_delayable(&ci_update_work);
 	l2cap_connected = false;
 	rx_bytes = 0;
 }
@@ -340,8 +531,6 @@ static void le_data_len_updated(struct bt_conn *conn,
 	printk("Data Length updated: TX len=%u time=%u, RX len=%u time=%u\n",
 	       info->tx_max_len, info->tx_max_time,
 	       info->rx_max_len, info->rx_max_time);
-
-	(void)info; /* CI update done via delayed work */
 }
 
 BT_CONN_CB_DEFINE(conn_callbacks) = {
@@ -445,6 +634,12 @@ void stats_thread(void)
 			uint32_t elapsed_frac = (uint32_t)((elapsed_ms % 1000) / 100);
 			printk("RX: %u kbps (avg: %u kbps) | %u bytes in %u.%us\n",
 			       kbps, avg_kbps, cur_bytes, elapsed_s, elapsed_frac);
+#if defined(CONFIG_L2CAP_CENTRAL_PLAYOUT)
+			po_report();
+#endif
+#if defined(CONFIG_TIME_SYNC)
+			time_sync_bt_report();
+#endif
 		}
 	}
 }
@@ -459,8 +654,7 @@ int main(void)
 
 	printk("Starting nRF54L15 L2CAP CoC Central\n");
 
-	k_work_init_delayable(&conn_setup_work, conn_setup_work_handler);
-	k_work_init_delayable(&ci_update_work, ci_update_work_handler);
+	link_up_init(&link_cfg);
 
 	err = bt_enable(NULL);
 	if (err) {
@@ -469,6 +663,10 @@ int main(void)
 	}
 	printk("Bluetooth initialized\n");
 
+#if defined(CONFIG_TIME_SYNC)
+	time_sync_bt_init();
+#endif
+
 	struct bt_le_scan_param scan_param = {
 		.type = BT_LE_SCAN_TYPE_ACTIVE,
 		.options = BT_LE_SCAN_OPT_NONE,
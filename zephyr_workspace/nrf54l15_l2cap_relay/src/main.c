@@ -0,0 +1,717 @@
+/*
+ * L2CAP CoC Relay for nRF54L15
+ *
+ * Dual-role node between a wearable and a gateway:
+ *
+ *   nrf54l15_l2cap_test_fast  --L2CAP-->  relay  --L2CAP-->  nrf54l15_l2cap_central_fast
+ *   (peripheral, "nRF54L15_Test")          (both)             (central, relay.conf)
+ *
+ * The relay advertises as "nRF54L15_Relay" with the same PSM service as
+ * the wearable. Once the gateway has opened its channel, it scans for
+ * the wearable, connects as central and opens the upstream channel.
+ *
+ * Zero copy: the host reassembles each upstream SDU into a buffer from
+ * relay_pool (alloc_buf), which reserves the headroom the downstream
+ * send needs. The payload is then forwarded as is, wrapped in a
+ * data-less fwd_pool buffer pointing at the same memory.
+ * bt_l2cap_chan_send() insists on a single reference, so the wrapper
+ * lets the relay hold the SDU buffer while the stack owns the buffer
+ * it was given.
+ *
+ * Credit flow: upstream runs in host-managed mode, so the wearable gets
+ * one credit per SDU once recv() returns. While a relay_pool buffer is
+ * free, recv() returns 0 and the credit goes straight back. When every
+ * buffer is waiting on the gateway, recv() returns -EINPROGRESS. The
+ * credit is then held until a forwarded buffer is released, so the
+ * relay never holds more than CONFIG_L2CAP_RELAY_BUFS SDUs. A slow
+ * gateway withholding credits stalls the wearable instead of growing a
+ * queue.
+ *
+ * Prints once per second: upstream/downstream kbps and the hold time
+ * from an SDU being fully received to the gateway acknowledging its
+ * last PDU.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/hci.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/uuid.h>
+#include <zephyr/bluetooth/gatt.h>
+#include <zephyr/bluetooth/l2cap.h>
+#include <zephyr/net_buf.h>
+#include <zephyr/spinlock.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/printk.h>
+
+#include "link_up.h"
+
+#define DEVICE_NAME     CONFIG_BT_DEVICE_NAME
+#define DEVICE_NAME_LEN (sizeof(DEVICE_NAME) - 1)
+
+#define TARGET_NAME     "nRF54L15_Test"
+#define TARGET_NAME_LEN (sizeof(TARGET_NAME) - 1)
+
+#define SDU_LEN          2000
+#define RX_MPS           247
+#define RELAY_BUFS       CONFIG_L2CAP_RELAY_BUFS
+#define STATS_INTERVAL_MS 1000
+
+/* Forwarded SDUs not yet acknowledged by the gateway: at most one per
+ * relay buffer plus one per controller TX context already released.
+ */
+#define HOLD_SLOTS       (RELAY_BUFS + CONFIG_BT_CONN_TX_MAX)
+
+/* PSM Discovery Service UUIDs - same service on the wearable and here */
+#define BT_UUID_PSM_SERVICE_VAL \
+	BT_UUID_128_ENCODE(0x12345678, 0x1234, 0x5678, 0x1234, 0x56789ABCDEF0)
+#define BT_UUID_PSM_CHAR_VAL \
+	BT_UUID_128_ENCODE(0x12345678, 0x1234, 0x5678, 0x1234, 0x56789ABCDEF1)
+
+#define BT_UUID_PSM_SERVICE BT_UUID_DECLARE_128(BT_UUID_PSM_SERVICE_VAL)
+#define BT_UUID_PSM_CHAR    BT_UUID_DECLARE_128(BT_UUID_PSM_CHAR_VAL)
+
+/* Upstream: we are central, the wearable serves the PSM */
+static struct bt_l2cap_le_chan up_chan;
+static struct bt_conn *up_conn;
+static volatile bool up_connected;
+
+/* Downstream: we are peripheral, the gateway connects to our server */
+static struct bt_l2cap_server l2cap_server;
+static struct bt_l2cap_le_chan down_chan;
+static struct bt_conn *down_conn;
+static volatile bool down_connected;
+
+/* GATT discovery state (upstream) */
+static struct bt_gatt_discover_params disc_params;
+static struct bt_gatt_read_params read_params;
+static uint16_t peer_psm;
+
+static struct k_work scan_work;
+static struct k_work adv_work;
+static struct k_work credit_work;
+
+/* ---- Relay Buffers ---- */
+
+/* Upstream SDUs are reassembled straight into these; the reserved
+ * headroom is what the downstream send prepends its headers into.
+ */
+NET_BUF_POOL_DEFINE(relay_pool, RELAY_BUFS, BT_L2CAP_SDU_BUF_SIZE(SDU_LEN),
+		    CONFIG_BT_CONN_TX_USER_DATA_SIZE, NULL);
+
+static void fwd_buf_destroy(struct net_buf *buf);
+
+/* Data-less wrappers handed to the downstream channel */
+NET_BUF_POOL_DEFINE(fwd_pool, RELAY_BUFS, 0, CONFIG_BT_CONN_TX_USER_DATA_SIZE,
+		    fwd_buf_destroy);
+
+/* relay_pool buffer each fwd_pool buffer points into */
+static struct net_buf *fwd_sdu[RELAY_BUFS];
+
+/* fwd_pool buffers the stack has not yet released */
+static atomic_t fwd_inflight;
+
+/* Upstream SDU whose credit is being held back (returned -EINPROGRESS) */
+static atomic_ptr_t credit_owed;
+
+/* ---- Stats ---- */
+
+struct hold_slot {
+	uint32_t t_in;
+	uint16_t len;
+};
+
+/* recv() pushes, down_sent() pops; SDUs complete in send order */
+static struct hold_slot hold[HOLD_SLOTS];
+static atomic_t hold_head;
+static atomic_t hold_tail;
+
+static struct k_spinlock stats_lock;
+static uint32_t in_bytes;
+static uint32_t out_bytes;
+static uint32_t hold_sum_us;
+static uint32_t hold_max_us;
+static uint32_t hold_count;
+static uint32_t credit_holds;
+static uint32_t dropped;
+
+/* ---- Forwarding ---- */
+
+static void fwd_buf_destroy(struct net_buf *buf)
+{
+	struct net_buf *sdu = fwd_sdu[net_buf_id(buf)];
+
+	fwd_sdu[net_buf_id(buf)] = NULL;
+	net_buf_destroy(buf);
+	net_buf_unref(sdu);
+
+	/* A relay buffer is free again: release a held credit, if any.
+	 * Runs wherever the stack drops the buffer, so defer the
+	 * signalling PDU to the workqueue.
+	 */
+	atomic_dec(&fwd_inflight);
+	k_work_submit(&credit_work);
+}
+
+static void credit_handler(struct k_work *work)
+{
+	struct net_buf *sdu;
+
+	if (atomic_get(&fwd_inflight) >= RELAY_BUFS) {
+		return;
+	}
+
+	sdu = atomic_ptr_clear(&credit_owed);
+	if (sdu == NULL) {
+		return;
+	}
+
+	/* Returns the wearable's credit and drops the host's reference;
+	 * the fwd_pool buffer still holds its own.
+	 */
+	bt_l2cap_chan_recv_complete(&up_chan.chan, sdu);
+}
+
+static int forward(struct net_buf *sdu)
+{
+	size_t headroom = net_buf_headroom(sdu);
+	struct net_buf *fwd;
+	atomic_val_t slot;
+	int err;
+
+	if (!down_connected || sdu->len > down_chan.tx.mtu) {
+		return -ENOTCONN;
+	}
+
+	/* Same memory, headroom included: nothing is copied */
+	fwd = net_buf_alloc_with_data(&fwd_pool, sdu->data - headroom,
+				      headroom + sdu->len, K_NO_WAIT);
+	if (fwd == NULL) {
+		return -ENOBUFS;
+	}
+	net_buf_pull(fwd, headroom);
+	fwd_sdu[net_buf_id(fwd)] = net_buf_ref(sdu);
+
+	slot = atomic_inc(&hold_head);
+	hold[slot % HOLD_SLOTS].t_in = k_cycle_get_32();
+	hold[slot % HOLD_SLOTS].len = sdu->len;
+
+	atomic_inc(&fwd_inflight);
+	err = bt_l2cap_chan_send(&down_chan.chan, fwd);
+	if (err < 0) {
+		atomic_dec(&hold_head);
+		/* Releases the SDU reference via fwd_buf_destroy() */
+		net_buf_unref(fwd);
+		return err;
+	}
+
+	return 0;
+}
+
+/* ---- Upstream Channel Callbacks ---- */
+
+static void up_chan_connected(struct bt_l2cap_chan *chan)
+{
+	struct bt_l2cap_le_chan *le_chan =
+		CONTAINER_OF(chan, struct bt_l2cap_le_chan, chan);
+
+	printk("Upstream L2CAP connected: tx.mtu=%u rx.mtu=%u rx.mps=%u\n",
+	       le_chan->tx.mtu, le_chan->rx.mtu, le_chan->rx.mps);
+
+	up_connected = true;
+	link_up_done(LINK_UP_OPEN, 0);
+}
+
+static void up_chan_disconnected(struct bt_l2cap_chan *chan)
+{
+	struct net_buf *sdu;
+
+	printk("Upstream L2CAP disconnected\n");
+	up_connected = false;
+	link_up_done(LINK_UP_OPEN, -ECONNREFUSED);
+
+	sdu = atomic_ptr_clear(&credit_owed);
+	if (sdu != NULL) {
+		net_buf_unref(sdu);
+	}
+}
+
+static struct net_buf *up_chan_alloc_buf(struct bt_l2cap_chan *chan)
+{
+	struct net_buf *buf = net_buf_alloc(&relay_pool, K_NO_WAIT);
+
+	if (buf != NULL) {
+		net_buf_reserve(buf, BT_L2CAP_SDU_CHAN_SEND_RESERVE);
+	}
+	return buf;
+}
+
+static int up_chan_recv(struct bt_l2cap_chan *chan, struct net_buf *buf)
+{
+	k_spinlock_key_t key;
+	uint16_t len = buf->len;
+	int err;
+
+	link_up_first_payload();
+
+	err = forward(buf);
+
+	key = k_spin_lock(&stats_lock);
+	in_bytes += len;
+	if (err) {
+		dropped++;
+	}
+	k_spin_unlock(&stats_lock, key);
+
+	if (err) {
+		/* Host returns the credit and frees the buffer */
+		return 0;
+	}
+
+	if (atomic_get(&fwd_inflight) < RELAY_BUFS) {
+		/* A buffer is free for the next SDU: credit now. The host
+		 * drops its reference, the forwarded wrapper keeps one.
+		 */
+		return 0;
+	}
+
+	/* Every buffer is waiting on the gateway: hold the credit. Kick
+	 * the work item in case a buffer was released in the meantime.
+	 */
+	key = k_spin_lock(&stats_lock);
+	credit_holds++;
+	k_spin_unlock(&stats_lock, key);
+
+	atomic_ptr_set(&credit_owed, buf);
+	k_work_submit(&credit_work);
+	return -EINPROGRESS;
+}
+
+static const struct bt_l2cap_chan_ops up_chan_ops = {
+	.connected = up_chan_connected,
+	.disconnected = up_chan_disconnected,
+	.alloc_buf = up_chan_alloc_buf,
+	.recv = up_chan_recv,
+};
+
+/* ---- Downstream Channel Callbacks ---- */
+
+static void down_chan_connected(struct bt_l2cap_chan *chan)
+{
+	struct bt_l2cap_le_chan *le_chan =
+		CONTAINER_OF(chan, struct bt_l2cap_le_chan, chan);
+
+	printk("Downstream L2CAP connected: tx.mtu=%u tx.mps=%u\n",
+	       le_chan->tx.mtu, le_chan->tx.mps);
+
+	atomic_set(&hold_head, 0);
+	atomic_set(&hold_tail, 0);
+	down_connected = true;
+
+	/* Gateway is ready: go and find the wearable */
+	if (up_conn == NULL) {
+		k_work_submit(&scan_work);
+	}
+}
+
+static void down_chan_disconnected(struct bt_l2cap_chan *chan)
+{
+	printk("Downstream L2CAP disconnected\n");
+	down_connected = false;
+}
+
+static int down_chan_recv(struct bt_l2cap_chan *chan, struct net_buf *buf)
+{
+	/* The gateway only receives */
+	return 0;
+}
+
+static void down_chan_sent(struct bt_l2cap_chan *chan)
+{
+	atomic_val_t slot = atomic_inc(&hold_tail);
+	const struct hold_slot *h = &hold[slot % HOLD_SLOTS];
+	uint32_t us = k_cyc_to_us_floor32(k_cycle_get_32() - h->t_in);
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&stats_lock);
+	out_bytes += h->len;
+	hold_sum_us += us;
+	hold_max_us = MAX(hold_max_us, us);
+	hold_count++;
+	k_spin_unlock(&stats_lock, key);
+}
+
+static const struct bt_l2cap_chan_ops down_chan_ops = {
+	.connected = down_chan_connected,
+	.disconnected = down_chan_disconnected,
+	.recv = down_chan_recv,
+	.sent = down_chan_sent,
+};
+
+static int l2cap_accept(struct bt_conn *conn, struct bt_l2cap_server *server,
+			struct bt_l2cap_chan **chan)
+{
+	if (down_connected) {
+		return -ENOMEM;
+	}
+
+	printk("L2CAP connection request from gateway\n");
+
+	memset(&down_chan, 0, sizeof(down_chan));
+	down_chan.chan.ops = &down_chan_ops;
+
+	*chan = &down_chan.chan;
+	return 0;
+}
+
+/* ---- PSM Discovery GATT Service (for the gateway) ---- */
+
+static ssize_t read_psm(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+			 void *buf, uint16_t len, uint16_t offset)
+{
+	uint16_t psm = l2cap_server.psm;
+
+	return bt_gatt_attr_read(conn, attr, buf, len, offset, &psm, sizeof(psm));
+}
+
+BT_GATT_SERVICE_DEFINE(psm_svc,
+	BT_GATT_PRIMARY_SERVICE(BT_UUID_PSM_SERVICE),
+	BT_GATT_CHARACTERISTIC(BT_UUID_PSM_CHAR,
+			       BT_GATT_CHRC_READ,
+			       BT_GATT_PERM_READ,
+			       read_psm, NULL, NULL),
+);
+
+/* ---- Upstream Setup (PSM discovery, channel open) ---- */
+
+static int up_l2cap_connect(struct bt_conn *conn)
+{
+	int err;
+
+	memset(&up_chan, 0, sizeof(up_chan));
+	up_chan.chan.ops = &up_chan_ops;
+	up_chan.rx.mtu = SDU_LEN;
+	up_chan.rx.mps = RX_MPS;
+
+	err = bt_l2cap_chan_connect(conn, &up_chan.chan, peer_psm);
+	if (err) {
+		printk("Upstream L2CAP connect failed (err %d)\n", err);
+	}
+	return err;
+}
+
+static uint8_t gatt_read_psm_cb(struct bt_conn *conn, uint8_t err,
+				 struct bt_gatt_read_params *params,
+				 const void *data, uint16_t length)
+{
+	if (err || !data || length < 2) {
+		printk("Wearable PSM read failed (err %u)\n", err);
+		link_up_done(LINK_UP_DISCOVER, err ? -EIO : -ENODATA);
+		return BT_GATT_ITER_STOP;
+	}
+
+	peer_psm = ((const uint8_t *)data)[0] | (((const uint8_t *)data)[1] << 8);
+	printk("Wearable PSM: 0x%04X\n", peer_psm);
+	link_up_done(LINK_UP_DISCOVER, 0);
+	return BT_GATT_ITER_STOP;
+}
+
+static uint8_t gatt_discover_cb(struct bt_conn *conn,
+				const struct bt_gatt_attr *attr,
+				struct bt_gatt_discover_params *params)
+{
+	int err;
+
+	if (!attr) {
+		printk("Wearable PSM service not found\n");
+		link_up_done(LINK_UP_DISCOVER, -ENOENT);
+		return BT_GATT_ITER_STOP;
+	}
+
+	if (params->type == BT_GATT_DISCOVER_PRIMARY) {
+		struct bt_gatt_service_val *svc =
+			(struct bt_gatt_service_val *)attr->user_data;
+
+		disc_params.uuid = NULL;
+		disc_params.start_handle = attr->handle + 1;
+		disc_params.end_handle = svc->end_handle;
+		disc_params.type = BT_GATT_DISCOVER_CHARACTERISTIC;
+
+		err = bt_gatt_discover(conn, &disc_params);
+		if (err) {
+			link_up_done(LINK_UP_DISCOVER, err);
+		}
+		return BT_GATT_ITER_STOP;
+	}
+
+	struct bt_gatt_chrc *chrc = (struct bt_gatt_chrc *)attr->user_data;
+
+	if (bt_uuid_cmp(chrc->uuid, BT_UUID_PSM_CHAR) != 0) {
+		return BT_GATT_ITER_CONTINUE;
+	}
+
+	read_params.func = gatt_read_psm_cb;
+	read_params.handle_count = 1;
+	read_params.single.handle = chrc->value_handle;
+	read_params.single.offset = 0;
+
+	err = bt_gatt_read(conn, &read_params);
+	if (err) {
+		link_up_done(LINK_UP_DISCOVER, err);
+	}
+	return BT_GATT_ITER_STOP;
+}
+
+static int start_gatt_discovery(struct bt_conn *conn)
+{
+	disc_params.uuid = BT_UUID_PSM_SERVICE;
+	disc_params.func = gatt_discover_cb;
+	disc_params.start_handle = BT_ATT_FIRST_ATTRIBUTE_HANDLE;
+	disc_params.end_handle = BT_ATT_LAST_ATTRIBUTE_HANDLE;
+	disc_params.type = BT_GATT_DISCOVER_PRIMARY;
+
+	return bt_gatt_discover(conn, &disc_params);
+}
+
+/* Bring-up runs on the upstream (central) link only; the gateway
+ * drives DLE and PHY on the downstream one.
+ */
+static const struct link_up_cfg link_cfg = {
+	.steps = LINK_UP_STEP(LINK_UP_DLE) | LINK_UP_STEP(LINK_UP_PHY) |
+		 LINK_UP_STEP(LINK_UP_DISCOVER) | LINK_UP_STEP(LINK_UP_OPEN),
+	.roles = BIT(BT_CONN_ROLE_CENTRAL),
+	.tx_octets = 251,
+	.tx_time = 2120,
+	.phy = BT_GAP_LE_PHY_2M,
+	.discover = start_gatt_discovery,
+	.open = up_l2cap_connect,
+	.open_after = LINK_UP_STEP(LINK_UP_DISCOVER),
+};
+
+/* ---- Scanning / Advertising ---- */
+
+static const struct bt_data ad[] = {
+	BT_DATA_BYTES(BT_DATA_FLAGS, (BT_LE_AD_GENERAL | BT_LE_AD_NO_BREDR)),
+	BT_DATA(BT_DATA_NAME_COMPLETE, DEVICE_NAME, DEVICE_NAME_LEN),
+};
+
+static const struct bt_data sd[] = {
+	BT_DATA_BYTES(BT_DATA_UUID128_ALL, BT_UUID_PSM_SERVICE_VAL),
+};
+
+static bool name_matches(struct bt_data *data, void *user_data)
+{
+	bool *found = user_data;
+
+	if (data->type == BT_DATA_NAME_COMPLETE &&
+	    data->data_len == TARGET_NAME_LEN &&
+	    memcmp(data->data, TARGET_NAME, TARGET_NAME_LEN) == 0) {
+		*found = true;
+		return false;
+	}
+	return true;
+}
+
+static void scan_cb(const bt_addr_le_t *addr, int8_t rssi,
+		    uint8_t type, struct net_buf_simple *ad_buf)
+{
+	bool found = false;
+	int err;
+
+	if (type != BT_GAP_ADV_TYPE_ADV_IND &&
+	    type != BT_GAP_ADV_TYPE_ADV_DIRECT_IND) {
+		return;
+	}
+
+	bt_data_parse(ad_buf, name_matches, &found);
+	if (!found) {
+		return;
+	}
+
+	err = bt_le_scan_stop();
+	if (err) {
+		printk("Scan stop failed (err %d)\n", err);
+		return;
+	}
+
+	/* Same 50 ms interval the gateway uses downstream */
+	struct bt_conn_le_create_param create_param = {
+		.options = BT_CONN_LE_OPT_NONE,
+		.interval = BT_GAP_SCAN_FAST_INTERVAL,
+		.window = BT_GAP_SCAN_FAST_WINDOW,
+	};
+	struct bt_le_conn_param conn_param = {
+		.interval_min = 40,
+		.interval_max = 40,
+		.latency = 0,
+		.timeout = 400,
+	};
+	struct bt_conn *conn;
+
+	err = bt_conn_le_create(addr, &create_param, &conn_param, &conn);
+	if (err) {
+		printk("Connection create failed (err %d)\n", err);
+		k_work_submit(&scan_work);
+		return;
+	}
+	bt_conn_unref(conn);
+	printk("Connecting to wearable...\n");
+}
+
+static void scan_handler(struct k_work *work)
+{
+	struct bt_le_scan_param scan_param = {
+		.type = BT_LE_SCAN_TYPE_ACTIVE,
+		.options = BT_LE_SCAN_OPT_NONE,
+		.interval = BT_GAP_SCAN_FAST_INTERVAL,
+		.window = BT_GAP_SCAN_FAST_WINDOW,
+	};
+	int err;
+
+	if (!down_connected || up_conn != NULL) {
+		return;
+	}
+
+	err = bt_le_scan_start(&scan_param, scan_cb);
+	if (err && err != -EALREADY) {
+		printk("Scan start failed (err %d)\n", err);
+		return;
+	}
+	printk("Scanning for '%s'...\n", TARGET_NAME);
+}
+
+static void adv_handler(struct k_work *work)
+{
+	int err;
+
+	err = bt_le_adv_start(BT_LE_ADV_CONN_FAST_1, ad, ARRAY_SIZE(ad),
+			      sd, ARRAY_SIZE(sd));
+	if (err && err != -EALREADY) {
+		printk("Advertising failed (err %d)\n", err);
+		return;
+	}
+	printk("Advertising as '%s'\n", DEVICE_NAME);
+}
+
+/* ---- Connection Callbacks ---- */
+
+static void connected(struct bt_conn *conn, uint8_t err)
+{
+	struct bt_conn_info info;
+
+	if (err) {
+		printk("Connection failed (err %u)\n", err);
+		k_work_submit(&scan_work);
+		return;
+	}
+
+	if (bt_conn_get_info(conn, &info) != 0) {
+		return;
+	}
+
+	if (info.role == BT_CONN_ROLE_CENTRAL) {
+		printk("Wearable connected\n");
+		up_conn = bt_conn_ref(conn);
+	} else {
+		printk("Gateway connected\n");
+		down_conn = bt_conn_ref(conn);
+		bt_le_adv_stop();
+	}
+}
+
+static void disconnected(struct bt_conn *conn, uint8_t reason)
+{
+	if (conn == up_conn) {
+		printk("Wearable disconnected (reason %u)\n", reason);
+		bt_conn_unref(up_conn);
+		up_conn = NULL;
+		up_connected = false;
+		k_work_submit(&scan_work);
+	} else if (conn == down_conn) {
+		printk("Gateway disconnected (reason %u)\n", reason);
+		bt_conn_unref(down_conn);
+		down_conn = NULL;
+		down_connected = false;
+		k_work_submit(&adv_work);
+	}
+}
+
+BT_CONN_CB_DEFINE(conn_callbacks) = {
+	.connected = connected,
+	.disconnected = disconnected,
+};
+
+/* ---- Stats Thread ---- */
+
+void stats_thread(void)
+{
+	while (1) {
+		k_sleep(K_MSEC(STATS_INTERVAL_MS));
+
+		k_spinlock_key_t key = k_spin_lock(&stats_lock);
+		uint32_t in = in_bytes;
+		uint32_t out = out_bytes;
+		uint32_t avg_us = hold_count ? hold_sum_us / hold_count : 0;
+		uint32_t max_us = hold_max_us;
+		uint32_t holds = credit_holds;
+		uint32_t drops = dropped;
+
+		in_bytes = 0;
+		out_bytes = 0;
+		hold_sum_us = 0;
+		hold_max_us = 0;
+		hold_count = 0;
+		k_spin_unlock(&stats_lock, key);
+
+		if (!up_connected && !down_connected) {
+			continue;
+		}
+
+		printk("RELAY: in %u kbps out %u kbps | hold avg %u.%u ms max %u.%u ms"
+		       " | bufs %u/%u | credit holds %u | dropped %u\n",
+		       in * 8 / STATS_INTERVAL_MS, out * 8 / STATS_INTERVAL_MS,
+		       avg_us / 1000, (avg_us % 1000) / 100,
+		       max_us / 1000, (max_us % 1000) / 100,
+		       (uint32_t)atomic_get(&fwd_inflight), RELAY_BUFS, holds, drops);
+	}
+}
+
+K_THREAD_DEFINE(stats_tid, 1024, stats_thread, NULL, NULL, NULL, 7, 0, 0);
+
+/* ---- Main ---- */
+
+int main(void)
+{
+	int err;
+
+	printk("Starting nRF54L15 L2CAP CoC Relay (%u SDU buffers)\n", RELAY_BUFS);
+
+	k_work_init(&scan_work, scan_handler);
+	k_work_init(&adv_work, adv_handler);
+	k_work_init(&credit_work, credit_handler);
+	link_up_init(&link_cfg);
+
+	err = bt_enable(NULL);
+	if (err) {
+		printk("Bluetooth init failed (err %d)\n", err);
+		return 0;
+	}
+
+	l2cap_server.psm = 0;
+	l2cap_server.sec_level = BT_SECURITY_L1;
+	l2cap_server.accept = l2cap_accept;
+
+	err = bt_l2cap_server_register(&l2cap_server);
+	if (err) {
+		printk("L2CAP server registration failed (err %d)\n", err);
+		return 0;
+	}
+	printk("L2CAP server registered, PSM=0x%04X\n", l2cap_server.psm);
+
+	/* Wait for the gateway first; the wearable is only picked up once
+	 * there is somewhere to forward to.
+	 */
+	k_work_submit(&adv_work);
+
+	return 0;
+}
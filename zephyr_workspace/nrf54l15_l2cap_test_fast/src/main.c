@@ -4,6 +4,21 @@
  * Streams data over L2CAP Connection-Oriented Channel to bypass GATT/ATT
  * overhead. A small GATT service exposes the dynamically allocated PSM
  * so the central can discover which PSM to connect to.
+ * Link setup is driven by common/link_up.
+ *
+ * This is the only L2CAP peripheral source: the controller is a build
+ * variant (-DCTLR=sdc|zephyr, see CMakeLists.txt) and SDU size, queue
+ * depth and CI come from Kconfig, so an SDC vs Zephyr LL comparison
+ * runs identical app code (bsim/ctlr_ab.sh). nrf54l15_l2cap_test
+ * builds this file with its macOS settings.
+ *
+ * With audio.conf the stream is packetised audio instead: one 16 ms
+ * frame per tick, batched by common/audio_pkt, for the central's
+ * playout engine (bsim/audio_playout.sh).
+ *
+ * time_sync.conf adds common/time_sync: connection anchors swapped
+ * with the central give both boards the other's clock, printed as a
+ * TSYNC line after the stats (bsim/time_sync.sh).
  */
 
 #include <zephyr/kernel.h>
@@ -15,11 +30,21 @@
 #include <zephyr/bluetooth/l2cap.h>
 #include <zephyr/sys/printk.h>
 
+#include "link_up.h"
+#include "profiler.h"
+
+#if defined(CONFIG_L2CAP_TEST_AUDIO)
+#include "audio_pkt.h"
+#endif
+#if defined(CONFIG_TIME_SYNC)
+#include "time_sync_bt.h"
+#endif
+
 #define DEVICE_NAME     CONFIG_BT_DEVICE_NAME
 #define DEVICE_NAME_LEN (sizeof(DEVICE_NAME) - 1)
 
-#define SDU_LEN          2000
-#define TX_BUF_COUNT     10
+#define SDU_LEN          CONFIG_L2CAP_TEST_SDU_LEN
+#define TX_BUF_COUNT     CONFIG_L2CAP_TEST_TX_BUFS
 #define STATS_INTERVAL_MS 1000
 
 /* PSM Discovery Service UUIDs */
@@ -44,7 +69,8 @@ static uint32_t bytes_sent;
 static volatile bool l2cap_connected;
 static volatile bool dle_ready;
 
-static struct k_work_delayable conn_param_work;
+/* Given when the channel opens or DLE completes; wakes the stream thread */
+static K_SEM_DEFINE(stream_ready, 0, 1);
 
 /* TX buffer pool */
 static void tx_buf_destroy(struct net_buf *buf)
@@ -65,6 +91,17 @@ static uint16_t tx_sdu_len;
 /* Test data pattern */
 static uint8_t tx_data[SDU_LEN];
 
+/* Send -> sent latency per SDU. At most TX_BUF_COUNT SDUs are in
+ * flight (tx_sem) and sent callbacks arrive in send order.
+ */
+static uint32_t sent_t0[TX_BUF_COUNT];
+static uint32_t sent_head;
+static atomic_t sent_tail;
+static struct k_spinlock lat_lock;
+static uint32_t lat_sum_us;
+static uint32_t lat_max_us;
+static uint32_t lat_count;
+
 /* ---- L2CAP Channel Callbacks ---- */
 
 static void l2cap_chan_connected(struct bt_l2cap_chan *chan)
@@ -82,6 +119,9 @@ static void l2cap_chan_connected(struct bt_l2cap_chan *chan)
 
 	l2cap_connected = true;
 	bytes_sent = 0;
+	sent_head = 0;
+	atomic_set(&sent_tail, 0);
+	k_sem_give(&stream_ready);
 
 	/* Allow multiple sends to keep the pipe full */
 	for (int i = 0; i < TX_BUF_COUNT; i++) {
@@ -108,6 +148,16 @@ static int l2cap_chan_recv(struct bt_l2cap_chan *chan, struct net_buf *buf)
 
 static void l2cap_chan_sent(struct bt_l2cap_chan *chan)
 {
+	atomic_val_t slot = atomic_inc(&sent_tail);
+	uint32_t us = k_cyc_to_us_floor32(k_cycle_get_32() -
+					  sent_t0[slot % TX_BUF_COUNT]);
+	k_spinlock_key_t key = k_spin_lock(&lat_lock);
+
+	lat_sum_us += us;
+	lat_max_us = MAX(lat_max_us, us);
+	lat_count++;
+	k_spin_unlock(&lat_lock, key);
+
 	k_sem_give(&tx_sem);
 }
 
@@ -166,25 +216,29 @@ static const struct bt_data sd[] = {
 
 /* ---- Connection Callbacks ---- */
 
-static void conn_param_work_handler(struct k_work *work)
+static void link_phase_done(enum link_up_phase phase, int err)
 {
-	if (!current_conn) {
-		return;
-	}
-
-	int err;
-
-	struct bt_conn_le_data_len_param dl_param = {
-		.tx_max_len = 251,
-		.tx_max_time = 2120,
-	};
-	err = bt_conn_le_data_len_update(current_conn, &dl_param);
-	if (err) {
-		printk("Data length update failed (err %d)\n", err);
+	if (phase == LINK_UP_DLE && err == 0) {
+		dle_ready = true;
+		k_sem_give(&stream_ready);
 	}
-	/* CI is controlled by the central - don't override here */
 }
 
+/* CI is left to the central unless CONFIG_L2CAP_TEST_CI_MAX is set */
+static const struct link_up_cfg link_cfg = {
+	.steps = LINK_UP_STEP(LINK_UP_DLE) |
+		 (CONFIG_L2CAP_TEST_CI_MAX ? LINK_UP_STEP(LINK_UP_CI) : 0),
+	.tx_octets = 251,
+	.tx_time = 2120,
+	.ci = {
+		.interval_min = CONFIG_L2CAP_TEST_CI_MIN,
+		.interval_max = CONFIG_L2CAP_TEST_CI_MAX,
+		.latency = 0,
+		.timeout = 400,
+	},
+	.phase_done = link_phase_done,
+};
+
 static void connected(struct bt_conn *conn, uint8_t err)
 {
 	char addr[BT_ADDR_LE_STR_LEN];
@@ -200,8 +254,6 @@ static void connected(struct bt_conn *conn, uint8_t err)
 
 	/* Stop advertising to free radio time for data transfer */
 	bt_le_adv_stop();
-
-	k_work_schedule(&conn_param_work, K_MSEC(50));
 }
 
 static void disconnected(struct bt_conn *conn, uint8_t reason)
@@ -216,7 +268,6 @@ static void disconnected(struct bt_conn *conn, uint8_t reason)
 		current_conn = NULL;
 	}
 
-	k_work_cancel_delayable(&conn_param_work);
 	l2cap_connected = false;
 	dle_ready = false;
 	bytes_sent = 0;
@@ -242,10 +293,6 @@ static void le_data_len_updated(struct bt_conn *conn,
 	printk("Data Length updated: TX len=%u time=%u, RX len=%u time=%u\n",
 	       info->tx_max_len, info->tx_max_time,
 	       info->rx_max_len, info->rx_max_time);
-
-	if (info->tx_max_len >= 251) {
-		dle_ready = true;
-	}
 }
 
 BT_CONN_CB_DEFINE(conn_callbacks) = {
@@ -256,6 +303,99 @@ BT_CONN_CB_DEFINE(conn_callbacks) = {
 	.le_data_len_updated = le_data_len_updated,
 };
 
+/* ---- Audio Stream ---- */
+
+#if defined(CONFIG_L2CAP_TEST_AUDIO)
+K_TIMER_DEFINE(audio_timer, NULL, NULL);
+
+static struct audio_pkt audio_tx;
+static uint8_t audio_sdu[AUDIO_PKT_SDU_MAX];
+static int16_t audio_pcm[AUDIO_PKT_FRAME];
+static uint32_t audio_frames;
+static uint32_t audio_dropped;
+
+/* The cycle counter: on nRF54L the GRTC, which the controller stamps
+ * connection anchors with too, so common/time_sync can map these
+ * timestamps onto the central's clock
+ */
+static inline uint32_t audio_now_us(void)
+{
+	return (uint32_t)k_cyc_to_us_floor64(k_cycle_get_64());
+}
+
+/* A live source cannot wait for a TX slot: without one the SDU is lost */
+static void audio_send(size_t len)
+{
+	struct net_buf *buf;
+
+	if (k_sem_take(&tx_sem, K_NO_WAIT) != 0) {
+		audio_dropped++;
+		return;
+	}
+
+	buf = net_buf_alloc(&sdu_tx_pool, K_NO_WAIT);
+	if (!buf) {
+		k_sem_give(&tx_sem);
+		audio_dropped++;
+		return;
+	}
+
+	net_buf_reserve(buf, BT_L2CAP_SDU_CHAN_SEND_RESERVE);
+	net_buf_add_mem(buf, audio_sdu, len);
+	sent_t0[sent_head % TX_BUF_COUNT] = k_cycle_get_32();
+
+	if (bt_l2cap_chan_send(&l2cap_chan.chan, buf) < 0) {
+		net_buf_unref(buf);
+		k_sem_give(&tx_sem);
+		audio_dropped++;
+		return;
+	}
+	sent_head++;
+	link_up_first_payload();
+	bytes_sent += len;
+}
+
+/* Runs while the channel is open. Timestamps are this board's clock,
+ * which the central measures its jitter and drift against.
+ */
+static void audio_stream(void)
+{
+	struct audio_pkt_cfg cfg = {
+		.frames = CONFIG_L2CAP_TEST_AUDIO_FRAMES,
+		.compress = true,
+		.hold_us = CONFIG_L2CAP_TEST_AUDIO_FRAMES * AUDIO_PKT_FRAME_US,
+		.sdu_max = tx_sdu_len,
+	};
+	uint32_t phase = 0;
+	uint16_t seq = 0;
+
+	audio_pkt_init(&audio_tx, &cfg);
+	k_timer_start(&audio_timer, K_USEC(AUDIO_PKT_FRAME_US), K_USEC(AUDIO_PKT_FRAME_US));
+
+	while (l2cap_connected) {
+		uint32_t ticks = k_timer_status_sync(&audio_timer);
+		uint32_t now = audio_now_us();
+
+		for (uint32_t k = 0; k < ticks; k++) {
+			size_t len;
+
+			/* 250 Hz sawtooth; frame k ended ticks - 1 - k periods ago */
+			for (int i = 0; i < AUDIO_PKT_FRAME; i++) {
+				phase += 65536u * 250 / 8000;
+				audio_pcm[i] = (int16_t)(phase & 0xFFFF) >> 2;
+			}
+			len = audio_pkt_push(&audio_tx, seq++, now - (ticks - k) * AUDIO_PKT_FRAME_US,
+					     audio_pcm, audio_sdu);
+			audio_frames++;
+			if (len) {
+				audio_send(len);
+			}
+		}
+	}
+	k_timer_stop(&audio_timer);
+}
+#endif /* CONFIG_L2CAP_TEST_AUDIO */
+
 /* ---- Stream Thread ---- */
 
 void stream_thread(void)
@@ -267,10 +407,15 @@ void stream_thread(void)
 
 	while (1) {
 		if (!l2cap_connected || !dle_ready) {
-			k_sleep(K_MSEC(100));
+			k_sem_take(&stream_ready, K_MSEC(100));
 			continue;
 		}
 
+#if defined(CONFIG_L2CAP_TEST_AUDIO)
+		audio_stream();
+		continue;
+#endif
+
 		/* Wait for a TX slot */
 		k_sem_take(&tx_sem, K_FOREVER);
 
@@ -287,12 +432,17 @@ void stream_thread(void)
 		net_buf_reserve(buf, BT_L2CAP_SDU_CHAN_SEND_RESERVE);
 		net_buf_add_mem(buf, tx_data, tx_sdu_len);
 
+		/* Stamp before sending: the sent callback may beat us back */
+		sent_t0[sent_head % TX_BUF_COUNT] = k_cycle_get_32();
+
 		int ret = bt_l2cap_chan_send(&l2cap_chan.chan, buf);
 		if (ret < 0) {
 			net_buf_unref(buf);
 			k_sem_give(&tx_sem);
 			k_sleep(K_MSEC(10));
 		} else {
+			sent_head++;
+			link_up_first_payload();
 			bytes_sent += tx_sdu_len;
 		}
 	}
@@ -300,9 +450,15 @@ void stream_thread(void)
 
 /* ---- Stats Thread ---- */
 
+/* With CONFIG_PROFILER (profile.conf), sample once the stream has been
+ * steady for this long; the buffer dumps itself when full.
+ */
+#define PROFILE_AFTER_S 5
+
 void stats_thread(void)
 {
 	uint32_t prev_bytes = 0;
+	uint32_t streaming_s = 0;
 
 	while (1) {
 		k_sleep(K_MSEC(STATS_INTERVAL_MS));
@@ -313,7 +469,31 @@ void stats_thread(void)
 
 			uint32_t kbps = (delta * 8) / STATS_INTERVAL_MS;
 
-			printk("TX: %u bytes total, %u kbps\n", bytes_sent, kbps);
+			k_spinlock_key_t key = k_spin_lock(&lat_lock);
+			uint32_t avg_us = lat_count ? lat_sum_us / lat_count : 0;
+			uint32_t max_us = lat_max_us;
+
+			lat_sum_us = 0;
+			lat_max_us = 0;
+			lat_count = 0;
+			k_spin_unlock(&lat_lock, key);
+
+			printk("TX: %u bytes total, %u kbps | sdu lat avg %u.%u ms max %u.%u ms\n",
+			       bytes_sent, kbps, avg_us / 1000, (avg_us % 1000) / 100,
+			       max_us / 1000, (max_us % 1000) / 100);
+#if defined(CONFIG_L2CAP_TEST_AUDIO)
+			printk("AUDIO: %u frames, %u SDUs, %u dropped\n",
+			       audio_frames, audio_tx.sdus, audio_dropped);
+#endif
+#if defined(CONFIG_TIME_SYNC)
+			time_sync_bt_report();
+#endif
+
+			if (++streaming_s == PROFILE_AFTER_S) {
+				profiler_start(0);
+			}
+		} else {
+			streaming_s = 0;
 		}
 	}
 }
@@ -327,10 +507,12 @@ int main(void)
 {
 	int err;
 
-	printk("Starting nRF54L15 L2CAP CoC Throughput Test\n");
+	printk("Starting nRF54L15 L2CAP CoC Throughput Test (%s, SDU %u, %u bufs)\n",
+	       IS_ENABLED(CONFIG_BT_LL_SOFTDEVICE) ? "SDC" : "Zephyr LL",
+	       SDU_LEN, TX_BUF_COUNT);
 
 	k_sem_init(&tx_sem, 0, TX_BUF_COUNT);
-	k_work_init_delayable(&conn_param_work, conn_param_work_handler);
+	link_up_init(&link_cfg);
 
 	err = bt_enable(NULL);
 	if (err) {
@@ -339,6 +521,10 @@ int main(void)
 	}
 	printk("Bluetooth initialized\n");
 
+#if defined(CONFIG_TIME_SYNC)
+	time_sync_bt_init();
+#endif
+
 	/* Register L2CAP server with dynamic PSM */
 	l2cap_server.psm = 0;
 	l2cap_server.sec_level = BT_SECURITY_L1;
@@ -3,7 +3,7 @@
  *
  * Streams data over L2CAP Connection-Oriented Channel.
  * A small GATT service exposes the dynamically allocated PSM.
- * Ported from nrf54l15_l2cap_test.
+ * Ported from nrf54l15_l2cap_test. Link setup is driven by common/link_up.
  */
 
 #include <zephyr/kernel.h>
@@ -15,6 +15,8 @@
 #include <zephyr/bluetooth/gatt.h>
 #include <zephyr/bluetooth/l2cap.h>
 
+#include "link_up.h"
+
 #define DEVICE_NAME     CONFIG_BT_DEVICE_NAME
 #define DEVICE_NAME_LEN (sizeof(DEVICE_NAME) - 1)
 
@@ -39,7 +41,7 @@ static volatile bool l2cap_connected;
 static volatile bool dle_ready;
 static uint16_t tx_sdu_len;
 static uint8_t tx_data[SDU_LEN];
-static struct k_work_delayable conn_param_work;
+static K_SEM_DEFINE(stream_ready, 0, 1);
 
 static void tx_buf_destroy(struct net_buf *buf) { net_buf_destroy(buf); }
 
@@ -58,6 +60,7 @@ static void l2cap_chan_connected(struct bt_l2cap_chan *chan)
 	       le_chan->tx.mtu, le_chan->tx.mps, tx_sdu_len);
 	l2cap_connected = true;
 	bytes_sent = 0;
+	k_sem_give(&stream_ready);
 	for (int i = 0; i < TX_BUF_COUNT; i++) {
 		k_sem_give(&tx_sem);
 	}
@@ -129,22 +132,23 @@ static const struct bt_data sd[] = {
 };
 
 /* Connection Callbacks */
-static void conn_param_work_handler(struct k_work *work)
+static void link_phase_done(enum link_up_phase phase, int err)
 {
-	if (!current_conn) {
-		return;
+	if (phase == LINK_UP_DLE && err == 0) {
+		dle_ready = true;
+		k_sem_give(&stream_ready);
 	}
-	struct bt_conn_le_data_len_param dl_param = {
-		.tx_max_len = 251, .tx_max_time = 2120,
-	};
-	bt_conn_le_data_len_update(current_conn, &dl_param);
+}
 
-	struct bt_le_conn_param param = {
+static const struct link_up_cfg link_cfg = {
+	.steps = LINK_UP_STEP(LINK_UP_DLE) | LINK_UP_STEP(LINK_UP_CI),
+	.tx_octets = 251, .tx_time = 2120,
+	.ci = {
 		.interval_min = 6, .interval_max = 12,
 		.latency = 0, .timeout = 400,
-	};
-	bt_conn_le_param_update(current_conn, &param);
-}
+	},
+	.phase_done = link_phase_done,
+};
 
 static void connected(struct bt_conn *conn, uint8_t err)
 {
@@ -153,7 +157,6 @@ static void connected(struct bt_conn *conn, uint8_t err)
 	}
 	current_conn = bt_conn_ref(conn);
 	bt_le_adv_stop();
-	k_work_schedule(&conn_param_work, K_MSEC(50));
 }
 
 static void disconnected(struct bt_conn *conn, uint8_t reason)
@@ -162,7 +165,6 @@ static void disconnected(struct bt_conn *conn, uint8_t reason)
 		bt_conn_unref(current_conn);
 		current_conn = NULL;
 	}
-	k_work_cancel_delayable(&conn_param_work);
 	l2cap_connected = false;
 	dle_ready = false;
 	bytes_sent = 0;
@@ -172,18 +174,9 @@ static void disconnected(struct bt_conn *conn, uint8_t reason)
 			sd, ARRAY_SIZE(sd));
 }
 
-static void le_data_len_updated(struct bt_conn *conn,
-				struct bt_conn_le_data_len_info *info)
-{
-	if (info->tx_max_len >= 251) {
-		dle_ready = true;
-	}
-}
-
 BT_CONN_CB_DEFINE(conn_callbacks) = {
 	.connected = connected,
 	.disconnected = disconnected,
-	.le_data_len_updated = le_data_len_updated,
 };
 
 /* Stream Thread */
@@ -195,7 +188,7 @@ void stream_thread(void)
 
 	while (1) {
 		if (!l2cap_connected || !dle_ready) {
-			k_sleep(K_MSEC(100));
+			k_sem_take(&stream_ready, K_MSEC(100));
 			continue;
 		}
 		k_sem_take(&tx_sem, K_FOREVER);
@@ -215,6 +208,7 @@ void stream_thread(void)
 			k_sem_give(&tx_sem);
 			k_sleep(K_MSEC(10));
 		} else {
+			link_up_first_payload();
 			bytes_sent += tx_sdu_len;
 		}
 	}
@@ -227,7 +221,7 @@ int main(void)
 	int err;
 
 	k_sem_init(&tx_sem, 0, TX_BUF_COUNT);
-	k_work_init_delayable(&conn_param_work, conn_param_work_handler);
+	link_up_init(&link_cfg);
 
 	printk("nRF54LM20 L2CAP CoC Throughput Test\n");
 
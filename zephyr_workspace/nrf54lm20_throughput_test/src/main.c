@@ -4,9 +4,19 @@
  * Ported from proven nrf54l15_ble_test. Streams continuous GATT
  * notifications via NUS TX characteristic. Uses bt_gatt_notify()
  * which handles MTU fragmentation automatically.
+ *
+ * By default there is no stream thread: notifications are queued up
+ * to CONFIG_TX_QUEUE_DEPTH and each completion queues the next one
+ * (CONFIG_TX_ENGINE_COMPLETION). The original notify + 5 ms sleep loop
+ * is kept as CONFIG_TX_ENGINE_SLEEP_LOOP for A/B power runs. Bytes
+ * sent and wake-ups from idle are readable on the stats characteristic
+ * (NUS UUID base, 0x6e400006), which power_comparison/ble_central.py
+ * polls. Link setup (PHY, DLE, CI) is driven by common/link_up.
  */
 
 #include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/byteorder.h>
 #include <zephyr/sys/printk.h>
 #include <zephyr/bluetooth/bluetooth.h>
 #include <zephyr/bluetooth/hci.h>
@@ -14,6 +24,8 @@
 #include <zephyr/bluetooth/uuid.h>
 #include <zephyr/bluetooth/gatt.h>
 
+#include "link_up.h"
+
 #define DEVICE_NAME     CONFIG_BT_DEVICE_NAME
 #define DEVICE_NAME_LEN (sizeof(DEVICE_NAME) - 1)
 
@@ -28,17 +40,69 @@
 	BT_UUID_128_ENCODE(0x6e400003, 0xb5a3, 0xf393, 0xe0a9, 0xe50e24dcca9e)
 #define BT_UUID_NUS_RX_VAL \
 	BT_UUID_128_ENCODE(0x6e400002, 0xb5a3, 0xf393, 0xe0a9, 0xe50e24dcca9e)
+#define BT_UUID_TX_STATS_VAL \
+	BT_UUID_128_ENCODE(0x6e400006, 0xb5a3, 0xf393, 0xe0a9, 0xe50e24dcca9e)
 
 #define BT_UUID_NUS_SERVICE BT_UUID_DECLARE_128(BT_UUID_NUS_SERVICE_VAL)
 #define BT_UUID_NUS_TX      BT_UUID_DECLARE_128(BT_UUID_NUS_TX_VAL)
 #define BT_UUID_NUS_RX      BT_UUID_DECLARE_128(BT_UUID_NUS_RX_VAL)
+#define BT_UUID_TX_STATS    BT_UUID_DECLARE_128(BT_UUID_TX_STATS_VAL)
+
+#define TX_ENGINE_ID (IS_ENABLED(CONFIG_TX_ENGINE_COMPLETION) ? 1U : 0U)
+
+/* Stats characteristic value, little endian. */
+struct tx_stats_report {
+	uint32_t uptime_ms;
+	uint32_t bytes_sent;
+	uint32_t wakeups;     /* interrupts taken from idle; 0 if not counted */
+	uint32_t send_errors;
+	uint8_t engine;       /* 0 = sleep loop, 1 = completion */
+	uint8_t depth;
+} __packed;
 
 static struct bt_conn *current_conn;
 static uint32_t bytes_sent;
 static bool notify_enabled;
 static volatile bool dle_ready;
 static uint8_t test_data[TEST_DATA_SIZE];
-static struct k_work_delayable conn_param_work;
+static uint32_t send_errors;
+
+#ifdef CONFIG_TX_WAKEUP_STATS
+/* User tracing hooks (CONFIG_TRACING_USER). Every exit from idle is an
+ * interrupt, so count the first ISR entry after the idle thread goes
+ * to sleep.
+ */
+static atomic_t wakeups;
+static bool cpu_idle;
+
+void sys_trace_idle_user(void)
+{
+	cpu_idle = true;
+}
+
+void sys_trace_isr_enter_user(int nested_interrupts)
+{
+	ARG_UNUSED(nested_interrupts);
+
+	if (cpu_idle) {
+		cpu_idle = false;
+		atomic_inc(&wakeups);
+	}
+}
+
+static uint32_t wakeup_count(void)
+{
+	return (uint32_t)atomic_get(&wakeups);
+}
+#else
+static uint32_t wakeup_count(void)
+{
+	return 0;
+}
+#endif /* CONFIG_TX_WAKEUP_STATS */
+
+static void tx_kick(void);
+static void tx_engine_reset(void);
 
 /* Advertising */
 static const struct bt_data ad[] = {
@@ -50,32 +114,54 @@ static const struct bt_data sd[] = {
 	BT_DATA_BYTES(BT_DATA_UUID128_ALL, BT_UUID_NUS_SERVICE_VAL),
 };
 
-/* Connection param work */
-static void conn_param_work_handler(struct k_work *work)
+/* Link bring-up: PHY and DLE go out together on connect, CI once PHY
+ * has finished (link_up never has two instant-based procedures in
+ * flight). The CCC write (OPEN) is the central's and is only timed.
+ */
+static void link_phase_done(enum link_up_phase phase, int err)
 {
-	if (!current_conn) {
-		return;
+	if (phase == LINK_UP_DLE && err == 0) {
+		dle_ready = true;
+		tx_kick();
 	}
+}
 
-	bt_conn_le_phy_update(current_conn, BT_CONN_LE_PHY_PARAM_2M);
-
-	struct bt_conn_le_data_len_param dl_param = {
-		.tx_max_len = 251, .tx_max_time = 2120,
-	};
-	bt_conn_le_data_len_update(current_conn, &dl_param);
-
-	struct bt_le_conn_param param = {
+static const struct link_up_cfg link_cfg = {
+	.steps = LINK_UP_STEP(LINK_UP_DLE) | LINK_UP_STEP(LINK_UP_PHY) |
+		 LINK_UP_STEP(LINK_UP_CI) | LINK_UP_STEP(LINK_UP_OPEN),
+	.tx_octets = 251, .tx_time = 2120,
+	.phy = BT_GAP_LE_PHY_2M,
+	.ci = {
 		.interval_min = 6, .interval_max = 12,
 		.latency = 0, .timeout = 400,
-	};
-	bt_conn_le_param_update(current_conn, &param);
-}
+	},
+	.phase_done = link_phase_done,
+};
 
 /* GATT NUS Service */
 static void tx_ccc_cfg_changed(const struct bt_gatt_attr *attr, uint16_t value)
 {
 	notify_enabled = (value == BT_GATT_CCC_NOTIFY);
 	printk("Notifications %s\n", notify_enabled ? "enabled" : "disabled");
+	if (notify_enabled) {
+		link_up_done(LINK_UP_OPEN, 0);
+	}
+	tx_kick();
+}
+
+static ssize_t on_stats_read(struct bt_conn *conn, const struct bt_gatt_attr *attr,
+			     void *buf, uint16_t len, uint16_t offset)
+{
+	struct tx_stats_report r = {
+		.uptime_ms = sys_cpu_to_le32(k_uptime_get_32()),
+		.bytes_sent = sys_cpu_to_le32(bytes_sent),
+		.wakeups = sys_cpu_to_le32(wakeup_count()),
+		.send_errors = sys_cpu_to_le32(send_errors),
+		.engine = TX_ENGINE_ID,
+		.depth = COND_CODE_1(CONFIG_TX_ENGINE_COMPLETION, (CONFIG_TX_QUEUE_DEPTH), (1)),
+	};
+
+	return bt_gatt_attr_read(conn, attr, buf, len, offset, &r, sizeof(r));
 }
 
 static ssize_t on_rx_write(struct bt_conn *conn, const struct bt_gatt_attr *attr,
@@ -95,6 +181,10 @@ BT_GATT_SERVICE_DEFINE(nus_svc,
 			       BT_GATT_CHRC_WRITE | BT_GATT_CHRC_WRITE_WITHOUT_RESP,
 			       BT_GATT_PERM_WRITE,
 			       NULL, on_rx_write, NULL),
+	BT_GATT_CHARACTERISTIC(BT_UUID_TX_STATS,
+			       BT_GATT_CHRC_READ,
+			       BT_GATT_PERM_READ,
+			       on_stats_read, NULL, NULL),
 );
 
 /* Connection callbacks */
@@ -106,8 +196,8 @@ static void connected(struct bt_conn *conn, uint8_t err)
 	}
 	printk("Connected\n");
 	current_conn = bt_conn_ref(conn);
+	tx_engine_reset();
 	bt_le_adv_stop();
-	k_work_schedule(&conn_param_work, K_MSEC(50));
 }
 
 static void disconnected(struct bt_conn *conn, uint8_t reason)
@@ -117,7 +207,6 @@ static void disconnected(struct bt_conn *conn, uint8_t reason)
 		bt_conn_unref(current_conn);
 		current_conn = NULL;
 	}
-	k_work_cancel_delayable(&conn_param_work);
 	bytes_sent = 0;
 	notify_enabled = false;
 	dle_ready = false;
@@ -131,9 +220,6 @@ static void le_data_len_updated(struct bt_conn *conn,
 	printk("DLE: TX len=%u time=%u, RX len=%u time=%u\n",
 	       info->tx_max_len, info->tx_max_time,
 	       info->rx_max_len, info->rx_max_time);
-	if (info->tx_max_len >= 251) {
-		dle_ready = true;
-	}
 }
 
 static void mtu_updated(struct bt_conn *conn, uint16_t tx, uint16_t rx)
@@ -151,19 +237,109 @@ BT_CONN_CB_DEFINE(conn_callbacks) = {
 	.le_data_len_updated = le_data_len_updated,
 };
 
-/* Stream thread — sends notifications as fast as possible */
-void stream_thread(void)
+#ifdef CONFIG_TX_ENGINE_COMPLETION
+
+/* Completion-driven TX. All refills run on the system workqueue:
+ * connection events kick tx_work, and notification complete callbacks
+ * are delivered on that same workqueue, so they refill inline without
+ * another context switch.
+ */
+static atomic_t tx_in_flight;
+static struct k_work_delayable tx_work;
+
+static void tx_refill(void);
+
+static void tx_done(struct bt_conn *conn, void *user_data)
 {
-	for (int i = 0; i < TEST_DATA_SIZE; i++) {
-		test_data[i] = i & 0xFF;
+	ARG_UNUSED(conn);
+	ARG_UNUSED(user_data);
+
+	/* Late completions from a previous connection may arrive after
+	 * connected() reset the count.
+	 */
+	if (atomic_dec(&tx_in_flight) <= 0) {
+		atomic_set(&tx_in_flight, 0);
 	}
+	link_up_first_payload();
+	bytes_sent += TEST_DATA_SIZE;
+	tx_refill();
+}
+
+static void tx_refill(void)
+{
+	while (current_conn && notify_enabled && dle_ready &&
+	       atomic_get(&tx_in_flight) < CONFIG_TX_QUEUE_DEPTH) {
+		struct bt_gatt_notify_params params = {
+			.attr = &nus_svc.attrs[1],
+			.data = test_data,
+			.len = TEST_DATA_SIZE,
+			.func = tx_done,
+		};
+		int err;
+
+		atomic_inc(&tx_in_flight);
+		err = bt_gatt_notify_cb(current_conn, &params);
+		if (err) {
+			atomic_dec(&tx_in_flight);
+			send_errors++;
+			/* Out of buffers with completions pending: the next
+			 * one restarts us. With none pending, retry later.
+			 */
+			if (atomic_get(&tx_in_flight) == 0) {
+				k_work_schedule(&tx_work, K_MSEC(CONFIG_TX_RETRY_MS));
+			}
+			break;
+		}
+	}
+}
+
+static void tx_work_handler(struct k_work *work)
+{
+	ARG_UNUSED(work);
+	tx_refill();
+}
+
+static void tx_kick(void)
+{
+	k_work_reschedule(&tx_work, K_NO_WAIT);
+}
+
+static void tx_engine_init(void)
+{
+	k_work_init_delayable(&tx_work, tx_work_handler);
+}
+
+static void tx_engine_reset(void)
+{
+	atomic_set(&tx_in_flight, 0);
+}
+
+#else /* CONFIG_TX_ENGINE_SLEEP_LOOP */
 
+static void tx_kick(void)
+{
+}
+
+static void tx_engine_init(void)
+{
+}
+
+static void tx_engine_reset(void)
+{
+}
+
+/* Stream thread — sends notifications as fast as possible */
+void stream_thread(void)
+{
 	while (1) {
 		if (current_conn && notify_enabled && dle_ready) {
 			int err = bt_gatt_notify(current_conn, &nus_svc.attrs[1],
 						 test_data, TEST_DATA_SIZE);
 			if (err == 0) {
+				link_up_first_payload();
 				bytes_sent += TEST_DATA_SIZE;
+			} else {
+				send_errors++;
 			}
 			k_sleep(K_MSEC(5));
 		} else {
@@ -172,32 +348,50 @@ void stream_thread(void)
 	}
 }
 
-/* Stats thread */
+K_THREAD_DEFINE(stream_tid, 2048, stream_thread, NULL, NULL, NULL, 7, 0, 0);
+
+#endif /* CONFIG_TX_ENGINE_COMPLETION */
+
+#ifdef CONFIG_PRINTK
+/* Stats thread. Console builds only: in the power build it would be
+ * the one remaining periodic wake-up.
+ */
 void stats_thread(void)
 {
-	uint32_t prev_bytes = 0;
+	uint32_t prev_bytes = 0, prev_wakeups = 0;
 
 	while (1) {
 		k_sleep(K_MSEC(STATS_INTERVAL_MS));
+		uint32_t w = wakeup_count();
+
 		if (current_conn && notify_enabled) {
 			uint32_t delta = bytes_sent - prev_bytes;
 			prev_bytes = bytes_sent;
 			uint32_t kbps = (delta * 8) / STATS_INTERVAL_MS;
-			printk("TX: %u kbps (%u bytes total)\n", kbps, bytes_sent);
+			printk("TX: %u kbps (%u bytes total) %u wakeups/s, %u send errors\n",
+			       kbps, bytes_sent, (w - prev_wakeups) * 1000U / STATS_INTERVAL_MS,
+			       send_errors);
 		}
+		prev_wakeups = w;
 	}
 }
 
 K_THREAD_DEFINE(stats_tid, 1024, stats_thread, NULL, NULL, NULL, 7, 0, 0);
-K_THREAD_DEFINE(stream_tid, 2048, stream_thread, NULL, NULL, NULL, 7, 0, 0);
+#endif
 
 int main(void)
 {
 	int err;
 
-	printk("nRF54LM20 GATT Throughput Test\n");
+	printk("nRF54LM20 GATT Throughput Test (%s TX engine)\n",
+	       IS_ENABLED(CONFIG_TX_ENGINE_COMPLETION) ? "completion" : "sleep-loop");
+
+	link_up_init(&link_cfg);
+	tx_engine_init();
 
-	k_work_init_delayable(&conn_param_work, conn_param_work_handler);
+	for (int i = 0; i < TEST_DATA_SIZE; i++) {
+		test_data[i] = i & 0xFF;
+	}
 
 	err = bt_enable(NULL);
 	if (err) {
@@ -17,6 +17,7 @@ Usage:
 """
 
 import argparse
+import struct
 import sys
 import time
 
@@ -28,6 +29,11 @@ def run_gatt_central(device_name, duration):
 
     # NUS TX UUID (same for both nRF and Alif throughput tests)
     TX_CHAR_UUID = "6e400003-b5a3-f393-e0a9-e50e24dcca9e"
+    # Device-side stats (nrf54lm20_throughput_test only): uptime_ms,
+    # bytes_sent, wakeups, send_errors (uint32 LE), engine, depth (uint8)
+    STATS_CHAR_UUID = "6e400006-b5a3-f393-e0a9-e50e24dcca9e"
+    STATS_FMT = "<IIIIBB"
+    ENGINES = {0: "sleep-loop", 1: "completion"}
 
     rx_bytes = 0
     start_time = None
@@ -36,6 +42,15 @@ def run_gatt_central(device_name, duration):
         nonlocal rx_bytes
         rx_bytes += len(data)
 
+    async def read_stats(client):
+        try:
+            raw = await client.read_gatt_char(STATS_CHAR_UUID)
+        except Exception:
+            return None
+        if len(raw) < struct.calcsize(STATS_FMT):
+            return None
+        return struct.unpack_from(STATS_FMT, raw)
+
     async def run():
         nonlocal rx_bytes, start_time
 
@@ -51,6 +66,11 @@ def run_gatt_central(device_name, duration):
             print(f"Connected, MTU={client.mtu_size}", flush=True)
             await client.start_notify(TX_CHAR_UUID, notification_handler)
 
+            stats0 = prev_stats = await read_stats(client)
+            if stats0:
+                print(f"Device TX engine: {ENGINES.get(stats0[4], stats0[4])}, "
+                      f"depth {stats0[5]}", flush=True)
+
             start_time = time.time()
             prev_bytes = 0
             elapsed = 0
@@ -63,8 +83,19 @@ def run_gatt_central(device_name, duration):
                 prev_bytes = rx_bytes
                 instant_kbps = (delta * 8) / 1000
                 avg_kbps = (rx_bytes * 8) / 1000 / elapsed if elapsed > 0 else 0
+                dev = ""
+                stats = await read_stats(client) if stats0 else None
+                if stats and stats[0] != prev_stats[0]:
+                    dt_ms = stats[0] - prev_stats[0]
+                    dev_kbps = (stats[1] - prev_stats[1]) * 8 / dt_ms
+                    wake_s = (stats[2] - prev_stats[2]) * 1000 / dt_ms
+                    run_ms = max(stats[0] - stats0[0], 1)
+                    avg_wake_s = (stats[2] - stats0[2]) * 1000 / run_ms
+                    dev = (f" | dev {dev_kbps:5.0f} kbps {wake_s:6.0f} wake/s "
+                           f"({avg_wake_s:.0f} avg) err {stats[3]}")
+                    prev_stats = stats
                 print(f"  [{elapsed:5.0f}s] {instant_kbps:6.0f} kbps (inst) "
-                      f"{avg_kbps:6.0f} kbps (avg) | {rx_bytes:,} bytes", flush=True)
+                      f"{avg_kbps:6.0f} kbps (avg) | {rx_bytes:,} bytes{dev}", flush=True)
 
         if start_time:
             total = time.time() - start_time
@@ -0,0 +1,181 @@
+#!/usr/bin/env python3
+"""
+Energy per frame and per byte at each nRF54L15 clock operating point.
+
+Captures PPK2 current and the device console together while a
+nrf54l15_dual_core_test build with dvfs.conf and CONFIG_DVFS_SWEEP_S
+cycles through pinned 64 MHz, pinned 128 MHz and the load-driven
+policy. Each DVFS_PHASE line opens a window and the matching DVFS_SUM
+line closes it. The window's average current times its duration gives
+the energy, which is divided by the frames and bytes the device counted
+in that window.
+
+Stream from the board (ble_throughput_test.py) and set a FLPR workload
+during the capture; without them the per-frame and per-byte columns
+stay empty.
+
+Usage:
+    ~/.pyenv/versions/3.11.11/envs/zephyr-env/bin/python3 dvfs_energy.py \
+        --console /dev/tty.usbmodem0010577123451 --voltage 3000 --phases 6
+"""
+
+import argparse
+import json
+import re
+import statistics
+import sys
+import threading
+import time
+
+import serial
+
+from ppk2_helper import init_ppk2, cleanup_ppk2, find_ppk2_port
+
+PHASE_RE = re.compile(r"DVFS_PHASE (\d+) mode=(\w+)")
+SUM_RE = re.compile(r"DVFS_SUM (\d+) mode=(\w+) (.*)")
+KV_RE = re.compile(r"(\w+)=(\d+)")
+
+# Samples outside this range are PPK2 glitches (same filter as ppk2_helper)
+VALID_UA = (0, 200000)
+
+
+class PowerLog:
+    """PPK2 samples with host timestamps, collected on a thread."""
+
+    def __init__(self, ppk2):
+        self.ppk2 = ppk2
+        self.chunks = []  # (timestamp, [uA])
+        self.lock = threading.Lock()
+        self.stop = threading.Event()
+        self.thread = threading.Thread(target=self._run, daemon=True)
+
+    def _run(self):
+        self.ppk2.start_measuring()
+        while not self.stop.is_set():
+            read_data = self.ppk2.get_data()
+            if read_data is not None:
+                samples, _ = self.ppk2.get_samples(read_data)
+                with self.lock:
+                    self.chunks.append((time.time(), samples))
+            time.sleep(0.01)
+        self.ppk2.stop_measuring()
+
+    def start(self):
+        self.thread.start()
+
+    def close(self):
+        self.stop.set()
+        self.thread.join(timeout=2)
+
+    def mean_ua(self, t0, t1):
+        with self.lock:
+            vals = [s for ts, chunk in self.chunks if t0 <= ts <= t1
+                    for s in chunk if VALID_UA[0] < s < VALID_UA[1]]
+        return statistics.mean(vals) if vals else None
+
+
+def phase_result(mode, fields, avg_ua, voltage_mV):
+    ms = fields.get("ms", 0)
+    frames = fields.get("frames", 0)
+    nbytes = fields.get("bytes", 0)
+    res = {"mode": mode, **fields, "avg_uA": round(avg_ua, 1) if avg_ua else None}
+    if avg_ua is None or ms == 0:
+        return res
+
+    power_mW = voltage_mV / 1000 * avg_ua / 1000
+    energy_mJ = power_mW * ms / 1000
+    res["power_mW"] = round(power_mW, 3)
+    res["energy_mJ"] = round(energy_mJ, 3)
+    res["uJ_per_frame"] = round(energy_mJ * 1e3 / frames, 2) if frames else None
+    res["nJ_per_byte"] = round(energy_mJ * 1e6 / nbytes, 2) if nbytes else None
+    return res
+
+
+def fmt(v, spec):
+    return format(v, spec) if v is not None else "-".rjust(len(format(0, spec)))
+
+
+def print_table(results):
+    print()
+    print(f"{'phase':>5} {'mode':<9} {'s':>5} {'t64%':>5} {'mW':>8} "
+          f"{'frames':>7} {'miss':>5} {'kbps':>6} {'uJ/frame':>9} {'nJ/byte':>8}")
+    for i, r in enumerate(results):
+        ms = r.get("ms", 0) or 1
+        t64 = 100 * r.get("t64", 0) / ms
+        kbps = r.get("bytes", 0) * 8 / ms
+        print(f"{i:>5} {r['mode']:<9} {ms / 1000:>5.1f} {t64:>5.0f} "
+              f"{fmt(r.get('power_mW'), '8.3f')} {r.get('frames', 0):>7} "
+              f"{r.get('misses', 0):>5} {kbps:>6.0f} "
+              f"{fmt(r.get('uJ_per_frame'), '9.2f')} {fmt(r.get('nJ_per_byte'), '8.2f')}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="DVFS energy per frame / per byte")
+    parser.add_argument("--console", required=True, help="Device console serial port (M33, uart20)")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--ppk2-port", help="PPK2 serial port (auto-detected if omitted)")
+    parser.add_argument("--voltage", type=int, default=3000, help="PPK2 source voltage (mV)")
+    parser.add_argument("--phases", type=int, default=6,
+                        help="DVFS_SUM lines to collect (3 per sweep cycle)")
+    parser.add_argument("--json", help="Write per-phase results to this file")
+    args = parser.parse_args()
+
+    ppk2_port = args.ppk2_port or find_ppk2_port()
+    if not ppk2_port:
+        print("ERROR: No PPK2 found. Connect PPK2 or specify --ppk2-port.", flush=True)
+        return 1
+
+    ppk2 = init_ppk2(ppk2_port, args.voltage)
+    log = PowerLog(ppk2)
+    console = serial.Serial(args.console, args.baud, timeout=1)
+    log.start()
+
+    results = []
+    phase_start = {}
+    try:
+        while len(results) < args.phases:
+            line = console.readline().decode(errors="replace").strip()
+            if not line:
+                continue
+            now = time.time()
+
+            m = PHASE_RE.search(line)
+            if m:
+                phase_start[int(m.group(1))] = now
+                print(f"  phase {m.group(1)}: {m.group(2)}", flush=True)
+                continue
+
+            m = SUM_RE.search(line)
+            if not m:
+                continue
+            idx = int(m.group(1))
+            if idx not in phase_start:
+                # Capture started mid-phase; the window is incomplete
+                continue
+            fields = {k: int(v) for k, v in KV_RE.findall(m.group(3))}
+            avg_ua = log.mean_ua(phase_start[idx], now)
+            results.append(phase_result(m.group(2), fields, avg_ua, args.voltage))
+            print(f"  phase {idx} done: {m.group(3)}", flush=True)
+    except KeyboardInterrupt:
+        print("Interrupted", flush=True)
+    finally:
+        log.close()
+        console.close()
+        cleanup_ppk2(ppk2)
+
+    if not results:
+        print("No complete phases captured", flush=True)
+        return 1
+
+    print_table(results)
+
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump({"voltage_mV": args.voltage, "phases": results}, f, indent=2)
+        print(f"\nWrote {args.json}", flush=True)
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,383 @@
+#!/usr/bin/env python3
+"""
+Firmware footprint tracker for every app in zephyr_workspace.
+
+Every top-level directory whose CMakeLists.txt is a Zephyr app is
+picked up; the board comes from the directory's prefix (see BOARDS),
+with APPS for the exceptions. Builds each app for its board with west
+(optional), parses the linker
+map of every image in the build directory and attributes flash and RAM
+to modules: BT host, BT controller, app, kernel, libc, drivers,
+net_buf pools and thread stacks. Results are compared per module and
+per symbol against a stored baseline so a new buffer, pool or Kconfig
+feature shows up as a size delta the moment it lands.
+
+Usage:
+    # Build everything and compare against the baseline
+    python3 footprint.py --build
+
+    # Re-use existing build directories, only the L2CAP apps
+    python3 footprint.py nrf54l15_l2cap_test nrf54l15_l2cap_test_fast
+
+    # Accept current sizes as the new baseline
+    python3 footprint.py --update
+"""
+
+import argparse
+import glob
+import json
+import os
+import re
+import subprocess
+import sys
+
+from platforms import BASE_DIR, ALIF_SDK_DIR
+
+ZEPHYR_PROJECT = os.path.join(BASE_DIR, "zephyrproject")
+DEFAULT_BASELINE = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                                "data", "footprint_baseline.json")
+
+NRF54L15 = "nrf54l15dk/nrf54l15/cpuapp"
+NRF54LM20 = "nrf54lm20dk/nrf54lm20a/cpuapp"
+ALIF_B1 = "alif_b1_dk/ab1c1f4m51820hh0/rtss_he"
+PSE84_M55 = "kit_pse84_eval/pse846gps2dbzc4a/m55"
+
+ALIF_ENV = {"GNUARMEMB_TOOLCHAIN_PATH": "/opt/homebrew", "ZEPHYR_TOOLCHAIN_VARIANT": "gnuarmemb"}
+
+QEMU_M33 = "mps2/an521/cpu0"
+
+# app directory prefix -> build settings
+BOARDS = [
+    ("nrf54l15_",  {"board": NRF54L15}),
+    ("nrf54lm20_", {"board": NRF54LM20}),
+    ("alif_b1_",   {"board": ALIF_B1, "workspace": ALIF_SDK_DIR, "env": ALIF_ENV}),
+    ("pse84_",     {"board": PSE84_M55}),
+]
+
+# Apps the prefix does not cover. audio_dsp_test shares the QEMU build
+# that run_qemu_test.sh makes.
+APPS = {
+    "audio_dsp_test": {"board": QEMU_M33, "build_dir": "build_qemu"},
+}
+
+ZEPHYR_APP_RE = re.compile(r"^\s*find_package\(Zephyr\b", re.MULTILINE)
+
+MODULES = ["bt_host", "bt_controller", "app", "kernel", "libc", "drivers",
+           "arch", "net_buf_pools", "stacks", "other"]
+
+# Archive name patterns, checked in order. Symbol-based rules for
+# net_buf pools and stacks take precedence (see classify()).
+ARCHIVE_RULES = [
+    (re.compile(r"bluetooth__host|bt_host"), "bt_host"),
+    (re.compile(r"bluetooth__controller|softdevice_controller|libmpsl|mpsl|ble_ll|alif_ble"), "bt_controller"),
+    (re.compile(r"bluetooth"), "bt_host"),
+    (re.compile(r"(^|/)app/|libapp\.a"), "app"),
+    (re.compile(r"libkernel\.a"), "kernel"),
+    (re.compile(r"libc\.a|libc_nano|picolibc|newlib|libgcc|libm\.a|minimal"), "libc"),
+    (re.compile(r"drivers__|libdrivers|hal_|nrfx|modules__hal|mdk"), "drivers"),
+    (re.compile(r"arch__|libarch|libisr_tables|cortex_m|riscv"), "arch"),
+]
+
+NET_BUF_RE = re.compile(r"^(_net_buf_|net_buf_data_|net_buf_fixed_|_net_buf_pool_)|\._net_buf_pool\.")
+STACK_RE = re.compile(r"stack", re.IGNORECASE)
+
+OUT_SECT_RE = re.compile(r"^([._A-Za-z][^\s]*)\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)(?:\s+load address 0x([0-9a-f]+))?")
+IN_SECT_RE = re.compile(r"^ ([^\s*][^\s]*)\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(\S.*)$")
+IN_SECT_WRAP_RE = re.compile(r"^ ([^\s*][^\s]*)$")
+WRAP_TAIL_RE = re.compile(r"^\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(\S.*)$")
+SYMBOL_RE = re.compile(r"^\s+0x([0-9a-f]+)\s+([A-Za-z_][\w.$]*)\s*$")
+REGION_RE = re.compile(r"^(\S+)\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s*(\S*)$")
+
+
+def parse_regions(lines):
+    """Return [(name, origin, length, writable)] from 'Memory Configuration'."""
+    regions = []
+    active = False
+    for line in lines:
+        if line.startswith("Memory Configuration"):
+            active = True
+            continue
+        if line.startswith("Linker script and memory map"):
+            break
+        if not active:
+            continue
+        m = REGION_RE.match(line.strip())
+        if m and m.group(1) not in ("Name", "*default*"):
+            regions.append((m.group(1), int(m.group(2), 16), int(m.group(3), 16), "w" in m.group(4)))
+    return regions
+
+
+def region_is_ram(regions, addr):
+    for _, origin, length, writable in regions:
+        if origin <= addr < origin + length:
+            return writable
+    return False
+
+
+def section_symbol(name):
+    """Best-effort symbol name from a -ffunction/-fdata-sections input section."""
+    for prefix in (".text.", ".rodata.", ".data.", ".bss.", ".noinit.", ".ramfunc."):
+        if name.startswith(prefix):
+            return name[len(prefix):]
+    return name
+
+
+def classify(symbol, section, archive, is_ram):
+    if NET_BUF_RE.search(symbol) or NET_BUF_RE.search(section):
+        return "net_buf_pools"
+    if is_ram and (STACK_RE.search(symbol) or STACK_RE.search(section)):
+        return "stacks"
+    for pattern, module in ARCHIVE_RULES:
+        if pattern.search(archive):
+            return module
+    return "other"
+
+
+def parse_map(path):
+    """Parse a GNU ld map file into {symbol: {module, flash, ram}}."""
+    with open(path, errors="replace") as f:
+        lines = f.read().splitlines()
+
+    regions = parse_regions(lines)
+    symbols = {}
+
+    try:
+        start = lines.index("Linker script and memory map")
+    except ValueError:
+        start = 0
+
+    out_has_lma = False
+    pending = None       # wrapped input section name
+    current = None       # [name, addr, size, archive, [(addr, sym)]]
+
+    def flush():
+        if not current or current[2] == 0:
+            return
+        name, addr, size, archive, syms = current
+        is_ram = region_is_ram(regions, addr)
+        in_flash = not is_ram or out_has_lma
+        syms = sorted(s for s in syms if addr <= s[0] < addr + size)
+        if not syms or syms[0][0] > addr:
+            syms.insert(0, (addr, section_symbol(name)))
+        bounds = [s[0] for s in syms[1:]] + [addr + size]
+        for (sym_addr, sym), end in zip(syms, bounds):
+            sym_size = end - sym_addr
+            if sym_size <= 0:
+                continue
+            entry = symbols.setdefault(sym, {"module": classify(sym, name, archive, is_ram),
+                                             "flash": 0, "ram": 0})
+            if in_flash:
+                entry["flash"] += sym_size
+            if is_ram:
+                entry["ram"] += sym_size
+
+    for line in lines[start:]:
+        if pending is not None:
+            m = WRAP_TAIL_RE.match(line)
+            if m:
+                flush()
+                current = [pending, int(m.group(1), 16), int(m.group(2), 16), m.group(3).strip(), []]
+            pending = None
+            continue
+
+        m = OUT_SECT_RE.match(line)
+        if m:
+            flush()
+            current = None
+            out_has_lma = m.group(4) is not None and m.group(4) != m.group(2)
+            continue
+
+        m = IN_SECT_RE.match(line)
+        if m:
+            flush()
+            current = [m.group(1), int(m.group(2), 16), int(m.group(3), 16), m.group(4).strip(), []]
+            continue
+
+        m = IN_SECT_WRAP_RE.match(line)
+        if m:
+            pending = m.group(1)
+            continue
+
+        m = SYMBOL_RE.match(line)
+        if m and current is not None:
+            current[4].append((int(m.group(1), 16), m.group(2)))
+
+    flush()
+    return symbols
+
+
+def summarize(symbols):
+    modules = {mod: {"flash": 0, "ram": 0} for mod in MODULES}
+    for entry in symbols.values():
+        modules[entry["module"]]["flash"] += entry["flash"]
+        modules[entry["module"]]["ram"] += entry["ram"]
+    total = {"flash": sum(m["flash"] for m in modules.values()),
+             "ram": sum(m["ram"] for m in modules.values())}
+    return {"modules": modules, "total": total}
+
+
+def discover_apps():
+    """Return {app: build settings} for every Zephyr app in BASE_DIR.
+
+    An app with no board rule is still listed, with board None, so that
+    its existing build is reported and --build names it rather than
+    skipping it quietly.
+    """
+    apps = {}
+    for app in sorted(os.listdir(BASE_DIR)):
+        src = os.path.join(BASE_DIR, app)
+        cmake = os.path.join(src, "CMakeLists.txt")
+        if not os.path.isfile(cmake):
+            continue
+        with open(cmake, errors="replace") as f:
+            if not ZEPHYR_APP_RE.search(f.read()):
+                continue
+        cfg = APPS.get(app)
+        if cfg is None:
+            cfg = next((dict(c) for prefix, c in BOARDS if app.startswith(prefix)),
+                       {"board": None})
+        cfg = dict(cfg)
+        if any(os.path.exists(os.path.join(src, s))
+               for s in ("sysbuild.cmake", "sysbuild.conf", "sysbuild")):
+            cfg.setdefault("sysbuild", True)
+        apps[app] = cfg
+    return apps
+
+
+def build_app(app, cfg):
+    """Run west build for one app. Returns True on success."""
+    src = os.path.join(BASE_DIR, app)
+    build_dir = os.path.join(src, cfg.get("build_dir", "build"))
+    if cfg["board"] is None:
+        print(f"  NO BOARD: {app} (add it to APPS in footprint.py)", flush=True)
+        return False
+    cmd = ["west", "build", "-b", cfg["board"], src, "-d", build_dir, "-p"]
+    if cfg.get("sysbuild"):
+        cmd.append("--sysbuild")
+    env = dict(os.environ, **cfg.get("env", {}))
+    print(f"  Building {app} ({cfg['board']})...", flush=True)
+    result = subprocess.run(cmd, cwd=cfg.get("workspace", ZEPHYR_PROJECT), env=env,
+                            stdout=subprocess.DEVNULL, stderr=subprocess.PIPE, text=True)
+    if result.returncode != 0:
+        print(f"  BUILD FAILED: {app}", flush=True)
+        print("\n".join(result.stderr.splitlines()[-10:]), flush=True)
+        return False
+    return True
+
+
+def find_images(app, cfg):
+    """Return {image_name: map_path} for every image in the app's build dir."""
+    build_dir = os.path.join(BASE_DIR, app, cfg.get("build_dir", "build"))
+    images = {}
+    direct = os.path.join(build_dir, "zephyr", "zephyr.map")
+    if os.path.exists(direct):
+        images[app] = direct
+    for path in sorted(glob.glob(os.path.join(build_dir, "*", "zephyr", "zephyr.map"))):
+        image = os.path.basename(os.path.dirname(os.path.dirname(path)))
+        images[app if image == app else f"{app}/{image}"] = path
+    return images
+
+
+def fmt_kb(n):
+    return f"{n / 1024:.1f}"
+
+
+def fmt_delta(n):
+    return f"{n:+d}" if n else "0"
+
+
+def print_image(name, data, base):
+    print(f"\n{name}", flush=True)
+    print(f"  {'Module':<16} {'Flash KB':>9} {'RAM KB':>9} {'dFlash B':>10} {'dRAM B':>10}")
+    print(f"  {'-' * 16} {'-' * 9} {'-' * 9} {'-' * 10} {'-' * 10}")
+    base_mods = base["modules"] if base else {}
+    rows = [(mod, data["modules"][mod]) for mod in MODULES] + [("TOTAL", data["total"])]
+    for mod, sizes in rows:
+        if mod != "TOTAL" and not sizes["flash"] and not sizes["ram"]:
+            continue
+        ref = base["total"] if (base and mod == "TOTAL") else base_mods.get(mod, {"flash": 0, "ram": 0})
+        d_flash = sizes["flash"] - ref["flash"] if base else 0
+        d_ram = sizes["ram"] - ref["ram"] if base else 0
+        print(f"  {mod:<16} {fmt_kb(sizes['flash']):>9} {fmt_kb(sizes['ram']):>9} "
+              f"{fmt_delta(d_flash):>10} {fmt_delta(d_ram):>10}")
+
+
+def print_symbol_diff(symbols, base_symbols, limit):
+    deltas = []
+    for sym in set(symbols) | set(base_symbols):
+        now = symbols.get(sym, {"flash": 0, "ram": 0, "module": "-"})
+        ref = base_symbols.get(sym, {"flash": 0, "ram": 0, "module": now["module"]})
+        d_flash = now["flash"] - ref["flash"]
+        d_ram = now["ram"] - ref["ram"]
+        if d_flash or d_ram:
+            deltas.append((abs(d_flash) + abs(d_ram), sym, now.get("module", ref["module"]), d_flash, d_ram))
+    if not deltas:
+        return
+    deltas.sort(reverse=True)
+    print(f"  Symbol changes ({len(deltas)}, top {min(limit, len(deltas))}):")
+    for _, sym, module, d_flash, d_ram in deltas[:limit]:
+        print(f"    {fmt_delta(d_flash):>8} {fmt_delta(d_ram):>8}  {module:<14} {sym}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Firmware footprint tracker")
+    parser.add_argument("apps", nargs="*", help="Apps to report (default: every app found)")
+    parser.add_argument("--build", action="store_true", help="Build each app before parsing")
+    parser.add_argument("--baseline", default=DEFAULT_BASELINE, help="Baseline JSON path")
+    parser.add_argument("--update", action="store_true", help="Write current sizes as the baseline")
+    parser.add_argument("--top", type=int, default=15, help="Symbol deltas to show per image")
+    parser.add_argument("--json", help="Also write the full report to this path")
+    args = parser.parse_args()
+
+    known = discover_apps()
+    apps = args.apps or list(known)
+    unknown = [a for a in apps if a not in known]
+    if unknown:
+        print(f"ERROR: unknown app(s): {', '.join(unknown)}", flush=True)
+        return 1
+
+    baseline = {}
+    if os.path.exists(args.baseline):
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+
+    report = {}
+    missing = 0
+    for app in apps:
+        if args.build and not build_app(app, known[app]):
+            missing += 1
+            continue
+        images = find_images(app, known[app])
+        if not images:
+            print(f"\n{app}\n  no build found (run with --build)", flush=True)
+            missing += 1
+            continue
+        for image, map_path in images.items():
+            symbols = parse_map(map_path)
+            data = summarize(symbols)
+            data["board"] = known[app]["board"]
+            data["symbols"] = symbols
+            report[image] = data
+
+            base = baseline.get(image)
+            print_image(image, data, base)
+            if base:
+                print_symbol_diff(symbols, base.get("symbols", {}), args.top)
+
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(report, f, indent=2, sort_keys=True)
+
+    if args.update:
+        baseline.update(report)
+        os.makedirs(os.path.dirname(args.baseline), exist_ok=True)
+        with open(args.baseline, "w") as f:
+            json.dump(baseline, f, indent=1, sort_keys=True)
+            f.write("\n")
+        print(f"\nBaseline updated: {args.baseline} ({len(report)} images)", flush=True)
+
+    return 1 if missing and args.build else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
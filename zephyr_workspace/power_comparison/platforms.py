@@ -21,6 +21,8 @@ PLATFORMS = {
             "idle": os.path.join(BASE_DIR, "nrf54lm20_idle_test", "build", "zephyr", "zephyr.hex"),
             "advertising": os.path.join(BASE_DIR, "nrf54lm20_adv_test", "build", "zephyr", "zephyr.hex"),
             "throughput": os.path.join(BASE_DIR, "nrf54lm20_throughput_test", "build", "zephyr", "zephyr.hex"),
+            # Same app built with -DCONFIG_TX_ENGINE_SLEEP_LOOP=y (original 5 ms loop)
+            "throughput_loop": os.path.join(BASE_DIR, "nrf54lm20_throughput_test", "build_loop", "zephyr", "zephyr.hex"),
             "l2cap": os.path.join(BASE_DIR, "nrf54lm20_l2cap_test", "build", "zephyr", "zephyr.hex"),
         },
     },
@@ -60,6 +62,13 @@ TEST_MODES = {
         "description": "Active BLE GATT notification streaming (244B payloads)",
         "requires_central": True,
     },
+    "throughput_loop": {
+        "name": "BLE Throughput (GATT, sleep-loop TX baseline)",
+        "duration_s": 120,
+        "settle_s": 15,
+        "description": "GATT notification streaming with the original notify + 5 ms sleep loop",
+        "requires_central": True,
+    },
     "l2cap": {
         "name": "BLE Throughput (L2CAP CoC)",
         "duration_s": 120,
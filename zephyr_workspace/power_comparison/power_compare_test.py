@@ -18,6 +18,7 @@ Usage:
 import argparse
 import json
 import os
+import re
 import signal
 import subprocess
 import sys
@@ -129,8 +130,29 @@ def wait_for_central_connection(proc, timeout=30):
     return False
 
 
+CENTRAL_AVG_RE = re.compile(r"(\d+)\s+kbps \(avg\)")
+CENTRAL_DEV_RE = re.compile(r"dev\s+(\d+) kbps\s+\d+ wake/s \((\d+) avg\)")
+
+
+def parse_central_summary(lines):
+    """Last received average kbps and, if the firmware reports them,
+    device kbps and average wake-ups/s from ble_central.py output."""
+    summary = {}
+    for line in lines:
+        m = CENTRAL_AVG_RE.search(line)
+        if m:
+            summary["rx_avg_kbps"] = int(m.group(1))
+        m = CENTRAL_DEV_RE.search(line)
+        if m:
+            summary["dev_kbps"] = int(m.group(1))
+            summary["dev_wakeups_per_s"] = int(m.group(2))
+    return summary
+
+
 def stop_central(proc):
-    """Stop the BLE central subprocess."""
+    """Stop the BLE central subprocess. Returns parse_central_summary()
+    of its remaining output."""
+    lines = []
     if proc and proc.poll() is None:
         proc.send_signal(signal.SIGINT)
         try:
@@ -142,8 +164,10 @@ def stop_central(proc):
     if proc and proc.stdout:
         remaining = proc.stdout.read()
         if remaining and remaining.strip():
-            for line in remaining.strip().split("\n")[-3:]:
+            lines = remaining.strip().split("\n")
+            for line in lines[-3:]:
                 print(f"  [central] {line}", flush=True)
+    return parse_central_summary(lines)
 
 
 def main():
@@ -198,6 +222,7 @@ def main():
             print(f"\n  Run {run}/{args.runs}", flush=True)
 
             central_proc = None
+            central_summary = {}
 
             # Flash if mode changed
             if not args.no_flash and last_flashed_mode != mode_name:
@@ -224,7 +249,7 @@ def main():
 
             # Stop central if running
             if central_proc:
-                stop_central(central_proc)
+                central_summary = stop_central(central_proc)
 
             if not power_data:
                 print(f"  WARNING: No power data collected", flush=True)
@@ -254,12 +279,17 @@ def main():
                 },
                 "power_per_second": power_data,
             }
+            if central_summary:
+                measurement["central"] = central_summary
 
             results["measurements"].append(measurement)
             save_results(results, output_path)
 
             print(f"  Result: {avg_mA:.3f} mA avg, {peak_uA/1000:.3f} mA peak, "
                   f"{avg_mW:.3f} mW", flush=True)
+            if "dev_wakeups_per_s" in central_summary:
+                print(f"          {central_summary.get('rx_avg_kbps', 0)} kbps rx, "
+                      f"{central_summary['dev_wakeups_per_s']} wake-ups/s", flush=True)
 
     cleanup_ppk2(ppk2)
 
@@ -8,6 +8,11 @@ SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
 WORKSPACE="$SCRIPT_DIR/.."
 NRF_ZEPHYR="$WORKSPACE/zephyrproject"
 ALIF_SDK="$SCRIPT_DIR/../../sdk-alif"
+PYTHON="${PYTHON:-$HOME/.pyenv/versions/3.11.11/envs/zephyr-env/bin/python3}"
+
+# -icount makes the guest clock advance per instruction instead of with
+# host wall-clock, so the sim_test micro-benchmarks are reproducible.
+QEMU_ICOUNT="-icount shift=0,align=off,sleep=off"
 
 GREEN='\033[0;32m'
 RED='\033[0;31m'
@@ -103,15 +108,29 @@ cd "$NRF_ZEPHYR"
 # Cortex-M33 (matches nRF54LM20 architecture)
 printf "  %-35s" "QEMU Cortex-M33 (mps2-an521)"
 if west build -b mps2/an521/cpu0 "../power_comparison/sim_test" -d "../power_comparison/sim_test/build_m33" -p 2>/dev/null | tail -1 | grep -q "Generating files"; then
-    QEMU_OUT=$(timeout 25 qemu-system-arm -cpu cortex-m33 -machine mps2-an521 -nographic -vga none -net none -serial mon:stdio \
-        -kernel "$WORKSPACE/power_comparison/sim_test/build_m33/zephyr/zephyr.elf" 2>&1 || true)
-    if echo "$QEMU_OUT" | grep -q "ALL TESTS PASSED"; then
+    QEMU_LOG="$WORKSPACE/power_comparison/sim_test/build_m33/qemu.log"
+    timeout 60 qemu-system-arm -cpu cortex-m33 -machine mps2-an521 -nographic -vga none -net none -serial mon:stdio \
+        $QEMU_ICOUNT -kernel "$WORKSPACE/power_comparison/sim_test/build_m33/zephyr/zephyr.elf" > "$QEMU_LOG" 2>&1 || true
+    if grep -q "ALL TESTS PASSED" "$QEMU_LOG"; then
         printf "${GREEN}ALL TESTS PASSED${NC}\n"
         ((passed++))
     else
         printf "${RED}TESTS FAILED${NC}\n"
         ((failed++))
     fi
+    printf "  %-35s" "Benchmarks Cortex-M33"
+    bench_status=0
+    "$PYTHON" "$SCRIPT_DIR/sim_test/bench_compare.py" --target m33 "$QEMU_LOG" > "$QEMU_LOG.bench" 2>&1 || bench_status=$?
+    if [ $bench_status -eq 0 ]; then
+        printf "${GREEN}NO REGRESSION${NC}\n"
+        ((passed++))
+    elif [ $bench_status -eq 2 ]; then
+        printf "${YELLOW}SKIP${NC} (no sim_test/baselines/m33.json)\n"
+    else
+        printf "${RED}REGRESSED${NC} (see $QEMU_LOG.bench)\n"
+        ((failed++))
+    fi
+    grep "^COREBENCH " "$QEMU_LOG" | sed 's/^/    /' || true
 else
     printf "${RED}BUILD FAILED${NC}\n"
     ((failed++))
@@ -120,15 +139,86 @@ fi
 # Cortex-M55 (matches Alif B1 architecture)
 printf "  %-35s" "QEMU Cortex-M55 (mps3-an547)"
 if west build -b mps3/corstone300/an547 "../power_comparison/sim_test" -d "../power_comparison/sim_test/build_m55" -p 2>/dev/null | tail -1 | grep -q "Generating files"; then
-    QEMU_OUT=$(timeout 25 qemu-system-arm -cpu cortex-m55 -machine mps3-an547 -nographic -vga none -net none -serial mon:stdio \
-        -kernel "$WORKSPACE/power_comparison/sim_test/build_m55/zephyr/zephyr.elf" 2>&1 || true)
-    if echo "$QEMU_OUT" | grep -q "ALL TESTS PASSED"; then
+    QEMU_LOG="$WORKSPACE/power_comparison/sim_test/build_m55/qemu.log"
+    timeout 60 qemu-system-arm -cpu cortex-m55 -machine mps3-an547 -nographic -vga none -net none -serial mon:stdio \
+        $QEMU_ICOUNT -kernel "$WORKSPACE/power_comparison/sim_test/build_m55/zephyr/zephyr.elf" > "$QEMU_LOG" 2>&1 || true
+    if grep -q "ALL TESTS PASSED" "$QEMU_LOG"; then
+        printf "${GREEN}ALL TESTS PASSED${NC}\n"
+        ((passed++))
+    else
+        printf "${RED}TESTS FAILED${NC}\n"
+        ((failed++))
+    fi
+    printf "  %-35s" "Benchmarks Cortex-M55"
+    bench_status=0
+    "$PYTHON" "$SCRIPT_DIR/sim_test/bench_compare.py" --target m55 "$QEMU_LOG" > "$QEMU_LOG.bench" 2>&1 || bench_status=$?
+    if [ $bench_status -eq 0 ]; then
+        printf "${GREEN}NO REGRESSION${NC}\n"
+        ((passed++))
+    elif [ $bench_status -eq 2 ]; then
+        printf "${YELLOW}SKIP${NC} (no sim_test/baselines/m55.json)\n"
+    else
+        printf "${RED}REGRESSED${NC} (see $QEMU_LOG.bench)\n"
+        ((failed++))
+    fi
+    grep "^COREBENCH " "$QEMU_LOG" | sed 's/^/    /' || true
+else
+    printf "${RED}BUILD FAILED${NC}\n"
+    ((failed++))
+fi
+
+# Helium pixel kernels (common/pixel): ref-vs-MVE bit-exactness + cycles/px
+printf "  %-35s" "QEMU pixel kernels (mps3-an547)"
+if west build -b mps3/corstone300/an547 "../pse84_pixel_test" -d "../pse84_pixel_test/build_qemu" -p 2>/dev/null | tail -1 | grep -q "Generating files"; then
+    QEMU_LOG="$WORKSPACE/pse84_pixel_test/build_qemu/qemu.log"
+    timeout 60 qemu-system-arm -cpu cortex-m55 -machine mps3-an547 -nographic -vga none -net none -serial mon:stdio \
+        $QEMU_ICOUNT -kernel "$WORKSPACE/pse84_pixel_test/build_qemu/zephyr/zephyr.elf" > "$QEMU_LOG" 2>&1 || true
+    if grep -q "ALL TESTS PASSED" "$QEMU_LOG"; then
+        printf "${GREEN}ALL TESTS PASSED${NC}\n"
+        ((passed++))
+    else
+        printf "${RED}TESTS FAILED${NC}\n"
+        ((failed++))
+    fi
+    grep "^PIXBENCH " "$QEMU_LOG" | sed 's/^/    /' || true
+else
+    printf "${RED}BUILD FAILED${NC}\n"
+    ((failed++))
+fi
+
+# Audio DSP golden tests (common/stft_ns): native_sim runs the checks on
+# the host, QEMU adds instruction counts per hop
+printf "  %-35s" "native_sim audio DSP (golden)"
+if [ "$(uname -s)" != "Linux" ]; then
+    printf "${YELLOW}SKIP${NC} (native_sim needs a Linux host)\n"
+elif west build -b native_sim "../audio_dsp_test" -d "../audio_dsp_test/build_native" -p 2>/dev/null | tail -1 | grep -q "Generating files"; then
+    SIM_LOG="$WORKSPACE/audio_dsp_test/build_native/native.log"
+    timeout 60 "$WORKSPACE/audio_dsp_test/build_native/zephyr/zephyr.exe" -stop_at=10 > "$SIM_LOG" 2>&1 || true
+    if grep -q "ALL TESTS PASSED" "$SIM_LOG"; then
+        printf "${GREEN}ALL TESTS PASSED${NC}\n"
+        ((passed++))
+    else
+        printf "${RED}TESTS FAILED${NC} (see $SIM_LOG)\n"
+        ((failed++))
+    fi
+else
+    printf "${RED}BUILD FAILED${NC}\n"
+    ((failed++))
+fi
+
+printf "  %-35s" "QEMU audio DSP (mps2-an521)"
+if west build -b mps2/an521/cpu0 "../audio_dsp_test" -d "../audio_dsp_test/build_qemu" -p 2>/dev/null | tail -1 | grep -q "Generating files"; then
+    QEMU_LOG="$WORKSPACE/audio_dsp_test/build_qemu/qemu.log"
+    timeout 60 qemu-system-arm -cpu cortex-m33 -machine mps2-an521 -nographic -vga none -net none -serial mon:stdio \
+        $QEMU_ICOUNT -kernel "$WORKSPACE/audio_dsp_test/build_qemu/zephyr/zephyr.elf" > "$QEMU_LOG" 2>&1 || true
+    if grep -q "ALL TESTS PASSED" "$QEMU_LOG"; then
         printf "${GREEN}ALL TESTS PASSED${NC}\n"
         ((passed++))
     else
         printf "${RED}TESTS FAILED${NC}\n"
         ((failed++))
     fi
+    grep "^NSBENCH " "$QEMU_LOG" | sed 's/^/    /' || true
 else
     printf "${RED}BUILD FAILED${NC}\n"
     ((failed++))
@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+"""
+Compare sim_test micro-benchmark output against a stored baseline.
+
+Parses the "BENCH <name> <iters> <min> <median> <max>" rows printed by
+sim_test/src/bench.c and checks each median against
+baselines/<target>.json. A benchmark regresses when its median exceeds
+the baseline by more than --tolerance percent AND by more than
+--slack cycles (the slack absorbs timer-resolution noise on the very
+short paths).
+
+Usage:
+    # Compare a QEMU log against the stored M33 baseline
+    python3 bench_compare.py --target m33 build_m33/qemu.log
+
+    # Record a new baseline from a known-good run
+    python3 bench_compare.py --target m33 build_m33/qemu.log --update
+
+Exit status: 0 when every median is within limits, 1 on a regression
+or an unreadable log, 2 when there is no baseline to compare against
+(run_qemu_test.sh reports that as SKIP, not as a pass).
+"""
+
+import argparse
+import json
+import os
+import re
+import sys
+
+EXIT_NO_BASELINE = 2
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+BASELINE_DIR = os.path.join(SCRIPT_DIR, "baselines")
+
+BEGIN_RE = re.compile(r"BENCH_BEGIN board=(\S+) cycles_per_sec=(\d+)")
+ROW_RE = re.compile(r"^BENCH\s+(\S+)\s+(\d+)\s+(\d+)\s+(\d+)\s+(\d+)\s*$")
+
+
+def parse_log(lines):
+    """Return (meta, {name: {iters, min, median, max}}) from log lines."""
+    meta = {}
+    results = {}
+    for line in lines:
+        line = line.strip()
+        m = BEGIN_RE.search(line)
+        if m:
+            meta = {"board": m.group(1), "cycles_per_sec": int(m.group(2))}
+            continue
+        m = ROW_RE.match(line)
+        if m:
+            results[m.group(1)] = {
+                "iters": int(m.group(2)),
+                "min": int(m.group(3)),
+                "median": int(m.group(4)),
+                "max": int(m.group(5)),
+            }
+    return meta, results
+
+
+def compare(results, baseline, tolerance_pct, slack):
+    """Print a comparison table; return the number of regressions."""
+    regressions = 0
+    base = baseline.get("results", {})
+
+    print(f"  {'Benchmark':<24} {'Base':>8} {'Now':>8} {'Delta':>8}  Status")
+    print(f"  {'-' * 24} {'-' * 8} {'-' * 8} {'-' * 8}  {'-' * 6}")
+
+    for name in sorted(set(base) | set(results)):
+        if name not in results:
+            print(f"  {name:<24} {base[name]['median']:>8} {'-':>8} {'-':>8}  MISSING")
+            regressions += 1
+            continue
+        now = results[name]["median"]
+        if name not in base:
+            print(f"  {name:<24} {'-':>8} {now:>8} {'-':>8}  NEW")
+            continue
+
+        ref = base[name]["median"]
+        delta = now - ref
+        pct = (delta * 100.0 / ref) if ref else 0.0
+        limit = max(ref * tolerance_pct / 100.0, slack)
+        if delta > limit:
+            status = "REGRESSED"
+            regressions += 1
+        elif -delta > limit:
+            status = "faster"
+        else:
+            status = "ok"
+        print(f"  {name:<24} {ref:>8} {now:>8} {pct:>+7.1f}%  {status}")
+
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare sim_test benchmarks against a baseline")
+    parser.add_argument("log", nargs="?", help="QEMU console log (default: stdin)")
+    parser.add_argument("--target", required=True, help="Baseline name, e.g. m33 or m55")
+    parser.add_argument("--tolerance", type=float, default=20.0,
+                        help="Allowed median increase in percent (default: 20)")
+    parser.add_argument("--slack", type=int, default=2,
+                        help="Allowed median increase in cycles regardless of percent (default: 2)")
+    parser.add_argument("--update", action="store_true", help="Write results as the new baseline")
+    args = parser.parse_args()
+
+    if args.log:
+        with open(args.log, errors="replace") as f:
+            lines = f.readlines()
+    else:
+        lines = sys.stdin.readlines()
+
+    meta, results = parse_log(lines)
+    if not results:
+        print("ERROR: no BENCH rows found in log", flush=True)
+        return 1
+
+    baseline_path = os.path.join(BASELINE_DIR, f"{args.target}.json")
+
+    if args.update:
+        os.makedirs(BASELINE_DIR, exist_ok=True)
+        with open(baseline_path, "w") as f:
+            json.dump({"meta": meta, "results": results}, f, indent=2, sort_keys=True)
+            f.write("\n")
+        print(f"Baseline written: {baseline_path} ({len(results)} benchmarks)", flush=True)
+        return 0
+
+    if not os.path.exists(baseline_path):
+        print(f"No baseline at {baseline_path}; run with --update to record one", flush=True)
+        return EXIT_NO_BASELINE
+
+    with open(baseline_path) as f:
+        baseline = json.load(f)
+
+    base_hz = baseline.get("meta", {}).get("cycles_per_sec")
+    if base_hz and meta.get("cycles_per_sec") and base_hz != meta["cycles_per_sec"]:
+        print(f"WARNING: cycle rate changed ({base_hz} -> {meta['cycles_per_sec']} Hz), "
+              "deltas are not comparable", flush=True)
+
+    print(f"Benchmarks vs {os.path.relpath(baseline_path, SCRIPT_DIR)} "
+          f"(tolerance {args.tolerance:.0f}% / {args.slack} cycles):", flush=True)
+    regressions = compare(results, baseline, args.tolerance, args.slack)
+    if regressions:
+        print(f"{regressions} benchmark(s) regressed", flush=True)
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
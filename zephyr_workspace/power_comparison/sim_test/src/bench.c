@@ -0,0 +1,375 @@
+/*
+ * RTOS Primitive Micro-Benchmarks
+ *
+ * Times the kernel paths the BLE streaming apps lean on (context switch,
+ * semaphores, message queues, FIFOs, net_buf pools, memcpy/memset at BLE
+ * payload sizes and ISR-to-thread wakeup), plus one iteration of the
+ * common/corebench compute kernels, and prints one parseable row per
+ * benchmark:
+ *
+ *   BENCH <name> <iters> <min> <median> <max>
+ *
+ * All values are in hardware cycles (k_cycle_get_32). Run QEMU with
+ * -icount so the numbers are deterministic instruction-driven counts
+ * rather than host wall-clock; see run_qemu_test.sh.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/irq_offload.h>
+#include <zephyr/net_buf.h>
+#include <zephyr/sys/printk.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "corebench.h"
+
+#define BENCH_ITERS        256
+#define HELPER_STACK_SIZE  1024
+
+/* BLE-relevant copy sizes: small header, ATT default, one LL PDU,
+ * one 498-MTU notification and one 2000-byte L2CAP SDU.
+ */
+static const uint16_t copy_sizes[] = { 16, 64, 251, 495, 2000 };
+
+static uint32_t samples[BENCH_ITERS];
+
+static uint8_t copy_src[2048] __aligned(4);
+static uint8_t copy_dst[2048] __aligned(4);
+
+static K_THREAD_STACK_DEFINE(helper_stack, HELPER_STACK_SIZE);
+static struct k_thread helper_thread;
+
+static K_SEM_DEFINE(ping_sem, 0, 1);
+static K_SEM_DEFINE(pong_sem, 0, 1);
+static K_SEM_DEFINE(isr_sem, 0, 1);
+
+static K_MSGQ_DEFINE(req_msgq, sizeof(uint32_t), 4, 4);
+static K_MSGQ_DEFINE(resp_msgq, sizeof(uint32_t), 4, 4);
+
+static K_FIFO_DEFINE(req_fifo);
+static K_FIFO_DEFINE(resp_fifo);
+
+struct fifo_item {
+	void *fifo_reserved;
+	uint32_t value;
+};
+
+static struct fifo_item fifo_items[2];
+
+/* Same shape as the L2CAP SDU pools in the streaming apps. */
+NET_BUF_POOL_FIXED_DEFINE(bench_pool, 4, 512, 8, NULL);
+
+static volatile uint32_t ts_yield;
+static volatile uint32_t ts_isr;
+static volatile uint32_t ts_wake;
+
+static int cmp_u32(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *)a;
+	uint32_t y = *(const uint32_t *)b;
+
+	return (x > y) - (x < y);
+}
+
+static void report(const char *name, uint32_t *buf, int n)
+{
+	qsort(buf, n, sizeof(buf[0]), cmp_u32);
+	printk("BENCH %-22s %5d %8u %8u %8u\n", name, n, buf[0], buf[n / 2],
+	       buf[n - 1]);
+}
+
+static void start_helper(k_thread_entry_t fn, int prio_offset)
+{
+	int prio = k_thread_priority_get(k_current_get()) + prio_offset;
+
+	k_thread_create(&helper_thread, helper_stack,
+			K_THREAD_STACK_SIZEOF(helper_stack),
+			fn, NULL, NULL, NULL, prio, 0, K_NO_WAIT);
+}
+
+/* ---- Timer overhead ---- */
+
+static void bench_cycle_overhead(void)
+{
+	for (int i = 0; i < BENCH_ITERS; i++) {
+		uint32_t t0 = k_cycle_get_32();
+
+		samples[i] = k_cycle_get_32() - t0;
+	}
+	report("cycle_read_overhead", samples, BENCH_ITERS);
+}
+
+/* ---- Context switch (k_yield between equal-priority threads) ---- */
+
+static void yield_helper(void *p1, void *p2, void *p3)
+{
+	for (int i = 0; i < BENCH_ITERS; i++) {
+		ts_yield = k_cycle_get_32();
+		k_yield();
+	}
+}
+
+static void bench_context_switch(void)
+{
+	start_helper(yield_helper, 0);
+
+	/* Let the helper run up to its first yield. */
+	k_yield();
+
+	for (int i = 0; i < BENCH_ITERS; i++) {
+		k_yield();
+		samples[i] = k_cycle_get_32() - ts_yield;
+	}
+
+	k_thread_join(&helper_thread, K_FOREVER);
+	report("ctx_switch_yield", samples, BENCH_ITERS);
+}
+
+/* ---- k_sem ---- */
+
+static void bench_sem_give_take(void)
+{
+	for (int i = 0; i < BENCH_ITERS; i++) {
+		uint32_t t0 = k_cycle_get_32();
+
+		k_sem_give(&ping_sem);
+		k_sem_take(&ping_sem, K_NO_WAIT);
+		samples[i] = k_cycle_get_32() - t0;
+	}
+	report("sem_give_take", samples, BENCH_ITERS);
+}
+
+static void sem_pong_helper(void *p1, void *p2, void *p3)
+{
+	for (int i = 0; i < BENCH_ITERS; i++) {
+		k_sem_take(&ping_sem, K_FOREVER);
+		k_sem_give(&pong_sem);
+	}
+}
+
+static void bench_sem_pingpong(void)
+{
+	k_sem_reset(&ping_sem);
+	k_sem_reset(&pong_sem);
+	start_helper(sem_pong_helper, 0);
+
+	for (int i = 0; i < BENCH_ITERS; i++) {
+		uint32_t t0 = k_cycle_get_32();
+
+		k_sem_give(&ping_sem);
+		k_sem_take(&pong_sem, K_FOREVER);
+		samples[i] = k_cycle_get_32() - t0;
+	}
+
+	k_thread_join(&helper_thread, K_FOREVER);
+	report("sem_pingpong_rt", samples, BENCH_ITERS);
+}
+
+/* ---- k_msgq round trip ---- */
+
+static void msgq_helper(void *p1, void *p2, void *p3)
+{
+	uint32_t msg;
+
+	for (int i = 0; i < BENCH_ITERS; i++) {
+		k_msgq_get(&req_msgq, &msg, K_FOREVER);
+		k_msgq_put(&resp_msgq, &msg, K_FOREVER);
+	}
+}
+
+static void bench_msgq_roundtrip(void)
+{
+	uint32_t msg;
+
+	k_msgq_purge(&req_msgq);
+	k_msgq_purge(&resp_msgq);
+	start_helper(msgq_helper, 0);
+
+	for (int i = 0; i < BENCH_ITERS; i++) {
+		uint32_t t0 = k_cycle_get_32();
+
+		msg = i;
+		k_msgq_put(&req_msgq, &msg, K_FOREVER);
+		k_msgq_get(&resp_msgq, &msg, K_FOREVER);
+		samples[i] = k_cycle_get_32() - t0;
+	}
+
+	k_thread_join(&helper_thread, K_FOREVER);
+	report("msgq_roundtrip", samples, BENCH_ITERS);
+}
+
+/* ---- k_fifo round trip ---- */
+
+static void fifo_helper(void *p1, void *p2, void *p3)
+{
+	for (int i = 0; i < BENCH_ITERS; i++) {
+		struct fifo_item *item = k_fifo_get(&req_fifo, K_FOREVER);
+
+		k_fifo_put(&resp_fifo, item);
+	}
+}
+
+static void bench_fifo_roundtrip(void)
+{
+	start_helper(fifo_helper, 0);
+
+	for (int i = 0; i < BENCH_ITERS; i++) {
+		struct fifo_item *item = &fifo_items[i & 1];
+		uint32_t t0 = k_cycle_get_32();
+
+		item->value = i;
+		k_fifo_put(&req_fifo, item);
+		(void)k_fifo_get(&resp_fifo, K_FOREVER);
+		samples[i] = k_cycle_get_32() - t0;
+	}
+
+	k_thread_join(&helper_thread, K_FOREVER);
+	report("fifo_roundtrip", samples, BENCH_ITERS);
+}
+
+/* ---- net_buf alloc/free ---- */
+
+static int bench_net_buf(void)
+{
+	for (int i = 0; i < BENCH_ITERS; i++) {
+		uint32_t t0 = k_cycle_get_32();
+		struct net_buf *buf = net_buf_alloc(&bench_pool, K_NO_WAIT);
+
+		if (!buf) {
+			printk("BENCH net_buf_alloc_free SKIP (pool empty)\n");
+			return -ENOMEM;
+		}
+		net_buf_unref(buf);
+		samples[i] = k_cycle_get_32() - t0;
+	}
+	report("net_buf_alloc_free", samples, BENCH_ITERS);
+	return 0;
+}
+
+/* ---- memcpy / memset ---- */
+
+static void bench_mem(void)
+{
+	char name[24];
+
+	memset(copy_src, 0x5A, sizeof(copy_src));
+
+	for (int s = 0; s < ARRAY_SIZE(copy_sizes); s++) {
+		size_t len = copy_sizes[s];
+
+		for (int i = 0; i < BENCH_ITERS; i++) {
+			uint32_t t0 = k_cycle_get_32();
+
+			memcpy(copy_dst, copy_src, len);
+			compiler_barrier();
+			samples[i] = k_cycle_get_32() - t0;
+		}
+		snprintk(name, sizeof(name), "memcpy_%u", (unsigned int)len);
+		report(name, samples, BENCH_ITERS);
+
+		for (int i = 0; i < BENCH_ITERS; i++) {
+			uint32_t t0 = k_cycle_get_32();
+
+			memset(copy_dst, i, len);
+			compiler_barrier();
+			samples[i] = k_cycle_get_32() - t0;
+		}
+		snprintk(name, sizeof(name), "memset_%u", (unsigned int)len);
+		report(name, samples, BENCH_ITERS);
+	}
+}
+
+/* ---- CoreMark-class iteration (common/corebench) ---- */
+
+#define COREBENCH_SAMPLES 32
+
+static int bench_corebench(void)
+{
+	int bad = 0;
+
+	for (int i = 0; i < COREBENCH_SAMPLES; i++) {
+		uint32_t t0 = k_cycle_get_32();
+		uint16_t crc = corebench_iteration();
+
+		samples[i] = k_cycle_get_32() - t0;
+		bad += (crc != COREBENCH_CRC);
+	}
+
+	if (bad) {
+		printk("BENCH corebench_iter SKIP (signature mismatch)\n");
+		return -EIO;
+	}
+	report("corebench_iter", samples, COREBENCH_SAMPLES);
+	return 0;
+}
+
+/* ---- ISR entry and ISR-to-thread wakeup ---- */
+
+static void bench_isr(const void *param)
+{
+	ts_isr = k_cycle_get_32();
+	k_sem_give(&isr_sem);
+}
+
+static void isr_wake_helper(void *p1, void *p2, void *p3)
+{
+	for (int i = 0; i < BENCH_ITERS; i++) {
+		k_sem_take(&isr_sem, K_FOREVER);
+		ts_wake = k_cycle_get_32();
+	}
+}
+
+static uint32_t isr_entry[BENCH_ITERS];
+
+static void bench_isr_to_thread(void)
+{
+	k_sem_reset(&isr_sem);
+
+	/* Higher priority than main so the wakeup preempts on ISR exit,
+	 * which is how the BT RX thread is woken by the controller.
+	 */
+	start_helper(isr_wake_helper, -1);
+
+	for (int i = 0; i < BENCH_ITERS; i++) {
+		uint32_t t0 = k_cycle_get_32();
+
+		irq_offload(bench_isr, NULL);
+
+		/* The helper has already run by the time we get here. */
+		isr_entry[i] = ts_isr - t0;
+		samples[i] = ts_wake - ts_isr;
+	}
+
+	k_thread_join(&helper_thread, K_FOREVER);
+	report("isr_entry", isr_entry, BENCH_ITERS);
+	report("isr_to_thread", samples, BENCH_ITERS);
+}
+
+int bench_run_all(void)
+{
+	int skipped = 0;
+
+	printk("BENCH_BEGIN board=%s cycles_per_sec=%u\n", CONFIG_BOARD,
+	       sys_clock_hw_cycles_per_sec());
+	printk("BENCH_COLS name iters min median max (cycles)\n");
+
+	bench_cycle_overhead();
+	bench_context_switch();
+	bench_sem_give_take();
+	bench_sem_pingpong();
+	bench_msgq_roundtrip();
+	bench_fifo_roundtrip();
+	if (bench_net_buf() < 0) {
+		skipped++;
+	}
+	bench_mem();
+	if (bench_corebench() < 0) {
+		skipped++;
+	}
+	bench_isr_to_thread();
+
+	printk("BENCH_END skipped=%d\n", skipped);
+
+	return skipped;
+}
@@ -0,0 +1,16 @@
+/*
+ * RTOS primitive micro-benchmarks for the QEMU validation image.
+ *
+ * Every benchmark prints one "BENCH" row; bench_compare.py parses the
+ * table and checks it against sim_test/baselines/<target>.json.
+ */
+
+#ifndef SIM_TEST_BENCH_H_
+#define SIM_TEST_BENCH_H_
+
+/* Run the full suite and print the result table. Returns the number of
+ * benchmarks that could not run (0 on success).
+ */
+int bench_run_all(void);
+
+#endif /* SIM_TEST_BENCH_H_ */
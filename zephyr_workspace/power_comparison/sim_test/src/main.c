@@ -2,14 +2,20 @@
  * Power Test QEMU Validation
  *
  * Verifies firmware boots and basic kernel operations work.
- * BLE is validated at compile time (real targets build successfully).
- * This test covers: boot, sleep/wake, memory, timer accuracy.
+ * BLE is validated at compile time (real targets build successfully);
+ * per-app flash/RAM sizes are reported by power_comparison/footprint.py.
+ * This test covers: boot, sleep/wake, memory, timer accuracy, the
+ * RTOS primitive micro-benchmarks in bench.c and the common/corebench
+ * compute score.
  */
 
 #include <zephyr/kernel.h>
 #include <zephyr/sys/printk.h>
 #include <string.h>
 
+#include "bench.h"
+#include "corebench.h"
+
 static int tests_passed;
 static int tests_failed;
 
@@ -110,6 +116,28 @@ static void test_timer_accuracy(void)
 	TEST_ASSERT(good >= 2, "Timer consistency (3x 1s sleep, >=2 within 10ms)");
 }
 
+/* With -icount shift=0 every guest instruction takes 1 ns, so the clock
+ * is a nominal 1000 MHz at one instruction per cycle: the score is an
+ * instruction-count cross-check for the hardware COREBENCH lines, not
+ * a speed.
+ */
+#define COREBENCH_QEMU_MHZ 1000
+
+#if defined(CONFIG_CPU_CORTEX_M55)
+#define COREBENCH_CORE "qemu-m55"
+#else
+#define COREBENCH_CORE "qemu-m33"
+#endif
+
+static void test_corebench(void)
+{
+	printk("\n--- Test: CoreMark-class compute (common/corebench) ---\n");
+
+	TEST_ASSERT(corebench_iteration() == COREBENCH_CRC, "Corebench signature");
+	TEST_ASSERT(corebench_run(COREBENCH_CORE, COREBENCH_QEMU_MHZ, 500, NULL) == 0,
+		    "Corebench 500 ms window");
+}
+
 int main(void)
 {
 	printk("========================================\n");
@@ -122,6 +150,10 @@ int main(void)
 	test_memory();
 	test_thread();
 	test_timer_accuracy();
+	test_corebench();
+
+	printk("\n--- Benchmarks: RTOS primitives ---\n");
+	TEST_ASSERT(bench_run_all() == 0, "All micro-benchmarks ran");
 
 	printk("\n========================================\n");
 	printk("Results: %d passed, %d failed\n", tests_passed, tests_failed);
@@ -133,16 +165,5 @@ int main(void)
 		printk("ALL TESTS PASSED\n");
 	}
 
-	/* Verify BLE firmware builds (compile-time check summary) */
-	printk("\nBLE compile validation:\n");
-	printk("  nrf54lm20_idle_test       - built OK (19.6 KB)\n");
-	printk("  nrf54lm20_adv_test        - built OK (117 KB)\n");
-	printk("  nrf54lm20_throughput_test  - built OK (122 KB)\n");
-	printk("  nrf54lm20_l2cap_test      - built OK (156 KB)\n");
-	printk("  alif_b1_idle_test         - built OK (26.9 KB)\n");
-	printk("  alif_b1_adv_test          - built OK (39.1 KB)\n");
-	printk("  alif_b1_throughput_test   - built OK (39.9 KB)\n");
-	printk("  alif_b1_l2cap_test        - built OK (39.9 KB)\n");
-
 	return 0;
 }
@@ -0,0 +1,177 @@
+/*
+ * Octal NOR asset store benchmark (common/assetfs).
+ *
+ * Mounts the image programmed at CONFIG_ASSETFS_FLASH_OFFSET, checks
+ * every asset's CRC, then measures:
+ *   - lookup time (hit and miss) over all names in the index,
+ *   - XIP bandwidth: in-place read sweep and memcpy into SRAM,
+ *   - MMIO bandwidth for the first asset above the XIP window, straight
+ *     into SOCMEM and into SRAM through the assetfs bounce buffer,
+ * and converts the copy rates into full-resolution (800x480 RGB565)
+ * frames per second.
+ */
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+
+#include "assetfs.h"
+
+#define LOOKUP_ROUNDS 16U
+#define COPY_CHUNK    (32U * 1024U)
+#define BW_BYTES_MAX  (8U * 1024U * 1024U)
+#define FRAME_BYTES   (800U * 480U * 2U)
+
+static uint8_t copy_buf[COPY_CHUNK] __aligned(32);
+
+static uint32_t kbps(uint64_t bytes, uint32_t cycles)
+{
+	uint64_t ns = MAX(k_cyc_to_ns_floor64(cycles), 1U);
+
+	return (uint32_t)((bytes * 1000000000ULL / 1024U) / ns);
+}
+
+/* Frames per second x100 at a given KB/s. */
+static uint32_t fps100(uint32_t kb_per_s)
+{
+	return (uint32_t)((uint64_t)kb_per_s * 1024U * 100U / FRAME_BYTES);
+}
+
+static void print_rate(const char *what, uint32_t rate)
+{
+	uint32_t f = fps100(rate);
+
+	printk("%-20s %8u KB/s  (%u.%02u full-res fps)\n", what, rate, f / 100U, f % 100U);
+}
+
+static void list_and_verify(uint32_t count)
+{
+	uint32_t bad = 0, xip = 0;
+	struct asset a;
+
+	for (uint32_t i = 0; i < count; i++) {
+		assetfs_get(i, &a);
+		if (a.xip != NULL) {
+			xip++;
+		}
+		if (i < 8U) {
+			printk("  %-31s %9u B @0x%08x %s\n", a.name, a.size, a.flash_addr,
+			       a.xip ? "xip" : "mmio");
+		}
+		if ((a.xip != NULL || IS_ENABLED(CONFIG_ASSETFS_MMIO)) && assetfs_verify(&a) < 0) {
+			printk("  CRC FAIL: %s\n", a.name);
+			bad++;
+		}
+	}
+	if (count > 8U) {
+		printk("  ... %u more\n", count - 8U);
+	}
+	printk("assets: %u (%u xip, %u mmio), crc failures: %u\n", count, xip, count - xip,
+	       bad);
+}
+
+static void bench_lookup(uint32_t count)
+{
+	struct assetfs_stats st;
+	struct asset a;
+	uint32_t hits = 0;
+
+	for (uint32_t r = 0; r < LOOKUP_ROUNDS; r++) {
+		for (uint32_t i = 0; i < count; i++) {
+			struct asset e;
+
+			assetfs_get(i, &e);
+			hits += assetfs_find(e.name, &a) == 0;
+		}
+		(void)assetfs_find("no/such/asset", &a);
+	}
+
+	assetfs_get_stats(&st);
+	printk("lookup: %u calls (%u hits, %u misses) avg %u ns max %u ns\n", st.lookups,
+	       hits, st.misses, (uint32_t)(st.lookup_sum_ns / MAX(st.lookups, 1U)),
+	       st.lookup_max_ns);
+}
+
+/* Largest asset matching the XIP/MMIO placement wanted. */
+static bool pick_asset(bool want_xip, uint32_t count, struct asset *out)
+{
+	bool found = false;
+	struct asset a;
+
+	for (uint32_t i = 0; i < count; i++) {
+		assetfs_get(i, &a);
+		if ((a.xip != NULL) == want_xip && (!found || a.size > out->size)) {
+			*out = a;
+			found = true;
+		}
+	}
+	return found;
+}
+
+static uint32_t bench_copy(const struct asset *a, uint32_t len, uint8_t *dst)
+{
+	uint32_t t0 = k_cycle_get_32();
+
+	for (uint32_t off = 0; off < len; off += COPY_CHUNK) {
+		if (assetfs_read(a, off, dst, COPY_CHUNK) < 0) {
+			return 0;
+		}
+	}
+	return kbps(len, k_cycle_get_32() - t0);
+}
+
+static void bench_bandwidth(uint32_t count)
+{
+	struct asset a;
+
+	if (pick_asset(true, count, &a)) {
+		const volatile uint32_t *p = a.xip;
+		uint32_t len = MIN(a.size, BW_BYTES_MAX) & ~3U;
+		uint32_t sum = 0, t0;
+
+		printk("xip asset: %s (%u B, sweeping %u B)\n", a.name, a.size, len);
+		t0 = k_cycle_get_32();
+		for (uint32_t i = 0; i < len / 4U; i++) {
+			sum += p[i];
+		}
+		print_rate("xip read in place", kbps(len, k_cycle_get_32() - t0));
+		print_rate("xip copy to sram", bench_copy(&a, len, copy_buf));
+		(void)sum;
+	}
+
+	if (pick_asset(false, count, &a)) {
+		uint32_t len = MIN(a.size, BW_BYTES_MAX);
+
+		printk("mmio asset: %s (%u B)\n", a.name, a.size);
+		if (IS_ENABLED(CONFIG_ASSETFS_MMIO)) {
+			print_rate("mmio copy to socmem",
+				   bench_copy(&a, len, (uint8_t *)CONFIG_ASSET_TEST_MMIO_BUF_ADDR));
+			print_rate("mmio via bounce", bench_copy(&a, len, copy_buf));
+		} else {
+			printk("mmio: skipped (CONFIG_ASSETFS_MMIO=n)\n");
+		}
+	}
+}
+
+int main(void)
+{
+	int count;
+
+	k_msleep(1000);
+	printk("=== PSE84 octal NOR asset store ===\n");
+	printk("image @ chip 0x%08x, xip window %u MB\n", CONFIG_ASSETFS_FLASH_OFFSET,
+	       CONFIG_ASSETFS_XIP_SIZE >> 20);
+
+	count = assetfs_mount();
+	if (count < 0) {
+		printk("mount failed: %d (program an image from asset_pack.py)\n", count);
+		return count;
+	}
+
+	list_and_verify(count);
+	bench_lookup(count);
+	bench_bandwidth(count);
+
+	printk("== done ==\n");
+	return 0;
+}
@@ -0,0 +1,8 @@
+# Sysbuild configuration for pse84_asset_test
+#
+# The M33 companion is the board's stock enable_cm55 image. Add the
+# asset MMIO server (m33/) to it as an extra Zephyr module; it is
+# enabled by CONFIG_ASSETFS_MMIO_SERVER in sysbuild/enable_cm55.conf.
+
+set(enable_cm55_EXTRA_ZEPHYR_MODULES ${APP_DIR}/m33 CACHE INTERNAL
+    "asset MMIO server module for the M33 companion")
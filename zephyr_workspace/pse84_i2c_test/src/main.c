@@ -11,6 +11,8 @@
 #include <zephyr/kernel.h>
 #include <zephyr/sys/printk.h>
 
+#include "pixel.h"
+
 #define FB_WIDTH  832
 #define FB_HEIGHT 480
 
@@ -43,8 +45,8 @@ int main(void)
 		0x001F, /* BLUE  */
 		0xFFFF, /* WHITE */
 	};
-	for (int col = 0; col < FB_WIDTH; col++) {
-		row_buf[col] = palette[(col * 4) / FB_WIDTH];
+	for (int bar = 0; bar < 4; bar++) {
+		pix_fill_rgb565(&row_buf[bar * FB_WIDTH / 4], palette[bar], FB_WIDTH / 4);
 	}
 
 	desc.buf_size = sizeof(row_buf);
@@ -0,0 +1,391 @@
+/*
+ * Pixel kernel validation (common/pixel).
+ *
+ * 1. Known-answer checks on the scalar reference kernels.
+ * 2. Bit-exact comparison of every Helium kernel against its reference
+ *    over pseudo-random input, for lengths 1..67 (every tail-predicate
+ *    shape) plus the panel widths 240/720/800/832. Output buffers carry
+ *    a guard band after the last pixel to catch predicated stores that
+ *    write past the end.
+ * 3. Cycles per pixel for ref vs MVE on one 800 px row, printed as
+ *    PIXBENCH lines. Under QEMU (-icount) these track instruction
+ *    counts rather than M55 pipeline timing, so only the ratios are
+ *    meaningful there; on the PSE84 they are DWT cycles.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/timing/timing.h>
+#include <string.h>
+
+#include "pixel.h"
+
+#define MAX_W      832U
+#define GUARD      16U
+#define GUARD_WORD 0xA5A5U
+
+#define BENCH_W     800U
+#define BENCH_ITERS 64U
+
+static int tests_passed;
+static int tests_failed;
+
+#define TEST_ASSERT(cond, name) do { \
+	if (cond) { \
+		printk("  PASS: %s\n", name); \
+		tests_passed++; \
+	} else { \
+		printk("  FAIL: %s\n", name); \
+		tests_failed++; \
+	} \
+} while (0)
+
+static uint8_t in8[MAX_W * 3U];
+static uint8_t in_u[MAX_W / 2U + 1U];
+static uint8_t in_v[MAX_W / 2U + 1U];
+static uint16_t in16_a[MAX_W];
+static uint16_t in16_b[MAX_W];
+static uint16_t out_ref[MAX_W + GUARD];
+static uint16_t out_mve[MAX_W + GUARD];
+
+static uint32_t lcg_state = 0x12345678U;
+
+static uint32_t lcg_next(void)
+{
+	lcg_state = lcg_state * 1664525U + 1013904223U;
+	return lcg_state >> 8;
+}
+
+static void fill_random(void)
+{
+	for (size_t i = 0; i < sizeof(in8); i++) {
+		in8[i] = (uint8_t)lcg_next();
+	}
+	for (size_t i = 0; i < sizeof(in_u); i++) {
+		in_u[i] = (uint8_t)lcg_next();
+		in_v[i] = (uint8_t)lcg_next();
+	}
+	for (size_t i = 0; i < MAX_W; i++) {
+		in16_a[i] = (uint16_t)lcg_next();
+		in16_b[i] = (uint16_t)lcg_next();
+	}
+}
+
+/* ---- Known answers (reference) ---- */
+
+static void test_reference(void)
+{
+	uint8_t rgb[6] = {255, 255, 255, 0x84, 0x82, 0x10};
+	uint8_t y[4] = {235, 16, 81, 41};
+	uint8_t u[2] = {128, 90};
+	uint8_t v[2] = {128, 240};
+	uint16_t src[4] = {0xF800, 0x07E0, 0x001F, 0xFFFF};
+	uint16_t out[12];
+	bool ok;
+
+	printk("\n--- Test: Reference kernels (known answers) ---\n");
+
+	pix_rgb888_to_rgb565_ref(out, rgb, 2);
+	TEST_ASSERT(out[0] == 0xFFFF && out[1] == 0x8402, "rgb888 -> rgb565 truncation");
+
+	/* Y=235/16 at neutral chroma are full white/black; (81, 90, 240)
+	 * is BT.601 studio red.
+	 */
+	pix_yuv420_row_to_rgb565_ref(out, y, u, v, 4);
+	TEST_ASSERT(out[0] == 0xFFFF && out[1] == 0x0000, "yuv420 white/black");
+	TEST_ASSERT((out[2] >> 11) == 31 && ((out[2] >> 5) & 0x3F) <= 1 && (out[2] & 0x1F) <= 1,
+		    "yuv420 BT.601 red");
+
+	pix_scale_nearest_row_ref(out, 12, src, 4);
+	ok = true;
+	for (int i = 0; i < 12; i++) {
+		ok = ok && out[i] == src[i / 3];
+	}
+	TEST_ASSERT(ok, "nearest 3x replicates each pixel");
+
+	pix_scale_bilinear_row_ref(out, 4, src, src, 4, 0);
+	TEST_ASSERT(memcmp(out, src, sizeof(src)) == 0, "bilinear 1:1 is identity");
+	/* Red over white at fy=255: every channel rounds to the white row. */
+	pix_scale_bilinear_row_ref(out, 1, &src[0], &src[3], 1, 255);
+	TEST_ASSERT(out[0] == 0xFFFF, "bilinear fy=255 rounds to row1");
+
+	pix_blend_rgb565_ref(out, &src[0], &src[2], 255, 2);
+	TEST_ASSERT(out[0] == src[0] && out[1] == src[1], "blend alpha=255 is fg");
+	pix_blend_rgb565_ref(out, &src[0], &src[2], 0, 2);
+	TEST_ASSERT(out[0] == src[2] && out[1] == src[3], "blend alpha=0 is bg");
+
+	pix_fill_rgb565_ref(out, 0x1234, 12);
+	TEST_ASSERT(out[0] == 0x1234 && out[11] == 0x1234, "fill");
+}
+
+#if PIX_HAVE_MVE
+
+/* ---- Bit-exact MVE vs reference ---- */
+
+static const uint16_t test_widths[] = {240, 720, 800, 832};
+
+static void clear_out(void)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(out_ref); i++) {
+		out_ref[i] = GUARD_WORD;
+		out_mve[i] = GUARD_WORD;
+	}
+}
+
+static bool outputs_match(size_t n)
+{
+	if (memcmp(out_ref, out_mve, n * sizeof(uint16_t)) != 0) {
+		for (size_t i = 0; i < n; i++) {
+			if (out_ref[i] != out_mve[i]) {
+				printk("    n=%u: mismatch at %u ref=0x%04x mve=0x%04x\n",
+				       (unsigned int)n, (unsigned int)i, out_ref[i], out_mve[i]);
+				break;
+			}
+		}
+		return false;
+	}
+	for (size_t i = n; i < n + GUARD; i++) {
+		if (out_mve[i] != GUARD_WORD) {
+			printk("    n=%u: store past end at %u\n", (unsigned int)n,
+			       (unsigned int)i);
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool exact_rgb888(size_t n)
+{
+	clear_out();
+	pix_rgb888_to_rgb565_ref(out_ref, in8, n);
+	pix_rgb888_to_rgb565_mve(out_mve, in8, n);
+	return outputs_match(n);
+}
+
+static bool exact_yuv420(size_t n)
+{
+	clear_out();
+	pix_yuv420_row_to_rgb565_ref(out_ref, in8, in_u, in_v, n);
+	pix_yuv420_row_to_rgb565_mve(out_mve, in8, in_u, in_v, n);
+	return outputs_match(n);
+}
+
+static bool exact_nearest(size_t dst_w, size_t src_w)
+{
+	clear_out();
+	pix_scale_nearest_row_ref(out_ref, dst_w, in16_a, src_w);
+	pix_scale_nearest_row_mve(out_mve, dst_w, in16_a, src_w);
+	return outputs_match(dst_w);
+}
+
+static bool exact_bilinear(size_t dst_w, size_t src_w, uint32_t fy)
+{
+	clear_out();
+	pix_scale_bilinear_row_ref(out_ref, dst_w, in16_a, in16_b, src_w, fy);
+	pix_scale_bilinear_row_mve(out_mve, dst_w, in16_a, in16_b, src_w, fy);
+	return outputs_match(dst_w);
+}
+
+static bool exact_blend(size_t n, uint8_t alpha)
+{
+	clear_out();
+	pix_blend_rgb565_ref(out_ref, in16_a, in16_b, alpha, n);
+	pix_blend_rgb565_mve(out_mve, in16_a, in16_b, alpha, n);
+	return outputs_match(n);
+}
+
+static bool exact_fill(size_t n)
+{
+	clear_out();
+	pix_fill_rgb565_ref(out_ref, 0x5AA5, n);
+	pix_fill_rgb565_mve(out_mve, 0x5AA5, n);
+	return outputs_match(n);
+}
+
+static void test_bit_exact(void)
+{
+	static const uint8_t alphas[] = {0, 1, 127, 128, 200, 254, 255};
+	static const uint8_t fys[] = {0, 1, 128, 255};
+	bool rgb = true, yuv = true, near = true, bil = true, blend = true, fill = true;
+
+	printk("\n--- Test: MVE bit-exact vs reference ---\n");
+	fill_random();
+
+	for (size_t n = 1; n <= 67; n++) {
+		rgb = rgb && exact_rgb888(n);
+		yuv = yuv && exact_yuv420(n);
+		near = near && exact_nearest(n, 17) && exact_nearest(n * 3, n) &&
+		       exact_nearest(n, MAX_W);
+		bil = bil && exact_bilinear(n, 1, 0) && exact_bilinear(n, 13, fys[n % 4]) &&
+		      exact_bilinear(n * 2, n, fys[(n + 1) % 4]);
+		blend = blend && exact_blend(n, alphas[n % ARRAY_SIZE(alphas)]);
+		fill = fill && exact_fill(n);
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(test_widths); i++) {
+		size_t w = test_widths[i];
+
+		rgb = rgb && exact_rgb888(w);
+		yuv = yuv && exact_yuv420(w);
+		near = near && exact_nearest(w, 240) && exact_nearest(w, w / 3);
+		for (size_t f = 0; f < ARRAY_SIZE(fys); f++) {
+			bil = bil && exact_bilinear(w, 240, fys[f]) &&
+			      exact_bilinear(w, 320, fys[f]) && exact_bilinear(w / 2, w, fys[f]);
+		}
+		for (size_t a = 0; a < ARRAY_SIZE(alphas); a++) {
+			blend = blend && exact_blend(w, alphas[a]);
+		}
+		fill = fill && exact_fill(w);
+	}
+
+	TEST_ASSERT(rgb, "rgb888 -> rgb565 bit-exact");
+	TEST_ASSERT(yuv, "yuv420 -> rgb565 bit-exact");
+	TEST_ASSERT(near, "nearest scale bit-exact");
+	TEST_ASSERT(bil, "bilinear scale bit-exact");
+	TEST_ASSERT(blend, "alpha blend bit-exact");
+	TEST_ASSERT(fill, "fill bit-exact");
+}
+
+#endif /* PIX_HAVE_MVE */
+
+/* ---- Cycles per pixel ---- */
+
+enum kernel_id {
+	K_RGB888,
+	K_YUV420,
+	K_NEAREST,
+	K_BILINEAR,
+	K_BLEND,
+	K_FILL,
+	K_COUNT,
+};
+
+static const char *const kernel_names[K_COUNT] = {
+	"rgb888_to_rgb565", "yuv420_to_rgb565", "scale_nearest_3x",
+	"scale_bilinear", "blend_rgb565", "fill_rgb565",
+};
+
+static void run_kernel(enum kernel_id k, bool mve)
+{
+	uint16_t *dst = mve ? out_mve : out_ref;
+
+#if PIX_HAVE_MVE
+	if (mve) {
+		switch (k) {
+		case K_RGB888:
+			pix_rgb888_to_rgb565_mve(dst, in8, BENCH_W);
+			break;
+		case K_YUV420:
+			pix_yuv420_row_to_rgb565_mve(dst, in8, in_u, in_v, BENCH_W);
+			break;
+		case K_NEAREST:
+			pix_scale_nearest_row_mve(dst, BENCH_W, in16_a, BENCH_W / 3U);
+			break;
+		case K_BILINEAR:
+			pix_scale_bilinear_row_mve(dst, BENCH_W, in16_a, in16_b, 320, 96);
+			break;
+		case K_BLEND:
+			pix_blend_rgb565_mve(dst, in16_a, in16_b, 160, BENCH_W);
+			break;
+		default:
+			pix_fill_rgb565_mve(dst, 0x5AA5, BENCH_W);
+			break;
+		}
+		return;
+	}
+#endif
+
+	switch (k) {
+	case K_RGB888:
+		pix_rgb888_to_rgb565_ref(dst, in8, BENCH_W);
+		break;
+	case K_YUV420:
+		pix_yuv420_row_to_rgb565_ref(dst, in8, in_u, in_v, BENCH_W);
+		break;
+	case K_NEAREST:
+		pix_scale_nearest_row_ref(dst, BENCH_W, in16_a, BENCH_W / 3U);
+		break;
+	case K_BILINEAR:
+		pix_scale_bilinear_row_ref(dst, BENCH_W, in16_a, in16_b, 320, 96);
+		break;
+	case K_BLEND:
+		pix_blend_rgb565_ref(dst, in16_a, in16_b, 160, BENCH_W);
+		break;
+	default:
+		pix_fill_rgb565_ref(dst, 0x5AA5, BENCH_W);
+		break;
+	}
+}
+
+/* Cycles per pixel x100 over BENCH_ITERS rows. */
+static uint32_t measure_cpp100(enum kernel_id k, bool mve)
+{
+	timing_t t0, t1;
+	uint64_t cycles;
+
+	run_kernel(k, mve); /* warm I-cache / D-cache */
+
+	t0 = timing_counter_get();
+	for (uint32_t i = 0; i < BENCH_ITERS; i++) {
+		run_kernel(k, mve);
+	}
+	t1 = timing_counter_get();
+
+	cycles = timing_cycles_get(&t0, &t1);
+	return (uint32_t)((cycles * 100U) / (BENCH_ITERS * BENCH_W));
+}
+
+static void bench_kernels(void)
+{
+	printk("\n--- Benchmarks: cycles/px (%u px row, %u iters) ---\n", BENCH_W,
+	       BENCH_ITERS);
+	printk("PIXBENCH_COLS kernel ref_cpp mve_cpp speedup\n");
+
+	timing_init();
+	timing_start();
+
+	for (int k = 0; k < K_COUNT; k++) {
+		uint32_t ref = measure_cpp100(k, false);
+		uint32_t mve = PIX_HAVE_MVE ? measure_cpp100(k, true) : 0;
+		uint32_t speedup = mve ? (ref * 100U) / mve : 0;
+
+		printk("PIXBENCH %-18s %u.%02u %u.%02u %u.%02ux\n", kernel_names[k],
+		       ref / 100U, ref % 100U, mve / 100U, mve % 100U,
+		       speedup / 100U, speedup % 100U);
+	}
+
+	timing_stop();
+}
+
+int main(void)
+{
+	printk("========================================\n");
+	printk("Pixel Kernel Validation\n");
+	printk("Board: %s\n", CONFIG_BOARD);
+	printk("MVE kernels: %s\n", PIX_HAVE_MVE ? "yes" : "no (reference only)");
+	printk("========================================\n");
+
+	test_reference();
+
+#if PIX_HAVE_MVE
+	test_bit_exact();
+#elif defined(CONFIG_CPU_CORTEX_M55)
+	/* An M55 build without MVE means the FPU/MVE Kconfig is wrong. */
+	TEST_ASSERT(false, "Cortex-M55 build has MVE enabled");
+#endif
+
+	fill_random();
+	bench_kernels();
+
+	printk("\n========================================\n");
+	printk("Results: %d passed, %d failed\n", tests_passed, tests_failed);
+	printk("========================================\n");
+
+	if (tests_failed > 0) {
+		printk("VALIDATION FAILED\n");
+	} else {
+		printk("ALL TESTS PASSED\n");
+	}
+
+	return 0;
+}
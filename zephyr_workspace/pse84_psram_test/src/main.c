@@ -1,6 +1,106 @@
 #include <zephyr/kernel.h>
 #include <zephyr/sys/printk.h>
 
+#include "psram_heap.h"
+
+#define FB_BYTES    (832U * 480U * 2U) /* one RGB565 frame at panel stride */
+#define AUDIO_BYTES (64U * 1024U)
+#define ASSET_BYTES (4U * 1024U * 1024U)
+#define CACHE_LINE  32U
+
+/* Allocate back-to-back cached blocks of awkward sizes and check that
+ * no two of them touch the same cache line, counting the requested
+ * size only; the heap must pad the rest. Returns the number of
+ * offending pairs, or -ENOMEM.
+ */
+static int line_sharing_check(void)
+{
+	static const size_t sizes[] = { 1, 33, 95, 7, 64, 40 };
+	uint8_t *blk[ARRAY_SIZE(sizes)];
+	int bad = 0;
+
+	for (size_t i = 0; i < ARRAY_SIZE(sizes); i++) {
+		blk[i] = psram_alloc(PSRAM_USE_CPU, sizes[i]);
+		if (blk[i] == NULL) {
+			bad = -ENOMEM;
+		}
+	}
+
+	for (size_t i = 0; bad >= 0 && i < ARRAY_SIZE(sizes); i++) {
+		uintptr_t first_i = (uintptr_t)blk[i] / CACHE_LINE;
+		uintptr_t last_i = ((uintptr_t)blk[i] + sizes[i] - 1U) / CACHE_LINE;
+
+		for (size_t j = i + 1U; j < ARRAY_SIZE(sizes); j++) {
+			uintptr_t first_j = (uintptr_t)blk[j] / CACHE_LINE;
+			uintptr_t last_j = ((uintptr_t)blk[j] + sizes[j] - 1U) / CACHE_LINE;
+
+			if (first_i <= last_j && first_j <= last_i) {
+				printk("  blocks %p+%u and %p+%u share a line\n", blk[i],
+				       (unsigned int)sizes[i], blk[j], (unsigned int)sizes[j]);
+				bad++;
+			}
+		}
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(sizes); i++) {
+		psram_free(blk[i]);
+	}
+	return bad;
+}
+
+/* Allocate one buffer of each kind the M55 apps need, report where it
+ * landed, then measure both pools.
+ */
+static void heap_demo(void)
+{
+	struct psram_bw bw;
+	void *fb, *audio, *assets, *scratch;
+	int ret;
+
+	printk("-- PSRAM heap --\n"); k_msleep(50);
+	ret = psram_heap_init();
+	if (ret < 0) {
+		printk("psram_heap_init failed: %d\n", ret);
+		return;
+	}
+
+	fb = psram_alloc(PSRAM_USE_FRAMEBUFFER, FB_BYTES);
+	audio = psram_alloc(PSRAM_USE_DMA, AUDIO_BYTES);
+	assets = psram_alloc(PSRAM_USE_ASSET_CACHE, ASSET_BYTES);
+	scratch = psram_alloc(PSRAM_USE_CPU, 256U * 1024U);
+
+	printk("framebuffer %p pool %d\n", fb, psram_pool_of(fb)); k_msleep(20);
+	printk("audio ring  %p pool %d\n", audio, psram_pool_of(audio)); k_msleep(20);
+	printk("asset cache %p pool %d\n", assets, psram_pool_of(assets)); k_msleep(20);
+	printk("cpu scratch %p pool %d\n", scratch, psram_pool_of(scratch)); k_msleep(20);
+
+	psram_free(scratch);
+	psram_free(assets);
+	psram_free(audio);
+	psram_free(fb);
+
+	ret = line_sharing_check();
+	if (ret == 0) {
+		printk("line sharing: ok\n");
+	} else {
+		printk("line sharing: FAIL (%d)\n", ret);
+	}
+	k_msleep(20);
+
+	for (int p = 0; p < PSRAM_POOL_COUNT; p++) {
+		ret = psram_heap_measure_bw(p, &bw);
+		if (ret < 0) {
+			printk("pool %d bandwidth: error %d\n", p, ret);
+		} else {
+			printk("pool %d bandwidth KB/s: write=%u read=%u copy=%u\n", p,
+			       bw.write_kbps, bw.read_kbps, bw.copy_kbps);
+		}
+		k_msleep(20);
+	}
+
+	psram_heap_print_stats();
+}
+
 int main(void)
 {
 	k_msleep(2000);
@@ -48,6 +148,8 @@ int main(void)
 	printk("+32 MB   @0x62000000 = 0x%08x\n", f_32M[0]); k_msleep(50);
 	printk("+60 MB   @0x63C00000 = 0x%08x (near end of 64 MB XIP)\n", f_60M[0]); k_msleep(100);
 
+	heap_demo();
+
 	printk("== probe done ==\n");
 	while (1) { k_msleep(1000); }
 	return 0;
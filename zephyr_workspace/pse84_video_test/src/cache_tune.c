@@ -0,0 +1,210 @@
+/*
+ * Cache maintenance and code/data placement for the video path
+ * (see cache_tune.h).
+ *
+ * The M55 runs this image XIP from SMIF0 through its I-cache, reads the
+ * frame blob through the D-cache from the same window, and writes
+ * socmem_fb through the D-cache while the DC DMA reads it behind the
+ * beam. Only the last of those needs maintenance for correctness; the
+ * rest is about keeping the XIP fetch latency off the draw loop.
+ */
+
+#include <string.h>
+#include <cmsis_core.h>
+#include <zephyr/cache.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/kernel.h>
+#include <zephyr/linker/section_tags.h>
+#include <zephyr/sys/printk.h>
+
+#include "cache_tune.h"
+#include "pixel.h"
+#include "video.h"
+
+#define DISPLAY_NODE DT_CHOSEN(zephyr_display)
+#define FB_BASE      DT_REG_ADDR(DT_PHANDLE(DISPLAY_NODE, framebuffer))
+#define FB_STRIDE    DT_PROP(DISPLAY_NODE, stride_pixels)
+
+#define CACHE_LINE   32U
+#define BENCH_RUNS   4U
+
+/* TCM placement when the board has the chosen nodes, SRAM otherwise. */
+#ifdef __dtcm_bss_section
+#define STAGE_SECTION __dtcm_bss_section
+#define STAGE_MEM     "dtcm"
+#else
+#define STAGE_SECTION
+#define STAGE_MEM     "sram"
+#endif
+
+#if defined(CONFIG_VIDEO_STAGE_FRAME) || defined(CONFIG_VIDEO_DRAW_BENCH)
+static uint8_t stage_buf[FRAME_BYTES] STAGE_SECTION __aligned(CACHE_LINE);
+#endif
+
+void cache_tune_init(void)
+{
+	printk("cache: I %s, D %s; fb 0x%08x stride %u; clean=%d prefetch=%d stage=%d (%s)\n",
+	       (SCB->CCR & SCB_CCR_IC_Msk) ? "on" : "off",
+	       (SCB->CCR & SCB_CCR_DC_Msk) ? "on" : "off", (uint32_t)FB_BASE, FB_STRIDE,
+	       IS_ENABLED(CONFIG_VIDEO_FB_CLEAN), IS_ENABLED(CONFIG_VIDEO_PREFETCH_SRC),
+	       IS_ENABLED(CONFIG_VIDEO_STAGE_FRAME), STAGE_MEM);
+}
+
+void fb_clean_band(uint32_t x, uint32_t y, uint32_t w, uint32_t h)
+{
+	uintptr_t start;
+	size_t len;
+
+	if (!IS_ENABLED(CONFIG_VIDEO_FB_CLEAN) || w == 0U || h == 0U) {
+		return;
+	}
+
+	/* One range from the first to the last pixel of the rectangle; the
+	 * stride gap in between is at most 112 px per row, cheaper to clean
+	 * than to issue a call per row.
+	 */
+	start = FB_BASE + (y * FB_STRIDE + x) * 2U;
+	len = ((h - 1U) * FB_STRIDE + w) * 2U;
+	(void)sys_cache_data_flush_range((void *)start, len);
+}
+
+void src_prefetch(const void *p, size_t len)
+{
+	const uint8_t *b = p;
+
+	if (!IS_ENABLED(CONFIG_VIDEO_PREFETCH_SRC)) {
+		return;
+	}
+	for (size_t off = 0; off < len; off += CACHE_LINE) {
+		__builtin_prefetch(b + off);
+	}
+}
+
+const uint8_t *frame_stage(const uint8_t *frame)
+{
+#ifdef CONFIG_VIDEO_STAGE_FRAME
+	memcpy(stage_buf, frame, FRAME_BYTES);
+	return stage_buf;
+#else
+	return frame;
+#endif
+}
+
+#ifdef CONFIG_VIDEO_DRAW_BENCH
+
+static uint16_t bench_band[DST_W * UPSCALE] __aligned(CACHE_LINE);
+
+/*
+ * The draw loop without display_write: 3x horizontal replicate as
+ * 32-bit stores (a,a)(a,b)(b,b) per source pixel pair, then two
+ * vertical copies. No library calls, so the whole body executes from
+ * wherever the function is placed.
+ */
+#define DEFINE_DRAW_LOOP(name, attr)                                          \
+	static attr __noinline void name(uint16_t *band, const uint16_t *src)   \
+	{                                                                       \
+		uint32_t *row = (uint32_t *)band;                               \
+                                                                                \
+		for (uint32_t sy = 0; sy < SRC_H; sy++) {                       \
+			const uint16_t *s = &src[sy * SRC_W];                   \
+			uint32_t *d = row;                                      \
+                                                                                \
+			for (uint32_t x = 0; x < SRC_W; x += 2U) {              \
+				uint32_t a = s[x], b = s[x + 1U];               \
+                                                                                \
+				d[0] = a | (a << 16);                           \
+				d[1] = a | (b << 16);                           \
+				d[2] = b | (b << 16);                           \
+				d += 3;                                         \
+			}                                                       \
+			for (uint32_t i = 0; i < DST_W / 2U; i++) {             \
+				row[DST_W / 2U + i] = row[i];                   \
+				row[DST_W + i] = row[i];                        \
+			}                                                       \
+		}                                                               \
+	}
+
+DEFINE_DRAW_LOOP(draw_xip, )
+DEFINE_DRAW_LOOP(draw_sram, __ramfunc)
+#ifdef __itcm_section
+DEFINE_DRAW_LOOP(draw_itcm, __itcm_section)
+#endif
+
+/* Current playback path: Helium row expand from XIP plus memcpy. */
+static __noinline void draw_mve(uint16_t *band, const uint16_t *src)
+{
+	for (uint32_t sy = 0; sy < SRC_H; sy++) {
+		pix_scale_nearest_row(band, DST_W, &src[sy * SRC_W], SRC_W);
+		memcpy(&band[DST_W], &band[0], DST_W * 2U);
+		memcpy(&band[DST_W * 2U], &band[0], DST_W * 2U);
+	}
+}
+
+typedef void (*draw_fn)(uint16_t *band, const uint16_t *src);
+
+static uint32_t time_draw(draw_fn fn, const uint8_t *src, bool cold)
+{
+	uint32_t total = 0;
+
+	if (!cold) {
+		fn(bench_band, (const uint16_t *)src);
+	}
+	for (uint32_t r = 0; r < BENCH_RUNS; r++) {
+		uint32_t t0;
+
+		if (cold) {
+			(void)sys_cache_data_flush_and_invd_all();
+			(void)sys_cache_instr_invd_all();
+		}
+		t0 = k_cycle_get_32();
+		fn(bench_band, (const uint16_t *)src);
+		total += k_cycle_get_32() - t0;
+	}
+	return total / BENCH_RUNS;
+}
+
+static void bench_one(const char *code, draw_fn fn, const char *data, const uint8_t *src)
+{
+	uint32_t warm = time_draw(fn, src, false);
+	uint32_t cold = time_draw(fn, src, true);
+
+	printk("DRAWBENCH code=%-4s data=%-4s warm=%7u us cold=%7u us\n", code, data,
+	       k_cyc_to_us_floor32(warm), k_cyc_to_us_floor32(cold));
+}
+
+void draw_bench_run(const uint8_t *frame, const char *src)
+{
+	static const struct {
+		const char *name;
+		draw_fn fn;
+	} code[] = {
+		{"xip", draw_xip},
+		{"sram", draw_sram},
+#ifdef __itcm_section
+		{"itcm", draw_itcm},
+#endif
+		{"mve", draw_mve},
+	};
+
+	memcpy(stage_buf, frame, FRAME_BYTES);
+
+	printk("draw loop, %ux%u -> %ux%u, avg of %u runs (cold = I+D invalidated)\n", SRC_W,
+	       SRC_H, DST_W, DST_H, BENCH_RUNS);
+	for (size_t i = 0; i < ARRAY_SIZE(code); i++) {
+		bench_one(code[i].name, code[i].fn, src, frame);
+		bench_one(code[i].name, code[i].fn, STAGE_MEM, stage_buf);
+	}
+#ifndef __itcm_section
+	printk("DRAWBENCH code=itcm n/a (no zephyr,itcm chosen node)\n");
+#endif
+}
+
+#else
+
+void draw_bench_run(const uint8_t *frame, const char *src)
+{
+	ARG_UNUSED(frame);
+	ARG_UNUSED(src);
+}
+
+#endif /* CONFIG_VIDEO_DRAW_BENCH */
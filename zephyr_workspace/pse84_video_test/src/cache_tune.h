@@ -0,0 +1,34 @@
+/*
+ * Cache maintenance and placement helpers for the video path.
+ *
+ * - fb_clean_band(): D-cache clean over a rectangle of socmem_fb so the
+ *   DC DMA sees it (CONFIG_VIDEO_FB_CLEAN).
+ * - src_prefetch(): PLD over a range of XIP frame data
+ *   (CONFIG_VIDEO_PREFETCH_SRC).
+ * - frame_stage(): copy a source frame into the TCM/SRAM staging
+ *   buffer (CONFIG_VIDEO_STAGE_FRAME).
+ * - draw_bench_run(): draw loop placement benchmark
+ *   (CONFIG_VIDEO_DRAW_BENCH).
+ */
+
+#ifndef PSE84_CACHE_TUNE_H_
+#define PSE84_CACHE_TUNE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+void cache_tune_init(void);
+
+void fb_clean_band(uint32_t x, uint32_t y, uint32_t w, uint32_t h);
+
+void src_prefetch(const void *p, size_t len);
+
+/* Returns the pointer to draw from: the staging copy, or `frame`
+ * itself when staging is disabled.
+ */
+const uint8_t *frame_stage(const uint8_t *frame);
+
+/* `src` names where `frame` lives, for the DRAWBENCH lines. */
+void draw_bench_run(const uint8_t *frame, const char *src);
+
+#endif /* PSE84_CACHE_TUNE_H_ */
@@ -0,0 +1,185 @@
+/*
+ * Source frame provider for playback (see frame_source.h).
+ */
+
+#include <errno.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+
+#include "cache_tune.h"
+#include "frame_source.h"
+#include "video.h"
+
+#ifdef CONFIG_VIDEO_VRLE
+#include "vrle.h"
+#endif
+#ifdef CONFIG_VIDEO_RENDER_OFFLOAD
+#include "render_ipc.h"
+#endif
+
+enum mode {
+	MODE_RAW,
+	MODE_M55,
+	MODE_M33,
+};
+
+static const char *const mode_name[] = {
+	[MODE_RAW] = "raw",
+	[MODE_M55] = "m55",
+	[MODE_M33] = "m33",
+};
+
+static enum mode mode;
+static struct frame_source_stats stats;
+
+#ifdef CONFIG_VIDEO_VRLE
+
+static const uint8_t frames_blob[] __aligned(4) = {
+#include "frames.vrle.inc"
+};
+
+static struct vrle vrle;
+static uint16_t decode_buf[SRC_W * SRC_H] __aligned(32);
+
+static const uint8_t *decode_local(uint32_t k)
+{
+	uint32_t t0 = k_cycle_get_32();
+	int err = vrle_decode(&vrle, k % NUM_FRAMES, decode_buf);
+
+	stats.decode_us_max = MAX(stats.decode_us_max,
+				  k_cyc_to_us_floor32(k_cycle_get_32() - t0));
+	if (err < 0) {
+		printk("frame %u: decode error %d\n", k % NUM_FRAMES, err);
+	}
+	return (const uint8_t *)decode_buf;
+}
+
+#else
+
+static const uint8_t frames_blob[] = {
+#include "frames.bin.inc"
+};
+
+BUILD_ASSERT(sizeof(frames_blob) == NUM_FRAMES * FRAME_BYTES,
+	     "frames.bin blob size does not match NUM_FRAMES * FRAME_BYTES");
+
+#endif /* CONFIG_VIDEO_VRLE */
+
+#ifdef CONFIG_VIDEO_RENDER_OFFLOAD
+
+/* Frame each slot was last asked for; slot = k & 1. */
+static uint32_t slot_frame[RENDER_IPC_SLOTS];
+
+static void request(uint32_t k)
+{
+	uint32_t slot = k % RENDER_IPC_SLOTS;
+
+	render_ipc_request(slot, k % NUM_FRAMES);
+	slot_frame[slot] = k;
+}
+
+static void fall_back(uint32_t k, const char *why)
+{
+	printk("render offload: %s at frame %u, decoding on the M55\n", why, k);
+	mode = MODE_M55;
+}
+
+static const uint8_t *get_remote(uint32_t k)
+{
+	uint32_t slot = k % RENDER_IPC_SLOTS;
+	uint32_t t0 = k_cycle_get_32();
+	const uint8_t *buf;
+
+	/* Frames skipped to catch up were never requested. */
+	if (slot_frame[slot] != k) {
+		request(k);
+	}
+	buf = render_ipc_wait(slot);
+	stats.wait_us_max = MAX(stats.wait_us_max, k_cyc_to_us_floor32(k_cycle_get_32() - t0));
+	if (buf == NULL) {
+		fall_back(k, "worker timeout");
+		return decode_local(k);
+	}
+	return buf;
+}
+
+#endif /* CONFIG_VIDEO_RENDER_OFFLOAD */
+
+int frame_source_init(void)
+{
+#ifdef CONFIG_VIDEO_VRLE
+	int n = vrle_open(&vrle, frames_blob, sizeof(frames_blob));
+
+	if (n != NUM_FRAMES || vrle_frame_pixels(&vrle) != SRC_W * SRC_H) {
+		printk("frames.vrle: bad header (%d frames)\n", n);
+		return -EINVAL;
+	}
+	printk("blob: %u frames, %u bytes VRL1 (%u%% of raw)\n", NUM_FRAMES,
+	       (unsigned int)sizeof(frames_blob),
+	       (unsigned int)(sizeof(frames_blob) * 100U / (NUM_FRAMES * FRAME_BYTES)));
+	mode = MODE_M55;
+#else
+	printk("blob: %u frames x %u bytes = %u bytes raw\n", NUM_FRAMES,
+	       (unsigned int)FRAME_BYTES, (unsigned int)sizeof(frames_blob));
+	mode = MODE_RAW;
+#endif
+
+#ifdef CONFIG_VIDEO_RENDER_OFFLOAD
+	int err = render_ipc_init(frames_blob, sizeof(frames_blob), FRAME_BYTES);
+
+	if (err == 0) {
+		mode = MODE_M33;
+		request(0);
+		request(1);
+	} else {
+		printk("render offload: no M33 worker (%d), decoding on the M55\n", err);
+	}
+#endif
+
+	printk("frame source: %s\n", mode_name[mode]);
+	return 0;
+}
+
+const char *frame_source_mode(void)
+{
+	return mode_name[mode];
+}
+
+const uint8_t *frame_source_get(uint32_t k)
+{
+	switch (mode) {
+#ifdef CONFIG_VIDEO_RENDER_OFFLOAD
+	case MODE_M33:
+		return get_remote(k);
+#endif
+#ifdef CONFIG_VIDEO_VRLE
+	case MODE_M55:
+		return decode_local(k);
+#else
+	case MODE_RAW:
+		return frame_stage(&frames_blob[(k % NUM_FRAMES) * FRAME_BYTES]);
+#endif
+	default:
+		return NULL;
+	}
+}
+
+void frame_source_done(uint32_t k)
+{
+#ifdef CONFIG_VIDEO_RENDER_OFFLOAD
+	/* Refill the slot just shown with the frame after next; the other
+	 * slot already holds (or is decoding) k + 1.
+	 */
+	if (mode == MODE_M33) {
+		request(k + RENDER_IPC_SLOTS);
+	}
+#else
+	ARG_UNUSED(k);
+#endif
+}
+
+void frame_source_stats(struct frame_source_stats *out)
+{
+	*out = stats;
+	stats = (struct frame_source_stats){0};
+}
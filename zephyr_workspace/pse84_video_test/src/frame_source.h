@@ -0,0 +1,37 @@
+/*
+ * Where playback gets each 240x144 RGB565 source frame:
+ *
+ *   raw  the uncompressed blob in XIP (CONFIG_VIDEO_VRLE=n), optionally
+ *        staged into TCM/SRAM (cache_tune.h)
+ *   m55  the VRL1 blob decoded on the M55 into SRAM
+ *   m33  decoded by the M33 render worker into shared SOCMEM, one frame
+ *        ahead (CONFIG_VIDEO_RENDER_OFFLOAD, common/render_ipc)
+ *
+ * m33 drops to m55 for good if the worker is missing at init or misses
+ * a frame.
+ */
+
+#ifndef PSE84_FRAME_SOURCE_H_
+#define PSE84_FRAME_SOURCE_H_
+
+#include <stdint.h>
+
+struct frame_source_stats {
+	uint32_t decode_us_max; /* on the M55; 0 in m33 mode */
+	uint32_t wait_us_max;   /* m33 mode: time blocked on the worker */
+};
+
+int frame_source_init(void);
+
+const char *frame_source_mode(void);
+
+/* Pixels of playback frame k (k counts up without wrapping). */
+const uint8_t *frame_source_get(uint32_t k);
+
+/* Frame k is on screen and its buffer is free again. */
+void frame_source_done(uint32_t k);
+
+/* Returns the stats since the last call and resets them. */
+void frame_source_stats(struct frame_source_stats *out);
+
+#endif /* PSE84_FRAME_SOURCE_H_ */
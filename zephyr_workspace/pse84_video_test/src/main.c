@@ -3,8 +3,22 @@
  *
  * Plays a 125-frame RGB565 animation (240x144 source, 3x pixel-doubled
  * to 720x432 on the 800x480 panel, centered with a 40/24 px black
- * border) at the native 24 fps. The raw frame blob is embedded as a
- * const in flash via generate_inc_file_for_target() — see CMakeLists.txt.
+ * border) at the native 24 fps. The frame blob is embedded as a const
+ * in flash via generate_inc_file_for_target() — see CMakeLists.txt —
+ * run-length coded by default, in which case each frame is decoded
+ * ahead of its draw window, on the M33 if the render worker in the
+ * companion image answers (frame_source.h).
+ *
+ * Frames are paced against the panel's refresh rather than the uptime
+ * clock: each source frame is assigned a refresh on a 24-on-61.8 Hz
+ * cadence and drawn into the live framebuffer, in one pass, at the
+ * start of the preceding refresh. The refresh clock's phase is not
+ * tied to the DC (see vsync.h), so this sets the cadence but does not
+ * keep the DC from scanning a half-written frame.
+ *
+ * Cache handling (Kconfig, cache_tune.h): each band is cleaned out of
+ * the D-cache right after it is written so the DC reads it, and the
+ * next source row is prefetched from XIP while the band is written.
  */
 
 #include <string.h>
@@ -13,28 +27,42 @@
 #include <zephyr/kernel.h>
 #include <zephyr/sys/printk.h>
 
-#define SRC_W       240U
-#define SRC_H       144U
-#define NUM_FRAMES  125U
-#define FRAME_BYTES (SRC_W * SRC_H * 2U)
+#ifdef CONFIG_CPU_LOAD_STATS
+#include "cpu_load.h"
+#endif
+#ifdef CONFIG_VIDEO_RENDER_OFFLOAD
+#include "render_ipc.h"
+#endif
+#ifdef CONFIG_IPC_BELL
+#include "ipc_bell.h"
+#endif
 
-#define UPSCALE     3U
-#define DST_W       (SRC_W * UPSCALE) /* 720 */
-#define DST_H       (SRC_H * UPSCALE) /* 432 */
+#include "cache_tune.h"
+#include "frame_source.h"
+#include "pixel.h"
+#include "video.h"
+#include "vsync.h"
 
-#define PANEL_W     800U
-#define PANEL_H     480U
-#define DST_X       ((PANEL_W - DST_W) / 2U) /* 40 */
-#define DST_Y       ((PANEL_H - DST_H) / 2U) /* 24 */
+#define CONTENT_FPS_MHZ 24000U /* source frame rate in milli-Hz */
 
-#define FRAME_PERIOD_MS 42U /* ~24 fps (1000 / 24 = 41.67) */
+/* Present-interval histogram: 4 ms bins, last bin is open-ended. */
+#define HIST_BIN_MS     4U
+#define HIST_BINS       20U
+#define STATS_FRAMES    120U /* ~5 s of content */
 
-static const uint8_t frames_blob[] = {
-#include "frames.bin.inc"
+struct pacing_stats {
+	uint32_t frames;
+	uint32_t dropped;   /* source frames skipped to catch up */
+	uint32_t repeated;  /* extra refreshes a frame stayed on screen */
+	uint32_t render_max_us;
+	uint32_t hist[HIST_BINS];
 };
 
-BUILD_ASSERT(sizeof(frames_blob) == NUM_FRAMES * FRAME_BYTES,
-	     "frames.bin blob size does not match NUM_FRAMES * FRAME_BYTES");
+static struct pacing_stats stats;
+static int64_t stats_start_ms;
+#ifdef CONFIG_CPU_LOAD_STATS
+static struct cpu_load m55_load;
+#endif
 
 /* Upscaled destination row: DST_W pixels, UPSCALE copies stacked. */
 static uint16_t dst_row_buf[DST_W * UPSCALE];
@@ -72,8 +100,14 @@ static void draw_border(const struct device *display)
 		(void)display_write(display, 0, y, &desc, border_row);
 		(void)display_write(display, DST_X + DST_W, y, &desc, border_row);
 	}
+
+	fb_clean_band(0, 0, PANEL_W, PANEL_H);
 }
 
+/* Draw one frame, 3-row band by band, as fast as it goes. There is no
+ * per-band wait: without a DC line or vsync interrupt there is nothing
+ * to chase, and waiting on the free-running model only added latency.
+ */
 static void draw_frame(const struct device *display, const uint8_t *frame)
 {
 	const uint16_t *src = (const uint16_t *)frame;
@@ -83,41 +117,106 @@ static void draw_frame(const struct device *display, const uint8_t *frame)
 		.pitch = DST_W,
 		.buf_size = sizeof(dst_row_buf),
 	};
-	uint32_t sy, sx;
+	uint32_t sy;
 
 	for (sy = 0; sy < SRC_H; sy++) {
-		const uint16_t *src_row = &src[sy * SRC_W];
-		uint16_t *out = dst_row_buf;
-
-		/* Horizontal 3x expand: each source pixel -> 3 dest pixels. */
-		for (sx = 0; sx < SRC_W; sx++) {
-			uint16_t p = src_row[sx];
+		uint32_t y0 = DST_Y + sy * UPSCALE;
 
-			out[0] = p;
-			out[1] = p;
-			out[2] = p;
-			out += UPSCALE;
-		}
+		/* Horizontal 3x expand (nearest at an integer ratio is an
+		 * exact replicate; Helium gather on the M55).
+		 */
+		pix_scale_nearest_row(dst_row_buf, DST_W, &src[sy * SRC_W], SRC_W);
 		/* Vertical 3x expand: replicate the row twice more. */
 		memcpy(&dst_row_buf[DST_W], &dst_row_buf[0], DST_W * 2U);
 		memcpy(&dst_row_buf[DST_W * 2U], &dst_row_buf[0], DST_W * 2U);
 
-		(void)display_write(display, DST_X, DST_Y + sy * UPSCALE, &desc,
-				    dst_row_buf);
+		/* Start the XIP fetch of the next source row so it overlaps
+		 * the write of this band.
+		 */
+		if (sy + 1U < SRC_H) {
+			src_prefetch(&src[(sy + 1U) * SRC_W], SRC_W * 2U);
+		}
+
+		(void)display_write(display, DST_X, y0, &desc, dst_row_buf);
+		fb_clean_band(DST_X, y0, DST_W, UPSCALE);
+	}
+}
+
+static void record_present(uint64_t interval_ns)
+{
+	uint32_t bin = (uint32_t)(interval_ns / (HIST_BIN_MS * 1000000ULL));
+
+	stats.hist[MIN(bin, HIST_BINS - 1U)]++;
+}
+
+/* Achieved frame rate and per-core load over the stats window. */
+static void print_cores(void)
+{
+	int64_t now = k_uptime_get();
+	uint32_t fps100 = (uint32_t)((uint64_t)STATS_FRAMES * 100000U /
+				     MAX(now - stats_start_ms, 1));
+	struct frame_source_stats fs;
+
+	frame_source_stats(&fs);
+	stats_start_ms = now;
+
+	printk("cores: src=%s fps=%u.%02u decode_max=%u us wait_max=%u us", frame_source_mode(),
+	       fps100 / 100U, fps100 % 100U, fs.decode_us_max, fs.wait_us_max);
+#ifdef CONFIG_CPU_LOAD_STATS
+	uint32_t m55 = cpu_load_update(&m55_load);
+
+	printk(" m55_busy=%u.%u%%", m55 / 10U, m55 % 10U);
+#endif
+#ifdef CONFIG_VIDEO_RENDER_OFFLOAD
+	struct render_ipc_worker w;
+
+	render_ipc_worker_status(&w);
+	if (w.magic == RENDER_IPC_WORKER_MAGIC) {
+		printk(" m33_busy=%u.%u%% m33_decode=%u us", w.busy_permille / 10U,
+		       w.busy_permille % 10U, w.decode_us);
 	}
+#endif
+#ifdef CONFIG_IPC_BELL
+	printk(" bells=%u", ipc_bell_count());
+#endif
+	printk("\n");
+}
+
+static void print_stats(void)
+{
+	printk("pacing: frames=%u dropped=%u repeated=%u render_max=%u us\n",
+	       stats.frames, stats.dropped, stats.repeated, stats.render_max_us);
+	printk("  present interval (ms):");
+	for (uint32_t i = 0; i < HIST_BINS; i++) {
+		if (stats.hist[i] == 0) {
+			continue;
+		}
+		if (i == HIST_BINS - 1U) {
+			printk(" [%u+)=%u", i * HIST_BIN_MS, stats.hist[i]);
+		} else {
+			printk(" [%u-%u)=%u", i * HIST_BIN_MS, (i + 1U) * HIST_BIN_MS,
+			       stats.hist[i]);
+		}
+	}
+	printk("\n");
+	memset(stats.hist, 0, sizeof(stats.hist));
+	stats.render_max_us = 0;
+	print_cores();
 }
 
 int main(void)
 {
 	const struct device *display;
 	struct display_capabilities caps;
-	uint32_t frame_idx = 0;
-	int64_t next_tick;
+	const struct vsync_timing *t;
+	uint32_t start, frame_k = 0;
+	uint32_t prev_present = 0;
+	bool have_prev = false;
 
 	printk("=== PSE84 video playback (240x144 -> 720x432 @ 24 fps) ===\n");
-	printk("blob: %u frames x %u bytes = %u bytes\n",
-	       NUM_FRAMES, (unsigned int)FRAME_BYTES,
-	       (unsigned int)sizeof(frames_blob));
+	if (frame_source_init() < 0) {
+		return -EINVAL;
+	}
 
 	display = DEVICE_DT_GET(DT_CHOSEN(zephyr_display));
 	if (!device_is_ready(display)) {
@@ -129,28 +228,78 @@ int main(void)
 	printk("display: %ux%u fmt 0x%x\n",
 	       caps.x_resolution, caps.y_resolution, caps.current_pixel_format);
 
+	vsync_init();
+	t = vsync_get_timing();
+	printk("scanout: %ux%u total, %u.%03u Hz, line %u ns\n",
+	       t->htotal, t->vtotal, t->refresh_mhz / 1000U,
+	       t->refresh_mhz % 1000U, (uint32_t)(t->line_ns >> 16));
+
+	cache_tune_init();
+	draw_bench_run(frame_source_get(0), frame_source_mode());
+
 	draw_border(display);
 
-	next_tick = k_uptime_get();
+	stats_start_ms = k_uptime_get();
+#ifdef CONFIG_CPU_LOAD_STATS
+	(void)cpu_load_update(&m55_load);
+#endif
+	start = vsync_now().refresh + 2U;
 	while (1) {
-		const uint8_t *frame = &frames_blob[frame_idx * FRAME_BYTES];
+		/* Refresh at which source frame k should first be visible. */
+		uint32_t due = start +
+			(uint32_t)(((uint64_t)frame_k * t->refresh_mhz) / CONTENT_FPS_MHZ);
+		struct vsync_pos pos = vsync_now();
+		uint32_t render_refresh, present;
+		const uint8_t *frame;
+		int64_t t0;
 
-		draw_frame(display, frame);
+		/* Drawing happens during the refresh before it is shown. If
+		 * that refresh has already started, skip ahead to the frame
+		 * the cadence says should be next.
+		 */
+		if (pos.refresh >= due) {
+			uint32_t on_time_k = (uint32_t)(((uint64_t)(pos.refresh + 1U - start) *
+							 CONTENT_FPS_MHZ) / t->refresh_mhz);
 
-		frame_idx++;
-		if (frame_idx >= NUM_FRAMES) {
-			frame_idx = 0;
+			if (on_time_k > frame_k) {
+				stats.dropped += on_time_k - frame_k;
+				frame_k = on_time_k;
+				due = start + (uint32_t)(((uint64_t)frame_k * t->refresh_mhz) /
+							 CONTENT_FPS_MHZ);
+			}
 		}
 
-		next_tick += FRAME_PERIOD_MS;
-		int64_t now = k_uptime_get();
-		int64_t sleep_ms = next_tick - now;
+		render_refresh = MAX(due - 1U, pos.refresh);
+		present = render_refresh + 1U;
+		if (present > due) {
+			stats.repeated += present - due;
+		}
 
-		if (sleep_ms > 0) {
-			k_msleep((uint32_t)sleep_ms);
-		} else {
-			/* We're behind schedule; resync to now. */
-			next_tick = now;
+		/* Decode, staging or waiting on the M33 all happen while the
+		 * previous frame is still being scanned out, ahead of the
+		 * draw window.
+		 */
+		frame = frame_source_get(frame_k);
+
+		vsync_wait_refresh(render_refresh);
+
+		t0 = k_uptime_ticks();
+		draw_frame(display, frame);
+		stats.render_max_us = MAX(stats.render_max_us,
+					  (uint32_t)k_ticks_to_us_ceil64(k_uptime_ticks() - t0));
+		frame_source_done(frame_k);
+
+		if (have_prev) {
+			record_present(vsync_refresh_ns(present) -
+				       vsync_refresh_ns(prev_present));
+		}
+		prev_present = present;
+		have_prev = true;
+
+		frame_k++;
+		stats.frames++;
+		if ((stats.frames % STATS_FRAMES) == 0U) {
+			print_stats();
 		}
 	}
 
@@ -0,0 +1,23 @@
+/*
+ * Source/destination geometry shared by the playback loop and the
+ * draw-loop benchmark.
+ */
+
+#ifndef PSE84_VIDEO_H_
+#define PSE84_VIDEO_H_
+
+#define SRC_W       240U
+#define SRC_H       144U
+#define NUM_FRAMES  125U
+#define FRAME_BYTES (SRC_W * SRC_H * 2U)
+
+#define UPSCALE     3U
+#define DST_W       (SRC_W * UPSCALE) /* 720 */
+#define DST_H       (SRC_H * UPSCALE) /* 432 */
+
+#define PANEL_W     800U
+#define PANEL_H     480U
+#define DST_X       ((PANEL_W - DST_W) / 2U) /* 40 */
+#define DST_Y       ((PANEL_H - DST_H) / 2U) /* 24 */
+
+#endif /* PSE84_VIDEO_H_ */
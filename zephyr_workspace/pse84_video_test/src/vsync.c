@@ -0,0 +1,86 @@
+/*
+ * GFXSS refresh clock (see vsync.h).
+ *
+ * Timing comes from the zephyr,display node so it always matches what
+ * the driver programmed into the DC. Fixed point (Q16 ns) keeps the
+ * 61.8 Hz refresh from drifting against the uptime clock.
+ */
+
+#include <zephyr/devicetree.h>
+#include <zephyr/kernel.h>
+
+#include "vsync.h"
+
+#define DISPLAY_NODE DT_CHOSEN(zephyr_display)
+
+#define PIXCLK_KHZ DT_PROP(DISPLAY_NODE, pixel_clock_khz)
+#define H_ACTIVE   DT_PROP(DISPLAY_NODE, width)
+#define V_ACTIVE   DT_PROP(DISPLAY_NODE, height)
+#define H_TOTAL    (H_ACTIVE + DT_PROP(DISPLAY_NODE, hsync_width) + \
+		    DT_PROP(DISPLAY_NODE, hfp) + DT_PROP(DISPLAY_NODE, hbp))
+#define V_TOTAL    (V_ACTIVE + DT_PROP(DISPLAY_NODE, vsync_width) + \
+		    DT_PROP(DISPLAY_NODE, vfp) + DT_PROP(DISPLAY_NODE, vbp))
+/* Raster order per frame: vsync, back porch, active, front porch. */
+#define V_ACTIVE_FIRST (DT_PROP(DISPLAY_NODE, vsync_width) + \
+			DT_PROP(DISPLAY_NODE, vbp))
+
+static struct vsync_timing timing;
+static uint64_t epoch_ns;
+
+static inline uint64_t now_ns(void)
+{
+	return k_ticks_to_ns_floor64(k_uptime_ticks());
+}
+
+static void sleep_until_ns(uint64_t t_ns)
+{
+	if (t_ns > now_ns()) {
+		k_sleep(K_TIMEOUT_ABS_TICKS(k_ns_to_ticks_ceil64(t_ns)));
+	}
+}
+
+void vsync_init(void)
+{
+	timing.htotal = H_TOTAL;
+	timing.vtotal = V_TOTAL;
+	timing.active_first = V_ACTIVE_FIRST;
+	timing.active_lines = V_ACTIVE;
+	timing.line_ns = ((uint64_t)H_TOTAL * 1000000ULL << 16) / PIXCLK_KHZ;
+	timing.period_ns = timing.line_ns * V_TOTAL;
+	timing.refresh_mhz = (uint32_t)((1000000000000ULL << 16) / timing.period_ns);
+
+	vsync_resync();
+}
+
+void vsync_resync(void)
+{
+	epoch_ns = now_ns();
+}
+
+const struct vsync_timing *vsync_get_timing(void)
+{
+	return &timing;
+}
+
+uint64_t vsync_refresh_ns(uint32_t refresh)
+{
+	return epoch_ns + (((uint64_t)refresh * timing.period_ns) >> 16);
+}
+
+struct vsync_pos vsync_now(void)
+{
+	uint64_t elapsed = (now_ns() - epoch_ns) << 16;
+	uint64_t in_frame = elapsed % timing.period_ns;
+	struct vsync_pos pos = {
+		.refresh = (uint32_t)(elapsed / timing.period_ns),
+		.row = (int32_t)(in_frame / timing.line_ns) - (int32_t)timing.active_first,
+	};
+
+	return pos;
+}
+
+uint32_t vsync_wait_refresh(uint32_t refresh)
+{
+	sleep_until_ns(vsync_refresh_ns(refresh));
+	return vsync_now().refresh;
+}
@@ -0,0 +1,63 @@
+/*
+ * Refresh clock for the GFXSS display controller.
+ *
+ * The DC runs in DSI video mode and scans socmem_fb continuously. The
+ * refresh period is derived from the panel timing in devicetree (pixel
+ * clock, active size, porches, sync widths) and counted from a time
+ * epoch:
+ *
+ *   refresh period = htotal * vtotal / pixel_clock
+ *   refresh number = (now - epoch) / period
+ *
+ * The epoch is set at vsync_init() and is not tied to the DC: the
+ * upstream-branch driver owns the DC interrupt and exposes no vsync,
+ * line or TE callback. The clock therefore has the DC's period but an
+ * arbitrary phase. It is good for whole-frame pacing, not for knowing
+ * where the scanout is within a refresh. vsync_resync() re-anchors
+ * the epoch and is meant to be called from a vsync/TE interrupt once
+ * the driver offers one.
+ */
+
+#ifndef PSE84_VSYNC_H_
+#define PSE84_VSYNC_H_
+
+#include <stdint.h>
+
+struct vsync_timing {
+	uint32_t htotal;
+	uint32_t vtotal;
+	uint32_t active_first;   /* raster line of active row 0 */
+	uint32_t active_lines;
+	uint64_t line_ns;        /* Q16 fixed point: ns << 16 */
+	uint64_t period_ns;      /* Q16 fixed point: ns << 16 */
+	uint32_t refresh_mhz;    /* refresh rate in milli-Hz */
+};
+
+/* Modelled position: refresh number since the epoch and active row
+ * (negative while in vertical blanking before the active area,
+ * >= active_lines in the front porch). Only `refresh` is meaningful
+ * until the epoch is anchored to the DC.
+ */
+struct vsync_pos {
+	uint32_t refresh;
+	int32_t row;
+};
+
+void vsync_init(void);
+
+/* Re-anchor the epoch so that "now" is the start of vsync. */
+void vsync_resync(void);
+
+const struct vsync_timing *vsync_get_timing(void);
+
+struct vsync_pos vsync_now(void);
+
+/* Sleep until the start of refresh `refresh` (no-op if already past).
+ * Returns the refresh number actually reached.
+ */
+uint32_t vsync_wait_refresh(uint32_t refresh);
+
+/* Nanoseconds since the epoch at which `refresh` begins. */
+uint64_t vsync_refresh_ns(uint32_t refresh);
+
+#endif /* PSE84_VSYNC_H_ */
@@ -0,0 +1,8 @@
+# Sysbuild configuration for pse84_video_test
+#
+# The M33 companion is the board's stock enable_cm55 image. Add the
+# render worker (m33/) to it as an extra Zephyr module; it is enabled
+# by CONFIG_RENDER_IPC in sysbuild/enable_cm55.conf.
+
+set(enable_cm55_EXTRA_ZEPHYR_MODULES ${APP_DIR}/m33 CACHE INTERNAL
+    "render worker module for the M33 companion")